@@ -7,7 +7,6 @@
 #include "SharedTrackerState.h"
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/mapped_region.hpp>
-#include <boost/interprocess/sync/scoped_lock.hpp>
 #include <algorithm>
 #include <iostream>
 #include <thread>
@@ -42,6 +41,10 @@ static void applyMorpheusDataFrame(const PSMoveProtocol::DeviceOutputDataFrame_H
 static void applyVirtualHMDDataFrame(const PSMoveProtocol::DeviceOutputDataFrame_HMDDataPacket& hmd_packet, PSMVirtualHMD *virtualHMD);
 
 // -- private definitions -----
+static_assert(
+    static_cast<int>(PSMVideoStreamFormat_MaskOverlay) == static_cast<int>(SharedVideoFrameFormat_MaskOverlay),
+    "PSMVideoStreamFormat must mirror eSharedVideoFrameFormat");
+
 class SharedVideoFrameReadOnlyAccessor
 {
 public:
@@ -52,7 +55,9 @@ public:
         , m_frame_width(0)
         , m_frame_height(0)
         , m_frame_stride(0)
+        , m_frame_channel_count(0)
         , m_last_frame_index(0)
+        , m_last_frame_capture_timestamp_us(0)
     {}
 
     ~SharedVideoFrameReadOnlyAccessor()
@@ -77,12 +82,25 @@ public:
                 new boost::interprocess::shared_memory_object(
                 boost::interprocess::open_only,
                 shared_memory_name,
-                boost::interprocess::read_write);
+                boost::interprocess::read_only);
 
-            // Map all of the shared memory for read/write access
-            m_region = new boost::interprocess::mapped_region(*m_shared_memory_object, boost::interprocess::read_write);
+            // Map all of the shared memory for read only access.
+            // Readers never write to the block, the service's slot sequence numbers are all it takes to avoid tearing.
+            m_region = new boost::interprocess::mapped_region(*m_shared_memory_object, boost::interprocess::read_only);
 
-            bSuccess = true;
+            // Make sure the service wrote the block in a layout we understand
+            const SharedVideoFrameHeader *sharedFrameState = getFrameHeader();
+            if (m_region->get_size() >= sizeof(SharedVideoFrameHeader) &&
+                sharedFrameState->layout_version == SharedVideoFrameHeader::k_layout_version &&
+                m_region->get_size() >= SharedVideoFrameHeader::computeTotalSize(sharedFrameState->stride, sharedFrameState->height))
+            {
+                bSuccess = true;
+            }
+            else
+            {
+                CLIENT_LOG_ERROR("SharedMemory::initialize()") << "Unsupported shared memory layout: " << m_shared_memory_name;
+                dispose();
+            }
         }
         catch (boost::interprocess::interprocess_exception &ex)
         {
@@ -123,18 +141,7 @@ public:
 
     bool readVideoFrame()
     {
-        bool bNewFrame = false;
-        SharedVideoFrameHeader *sharedFrameState = getFrameHeader();
-        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(sharedFrameState->mutex);
-
-        // Make sure the target buffer is big enough to read the video frame into
-        size_t buffer_size =
-            SharedVideoFrameHeader::computeVideoBufferSize(sharedFrameState->stride, sharedFrameState->height);
-
-        // Make sure the shared memory is the size we expect
-        size_t total_shared_mem_size =
-            SharedVideoFrameHeader::computeTotalSize(sharedFrameState->stride, sharedFrameState->height);
-        assert(m_region->get_size() >= total_shared_mem_size);
+        const SharedVideoFrameHeader *sharedFrameState = getFrameHeader();
 
         // Re-allocate the buffer if any of the video properties changed
         if (m_frame_width != sharedFrameState->width ||
@@ -146,21 +153,27 @@ public:
             m_frame_width = sharedFrameState->width;
             m_frame_height = sharedFrameState->height;
             m_frame_stride = sharedFrameState->stride;
+            m_frame_channel_count = sharedFrameState->channel_count;
 
             allocateVideoBuffer();
         }
 
-        // Copy over the video frame if the frame index changed
-        if (m_last_frame_index != sharedFrameState->frame_index)
+        if (m_bgr_frame_buffer == nullptr)
         {
-            if (buffer_size > 0)
-            {
-                std::memcpy(m_bgr_frame_buffer, sharedFrameState->getBufferMutable(), buffer_size);
-            }
+            return false;
+        }
 
-            m_last_frame_index = sharedFrameState->frame_index;
+        // Copy over the latest complete video frame if the frame index changed
+        int32_t frame_index = m_last_frame_index;
+        uint64_t capture_timestamp_us = m_last_frame_capture_timestamp_us;
+        const bool bNewFrame =
+            sharedFrameState->readLatestVideoFrame(
+                m_bgr_frame_buffer, m_last_frame_index, frame_index, capture_timestamp_us);
 
-            bNewFrame = true;
+        if (bNewFrame)
+        {
+            m_last_frame_index = frame_index;
+            m_last_frame_capture_timestamp_us = capture_timestamp_us;
         }
 
         return bNewFrame;
@@ -191,12 +204,14 @@ public:
     inline int getVideoFrameWidth() const { return m_frame_width; }
     inline int getVideoFrameHeight() const { return m_frame_height; }
     inline int getVideoFrameStride() const { return m_frame_stride; }
+    inline int getVideoFrameChannelCount() const { return m_frame_channel_count; }
     inline int getLastVideoFrameIndex() const { return m_last_frame_index; }
+    inline uint64_t getLastVideoFrameCaptureTimestamp() const { return m_last_frame_capture_timestamp_us; }
 
 protected:
-    SharedVideoFrameHeader *getFrameHeader()
+    const SharedVideoFrameHeader *getFrameHeader() const
     {
-        return reinterpret_cast<SharedVideoFrameHeader *>(m_region->get_address());
+        return reinterpret_cast<const SharedVideoFrameHeader *>(m_region->get_address());
     }
 
 private:
@@ -204,8 +219,9 @@ private:
     boost::interprocess::shared_memory_object *m_shared_memory_object;
     boost::interprocess::mapped_region *m_region;
     unsigned char *m_bgr_frame_buffer;
-    int m_frame_width, m_frame_height, m_frame_stride;
+    int m_frame_width, m_frame_height, m_frame_stride, m_frame_channel_count;
     int m_last_frame_index;
+    uint64_t m_last_frame_capture_timestamp_us;
 };
 
 // -- methods -----
@@ -327,6 +343,7 @@ bool PSMoveClient::startup(e_log_severity_level log_level)
 		{
 			m_trackers[tracker_id].tracker_info.tracker_id= tracker_id;
 			m_trackers[tracker_id].tracker_info.tracker_type= PSMTracker_None;
+			m_tracker_video_stream_formats[tracker_id]= PSMVideoStreamFormat_BGR;
 		}
 
 		memset(m_HMDs, 0, sizeof(PSMHeadMountedDisplay)*PSMOVESERVICE_MAX_HMD_COUNT);
@@ -920,14 +937,18 @@ PSMRequestID PSMoveClient::get_tracker_list()
     return request->request_id();
 }
 
-PSMRequestID PSMoveClient::start_tracker_data_stream(PSMTrackerID tracker_id)
+PSMRequestID PSMoveClient::start_tracker_data_stream(PSMTrackerID tracker_id, PSMVideoStreamFormat format)
 {
     CLIENT_LOG_INFO("start_tracker_data_stream") << "requesting tracker stream start for TrackerID: " << tracker_id << std::endl;
 
+    // Remember which shared memory block open_video_stream() should read from
+    m_tracker_video_stream_formats[tracker_id]= format;
+
     // Tell the psmove service that we are acquiring this tracker
     RequestPtr request(new PSMoveProtocol::Request());
     request->set_type(PSMoveProtocol::Request_RequestType_START_TRACKER_DATA_STREAM);
     request->mutable_request_start_tracker_data_stream()->set_tracker_id(tracker_id);
+    request->mutable_request_start_tracker_data_stream()->set_video_stream_format(static_cast<int>(format));
 
     m_request_manager->send_request(request);
 
@@ -959,8 +980,12 @@ bool PSMoveClient::open_video_stream(PSMTrackerID tracker_id)
 		if (tracker->opaque_shared_memory_accesor == nullptr)
 		{
 			SharedVideoFrameReadOnlyAccessor *shared_memory_accesor = new SharedVideoFrameReadOnlyAccessor();
+			const std::string shared_memory_name=
+				getSharedVideoFrameStreamName(
+					tracker->tracker_info.shared_memory_name,
+					static_cast<eSharedVideoFrameFormat>(m_tracker_video_stream_formats[tracker_id]));
 
-			if (shared_memory_accesor->initialize(tracker->tracker_info.shared_memory_name))
+			if (shared_memory_accesor->initialize(shared_memory_name.c_str()))
 			{
 				static const int k_max_read_attempt_count = 10;
 				int read_attempt = 0;
@@ -1051,6 +1076,29 @@ const unsigned char *PSMoveClient::get_video_frame_buffer(PSMTrackerID tracker_i
 
 	return buffer;
 }
+
+bool PSMoveClient::get_video_frame_size(PSMTrackerID tracker_id, int *out_width, int *out_height, int *out_channel_count) const
+{
+	bool bSuccess= false;
+
+	if (IS_VALID_TRACKER_INDEX(tracker_id))
+	{
+		const PSMTracker *tracker= &m_trackers[tracker_id];
+
+		if (tracker->opaque_shared_memory_accesor != nullptr)
+		{
+			SharedVideoFrameReadOnlyAccessor *shared_memory_accesor = 
+				reinterpret_cast<SharedVideoFrameReadOnlyAccessor *>(tracker->opaque_shared_memory_accesor);
+
+			*out_width= shared_memory_accesor->getVideoFrameWidth();
+			*out_height= shared_memory_accesor->getVideoFrameHeight();
+			*out_channel_count= shared_memory_accesor->getVideoFrameChannelCount();
+			bSuccess= true;
+		}
+	}
+
+	return bSuccess;
+}
     
 bool PSMoveClient::allocate_hmd_listener(PSMHmdID hmd_id)
 {
@@ -1266,6 +1314,8 @@ static void applyControllerDataFrame(
     controller->ControllerType = static_cast<PSMControllerType>(controller_packet.controller_type());
     controller->OutputSequenceNum = controller_packet.sequence_num();
     controller->IsConnected = controller_packet.isconnected();
+    controller->OpticalCaptureTimestampUs = controller_packet.optical_capture_timestamp_us();
+    controller->OpticalSampleAgeMs = controller_packet.optical_sample_age_ms();
 
     // Compute the data frame receive window statistics if we have received enough samples
     {
@@ -1860,6 +1910,8 @@ static void applyTrackerDataFrame(
     {
         tracker->sequence_num = tracker_packet.sequence_num();
         tracker->is_connected = tracker_packet.isconnected();
+        tracker->processed_vision_frame_count = tracker_packet.processed_vision_frame_count();
+        tracker->dropped_vision_frame_count = tracker_packet.dropped_vision_frame_count();
     }
 }
 
@@ -1876,6 +1928,8 @@ static void applyHmdDataFrame(
     hmd->HmdType = static_cast<PSMHmdType>(hmd_packet.hmd_type());
     hmd->OutputSequenceNum = hmd_packet.sequence_num();
     hmd->IsConnected = hmd_packet.isconnected();
+    hmd->OpticalCaptureTimestampUs = hmd_packet.optical_capture_timestamp_us();
+    hmd->OpticalSampleAgeMs = hmd_packet.optical_sample_age_ms();
 
     // Compute the data frame receive window statistics if we have received enough samples
     {
@@ -60,12 +60,13 @@ public:
     PSMTracker* get_tracker_view(PSMTrackerID tracker_id);
 	PSMRequestID get_tracking_space_settings();
     PSMRequestID get_tracker_list();
-    PSMRequestID start_tracker_data_stream(PSMTrackerID tracker_id);
+    PSMRequestID start_tracker_data_stream(PSMTrackerID tracker_id, PSMVideoStreamFormat format = PSMVideoStreamFormat_BGR);
     PSMRequestID stop_tracker_data_stream(PSMTrackerID tracker_id);
 	bool open_video_stream(PSMTrackerID tracker_id);
 	bool poll_video_stream(PSMTrackerID tracker_id);
 	void close_video_stream(PSMTrackerID tracker_id);
 	const unsigned char *get_video_frame_buffer(PSMTrackerID tracker_id) const;
+	bool get_video_frame_size(PSMTrackerID tracker_id, int *out_width, int *out_height, int *out_channel_count) const;
 
     bool allocate_hmd_listener(PSMHmdID HmdID);
     void free_hmd_listener(PSMHmdID HmdID);   
@@ -119,6 +120,7 @@ private:
 
     //-- Tracker Views -----
 	PSMTracker m_trackers[PSMOVESERVICE_MAX_TRACKER_COUNT];
+	PSMVideoStreamFormat m_tracker_video_stream_formats[PSMOVESERVICE_MAX_TRACKER_COUNT]; // format last requested for each tracker
     
     //-- HMD Views -----
 	PSMHeadMountedDisplay m_HMDs[PSMOVESERVICE_MAX_HMD_COUNT];
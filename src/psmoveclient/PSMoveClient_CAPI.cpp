@@ -1105,6 +1105,20 @@ PSMResult PSM_StartTrackerDataStream(PSMTrackerID tracker_id, int timeout_ms)
     return result;
 }
 
+PSMResult PSM_StartTrackerDataStreamWithFormat(PSMTrackerID tracker_id, PSMVideoStreamFormat format, int timeout_ms)
+{
+    PSMResult result= PSMResult_Error;
+
+    if (g_psm_client != nullptr && IS_VALID_TRACKER_INDEX(tracker_id))
+    {
+		PSMBlockingRequest request(g_psm_client->start_tracker_data_stream(tracker_id, format));
+
+		result= request.send(timeout_ms);
+    }
+
+    return result;
+}
+
 PSMResult PSM_StopTrackerDataStream(PSMTrackerID tracker_id, int timeout_ms)
 {
     PSMResult result= PSMResult_Error;
@@ -1195,6 +1209,24 @@ PSMResult PSM_GetTrackerVideoFrameBuffer(PSMTrackerID tracker_id, const unsigned
     return result;
 }
 
+PSMResult PSM_GetTrackerVideoFrameSize(PSMTrackerID tracker_id, int *out_width, int *out_height, int *out_channel_count)
+{
+    PSMResult result= PSMResult_Error;
+	assert(out_width != nullptr);
+	assert(out_height != nullptr);
+	assert(out_channel_count != nullptr);
+
+    if (g_psm_client != nullptr && IS_VALID_TRACKER_INDEX(tracker_id))
+    {
+		if (g_psm_client->get_video_frame_size(tracker_id, out_width, out_height, out_channel_count))
+		{
+			result= PSMResult_Success;
+		}
+    }
+
+    return result;
+}
+
 PSMResult PSM_GetTrackerFrustum(PSMTrackerID tracker_id, PSMFrustum *out_frustum)
 {
     PSMResult result= PSMResult_Error;
@@ -1257,6 +1289,25 @@ PSMResult PSM_StartTrackerDataStreamAsync(PSMTrackerID tracker_id, PSMRequestID
     return result_code;
 }
 
+PSMResult PSM_StartTrackerDataStreamWithFormatAsync(PSMTrackerID tracker_id, PSMVideoStreamFormat format, PSMRequestID *out_request_id)
+{
+    PSMResult result_code= PSMResult_Error;
+
+    if (g_psm_client != nullptr && IS_VALID_TRACKER_INDEX(tracker_id))
+    {
+        PSMRequestID req_id = g_psm_client->start_tracker_data_stream(tracker_id, format);
+
+        if (out_request_id != nullptr)
+        {
+            *out_request_id= req_id;
+        }
+
+        result_code= (req_id != PSM_INVALID_REQUEST_ID) ? PSMResult_RequestSent : PSMResult_Error;
+    }
+
+    return result_code;
+}
+
 PSMResult PSM_StopTrackerDataStreamAsync(PSMTrackerID tracker_id, PSMRequestID *out_request_id)
 {
     PSMResult result_code= PSMResult_Error;
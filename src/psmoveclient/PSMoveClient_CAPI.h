@@ -155,6 +155,17 @@ typedef enum
     PSMDriver_GENERIC_WEBCAM
 } PSMTrackerDriver;
 
+/// The formats a tracker video stream can be requested in
+typedef enum
+{
+    PSMVideoStreamFormat_BGR, ///< Full resolution BGR with the debug overlay
+    PSMVideoStreamFormat_HalfBGR, ///< Half resolution BGR with the debug overlay
+    PSMVideoStreamFormat_QuarterBGR, ///< Quarter resolution BGR with the debug overlay
+    PSMVideoStreamFormat_Gray, ///< Full resolution grayscale with the debug overlay
+    PSMVideoStreamFormat_Mask, ///< Full resolution 8-bit color segmentation mask
+    PSMVideoStreamFormat_MaskOverlay ///< Full resolution BGR color segmentation mask with the debug overlay
+} PSMVideoStreamFormat;
+
 // Controller State
 //------------------
 
@@ -396,6 +407,8 @@ typedef struct
     bool            IsConnected;
     long long       DataFrameLastReceivedTime;
     float           DataFrameAverageFPS;
+    unsigned long long OpticalCaptureTimestampUs; // service steady clock, 0 if not optically tracked
+    float           OpticalSampleAgeMs;
     int             ListenerCount;
 } PSMController;
 
@@ -446,6 +459,8 @@ typedef struct
     int sequence_num;
     long long data_frame_last_received_time;
     float data_frame_average_fps;
+    int processed_vision_frame_count; ///< video frames the service searched for tracked devices
+    int dropped_vision_frame_count; ///< video frames the service skipped to stay within its vision time budget
 
     // SharedVideoFrameReadOnlyAccessor used by config tool
     void *opaque_shared_memory_accesor;
@@ -512,6 +527,8 @@ typedef struct
     bool            IsConnected;
     long long       DataFrameLastReceivedTime;
     float           DataFrameAverageFPS;
+    unsigned long long OpticalCaptureTimestampUs; // service steady clock, 0 if not optically tracked
+    float           OpticalSampleAgeMs;
     int             ListenerCount;
 } PSMHeadMountedDisplay;
 
@@ -1225,6 +1242,18 @@ PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetTrackerList(PSMTrackerList *out_tracker_li
  */
 PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStream(PSMTrackerID tracker_id, int timeout_ms);
 
+/** \brief Requests start of a shared memory video stream in the given format for a given tracker
+	Same as \ref PSM_StartTrackerDataStream, but the video gets streamed in the given format.
+	Reduced formats cost PSMoveService and the client a lot less to copy than full resolution BGR.
+	\ref PSM_OpenTrackerVideoStream opens the video in the format last requested for the tracker.
+	\remark Blocking - Returns after either stream start response comes back OR the timeout period is reached. 
+	\param tracker_id The id of the tracker to start the stream for.
+	\param format The \ref PSMVideoStreamFormat the video frames are written in
+	\param timeout_ms The conection timeout period in milliseconds, usually PSM_DEFAULT_TIMEOUT
+	\return PSMResult_Success upon receiving result, PSMResult_Timeoout, or PSMResult_Error on request error.
+ */
+PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStreamWithFormat(PSMTrackerID tracker_id, PSMVideoStreamFormat format, int timeout_ms);
+
 /** \brief Requests stop of a shared memory video stream for a given tracker
 	Asks PSMoveService to stop an active video stream for the given tracker.
 	\remark Video streams can only be started on clients that run on the same machine as PSMoveService is running on.
@@ -1276,6 +1305,16 @@ PSM_PUBLIC_FUNCTION(PSMResult) PSM_CloseTrackerVideoStream(PSMTrackerID tracker_
  */
 PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetTrackerVideoFrameBuffer(PSMTrackerID tracker_id, const unsigned char **out_buffer); 
 
+/** \brief Fetch the size of the frames in an opened tracker video stream
+	Reduced resolution formats are smaller than the tracker screen dimensions, and the gray and mask formats have one byte per pixel.
+	\param tracker_id The tracker whose video stream we want the frame size of
+	\param[out] out_width The frame width in pixels
+	\param[out] out_height The frame height in pixels
+	\param[out] out_channel_count The number of bytes per pixel (3 for BGR, 1 for gray or mask)
+	\return PSMResult_Success if the video stream is open
+ */
+PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetTrackerVideoFrameSize(PSMTrackerID tracker_id, int *out_width, int *out_height, int *out_channel_count);
+
 /** \brief Helper function to fetch tracking frustum properties from a tracker
 	\param The id of the tracker we wish to get the tracking frustum properties for
 	\param out_frustum The tracking frustum properties to write the result into
@@ -1310,6 +1349,15 @@ PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetTrackerFrustum(PSMTrackerID tracker_id, PS
  */
 PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStreamAsync(PSMTrackerID tracker_id, PSMRequestID *out_request_id);
 
+/** \brief Requests start shared memory video stream in the given format for a given tracker
+	Same as \ref PSM_StartTrackerDataStreamAsync, but the video gets streamed in the given format.
+	\param tracker_id The tracker id we wish to start the stream for
+	\param format The \ref PSMVideoStreamFormat the video frames are written in
+	\param[out] out_request_id The id of the request sent to PSMoveService. Can be used to register callback with \ref PSM_RegisterCallback.
+	\return PSMResult_RequestSent on success or PSMResult_Error if there was no valid connection
+ */
+PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStreamWithFormatAsync(PSMTrackerID tracker_id, PSMVideoStreamFormat format, PSMRequestID *out_request_id);
+
 /** \brief Requests stop shared memory video stream for a given tracker
 	Asks PSMoveService to stop video data for the given tracker.
 	\remark Async - Result obtained in one of two ways:
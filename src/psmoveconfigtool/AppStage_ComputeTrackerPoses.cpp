@@ -1365,10 +1365,12 @@ void AppStage_ComputeTrackerPoses::request_tracker_start_stream(
     // Increment the number of requests we're waiting to get back
     ++m_pendingTrackerStartCount;
 
-    // Request data to start streaming to the tracker
+    // Request data to start streaming to the tracker.
+    // The video is only ever shown as a preview, so half resolution is plenty.
     PSMRequestID requestID;
-    PSM_StartTrackerDataStreamAsync(
+    PSM_StartTrackerDataStreamWithFormatAsync(
         TrackerInfo->tracker_id, 
+        PSMVideoStreamFormat_HalfBGR,
         &requestID);
     PSM_RegisterCallback(requestID, AppStage_ComputeTrackerPoses::handle_tracker_start_stream_response, this);
 }
@@ -1396,13 +1398,15 @@ void AppStage_ComputeTrackerPoses::handle_tracker_start_stream_response(
             PSMClientTrackerInfo &trackerInfo= trackerState.trackerView->tracker_info;
 
             // Open the shared memory that the video stream is being written to
-            if (PSM_OpenTrackerVideoStream(trackerInfo.tracker_id) == PSMResult_Success)
+            int frame_width, frame_height, frame_channel_count;
+            if (PSM_OpenTrackerVideoStream(trackerInfo.tracker_id) == PSMResult_Success &&
+                PSM_GetTrackerVideoFrameSize(trackerInfo.tracker_id, &frame_width, &frame_height, &frame_channel_count) == PSMResult_Success)
             {
                 // Create a texture to render the video frame to
                 trackerState.textureAsset = new TextureAsset();
                 trackerState.textureAsset->init(
-                    static_cast<unsigned int>(trackerInfo.tracker_screen_dimensions.x),
-                    static_cast<unsigned int>(trackerInfo.tracker_screen_dimensions.y),
+                    static_cast<unsigned int>(frame_width),
+                    static_cast<unsigned int>(frame_height),
                     GL_RGB, // texture format
                     GL_BGR, // buffer format
                     nullptr);
@@ -5,48 +5,239 @@
 #define BOOST_INTERPROCESS_SHARED_DIR_PATH "shared_mem"
 #endif // WIN32
 
-#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <string>
 
+// Formats a tracker's video can be streamed in (see RequestStartTrackerDataStream).
+// Every format a client asks for gets its own shared memory block,
+// and the service converts each frame once per format no matter how many clients read it.
+enum eSharedVideoFrameFormat
+{
+    SharedVideoFrameFormat_BGR, // full resolution BGR with the debug overlay
+    SharedVideoFrameFormat_HalfBGR, // half resolution BGR with the debug overlay
+    SharedVideoFrameFormat_QuarterBGR, // quarter resolution BGR with the debug overlay
+    SharedVideoFrameFormat_Gray, // full resolution grayscale with the debug overlay
+    SharedVideoFrameFormat_Mask, // full resolution 8-bit segmentation mask
+    SharedVideoFrameFormat_MaskOverlay, // full resolution BGR: the tinted mask with the debug overlay over black
+
+    SharedVideoFrameFormat_Count
+};
+
+inline bool getIsSharedVideoFrameFormatValid(int format)
+{
+    return format >= 0 && format < SharedVideoFrameFormat_Count;
+}
+
+// How many times smaller each side of the streamed frame is than the captured one
+inline int getSharedVideoFrameFormatDownscale(eSharedVideoFrameFormat format)
+{
+    switch (format)
+    {
+    case SharedVideoFrameFormat_HalfBGR:
+        return 2;
+    case SharedVideoFrameFormat_QuarterBGR:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+inline int getSharedVideoFrameFormatChannelCount(eSharedVideoFrameFormat format)
+{
+    return (format == SharedVideoFrameFormat_Gray || format == SharedVideoFrameFormat_Mask) ? 1 : 3;
+}
+
+// Full BGR frames keep the tracker's base block name so older clients still find them
+inline std::string getSharedVideoFrameStreamName(const std::string &base_name, eSharedVideoFrameFormat format)
+{
+    switch (format)
+    {
+    case SharedVideoFrameFormat_HalfBGR:
+        return base_name + "_half";
+    case SharedVideoFrameFormat_QuarterBGR:
+        return base_name + "_quarter";
+    case SharedVideoFrameFormat_Gray:
+        return base_name + "_gray";
+    case SharedVideoFrameFormat_Mask:
+        return base_name + "_mask";
+    case SharedVideoFrameFormat_MaskOverlay:
+        return base_name + "_mask_overlay";
+    default:
+        return base_name;
+    }
+}
+
+// The video stream shared memory block is laid out as:
+//
+//   [SharedVideoFrameHeader][frame slot 0][frame slot 1][frame slot 2]
+//
+// The service writes each new frame into the slot after the latest one and then makes it the latest.
+// Each slot carries a sequence number that is odd while the slot is being written (a seqlock).
+// Readers copy the latest slot and retry if its sequence number changed while they were copying it.
+// This way the service never waits on a reader and any number of readers never see a torn frame.
+// Readers only ever load from the block, so they can map it read-only.
 class SharedVideoFrameHeader
 {
 public:
-    SharedVideoFrameHeader()
-        : mutex()
-        , width(0)
-        , height(0)
-        , stride(0)
-        , frame_index(0)
+    // Bump this whenever the layout of the block changes
+    static const uint32_t k_layout_version = 3;
+    static const int k_slot_count = 3;
+    static const size_t k_slot_alignment = 64;
+    static const int k_max_read_attempts = 4;
+
+    struct FrameSlot
     {
+        // Odd while the service is writing the slot
+        std::atomic<uint32_t> sequence;
+        // Increases by one for every frame written to the block
+        int32_t frame_index;
+        // When the frame was captured, in microseconds on the service's monotonic clock
+        uint64_t capture_timestamp_us;
+    };
+
+    SharedVideoFrameHeader(eSharedVideoFrameFormat frame_format, int frame_width, int frame_height, int frame_stride)
+        : layout_version(k_layout_version)
+        , format(frame_format)
+        , channel_count(getSharedVideoFrameFormatChannelCount(frame_format))
+        , width(frame_width)
+        , height(frame_height)
+        , stride(frame_stride)
+        , latest_slot(-1)
+        , last_frame_index(0)
+    {
+        for (int slot_index = 0; slot_index < k_slot_count; ++slot_index)
+        {
+            slots[slot_index].sequence.store(0, std::memory_order_relaxed);
+            slots[slot_index].frame_index = 0;
+            slots[slot_index].capture_timestamp_us = 0;
+        }
     }
-    
-    //Mutex to protect access to the shared memory
-    boost::interprocess::interprocess_mutex mutex;
 
-    int width;
-    int height;
-    int stride;
-    int frame_index;
-    // Buffer stored past the end of the header
+    uint32_t layout_version;
+    int32_t format; // eSharedVideoFrameFormat
+    int32_t channel_count; // bytes per pixel
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+    // Slot holding the most recent complete frame (-1 until the first frame is written)
+    std::atomic<int32_t> latest_slot;
+    // Only touched by the writer
+    int32_t last_frame_index;
+    FrameSlot slots[k_slot_count];
+    // Frame slot buffers stored past the end of the header
 
-    const unsigned char *getBuffer() const
+    const unsigned char *getSlotBuffer(int slot_index) const
     {
-        return reinterpret_cast<const unsigned char *>(this) + sizeof(SharedVideoFrameHeader);
+        return
+            reinterpret_cast<const unsigned char *>(this) + computeHeaderSize() +
+            slot_index*computeSlotStride(stride, height);
     }
 
-    unsigned char *getBufferMutable()
+    unsigned char *getSlotBufferMutable(int slot_index)
     {
-        return const_cast<unsigned char *>(getBuffer());
+        return const_cast<unsigned char *>(getSlotBuffer(slot_index));
+    }
+
+    // Copies the frame into the slot after the latest one and publishes it. Never blocks.
+    // Only one process (the service) may write to a block.
+    void writeVideoFrame(const unsigned char *buffer, uint64_t capture_timestamp_us)
+    {
+        const int32_t slot_index = (latest_slot.load(std::memory_order_relaxed) + 1) % k_slot_count;
+        FrameSlot &slot = slots[slot_index];
+        const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+        // Mark the slot as being written before touching any of it
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        ++last_frame_index;
+        slot.frame_index = last_frame_index;
+        slot.capture_timestamp_us = capture_timestamp_us;
+        memcpy(getSlotBufferMutable(slot_index), buffer, computeVideoBufferSize(stride, height));
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        latest_slot.store(slot_index, std::memory_order_release);
+    }
+
+    // Copies the latest complete frame into out_buffer if it's newer than known_frame_index.
+    // Returns false if there was no new frame, or if the writer kept lapping the copy
+    // (only possible when the reader is k_slot_count frames slower than the writer).
+    bool readLatestVideoFrame(
+        unsigned char *out_buffer,
+        int32_t known_frame_index,
+        int32_t &out_frame_index,
+        uint64_t &out_capture_timestamp_us) const
+    {
+        for (int attempt = 0; attempt < k_max_read_attempts; ++attempt)
+        {
+            const int32_t slot_index = latest_slot.load(std::memory_order_acquire);
+            if (slot_index < 0 || slot_index >= k_slot_count)
+            {
+                // Nothing written yet
+                return false;
+            }
+
+            const FrameSlot &slot = slots[slot_index];
+            const uint32_t sequence_before = slot.sequence.load(std::memory_order_acquire);
+            if ((sequence_before & 1) != 0)
+            {
+                // Writer already moved on to this slot
+                continue;
+            }
+
+            const int32_t frame_index = slot.frame_index;
+            const uint64_t capture_timestamp_us = slot.capture_timestamp_us;
+            const bool bNewFrame = frame_index != known_frame_index;
+
+            if (bNewFrame)
+            {
+                memcpy(out_buffer, getSlotBuffer(slot_index), computeVideoBufferSize(stride, height));
+            }
+
+            // Keep the copy above from being reordered past the sequence check
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence_before)
+            {
+                if (bNewFrame)
+                {
+                    out_frame_index = frame_index;
+                    out_capture_timestamp_us = capture_timestamp_us;
+                }
+
+                return bNewFrame;
+            }
+        }
+
+        return false;
+    }
+
+    static size_t computeHeaderSize()
+    {
+        return alignSize(sizeof(SharedVideoFrameHeader));
     }
 
     static size_t computeVideoBufferSize(int stride, int height)
     {
-        return stride*height;
+        return static_cast<size_t>(stride)*static_cast<size_t>(height);
+    }
+
+    static size_t computeSlotStride(int stride, int height)
+    {
+        return alignSize(computeVideoBufferSize(stride, height));
     }
 
     static size_t computeTotalSize(int stride, int height)
     {
-        return sizeof(SharedVideoFrameHeader) + computeVideoBufferSize(stride, height);
+        return computeHeaderSize() + k_slot_count*computeSlotStride(stride, height);
+    }
+
+private:
+    static size_t alignSize(size_t size)
+    {
+        return (size + k_slot_alignment - 1) & ~(k_slot_alignment - 1);
     }
 };
 
-#endif // SHARED_TRACKER_STATE_H
\ No newline at end of file
+#endif // SHARED_TRACKER_STATE_H
@@ -2,6 +2,7 @@
 #define DEVICE_INTERFACE_H
 
 // -- includes -----
+#include <chrono>
 #include <string>
 #include <tuple>
 
@@ -291,9 +292,8 @@ struct CommonControllerState : CommonDeviceState
 
     enum BatteryLevel Battery;
     unsigned int AllButtons;                    // all-buttons, used to detect changes
+    std::chrono::steady_clock::time_point ArrivalTime; // when the host received the input report
 
-    //TODO: high-precision timestamp. Need to do in hidapi?
-    
     inline CommonControllerState()
     {
         clear();
@@ -305,6 +305,7 @@ struct CommonControllerState : CommonDeviceState
         DeviceType= SUPPORTED_CONTROLLER_TYPE_COUNT; // invalid
         Battery= Batt_MAX;
         AllButtons= 0;
+        ArrivalTime= std::chrono::steady_clock::time_point();
     }
 };
 
@@ -447,6 +448,10 @@ public:
     // Fetch the device state at the given sample index.
     // A lookBack of 0 corresponds to the most recent data.
     virtual const CommonDeviceState * getState(int lookBack = 0) const = 0;   
+
+    // Returns true if a reader thread has input waiting for the next poll().
+    // Devices that only read during poll() never do.
+    virtual bool getHasQueuedInput() const { return false; }
 };
 
 /// Abstract class for controller interface. Implemented in PSMoveController.cpp
@@ -526,8 +531,9 @@ public:
     // Returns the video frame size (used to compute frame buffer size)
     virtual bool getVideoFrameDimensions(int *out_width, int *out_height, int *out_stride) const = 0;
 
-    // Returns a pointer to the last video frame buffer captured
-    virtual const unsigned char *getVideoFrameBuffer() const = 0;
+    // Returns a reference to the last video frame captured (invalid if there isn't one yet).
+    // The frame won't get captured over while the reference is held.
+    virtual class TrackerVideoFrameRef getVideoFrame() const = 0;
 
     static const char *getDriverTypeString(eDriverType device_type)
     {
@@ -0,0 +1,219 @@
+// -- includes -----
+#include "DeviceOutputWriter.h"
+#include "ServerLog.h"
+#include "ServerUtility.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+// -- constants -----
+// Writes slower than this get logged
+static const float k_slow_write_warning_ms = 20.f;
+
+// -- public methods -----
+DeviceOutputWriter::DeviceOutputWriter(const std::string &device_name)
+    : m_device_name(device_name)
+    , m_write_func()
+    , m_min_write_interval(0)
+    , m_keep_alive_interval(0)
+    , m_bReportPending(false)
+    , m_exit_signaled(false)
+    , m_bHasWrittenReport(false)
+    , m_last_write_time()
+    , m_bLastWriteFailed(false)
+    , m_thread_started(false)
+    , m_write_count(0)
+    , m_failed_write_count(0)
+    , m_coalesced_report_count(0)
+    , m_max_write_latency_ms(0.f)
+{
+}
+
+DeviceOutputWriter::~DeviceOutputWriter()
+{
+    stop();
+}
+
+void DeviceOutputWriter::start(t_write_report_func write_func, int min_write_interval_ms, int keep_alive_interval_ms)
+{
+    if (!m_thread_started)
+    {
+        SERVER_LOG_INFO("DeviceOutputWriter::start") << "Starting output writer thread for " << m_device_name;
+
+        m_write_func = write_func;
+        m_min_write_interval = std::chrono::milliseconds(std::max(min_write_interval_ms, 0));
+        m_keep_alive_interval = std::chrono::milliseconds(std::max(keep_alive_interval_ms, 0));
+        m_bReportPending = false;
+        m_bHasWrittenReport = false;
+        m_bLastWriteFailed = false;
+        m_write_count = 0;
+        m_failed_write_count = 0;
+        m_coalesced_report_count = 0;
+        m_max_write_latency_ms = 0.f;
+
+        m_exit_signaled = false;
+        m_writer_thread = std::thread(&DeviceOutputWriter::writerThreadFunc, this);
+        m_thread_started = true;
+    }
+}
+
+void DeviceOutputWriter::stop()
+{
+    if (m_thread_started)
+    {
+        SERVER_LOG_INFO("DeviceOutputWriter::stop") << "Stopping output writer thread for " << m_device_name;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit_signaled = true;
+        }
+        m_condition.notify_one();
+        m_writer_thread.join();
+
+        m_thread_started = false;
+        m_write_func = t_write_report_func();
+
+        SERVER_LOG_INFO("DeviceOutputWriter::stop") << m_device_name << " wrote " << m_write_count
+            << " reports (" << m_failed_write_count << " failed, " << m_coalesced_report_count
+            << " coalesced), max write latency " << m_max_write_latency_ms << "ms";
+    }
+}
+
+bool DeviceOutputWriter::postReport(const unsigned char *report, size_t report_size, bool bKeepAlive)
+{
+    assert(report_size <= MAX_DEVICE_OUTPUT_REPORT_SIZE);
+    bool bPosted = false;
+
+    if (m_thread_started)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_bReportPending)
+            {
+                // Keep the older post time so the latency covers the whole wait
+                ++m_coalesced_report_count;
+            }
+            else
+            {
+                m_pending_report.post_time = std::chrono::steady_clock::now();
+            }
+
+            m_pending_report.size = std::min(report_size, static_cast<size_t>(MAX_DEVICE_OUTPUT_REPORT_SIZE));
+            memcpy(m_pending_report.data, report, m_pending_report.size);
+            m_pending_report.bKeepAlive = bKeepAlive;
+            m_bReportPending = true;
+        }
+        m_condition.notify_one();
+
+        bPosted = true;
+    }
+
+    return bPosted;
+}
+
+// -- private methods -----
+void DeviceOutputWriter::writerThreadFunc()
+{
+    ServerUtility::set_current_thread_name("Device Output Thread");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_exit_signaled)
+    {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const bool bKeepAliveDue =
+            !m_bReportPending && m_bHasWrittenReport &&
+            m_last_written_report.bKeepAlive && m_keep_alive_interval.count() > 0;
+
+        if (m_bReportPending || bKeepAliveDue)
+        {
+            const std::chrono::steady_clock::time_point write_time = m_bHasWrittenReport
+                ? m_last_write_time + (m_bReportPending ? m_min_write_interval : m_keep_alive_interval)
+                : now;
+
+            if (now < write_time)
+            {
+                // Further posts in the meantime replace the pending report
+                m_condition.wait_until(lock, write_time);
+            }
+            else
+            {
+                OutputReport report = m_bReportPending ? m_pending_report : m_last_written_report;
+                const bool bIsKeepAlive = !m_bReportPending;
+
+                m_bReportPending = false;
+
+                lock.unlock();
+                writeReport(report, bIsKeepAlive);
+                lock.lock();
+            }
+        }
+        else
+        {
+            m_condition.wait(lock);
+        }
+    }
+
+    // Don't drop the last word (e.g. turning the LED and rumble off on close)
+    if (m_bReportPending)
+    {
+        OutputReport report = m_pending_report;
+
+        m_bReportPending = false;
+
+        lock.unlock();
+        writeReport(report, false);
+    }
+}
+
+void DeviceOutputWriter::writeReport(const OutputReport &report, bool bIsKeepAlive)
+{
+    const std::chrono::steady_clock::time_point write_start_time = std::chrono::steady_clock::now();
+    const bool bSuccess = m_write_func(report.data, report.size);
+    const std::chrono::steady_clock::time_point write_end_time = std::chrono::steady_clock::now();
+
+    m_last_written_report = report;
+    m_bHasWrittenReport = true;
+    m_last_write_time = write_start_time;
+    ++m_write_count;
+
+    if (bSuccess)
+    {
+        if (m_bLastWriteFailed)
+        {
+            SERVER_LOG_INFO("DeviceOutputWriter") << m_device_name << " output writes recovered";
+        }
+
+        // Keep-alive repeats never waited on anybody
+        if (!bIsKeepAlive)
+        {
+            const float latency_ms =
+                std::chrono::duration<float, std::milli>(write_end_time - report.post_time).count();
+            const float write_duration_ms =
+                std::chrono::duration<float, std::milli>(write_end_time - write_start_time).count();
+
+            if (latency_ms > m_max_write_latency_ms)
+            {
+                m_max_write_latency_ms = latency_ms;
+            }
+
+            if (write_duration_ms > k_slow_write_warning_ms)
+            {
+                SERVER_LOG_WARNING("DeviceOutputWriter") << m_device_name << " output write took " << write_duration_ms << "ms";
+            }
+        }
+    }
+    else
+    {
+        ++m_failed_write_count;
+
+        // Only log the first failure of a streak, the device is probably going away
+        if (!m_bLastWriteFailed)
+        {
+            SERVER_LOG_WARNING("DeviceOutputWriter") << m_device_name << " output write failed";
+        }
+    }
+
+    m_bLastWriteFailed = !bSuccess;
+}
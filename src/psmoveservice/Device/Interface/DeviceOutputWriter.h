@@ -0,0 +1,85 @@
+#ifndef DEVICE_OUTPUT_WRITER_H
+#define DEVICE_OUTPUT_WRITER_H
+
+// -- includes -----
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// -- constants -----
+// Largest output report a writer can hold (DS4 bluetooth output reports are under 80 bytes)
+#define MAX_DEVICE_OUTPUT_REPORT_SIZE 128
+
+// -- definitions -----
+// Writes the output reports of one device (LED, rumble, commands) on a dedicated thread,
+// so a slow bluetooth or USB write never stalls the main loop.
+// Posting a report replaces whatever report is still waiting to be written (the latest value wins),
+// and reports are written at most once per minimum write interval.
+// A keep-alive report gets written again on an interval until a newer report replaces it
+// (e.g. the PSMove turns its LED off if it doesn't hear from the host).
+class DeviceOutputWriter
+{
+public:
+    // Writes one report to the device on the writer thread, returns false if the write failed
+    typedef std::function<bool(const unsigned char *report, size_t report_size)> t_write_report_func;
+
+    DeviceOutputWriter(const std::string &device_name);
+    ~DeviceOutputWriter();
+
+    // keep_alive_interval_ms of 0 turns keep-alive reports off
+    void start(t_write_report_func write_func, int min_write_interval_ms, int keep_alive_interval_ms);
+    // Writes the last posted report if it is still pending, then stops the thread
+    void stop();
+
+    // Never blocks on the device. Returns false if the writer isn't running.
+    bool postReport(const unsigned char *report, size_t report_size, bool bKeepAlive);
+
+    inline bool getIsRunning() const
+    { return m_thread_started; }
+
+protected:
+    struct OutputReport
+    {
+        unsigned char data[MAX_DEVICE_OUTPUT_REPORT_SIZE];
+        size_t size;
+        bool bKeepAlive;
+        std::chrono::steady_clock::time_point post_time;
+    };
+
+    void writerThreadFunc();
+    void writeReport(const OutputReport &report, bool bIsKeepAlive);
+
+private:
+    std::string m_device_name;
+    t_write_report_func m_write_func;
+    std::chrono::milliseconds m_min_write_interval;
+    std::chrono::milliseconds m_keep_alive_interval;
+
+    // Shared state
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    OutputReport m_pending_report;
+    bool m_bReportPending;
+    std::atomic_bool m_exit_signaled;
+
+    // Writer thread state
+    OutputReport m_last_written_report;
+    bool m_bHasWrittenReport;
+    std::chrono::steady_clock::time_point m_last_write_time;
+    bool m_bLastWriteFailed;
+
+    std::thread m_writer_thread;
+    bool m_thread_started;
+
+    // Write statistics, logged when the writer stops
+    std::atomic_int m_write_count;
+    std::atomic_int m_failed_write_count;
+    std::atomic_int m_coalesced_report_count;
+    std::atomic<float> m_max_write_latency_ms;
+};
+
+#endif // DEVICE_OUTPUT_WRITER_H
@@ -0,0 +1,136 @@
+// -- includes -----
+#include "DeviceSampleClock.h"
+
+#include <algorithm>
+
+// -- constants -----
+// How much host time has to pass before it's trusted to calibrate the tick period
+static const float k_min_calibration_seconds = 1.f;
+// Consecutive reports with the same timestamp before the timestamp is considered stuck
+static const int k_max_stalled_timestamp_count = 4;
+
+// -- public methods -----
+DeviceSampleClock::DeviceSampleClock()
+{
+    Settings settings;
+    settings.timestamp_bits = 16;
+    settings.sequence_bits = 0;
+    settings.seconds_per_tick = 0.f;
+    settings.nominal_sample_seconds = 1.f / 60.f;
+    settings.max_sample_seconds = 1.f / 10.f;
+
+    reset(settings);
+}
+
+void DeviceSampleClock::reset(const Settings &settings)
+{
+    m_settings = settings;
+    m_timestamp_mask = (settings.timestamp_bits < 32) ? ((1u << settings.timestamp_bits) - 1) : 0xffffffff;
+    m_sequence_mask = (settings.sequence_bits > 0) ? ((1u << settings.sequence_bits) - 1) : 0;
+
+    reset();
+}
+
+void DeviceSampleClock::reset()
+{
+    m_seconds_per_tick = m_settings.seconds_per_tick;
+
+    m_bHasLastSample = false;
+    m_last_raw_timestamp = 0;
+    m_last_raw_sequence = 0;
+    m_last_arrival_time = std::chrono::steady_clock::time_point();
+    m_stalled_timestamp_count = 0;
+
+    m_anchor_arrival_time = std::chrono::steady_clock::time_point();
+    m_ticks_since_anchor = 0.0;
+
+    m_dropped_sample_count = 0;
+    m_resync_count = 0;
+}
+
+float DeviceSampleClock::update(
+    unsigned int raw_timestamp,
+    int raw_sequence,
+    const std::chrono::steady_clock::time_point &arrival_time)
+{
+    float sample_seconds = m_settings.nominal_sample_seconds;
+
+    if (m_bHasLastSample)
+    {
+        const float host_delta_seconds =
+            std::max(std::chrono::duration<float>(arrival_time - m_last_arrival_time).count(), 0.f);
+        const unsigned int delta_ticks = (raw_timestamp - m_last_raw_timestamp) & m_timestamp_mask;
+
+        // Every skipped sequence number is a report lost on the way (e.g. bluetooth interference)
+        if (m_sequence_mask != 0)
+        {
+            const unsigned int delta_sequence = static_cast<unsigned int>(raw_sequence - m_last_raw_sequence) & m_sequence_mask;
+
+            if (delta_sequence > 1)
+            {
+                m_dropped_sample_count += delta_sequence - 1;
+            }
+        }
+
+        m_stalled_timestamp_count = (delta_ticks == 0) ? m_stalled_timestamp_count + 1 : 0;
+
+        if (m_stalled_timestamp_count >= k_max_stalled_timestamp_count)
+        {
+            // The device isn't filling in the timestamp
+            sample_seconds = resync(arrival_time, host_delta_seconds);
+        }
+        else if (getIsCalibrated() &&
+                 host_delta_seconds > 0.5f * static_cast<float>(m_timestamp_mask + 1.0) * m_seconds_per_tick)
+        {
+            // Long enough for the timestamp to have wrapped, the tick delta can't be trusted
+            sample_seconds = resync(arrival_time, host_delta_seconds);
+        }
+        else
+        {
+            // Refine the tick period against host time, averaging out arrival jitter over the whole span
+            m_ticks_since_anchor += static_cast<double>(delta_ticks);
+
+            const float anchor_seconds = std::chrono::duration<float>(arrival_time - m_anchor_arrival_time).count();
+            if (anchor_seconds >= k_min_calibration_seconds && m_ticks_since_anchor > 0.0)
+            {
+                m_seconds_per_tick = static_cast<float>(static_cast<double>(anchor_seconds) / m_ticks_since_anchor);
+            }
+
+            if (getIsCalibrated())
+            {
+                sample_seconds = std::min(static_cast<float>(delta_ticks) * m_seconds_per_tick, m_settings.max_sample_seconds);
+            }
+            else
+            {
+                // Not calibrated yet, arrival times are the best there is
+                sample_seconds = std::min(host_delta_seconds, m_settings.max_sample_seconds);
+            }
+        }
+    }
+    else
+    {
+        m_anchor_arrival_time = arrival_time;
+        m_ticks_since_anchor = 0.0;
+    }
+
+    m_bHasLastSample = true;
+    m_last_raw_timestamp = raw_timestamp & m_timestamp_mask;
+    m_last_raw_sequence = raw_sequence;
+    m_last_arrival_time = arrival_time;
+
+    return sample_seconds;
+}
+
+// -- private methods -----
+float DeviceSampleClock::resync(
+    const std::chrono::steady_clock::time_point &arrival_time,
+    float host_delta_seconds)
+{
+    ++m_resync_count;
+
+    // Start calibrating over from this sample
+    m_anchor_arrival_time = arrival_time;
+    m_ticks_since_anchor = 0.0;
+
+    return std::min(host_delta_seconds, m_settings.max_sample_seconds);
+}
@@ -0,0 +1,69 @@
+#ifndef DEVICE_SAMPLE_CLOCK_H
+#define DEVICE_SAMPLE_CLOCK_H
+
+// -- includes -----
+#include <chrono>
+
+// -- definitions -----
+// Turns the wrapping hardware timestamp and sequence counter a device stamps its input reports with
+// into the time between consecutive samples, so IMU integration follows the device's sample clock
+// rather than when the reports happened to be read.
+// Host arrival times only anchor the device clock: averaged over seconds they calibrate the tick period,
+// and they take over when the timestamp can't be trusted (first sample, a gap longer than the counter wraps,
+// a timestamp that stopped moving).
+class DeviceSampleClock
+{
+public:
+    struct Settings
+    {
+        int timestamp_bits;                 // width of the hardware timestamp counter
+        int sequence_bits;                  // width of the report sequence counter (0 if there is none)
+        float seconds_per_tick;             // initial guess of the timestamp period, <= 0 if unknown
+        float nominal_sample_seconds;       // expected time between reports
+        float max_sample_seconds;           // longest gap that still gets integrated in one step
+    };
+
+    DeviceSampleClock();
+
+    void reset(const Settings &settings);
+    void reset();
+
+    // Returns the seconds since the previous sample.
+    float update(unsigned int raw_timestamp, int raw_sequence, const std::chrono::steady_clock::time_point &arrival_time);
+
+    // True once seconds per tick is known (guessed or calibrated)
+    inline bool getIsCalibrated() const
+    { return m_seconds_per_tick > 0.f; }
+    inline float getSecondsPerTick() const
+    { return m_seconds_per_tick; }
+    // Reports the device sent that never made it to the host
+    inline int getDroppedSampleCount() const
+    { return m_dropped_sample_count; }
+    // Samples where the device timestamp couldn't be used and host time filled in
+    inline int getResyncCount() const
+    { return m_resync_count; }
+
+protected:
+    float resync(const std::chrono::steady_clock::time_point &arrival_time, float host_delta_seconds);
+
+private:
+    Settings m_settings;
+    unsigned int m_timestamp_mask;
+    unsigned int m_sequence_mask;
+    float m_seconds_per_tick;
+
+    bool m_bHasLastSample;
+    unsigned int m_last_raw_timestamp;
+    int m_last_raw_sequence;
+    std::chrono::steady_clock::time_point m_last_arrival_time;
+    int m_stalled_timestamp_count;
+
+    // Host time anchor used for calibrating the tick period
+    std::chrono::steady_clock::time_point m_anchor_arrival_time;
+    double m_ticks_since_anchor;
+
+    int m_dropped_sample_count;
+    int m_resync_count;
+};
+
+#endif // DEVICE_SAMPLE_CLOCK_H
@@ -0,0 +1,64 @@
+#ifndef DEVICE_STATE_RING_H
+#define DEVICE_STATE_RING_H
+
+// -- includes -----
+#include <array>
+#include <assert.h>
+
+// -- definitions -----
+// Fixed size history of the last k_capacity device states.
+// Pushing onto a full ring overwrites the oldest state in place,
+// so keeping the history never allocates on the poll thread.
+template <typename t_state, int k_capacity>
+class DeviceStateRing
+{
+public:
+    DeviceStateRing()
+        : m_nextIndex(0)
+        , m_count(0)
+    {}
+
+    inline bool empty() const { return m_count == 0; }
+    inline int size() const { return m_count; }
+    inline int capacity() const { return k_capacity; }
+
+    inline void clear()
+    {
+        m_nextIndex = 0;
+        m_count = 0;
+    }
+
+    inline void push_back(const t_state &state)
+    {
+        m_states[m_nextIndex] = state;
+        m_nextIndex = (m_nextIndex + 1) % k_capacity;
+
+        if (m_count < k_capacity)
+        {
+            ++m_count;
+        }
+    }
+
+    // The most recent state, the ring must not be empty
+    inline const t_state &back() const
+    {
+        assert(m_count > 0);
+        return m_states[(m_nextIndex + k_capacity - 1) % k_capacity];
+    }
+
+    // A lookBack of 0 corresponds to the most recent state.
+    // Returns nullptr past the oldest state still in the ring.
+    inline const t_state *getLookBack(int lookBack) const
+    {
+        return (lookBack >= 0 && lookBack < m_count)
+            ? &m_states[(m_nextIndex + k_capacity - 1 - lookBack) % k_capacity]
+            : nullptr;
+    }
+
+private:
+    std::array<t_state, k_capacity> m_states;
+    int m_nextIndex;
+    int m_count;
+};
+
+#endif // DEVICE_STATE_RING_H
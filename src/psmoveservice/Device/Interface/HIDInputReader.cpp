@@ -0,0 +1,160 @@
+// -- includes -----
+#include "HIDInputReader.h"
+#include "ServerLog.h"
+#include "ServerUpdateSignal.h"
+#include "ServerUtility.h"
+#include "hidapi.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+// -- constants -----
+// How long the reader thread blocks in hid_read_timeout() before checking if it should exit
+static const int k_reader_thread_timeout_ms = 100;
+
+// -- private definitions -----
+struct HIDInputReport
+{
+    std::chrono::steady_clock::time_point arrival_time;
+    int size;
+    unsigned char data[MAX_HID_INPUT_REPORT_SIZE];
+};
+
+struct HIDInputReportQueue
+{
+    boost::lockfree::spsc_queue<HIDInputReport, boost::lockfree::capacity<64> > reports;
+};
+
+// -- public methods -----
+HIDInputReader::HIDInputReader(const std::string &device_name)
+    : m_device_name(device_name)
+    , m_handle(nullptr)
+    , m_report_size(0)
+    , m_report_queue(new HIDInputReportQueue)
+    , m_thread_started(false)
+    , m_exit_signaled(false)
+    , m_read_failed(false)
+    , m_dropped_report_count(0)
+{
+}
+
+HIDInputReader::~HIDInputReader()
+{
+    stop();
+
+    delete m_report_queue;
+}
+
+void HIDInputReader::start(hid_device *handle, size_t report_size, bool bUseReaderThread)
+{
+    assert(!m_thread_started);
+    assert(report_size <= MAX_HID_INPUT_REPORT_SIZE);
+
+    m_handle = handle;
+    m_report_size = std::min(report_size, static_cast<size_t>(MAX_HID_INPUT_REPORT_SIZE));
+    m_read_failed = false;
+    m_dropped_report_count = 0;
+
+    if (bUseReaderThread && m_handle != nullptr)
+    {
+        SERVER_LOG_INFO("HIDInputReader::start") << "Starting HID reader thread for " << m_device_name;
+        m_exit_signaled = false;
+        m_reader_thread = std::thread(&HIDInputReader::readerThreadFunc, this);
+        m_thread_started = true;
+    }
+}
+
+void HIDInputReader::stop()
+{
+    if (m_thread_started)
+    {
+        SERVER_LOG_INFO("HIDInputReader::stop") << "Stopping HID reader thread for " << m_device_name;
+        m_exit_signaled = true;
+        m_reader_thread.join();
+        m_thread_started = false;
+
+        if (m_dropped_report_count > 0)
+        {
+            SERVER_LOG_WARNING("HIDInputReader::stop") << m_device_name << " dropped "
+                << m_dropped_report_count << " input reports while the poll thread fell behind";
+        }
+    }
+
+    // Anything left over belongs to the device being closed
+    HIDInputReport report;
+    while (m_report_queue->reports.pop(report))
+    {
+    }
+
+    m_handle = nullptr;
+}
+
+int HIDInputReader::read(unsigned char *data, size_t length, std::chrono::steady_clock::time_point &out_arrival_time)
+{
+    int res;
+
+    if (m_thread_started)
+    {
+        HIDInputReport report;
+
+        if (m_report_queue->reports.pop(report))
+        {
+            res = std::min(report.size, static_cast<int>(length));
+            memcpy(data, report.data, res);
+            out_arrival_time = report.arrival_time;
+        }
+        else
+        {
+            // Only report the failure once every report read before it got handed out
+            res = m_read_failed ? -1 : 0;
+        }
+    }
+    else
+    {
+        res = hid_read(m_handle, data, length);
+        out_arrival_time = std::chrono::steady_clock::now();
+    }
+
+    return res;
+}
+
+bool HIDInputReader::getHasQueuedReports() const
+{
+    return m_thread_started && (m_report_queue->reports.read_available() > 0 || m_read_failed);
+}
+
+// -- private methods -----
+void HIDInputReader::readerThreadFunc()
+{
+    ServerUtility::set_current_thread_name("HID Reader Thread");
+
+    HIDInputReport report;
+
+    while (!m_exit_signaled)
+    {
+        const int res = hid_read_timeout(m_handle, report.data, m_report_size, k_reader_thread_timeout_ms);
+
+        if (res > 0)
+        {
+            report.arrival_time = std::chrono::steady_clock::now();
+            report.size = res;
+
+            if (!m_report_queue->reports.push(report))
+            {
+                ++m_dropped_report_count;
+            }
+
+            ServerUpdateSignal::signal();
+        }
+        else if (res < 0)
+        {
+            // Let the poll thread close the device
+            m_read_failed = true;
+            ServerUpdateSignal::signal();
+            break;
+        }
+    }
+}
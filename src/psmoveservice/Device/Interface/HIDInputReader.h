@@ -0,0 +1,63 @@
+#ifndef HID_INPUT_READER_H
+#define HID_INPUT_READER_H
+
+// -- includes -----
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// -- pre-declarations -----
+typedef struct hid_device_ hid_device;
+struct HIDInputReportQueue;
+
+// -- constants -----
+// Largest input report a reader thread queues up (DS4 bluetooth reports are under 80 bytes)
+#define MAX_HID_INPUT_REPORT_SIZE 128
+
+// -- definitions -----
+// Reads the input reports of one HID device, either synchronously (hid_read() on the poll thread)
+// or on a dedicated thread that blocks in hid_read_timeout().
+// The reader thread stamps each report with its arrival time, hands it to the poll thread
+// through a lock-free single producer/single consumer queue and wakes up the service loop.
+// Either way read() is called from the device's poll() and stamps every report it returns.
+class HIDInputReader
+{
+public:
+    HIDInputReader(const std::string &device_name);
+    ~HIDInputReader();
+
+    // Starts reading reports of up to report_size bytes from the given (open) device.
+    // The handle has to stay open until stop().
+    void start(hid_device *handle, size_t report_size, bool bUseReaderThread);
+    void stop();
+
+    // Same contract as hid_read(): returns the size of the report copied into data,
+    // 0 if there is no new report or -1 if the device failed
+    int read(unsigned char *data, size_t length, std::chrono::steady_clock::time_point &out_arrival_time);
+
+    inline bool getIsUsingReaderThread() const
+    { return m_thread_started; }
+    // True if the reader thread has reports queued up for the next read()
+    bool getHasQueuedReports() const;
+    // Reports the reader thread threw away because the poll thread fell behind
+    inline int getDroppedReportCount() const
+    { return m_dropped_report_count; }
+
+protected:
+    void readerThreadFunc();
+
+private:
+    std::string m_device_name;
+    hid_device *m_handle;
+    size_t m_report_size;
+
+    HIDInputReportQueue *m_report_queue;
+    std::thread m_reader_thread;
+    bool m_thread_started;
+    std::atomic_bool m_exit_signaled;
+    std::atomic_bool m_read_failed;
+    std::atomic_int m_dropped_report_count;
+};
+
+#endif // HID_INPUT_READER_H
@@ -0,0 +1,204 @@
+// -- includes -----
+#include "TrackerVideoFrameRing.h"
+
+#include <assert.h>
+#include <atomic>
+
+// -- private definitions -----
+struct TrackerVideoFrameBuffer
+{
+    std::vector<unsigned char> buffer;
+    int width;
+    int height;
+    int stride;
+    int sequence_number;
+    std::chrono::steady_clock::time_point capture_time;
+
+    // Number of TrackerVideoFrameRefs pointing at this frame.
+    // Released on whatever thread drops the last reference, checked by the capture thread.
+    std::atomic_int ref_count;
+
+    TrackerVideoFrameBuffer(int frame_width, int frame_height, int frame_stride)
+        : buffer(static_cast<size_t>(frame_stride) * static_cast<size_t>(frame_height))
+        , width(frame_width)
+        , height(frame_height)
+        , stride(frame_stride)
+        , sequence_number(-1)
+        , capture_time()
+        , ref_count(0)
+    {}
+};
+
+// -- TrackerVideoFrameRef -----
+TrackerVideoFrameRef::TrackerVideoFrameRef()
+    : m_frame()
+{
+}
+
+TrackerVideoFrameRef::TrackerVideoFrameRef(const std::shared_ptr<TrackerVideoFrameBuffer> &frame)
+    : m_frame(frame)
+{
+    if (m_frame)
+    {
+        m_frame->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+TrackerVideoFrameRef::TrackerVideoFrameRef(const TrackerVideoFrameRef &other)
+    : m_frame(other.m_frame)
+{
+    if (m_frame)
+    {
+        m_frame->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+TrackerVideoFrameRef::~TrackerVideoFrameRef()
+{
+    release();
+}
+
+TrackerVideoFrameRef &TrackerVideoFrameRef::operator=(const TrackerVideoFrameRef &other)
+{
+    if (m_frame != other.m_frame)
+    {
+        release();
+
+        m_frame = other.m_frame;
+        if (m_frame)
+        {
+            m_frame->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    return *this;
+}
+
+void TrackerVideoFrameRef::release()
+{
+    if (m_frame)
+    {
+        // Release so that all of our reads of the frame happen before the capture thread reuses it
+        m_frame->ref_count.fetch_sub(1, std::memory_order_release);
+        m_frame.reset();
+    }
+}
+
+bool TrackerVideoFrameRef::getIsValid() const
+{
+    return static_cast<bool>(m_frame);
+}
+
+const unsigned char *TrackerVideoFrameRef::getBuffer() const
+{
+    return m_frame ? m_frame->buffer.data() : nullptr;
+}
+
+int TrackerVideoFrameRef::getWidth() const
+{
+    return m_frame ? m_frame->width : 0;
+}
+
+int TrackerVideoFrameRef::getHeight() const
+{
+    return m_frame ? m_frame->height : 0;
+}
+
+int TrackerVideoFrameRef::getStride() const
+{
+    return m_frame ? m_frame->stride : 0;
+}
+
+int TrackerVideoFrameRef::getSequenceNumber() const
+{
+    return m_frame ? m_frame->sequence_number : -1;
+}
+
+std::chrono::steady_clock::time_point TrackerVideoFrameRef::getCaptureTime() const
+{
+    return m_frame ? m_frame->capture_time : std::chrono::steady_clock::time_point();
+}
+
+// -- TrackerVideoFrameRing -----
+TrackerVideoFrameRing::TrackerVideoFrameRing()
+    : m_frames()
+    , m_writeIndex(-1)
+    , m_latestIndex(-1)
+    , m_nextSequenceNumber(0)
+    , m_droppedFrameCount(0)
+{
+}
+
+void TrackerVideoFrameRing::allocate(int width, int height, int stride, int frame_count)
+{
+    assert(m_writeIndex == -1);
+    assert(frame_count >= 2);
+
+    // Outstanding refs keep their own shared_ptr to the old buffers
+    m_frames.clear();
+    for (int frame_index = 0; frame_index < frame_count; ++frame_index)
+    {
+        m_frames.push_back(std::make_shared<TrackerVideoFrameBuffer>(width, height, stride));
+    }
+
+    m_writeIndex = -1;
+    m_latestIndex = -1;
+}
+
+void TrackerVideoFrameRing::dispose()
+{
+    m_frames.clear();
+    m_writeIndex = -1;
+    m_latestIndex = -1;
+}
+
+unsigned char *TrackerVideoFrameRing::beginFrameWrite()
+{
+    assert(m_writeIndex == -1);
+
+    const int frame_count = static_cast<int>(m_frames.size());
+
+    // Start after the latest frame so the oldest frames get captured over first.
+    // New refs only come from getLatestFrame() on this thread or from copying an existing ref,
+    // so an unreferenced frame that isn't the latest one stays unreferenced while we write it.
+    for (int offset = 1; offset <= frame_count; ++offset)
+    {
+        const int frame_index = (m_latestIndex + offset + frame_count) % frame_count;
+        TrackerVideoFrameBuffer *frame = m_frames[frame_index].get();
+
+        if (frame_index != m_latestIndex && frame->ref_count.load(std::memory_order_acquire) == 0)
+        {
+            m_writeIndex = frame_index;
+            return frame->buffer.data();
+        }
+    }
+
+    if (frame_count > 0)
+    {
+        ++m_droppedFrameCount;
+    }
+
+    return nullptr;
+}
+
+void TrackerVideoFrameRing::endFrameWrite(bool bPublish, const std::chrono::steady_clock::time_point &capture_time)
+{
+    if (m_writeIndex != -1)
+    {
+        if (bPublish)
+        {
+            m_frames[m_writeIndex]->sequence_number = m_nextSequenceNumber;
+            m_frames[m_writeIndex]->capture_time = capture_time;
+            ++m_nextSequenceNumber;
+
+            m_latestIndex = m_writeIndex;
+        }
+
+        m_writeIndex = -1;
+    }
+}
+
+TrackerVideoFrameRef TrackerVideoFrameRing::getLatestFrame() const
+{
+    return (m_latestIndex != -1) ? TrackerVideoFrameRef(m_frames[m_latestIndex]) : TrackerVideoFrameRef();
+}
@@ -0,0 +1,86 @@
+#ifndef TRACKER_VIDEO_FRAME_RING_H
+#define TRACKER_VIDEO_FRAME_RING_H
+
+// -- includes -----
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// -- pre-declarations -----
+struct TrackerVideoFrameBuffer;
+
+// -- definitions -----
+// Reference to a captured video frame in a TrackerVideoFrameRing.
+// The frame won't be captured over for as long as any reference to it exists,
+// so the vision stage and the video stream publisher can read it in place instead of copying it.
+// References can be copied and released from any thread.
+class TrackerVideoFrameRef
+{
+public:
+    TrackerVideoFrameRef();
+    TrackerVideoFrameRef(const TrackerVideoFrameRef &other);
+    ~TrackerVideoFrameRef();
+
+    TrackerVideoFrameRef &operator=(const TrackerVideoFrameRef &other);
+
+    // Drops the reference, letting the ring capture into the frame again
+    void release();
+
+    bool getIsValid() const;
+    const unsigned char *getBuffer() const;
+    int getWidth() const;
+    int getHeight() const;
+    int getStride() const;
+    int getSequenceNumber() const;
+    // When the frame was captured (as stamped by the tracker's poll)
+    std::chrono::steady_clock::time_point getCaptureTime() const;
+
+private:
+    friend class TrackerVideoFrameRing;
+
+    explicit TrackerVideoFrameRef(const std::shared_ptr<TrackerVideoFrameBuffer> &frame);
+
+    std::shared_ptr<TrackerVideoFrameBuffer> m_frame;
+};
+
+// A small fixed set of BGR frame buffers that a tracker captures into round robin.
+// A frame only gets captured over once nothing references it anymore,
+// and capture drops the new frame if every buffer is still in use.
+// Capturing and getLatestFrame() must happen on the same thread (the tracker's poll thread).
+class TrackerVideoFrameRing
+{
+public:
+    static const int k_default_frame_count = 4;
+
+    TrackerVideoFrameRing();
+
+    // (Re)allocates the frame buffers.
+    // Frames still referenced from a previous allocation stay valid until they are released.
+    void allocate(int width, int height, int stride, int frame_count = k_default_frame_count);
+    void dispose();
+
+    inline bool getIsAllocated() const { return m_frames.size() > 0; }
+
+    // Returns a buffer nothing references to capture the next frame into,
+    // or nullptr if all of them are in use
+    unsigned char *beginFrameWrite();
+
+    // Makes the frame from beginFrameWrite() the latest one if bPublish is set,
+    // otherwise hands the buffer back (i.e. the capture failed)
+    void endFrameWrite(bool bPublish, const std::chrono::steady_clock::time_point &capture_time);
+
+    // Returns a reference to the last published frame (invalid if nothing has been captured yet)
+    TrackerVideoFrameRef getLatestFrame() const;
+
+    // Number of frames thrown away because every buffer was still referenced
+    inline int getDroppedFrameCount() const { return m_droppedFrameCount; }
+
+private:
+    std::vector<std::shared_ptr<TrackerVideoFrameBuffer> > m_frames;
+    int m_writeIndex;
+    int m_latestIndex;
+    int m_nextSequenceNumber;
+    int m_droppedFrameCount;
+};
+
+#endif // TRACKER_VIDEO_FRAME_RING_H
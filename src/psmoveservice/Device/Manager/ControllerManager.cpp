@@ -122,18 +122,23 @@ ControllerManager::shutdown()
 	}
 }
 
+bool
+ControllerManager::getIsPoseUpdateActive(int device_id)
+{
+	ServerControllerViewPtr controllerView = getControllerViewPtr(device_id);
+
+	return controllerView->getIsOpen() && 
+		(controllerView->getIsBluetooth() || controllerView->getIsVirtualController());
+}
+
 void
-ControllerManager::updateStateAndPredict(TrackerManager* tracker_manager)
+ControllerManager::updateStateAndPredict()
 {
 	for (int device_id = 0; device_id < getMaxDevices(); ++device_id)
 	{
-		ServerControllerViewPtr controllerView = getControllerViewPtr(device_id);
-
-		if (controllerView->getIsOpen() && 
-            (controllerView->getIsBluetooth() || controllerView->getIsVirtualController()))
+		if (getIsPoseUpdateActive(device_id))
 		{
-			controllerView->updateOpticalPoseEstimation(tracker_manager);
-			controllerView->updateStateAndPredict();
+			getControllerViewPtr(device_id)->updateStateAndPredict();
 		}
 	}
 }
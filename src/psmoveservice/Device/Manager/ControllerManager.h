@@ -40,7 +40,11 @@ public:
     /// Call hid_close()
     void shutdown() override;
     
-    void updateStateAndPredict(TrackerManager* tracker_manager);
+    // Controllers streaming over bluetooth (or virtual ones) get their pose updated every tick
+    bool getIsPoseUpdateActive(int device_id);
+    // Fold the latest IMU state and optical pose estimates into each controller's pose filter.
+    // The optical pose estimates get updated beforehand (see DeviceManager::updateOpticalPoseEstimations).
+    void updateStateAndPredict();
     void publish() override;
 
     inline const ControllerManagerConfig& getConfig() const
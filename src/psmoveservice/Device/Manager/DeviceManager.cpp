@@ -5,6 +5,7 @@
 #include "DeviceEnumerator.h"
 #include "HMDManager.h"
 #include "OrientationFilter.h"
+#include "PoseFilterInterface.h"
 #ifdef WIN32
 #include "PlatformDeviceAPIWin32.h"
 #endif // WIN32
@@ -20,6 +21,7 @@
 #include "PSMoveConfig.h"
 #include "TrackerManager.h"
 
+#include <algorithm>
 #include <chrono>
 
 //-- constants -----
@@ -111,6 +113,8 @@ DeviceManager::DeviceManager()
     , m_tracker_manager(new TrackerManager())
     , m_hmd_manager(new HMDManager())
 {
+    m_controller_optical_ticks_waited.assign(m_controller_manager->getMaxDevices(), 0);
+    m_hmd_optical_ticks_waited.assign(m_hmd_manager->getMaxDevices(), 0);
 }
 
 DeviceManager::~DeviceManager()
@@ -203,14 +207,97 @@ DeviceManager::update()
     m_tracker_manager->poll(); // Update tracker count and poll video frames
     m_hmd_manager->poll(); // Update HMD count and poll IMU state
 
-    m_controller_manager->updateStateAndPredict(m_tracker_manager); // Compute pose/prediction of tracking blob+IMU state
-    m_hmd_manager->updateStateAndPredict(m_tracker_manager); // Compute pose/prediction of tracking blobs+IMU state
+    m_tracker_manager->beginVisionTick(); // Reset the main thread vision time budget
+    updateOpticalPoseEstimations(); // Find tracking blobs, most uncertain devices first
+    m_controller_manager->updateStateAndPredict(); // Compute pose/prediction of tracking blob+IMU state
+    m_hmd_manager->updateStateAndPredict(); // Compute pose/prediction of tracking blobs+IMU state
+    m_tracker_manager->dispatchVisionRequests(); // Kick off blob finding on the vision threads (if enabled)
 
     m_controller_manager->publish(); // publish controller state to any listening clients  (common case)
     m_tracker_manager->publish(); // publish tracker state to any listening clients (probably only used by ConfigTool)
     m_hmd_manager->publish(); // publish hmd state to any listening clients (common case)
 }
 
+std::chrono::microseconds
+DeviceManager::getTimeUntilNextPoll() const
+{
+    return std::min(
+        std::min(m_controller_manager->getTimeUntilNextPoll(), m_tracker_manager->getTimeUntilNextPoll()),
+        m_hmd_manager->getTimeUntilNextPoll());
+}
+
+void
+DeviceManager::updateOpticalPoseEstimations()
+{
+    struct OpticalUpdateEntry
+    {
+        float priority;
+        ServerControllerView *controller_view;
+        ServerHMDView *hmd_view;
+        int *ticks_waited;
+    };
+
+    // Position uncertainty of a device's pose filter (cm^2), weighted by how long it has waited.
+    // The extra 1 cm^2 keeps a device whose filter reports no uncertainty from waiting forever.
+    auto computeOpticalUpdatePriority = [](const IPoseFilter *pose_filter, const int ticks_waited) -> float {
+        const float position_variance = (pose_filter != nullptr) ? pose_filter->getPositionCovarianceCmSqr().trace() : 0.f;
+
+        return (1.f + position_variance) * static_cast<float>(1 + ticks_waited);
+    };
+
+    std::vector<OpticalUpdateEntry> entries;
+
+    for (int controller_id = 0; controller_id < m_controller_manager->getMaxDevices(); ++controller_id)
+    {
+        if (m_controller_manager->getIsPoseUpdateActive(controller_id))
+        {
+            ServerControllerView *controller_view = m_controller_manager->getControllerViewPtr(controller_id).get();
+            int *ticks_waited = &m_controller_optical_ticks_waited[controller_id];
+            const OpticalUpdateEntry entry = {
+                computeOpticalUpdatePriority(controller_view->getPoseFilter(), *ticks_waited),
+                controller_view, nullptr, ticks_waited };
+
+            entries.push_back(entry);
+        }
+    }
+
+    for (int hmd_id = 0; hmd_id < m_hmd_manager->getMaxDevices(); ++hmd_id)
+    {
+        ServerHMDView *hmd_view = m_hmd_manager->getHMDViewPtr(hmd_id).get();
+
+        if (hmd_view->getIsOpen())
+        {
+            int *ticks_waited = &m_hmd_optical_ticks_waited[hmd_id];
+            const OpticalUpdateEntry entry = {
+                computeOpticalUpdatePriority(hmd_view->getPoseFilter(), *ticks_waited),
+                nullptr, hmd_view, ticks_waited };
+
+            entries.push_back(entry);
+        }
+    }
+
+    std::stable_sort(
+        entries.begin(), entries.end(),
+        [](const OpticalUpdateEntry &a, const OpticalUpdateEntry &b) { return a.priority > b.priority; });
+
+    // Always run every device's optical update, even over budget:
+    // it also fetches vision worker results and times out lost projections.
+    // The trackers skip the main thread vision work once the budget is spent.
+    for (const OpticalUpdateEntry &entry : entries)
+    {
+        *entry.ticks_waited = m_tracker_manager->getHasVisionBudget() ? 0 : *entry.ticks_waited + 1;
+
+        if (entry.controller_view != nullptr)
+        {
+            entry.controller_view->updateOpticalPoseEstimation(m_tracker_manager);
+        }
+        else
+        {
+            entry.hmd_view->updateOpticalPoseEstimation(m_tracker_manager);
+        }
+    }
+}
+
 void
 DeviceManager::shutdown()
 {
@@ -48,6 +48,7 @@ public:
     bool startup(); /**< Initialize the interfaces for each specific manager. */
     void update();  /**< Poll all connected devices for each specific manager. */
     void shutdown();/**< Shutdown the interfaces for each specific manager. */
+    std::chrono::microseconds getTimeUntilNextPoll() const; /**< How long the main loop can wait before a manager needs polling. */
 
     static inline DeviceManager *getInstance()
     { return m_instance; }
@@ -90,6 +91,14 @@ private:
 	// List of registered hot-plug listeners
 	std::vector<DeviceHotplugListener> m_listeners;
 
+	// Updates in a row each device's optical pose estimate started with the vision budget already spent.
+	// Scales up the device's priority so that low priority devices still get their turn.
+	std::vector<int> m_controller_optical_ticks_waited;
+	std::vector<int> m_hmd_optical_ticks_waited;
+
+	/// Find every device's tracking projections, most uncertain device first, within the vision budget
+	void updateOpticalPoseEstimations();
+
 public:
     class ControllerManager *m_controller_manager;
     class TrackerManager *m_tracker_manager;
@@ -8,6 +8,9 @@
 #include "ServerUtility.h"
 #include "ServerRequestHandler.h"
 
+#include <algorithm>
+#include <limits>
+
 //-- methods -----
 /// Constructor and set intervals (ms) for reconnect and polling
 DeviceTypeManager::DeviceTypeManager(const int recon_int, const int poll_int)
@@ -72,6 +75,7 @@ DeviceTypeManager::shutdown()
 }
 
 /// Calls poll_devices and update_connected_devices if poll_interval and reconnect_interval has elapsed, respectively.
+/// Devices get polled early if a reader thread has input waiting for them.
 void
 DeviceTypeManager::poll()
 {
@@ -80,7 +84,7 @@ DeviceTypeManager::poll()
     // See if it's time to poll controllers for data
     std::chrono::duration<double, std::milli> update_diff = now - m_last_poll_time;
 
-    if (update_diff.count() >= poll_interval)
+    if (update_diff.count() >= poll_interval || get_has_queued_device_input())
     {
         poll_devices();
         m_last_poll_time = now;
@@ -107,6 +111,58 @@ DeviceTypeManager::poll()
     }
 }
 
+std::chrono::microseconds
+DeviceTypeManager::getTimeUntilNextPoll() const
+{
+    // Refresh the device list right away if a hotplug event dirtied it,
+    // or poll right away if a reader thread has input waiting
+    if (m_bIsDeviceListDirty || get_has_queued_device_input())
+    {
+        return std::chrono::microseconds::zero();
+    }
+
+    bool bHasOpenDevice = false;
+    if (m_deviceViews != nullptr)
+    {
+        for (int device_id = 0; device_id < getMaxDevices(); ++device_id)
+        {
+            if (m_deviceViews[device_id] && m_deviceViews[device_id]->getIsOpen())
+            {
+                bHasOpenDevice = true;
+                break;
+            }
+        }
+    }
+
+    std::chrono::duration<double, std::milli> time_until_poll(std::numeric_limits<double>::max());
+    const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+
+    if (bHasOpenDevice)
+    {
+        time_until_poll = std::chrono::duration<double, std::milli>(poll_interval) - (now - m_last_poll_time);
+    }
+
+    if (reconnect_interval > 0)
+    {
+        time_until_poll = std::min(
+            time_until_poll,
+            std::chrono::duration<double, std::milli>(reconnect_interval) - (now - m_last_reconnect_time));
+    }
+
+    if (time_until_poll.count() <= 0.0)
+    {
+        return std::chrono::microseconds::zero();
+    }
+    else if (time_until_poll >= std::chrono::duration<double, std::milli>(std::chrono::microseconds::max()))
+    {
+        return std::chrono::microseconds::max();
+    }
+    else
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time_until_poll);
+    }
+}
+
 bool
 DeviceTypeManager::update_connected_devices()
 {
@@ -253,6 +309,24 @@ DeviceTypeManager::can_update_connected_devices()
     return !ServerRequestHandler::get_instance()->any_active_bluetooth_requests();
 }
 
+bool
+DeviceTypeManager::get_has_queued_device_input() const
+{
+    bool bHasQueuedInput = false;
+
+    if (m_deviceViews != nullptr)
+    {
+        for (int device_id = 0; device_id < getMaxDevices() && !bHasQueuedInput; ++device_id)
+        {
+            const IDeviceInterface *device = m_deviceViews[device_id] ? m_deviceViews[device_id]->getDevice() : nullptr;
+
+            bHasQueuedInput = device != nullptr && device->getHasQueuedInput();
+        }
+    }
+
+    return bHasQueuedInput;
+}
+
 void
 DeviceTypeManager::poll_devices()
 {
@@ -25,6 +25,10 @@ public:
     void poll();
     virtual void publish();
 
+    /// How long until poll() has something to do (can be zero).
+    /// Devices only get polled while one is open, otherwise this is the next reconnect check.
+    std::chrono::microseconds getTimeUntilNextPoll() const;
+
     virtual int getMaxDevices() const = 0;
 
     /**
@@ -45,6 +49,7 @@ public:
 
 protected:
     virtual void poll_devices();
+    bool get_has_queued_device_input() const;
 
     /** This method tries make the list of open devices in m_devices match
     the list of connected devices in the device enumerator.
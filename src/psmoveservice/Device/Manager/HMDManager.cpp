@@ -83,7 +83,7 @@ HMDManager::shutdown()
 }
 
 void
-HMDManager::updateStateAndPredict(TrackerManager* tracker_manager)
+HMDManager::updateStateAndPredict()
 {
 	for (int device_id = 0; device_id < getMaxDevices(); ++device_id)
 	{
@@ -91,7 +91,6 @@ HMDManager::updateStateAndPredict(TrackerManager* tracker_manager)
 
 		if (hmdView->getIsOpen())
 		{
-			hmdView->updateOpticalPoseEstimation(tracker_manager);
 			hmdView->updateStateAndPredict();
 		}
 	}
@@ -38,7 +38,9 @@ public:
     virtual bool startup() override;
     virtual void shutdown() override;
 
-	void updateStateAndPredict(TrackerManager* tracker_manager);
+	// Fold the latest IMU state and optical pose estimates into each HMD's pose filter.
+	// The optical pose estimates get updated beforehand (see DeviceManager::updateOpticalPoseEstimations).
+	void updateStateAndPredict();
 
     static const int k_max_devices = 4;
     int getMaxDevices() const override
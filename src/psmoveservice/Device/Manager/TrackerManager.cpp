@@ -24,11 +24,20 @@ TrackerManagerConfig::TrackerManagerConfig(const std::string &fnamebase)
 	controller_position_smoothing = 0.f;
 	ignore_pose_from_one_tracker = false;
     optical_tracking_timeout= 100;
-	tracker_sleep_ms = 1;
+	min_update_interval_us = 1000;
+	max_update_wait_ms = 100;
 	use_bgr_to_hsv_lookup_table = true;
+	bgr_to_hsv_lookup_table_bits = 8;
+	use_vision_worker_threads = false;
+	use_color_label_segmentation = false;
+	use_fused_hsv_threshold_kernel = false;
 	exclude_opposed_cameras = false;
 	min_valid_projection_area= 16;
 	disable_roi = false;
+	reacquisition_pyramid_levels = 2;
+	max_full_frame_searches_per_frame = 1;
+	vision_budget_us_per_tick = 5000;
+	point_cloud_pose_budget_us = 800;
 	default_tracker_profile.frame_width = 640;
 	//default_tracker_profile.frame_height = 480;
 	default_tracker_profile.frame_rate = 40;
@@ -53,13 +62,22 @@ TrackerManagerConfig::config2ptree()
 	pt.put("ignore_pose_from_one_tracker", ignore_pose_from_one_tracker);
     pt.put("optical_tracking_timeout", optical_tracking_timeout);
 	pt.put("use_bgr_to_hsv_lookup_table", use_bgr_to_hsv_lookup_table);
-	pt.put("tracker_sleep_ms", tracker_sleep_ms);
+	pt.put("bgr_to_hsv_lookup_table_bits", bgr_to_hsv_lookup_table_bits);
+	pt.put("use_vision_worker_threads", use_vision_worker_threads);
+	pt.put("use_color_label_segmentation", use_color_label_segmentation);
+	pt.put("use_fused_hsv_threshold_kernel", use_fused_hsv_threshold_kernel);
+	pt.put("min_update_interval_us", min_update_interval_us);
+	pt.put("max_update_wait_ms", max_update_wait_ms);
 
 	pt.put("excluded_opposed_cameras", exclude_opposed_cameras);	
 
 	pt.put("min_valid_projection_area", min_valid_projection_area);	
 
 	pt.put("disable_roi", disable_roi);
+	pt.put("reacquisition_pyramid_levels", reacquisition_pyramid_levels);
+	pt.put("max_full_frame_searches_per_frame", max_full_frame_searches_per_frame);
+	pt.put("vision_budget_us_per_tick", vision_budget_us_per_tick);
+	pt.put("point_cloud_pose_budget_us", point_cloud_pose_budget_us);
 
 	pt.put("default_tracker_profile.frame_width", default_tracker_profile.frame_width);
 	//pt.put("default_tracker_profile.frame_height", default_tracker_profile.frame_height);
@@ -85,10 +103,20 @@ TrackerManagerConfig::ptree2config(const boost::property_tree::ptree &pt)
 		ignore_pose_from_one_tracker = pt.get<bool>("ignore_pose_from_one_tracker", ignore_pose_from_one_tracker);
         optical_tracking_timeout= pt.get<int>("optical_tracking_timeout", optical_tracking_timeout);
 		use_bgr_to_hsv_lookup_table = pt.get<bool>("use_bgr_to_hsv_lookup_table", use_bgr_to_hsv_lookup_table);
-		tracker_sleep_ms = pt.get<int>("tracker_sleep_ms", tracker_sleep_ms);
+		bgr_to_hsv_lookup_table_bits = pt.get<int>("bgr_to_hsv_lookup_table_bits", bgr_to_hsv_lookup_table_bits);
+		use_vision_worker_threads = pt.get<bool>("use_vision_worker_threads", use_vision_worker_threads);
+		use_color_label_segmentation = pt.get<bool>("use_color_label_segmentation", use_color_label_segmentation);
+		use_fused_hsv_threshold_kernel = pt.get<bool>("use_fused_hsv_threshold_kernel", use_fused_hsv_threshold_kernel);
+		// Older configs only had a fixed sleep between updates
+		min_update_interval_us = pt.get<int>("min_update_interval_us", 1000 * pt.get<int>("tracker_sleep_ms", min_update_interval_us / 1000));
+		max_update_wait_ms = pt.get<int>("max_update_wait_ms", max_update_wait_ms);
 		exclude_opposed_cameras = pt.get<bool>("excluded_opposed_cameras", exclude_opposed_cameras);
 		min_valid_projection_area = pt.get<float>("min_valid_projection_area", min_valid_projection_area);	
 		disable_roi = pt.get<bool>("disable_roi", disable_roi);
+		reacquisition_pyramid_levels = pt.get<int>("reacquisition_pyramid_levels", reacquisition_pyramid_levels);
+		max_full_frame_searches_per_frame = pt.get<int>("max_full_frame_searches_per_frame", max_full_frame_searches_per_frame);
+		vision_budget_us_per_tick = pt.get<int>("vision_budget_us_per_tick", vision_budget_us_per_tick);
+		point_cloud_pose_budget_us = pt.get<int>("point_cloud_pose_budget_us", point_cloud_pose_budget_us);
 		default_tracker_profile.frame_width = pt.get<float>("default_tracker_profile.frame_width", 640);
 		//default_tracker_profile.frame_height = pt.get<float>("default_tracker_profile.frame_height", 480);
 		default_tracker_profile.frame_rate = pt.get<float>("default_tracker_profile.frame_rate", 40);
@@ -147,6 +175,7 @@ TrackerManagerConfig::get_global_down_axis() const
 TrackerManager::TrackerManager()
     : DeviceTypeManager(10000, 13)
     , m_tracker_list_dirty(false)
+    , m_vision_time_this_tick(0)
 {
 }
 
@@ -237,6 +266,40 @@ TrackerManager::getTrackerViewPtr(int device_id) const
     return std::static_pointer_cast<ServerTrackerView>(m_deviceViews[device_id]);
 }
 
+void
+TrackerManager::dispatchVisionRequests()
+{
+    for (int tracker_id = 0; tracker_id < k_max_devices; ++tracker_id)
+    {
+        ServerTrackerViewPtr tracker_view = getTrackerViewPtr(tracker_id);
+
+        if (tracker_view->getIsOpen() && tracker_view->getIsVisionWorkerEnabled())
+        {
+            tracker_view->dispatchVisionRequests();
+        }
+    }
+}
+
+void
+TrackerManager::beginVisionTick()
+{
+    m_vision_time_this_tick = std::chrono::microseconds(0);
+}
+
+bool
+TrackerManager::getHasVisionBudget() const
+{
+    return
+        cfg.vision_budget_us_per_tick <= 0 ||
+        m_vision_time_this_tick.count() < cfg.vision_budget_us_per_tick;
+}
+
+void
+TrackerManager::chargeVisionTime(const std::chrono::microseconds &vision_time)
+{
+    m_vision_time_this_tick += vision_time;
+}
+
 int TrackerManager::getListUpdatedResponseType()
 {
 	return PSMoveProtocol::Response_ResponseType_TRACKER_LIST_UPDATED;
@@ -2,6 +2,7 @@
 #define TRACKER_MANAGER_H
 
 //-- includes -----
+#include <chrono>
 #include <memory>
 #include <deque>
 #include "DeviceTypeManager.h"
@@ -53,11 +54,20 @@ public:
 	bool ignore_pose_from_one_tracker;
     long version;
     int optical_tracking_timeout;
-	int tracker_sleep_ms;
+	int min_update_interval_us; // the service loop wakes on new input, but never sooner than this after its last update
+	int max_update_wait_ms; // longest the service loop waits for input before updating anyway
 	bool use_bgr_to_hsv_lookup_table;
+	int bgr_to_hsv_lookup_table_bits; // 8 = exact table, fewer bits = smaller quantized table
+	bool use_vision_worker_threads;
+	bool use_color_label_segmentation;
+	bool use_fused_hsv_threshold_kernel;
 	bool exclude_opposed_cameras;
 	float min_valid_projection_area;
 	bool disable_roi;
+	int reacquisition_pyramid_levels; // lost devices get searched for at 1/2^levels scale first (0 = full resolution only)
+	int max_full_frame_searches_per_frame; // per tracker, lost devices take turns beyond this (0 = no limit)
+	int vision_budget_us_per_tick; // main thread vision time per update, the rest waits for a later frame (0 = no limit)
+	int point_cloud_pose_budget_us; // per tracker per frame, the HMD point cloud pose solver stops searching past this
     TrackerProfile default_tracker_profile;
 	float global_forward_degrees;
 
@@ -86,6 +96,16 @@ public:
 
     ServerTrackerViewPtr getTrackerViewPtr(int device_id) const;
 
+    // Hand this update's projection requests to each tracker's vision worker thread
+    void dispatchVisionRequests();
+
+    // Starts this update's main thread vision time budget
+    void beginVisionTick();
+    // True while there is vision time left this update
+    bool getHasVisionBudget() const;
+    // Charges vision work done on the main thread against this update's budget
+    void chargeVisionTime(const std::chrono::microseconds &vision_time);
+
     inline void saveDefaultTrackerProfile(const TrackerProfile *profile)
     {
         cfg.default_tracker_profile = *profile;
@@ -120,6 +140,7 @@ private:
     std::deque<eCommonTrackingColorID> m_available_color_ids;
     TrackerManagerConfig cfg;
     bool m_tracker_list_dirty;
+    std::chrono::microseconds m_vision_time_this_tick;
 };
 
 #endif // TRACKER_MANAGER_H
\ No newline at end of file
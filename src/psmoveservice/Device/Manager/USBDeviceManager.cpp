@@ -6,6 +6,7 @@
 #include "LibUSBApi.h"
 #include "NullUSBApi.h"
 #include "ServerLog.h"
+#include "ServerUpdateSignal.h"
 #include "ServerUtility.h"
 
 #include <atomic>
@@ -383,6 +384,9 @@ public:
 		}
 
 		result_queue.push(state);
+
+		// Have the main thread run the result callback right away
+		ServerUpdateSignal::signal();
 	}
 
 protected:
@@ -0,0 +1,497 @@
+//-- includes -----
+#include "HSVThresholdKernel.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define HSV_THRESHOLD_KERNEL_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        // MSVC allows any intrinsic in any function, so no per-function target is needed
+        #define HSV_TARGET_SSE41
+        #define HSV_TARGET_AVX2
+    #else
+        // Compile the SIMD kernels for their instruction set only,
+        // the rest of the service keeps the default target and we dispatch at runtime
+        #define HSV_TARGET_SSE41 __attribute__((target("sse4.1")))
+        #define HSV_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+//-- Notes -----
+// cv::cvtColor(COLOR_BGR2HSV) on 8-bit images computes:
+//   v = max(b,g,r), diff = v - min(b,g,r)
+//   s = round(255*diff/v)
+//   h = round(30*(g-b)/diff)       if v == r (plus 180 if negative)
+//   h = round(60 + 30*(b-r)/diff)  if v == g
+//   h = round(120 + 30*(r-g)/diff) if v == b
+// cv::inRange() then tests the rounded values against integer bounds.
+// Rather than dividing, the kernels test the unrounded fractions against the bounds
+// widened by half a unit, scaled through by the (positive) denominator:
+//   round(x/d) >= lo  <=>  2*x >= (2*lo - 1)*d
+//   round(x/d) <= hi  <=>  2*x <  (2*hi + 1)*d
+// which keeps everything in 32-bit integer multiplies and compares.
+
+//-- private methods -----
+static int roundBound(float x, int lo, int hi)
+{
+    return std::min(std::max(static_cast<int>(floorf(x + 0.5f)), lo), hi);
+}
+
+static void setBounds(int &out_min, int &out_max, float range_min, float range_max, int channel_max)
+{
+    out_min = roundBound(range_min, 0, channel_max);
+    out_max = roundBound(range_max, 0, channel_max);
+
+    // Same as cv::inRange(), an inverted range matches nothing
+    if (out_min > out_max)
+    {
+        out_min = 1;
+        out_max = 0;
+    }
+}
+
+static inline bool isPixelInHSVRange(int b, int g, int r, const HSVThresholdRange &range)
+{
+    const int v = std::max(std::max(b, g), r);
+    const int diff = v - std::min(std::min(b, g), r);
+
+    if (v < range.value_min || v > range.value_max)
+    {
+        return false;
+    }
+
+    // s = 255*diff/v, with v=0 treated as 1 so black pixels get a saturation of 0
+    const int v1 = std::max(v, 1);
+    const int s2 = 510 * diff;
+    if (s2 < (2 * range.saturation_min - 1)*v1 || s2 >= (2 * range.saturation_max + 1)*v1)
+    {
+        return false;
+    }
+
+    // t = 2*hue*diff, with diff=0 treated as 1 so gray pixels get a hue of 0
+    int t;
+    if (v == r)
+    {
+        t = 60 * (g - b);
+        if (t + diff < 0)
+        {
+            t += 360 * diff;
+        }
+    }
+    else if (v == g)
+    {
+        t = 60 * (b - r) + 120 * diff;
+    }
+    else
+    {
+        t = 60 * (r - g) + 240 * diff;
+    }
+
+    const int d1 = std::max(diff, 1);
+    for (int i = 0; i < 2; ++i)
+    {
+        if (t >= (2 * range.hue_min[i] - 1)*d1 && t < (2 * range.hue_max[i] + 1)*d1)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void thresholdRowScalar(
+    const unsigned char *bgr, unsigned char *mask, int width, const HSVThresholdRange &range)
+{
+    for (int x = 0; x < width; ++x, bgr += 3)
+    {
+        mask[x] = isPixelInHSVRange(bgr[0], bgr[1], bgr[2], range) ? 255 : 0;
+    }
+}
+
+#ifdef HSV_THRESHOLD_KERNEL_X86
+struct HSVThresholdSSEConstants
+{
+    __m128i hue_lo[2], hue_hi[2];
+    __m128i saturation_lo, saturation_hi;
+    __m128i value_min, value_max;
+};
+
+struct HSVThresholdAVXConstants
+{
+    __m256i hue_lo[2], hue_hi[2];
+    __m256i saturation_lo, saturation_hi;
+};
+
+// Splits 16 packed BGR pixels (48 bytes) into one register per channel
+HSV_TARGET_SSE41
+static inline void deinterleaveBGR16(const unsigned char *bgr, __m128i &b, __m128i &g, __m128i &r)
+{
+    const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgr));
+    const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgr + 16));
+    const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgr + 32));
+
+    b = _mm_or_si128(
+        _mm_or_si128(
+            _mm_shuffle_epi8(c0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+            _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1))),
+        _mm_shuffle_epi8(c2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)));
+    g = _mm_or_si128(
+        _mm_or_si128(
+            _mm_shuffle_epi8(c0, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+            _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1))),
+        _mm_shuffle_epi8(c2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)));
+    r = _mm_or_si128(
+        _mm_or_si128(
+            _mm_shuffle_epi8(c0, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+            _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1))),
+        _mm_shuffle_epi8(c2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)));
+}
+
+// Computes the per-byte max/min channel state shared by both SIMD kernels
+HSV_TARGET_SSE41
+static inline void computeChannelStats16(
+    const __m128i b, const __m128i g, const __m128i r,
+    const HSVThresholdSSEConstants &k,
+    __m128i &v, __m128i &diff, __m128i &v_is_r, __m128i &v_is_g, __m128i &value_ok)
+{
+    v = _mm_max_epu8(_mm_max_epu8(b, g), r);
+    diff = _mm_sub_epi8(v, _mm_min_epu8(_mm_min_epu8(b, g), r));
+    v_is_r = _mm_cmpeq_epi8(v, r);
+    v_is_g = _mm_andnot_si128(v_is_r, _mm_cmpeq_epi8(v, g));
+    value_ok = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_max_epu8(v, k.value_min), v),
+        _mm_cmpeq_epi8(_mm_min_epu8(v, k.value_max), v));
+}
+
+// Tests the hue and saturation of the low 4 pixels of each channel register
+HSV_TARGET_SSE41
+static inline __m128i testHueSaturation4(
+    const __m128i b8, const __m128i g8, const __m128i r8,
+    const __m128i v8, const __m128i diff8, const __m128i v_is_r8, const __m128i v_is_g8,
+    const HSVThresholdSSEConstants &k)
+{
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i b = _mm_cvtepu8_epi32(b8);
+    const __m128i g = _mm_cvtepu8_epi32(g8);
+    const __m128i r = _mm_cvtepu8_epi32(r8);
+    const __m128i v = _mm_cvtepu8_epi32(v8);
+    const __m128i diff = _mm_cvtepu8_epi32(diff8);
+    const __m128i v_is_r = _mm_cvtepi8_epi32(v_is_r8);
+    const __m128i v_is_g = _mm_cvtepi8_epi32(v_is_g8);
+
+    // Hue numerator and sector offset for whichever channel is the max
+    __m128i num = _mm_blendv_epi8(_mm_sub_epi32(r, g), _mm_sub_epi32(b, r), v_is_g);
+    num = _mm_blendv_epi8(num, _mm_sub_epi32(g, b), v_is_r);
+    __m128i offset = _mm_blendv_epi8(_mm_set1_epi32(240), _mm_set1_epi32(120), v_is_g);
+    offset = _mm_andnot_si128(v_is_r, offset);
+
+    __m128i t = _mm_add_epi32(_mm_mullo_epi32(num, _mm_set1_epi32(60)), _mm_mullo_epi32(offset, diff));
+
+    // Red sector hues that round below zero wrap around to the top of the hue circle
+    const __m128i wrap = _mm_and_si128(v_is_r, _mm_cmpgt_epi32(_mm_setzero_si128(), _mm_add_epi32(t, diff)));
+    t = _mm_add_epi32(t, _mm_and_si128(wrap, _mm_mullo_epi32(diff, _mm_set1_epi32(360))));
+
+    const __m128i d1 = _mm_max_epi32(diff, one);
+    const __m128i hue_ok = _mm_or_si128(
+        _mm_andnot_si128(
+            _mm_cmpgt_epi32(_mm_mullo_epi32(d1, k.hue_lo[0]), t),
+            _mm_cmpgt_epi32(_mm_mullo_epi32(d1, k.hue_hi[0]), t)),
+        _mm_andnot_si128(
+            _mm_cmpgt_epi32(_mm_mullo_epi32(d1, k.hue_lo[1]), t),
+            _mm_cmpgt_epi32(_mm_mullo_epi32(d1, k.hue_hi[1]), t)));
+
+    const __m128i v1 = _mm_max_epi32(v, one);
+    const __m128i s2 = _mm_mullo_epi32(diff, _mm_set1_epi32(510));
+    const __m128i saturation_ok = _mm_andnot_si128(
+        _mm_cmpgt_epi32(_mm_mullo_epi32(v1, k.saturation_lo), s2),
+        _mm_cmpgt_epi32(_mm_mullo_epi32(v1, k.saturation_hi), s2));
+
+    return _mm_and_si128(hue_ok, saturation_ok);
+}
+
+HSV_TARGET_SSE41
+static void initSSEConstants(const HSVThresholdRange &range, HSVThresholdSSEConstants &k)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        k.hue_lo[i] = _mm_set1_epi32(2 * range.hue_min[i] - 1);
+        k.hue_hi[i] = _mm_set1_epi32(2 * range.hue_max[i] + 1);
+    }
+    k.saturation_lo = _mm_set1_epi32(2 * range.saturation_min - 1);
+    k.saturation_hi = _mm_set1_epi32(2 * range.saturation_max + 1);
+    k.value_min = _mm_set1_epi8(static_cast<char>(range.value_min));
+    k.value_max = _mm_set1_epi8(static_cast<char>(range.value_max));
+}
+
+HSV_TARGET_SSE41
+static void thresholdImageSSE41(
+    const unsigned char *bgr, int bgr_stride,
+    unsigned char *mask, int mask_stride,
+    int width, int height,
+    const HSVThresholdRange &range)
+{
+    HSVThresholdSSEConstants k;
+    initSSEConstants(range, k);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char *bgr_row = bgr + y*bgr_stride;
+        unsigned char *mask_row = mask + y*mask_stride;
+        int x = 0;
+
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i b, g, r, v, diff, v_is_r, v_is_g, value_ok;
+            deinterleaveBGR16(bgr_row + 3*x, b, g, r);
+            computeChannelStats16(b, g, r, k, v, diff, v_is_r, v_is_g, value_ok);
+
+            const __m128i q0 = testHueSaturation4(b, g, r, v, diff, v_is_r, v_is_g, k);
+            const __m128i q1 = testHueSaturation4(
+                _mm_srli_si128(b, 4), _mm_srli_si128(g, 4), _mm_srli_si128(r, 4), _mm_srli_si128(v, 4),
+                _mm_srli_si128(diff, 4), _mm_srli_si128(v_is_r, 4), _mm_srli_si128(v_is_g, 4), k);
+            const __m128i q2 = testHueSaturation4(
+                _mm_srli_si128(b, 8), _mm_srli_si128(g, 8), _mm_srli_si128(r, 8), _mm_srli_si128(v, 8),
+                _mm_srli_si128(diff, 8), _mm_srli_si128(v_is_r, 8), _mm_srli_si128(v_is_g, 8), k);
+            const __m128i q3 = testHueSaturation4(
+                _mm_srli_si128(b, 12), _mm_srli_si128(g, 12), _mm_srli_si128(r, 12), _mm_srli_si128(v, 12),
+                _mm_srli_si128(diff, 12), _mm_srli_si128(v_is_r, 12), _mm_srli_si128(v_is_g, 12), k);
+
+            // Lane masks are 0 or -1, which pack (with saturation) down to 0x00 or 0xFF
+            const __m128i hs_ok = _mm_packs_epi16(_mm_packs_epi32(q0, q1), _mm_packs_epi32(q2, q3));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(mask_row + x), _mm_and_si128(hs_ok, value_ok));
+        }
+
+        thresholdRowScalar(bgr_row + 3*x, mask_row + x, width - x, range);
+    }
+}
+
+// Tests the hue and saturation of the low 8 pixels of each channel register
+HSV_TARGET_AVX2
+static inline __m256i testHueSaturation8(
+    const __m128i b8, const __m128i g8, const __m128i r8,
+    const __m128i v8, const __m128i diff8, const __m128i v_is_r8, const __m128i v_is_g8,
+    const HSVThresholdAVXConstants &k)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i b = _mm256_cvtepu8_epi32(b8);
+    const __m256i g = _mm256_cvtepu8_epi32(g8);
+    const __m256i r = _mm256_cvtepu8_epi32(r8);
+    const __m256i v = _mm256_cvtepu8_epi32(v8);
+    const __m256i diff = _mm256_cvtepu8_epi32(diff8);
+    const __m256i v_is_r = _mm256_cvtepi8_epi32(v_is_r8);
+    const __m256i v_is_g = _mm256_cvtepi8_epi32(v_is_g8);
+
+    __m256i num = _mm256_blendv_epi8(_mm256_sub_epi32(r, g), _mm256_sub_epi32(b, r), v_is_g);
+    num = _mm256_blendv_epi8(num, _mm256_sub_epi32(g, b), v_is_r);
+    __m256i offset = _mm256_blendv_epi8(_mm256_set1_epi32(240), _mm256_set1_epi32(120), v_is_g);
+    offset = _mm256_andnot_si256(v_is_r, offset);
+
+    __m256i t = _mm256_add_epi32(_mm256_mullo_epi32(num, _mm256_set1_epi32(60)), _mm256_mullo_epi32(offset, diff));
+
+    const __m256i wrap = _mm256_and_si256(v_is_r, _mm256_cmpgt_epi32(_mm256_setzero_si256(), _mm256_add_epi32(t, diff)));
+    t = _mm256_add_epi32(t, _mm256_and_si256(wrap, _mm256_mullo_epi32(diff, _mm256_set1_epi32(360))));
+
+    const __m256i d1 = _mm256_max_epi32(diff, one);
+    const __m256i hue_ok = _mm256_or_si256(
+        _mm256_andnot_si256(
+            _mm256_cmpgt_epi32(_mm256_mullo_epi32(d1, k.hue_lo[0]), t),
+            _mm256_cmpgt_epi32(_mm256_mullo_epi32(d1, k.hue_hi[0]), t)),
+        _mm256_andnot_si256(
+            _mm256_cmpgt_epi32(_mm256_mullo_epi32(d1, k.hue_lo[1]), t),
+            _mm256_cmpgt_epi32(_mm256_mullo_epi32(d1, k.hue_hi[1]), t)));
+
+    const __m256i v1 = _mm256_max_epi32(v, one);
+    const __m256i s2 = _mm256_mullo_epi32(diff, _mm256_set1_epi32(510));
+    const __m256i saturation_ok = _mm256_andnot_si256(
+        _mm256_cmpgt_epi32(_mm256_mullo_epi32(v1, k.saturation_lo), s2),
+        _mm256_cmpgt_epi32(_mm256_mullo_epi32(v1, k.saturation_hi), s2));
+
+    return _mm256_and_si256(hue_ok, saturation_ok);
+}
+
+HSV_TARGET_AVX2
+static void thresholdImageAVX2(
+    const unsigned char *bgr, int bgr_stride,
+    unsigned char *mask, int mask_stride,
+    int width, int height,
+    const HSVThresholdRange &range)
+{
+    HSVThresholdSSEConstants k;
+    initSSEConstants(range, k);
+
+    HSVThresholdAVXConstants k256;
+    for (int i = 0; i < 2; ++i)
+    {
+        k256.hue_lo[i] = _mm256_set1_epi32(2 * range.hue_min[i] - 1);
+        k256.hue_hi[i] = _mm256_set1_epi32(2 * range.hue_max[i] + 1);
+    }
+    k256.saturation_lo = _mm256_set1_epi32(2 * range.saturation_min - 1);
+    k256.saturation_hi = _mm256_set1_epi32(2 * range.saturation_max + 1);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char *bgr_row = bgr + y*bgr_stride;
+        unsigned char *mask_row = mask + y*mask_stride;
+        int x = 0;
+
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i b, g, r, v, diff, v_is_r, v_is_g, value_ok;
+            deinterleaveBGR16(bgr_row + 3*x, b, g, r);
+            computeChannelStats16(b, g, r, k, v, diff, v_is_r, v_is_g, value_ok);
+
+            const __m256i lo = testHueSaturation8(b, g, r, v, diff, v_is_r, v_is_g, k256);
+            const __m256i hi = testHueSaturation8(
+                _mm_srli_si128(b, 8), _mm_srli_si128(g, 8), _mm_srli_si128(r, 8), _mm_srli_si128(v, 8),
+                _mm_srli_si128(diff, 8), _mm_srli_si128(v_is_r, 8), _mm_srli_si128(v_is_g, 8), k256);
+
+            // packs works per 128-bit lane, so restore pixel order before the final pack
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+            const __m128i hs_ok = _mm_packs_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(mask_row + x), _mm_and_si128(hs_ok, value_ok));
+        }
+
+        thresholdRowScalar(bgr_row + 3*x, mask_row + x, width - x, range);
+    }
+}
+
+static void queryCPUSupport(bool &out_sse41, bool &out_avx2)
+{
+#if defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    out_sse41 = (info[2] & (1 << 19)) != 0;
+
+    // AVX2 also needs the OS to save the upper halves of the ymm registers
+    const bool bOSSavesYMM = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    out_avx2 = false;
+    if (max_leaf >= 7 && bOSSavesYMM)
+    {
+        __cpuidex(info, 7, 0);
+        out_avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    out_sse41 = __builtin_cpu_supports("sse4.1") != 0;
+    out_avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // HSV_THRESHOLD_KERNEL_X86
+
+//-- public methods -----
+HSVThresholdRange HSVThresholdRange::fromColorRange(const CommonHSVColorRange &hsvColorRange)
+{
+    HSVThresholdRange range;
+
+    const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
+    const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
+
+    // Mirrors the hue wrapping in OpenCVBufferState::computeBiggestNContours
+    if (hue_min < 0)
+    {
+        setBounds(range.hue_min[0], range.hue_max[0], 0, hue_max, 180);
+        setBounds(range.hue_min[1], range.hue_max[1], 180 + hue_min, 180, 180);
+    }
+    else if (hue_max > 180)
+    {
+        setBounds(range.hue_min[0], range.hue_max[0], 0, hue_max - 180, 180);
+        setBounds(range.hue_min[1], range.hue_max[1], hue_min, 180, 180);
+    }
+    else
+    {
+        setBounds(range.hue_min[0], range.hue_max[0], hue_min, hue_max, 180);
+        setBounds(range.hue_min[1], range.hue_max[1], 1, 0, 180);
+    }
+
+    setBounds(range.saturation_min, range.saturation_max,
+        hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range,
+        hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range,
+        255);
+    setBounds(range.value_min, range.value_max,
+        hsvColorRange.value_range.center - hsvColorRange.value_range.range,
+        hsvColorRange.value_range.center + hsvColorRange.value_range.range,
+        255);
+
+    return range;
+}
+
+eHSVThresholdKernelType getBestSupportedHSVThresholdKernel()
+{
+#ifdef HSV_THRESHOLD_KERNEL_X86
+    // Only query the CPU once
+    static const eHSVThresholdKernelType best_kernel = []() {
+        bool bSupportsSSE41, bSupportsAVX2;
+        queryCPUSupport(bSupportsSSE41, bSupportsAVX2);
+
+        return
+            bSupportsAVX2 ? HSVThresholdKernel_AVX2 :
+            bSupportsSSE41 ? HSVThresholdKernel_SSE41 :
+            HSVThresholdKernel_Scalar;
+    }();
+
+    return best_kernel;
+#else
+    return HSVThresholdKernel_Scalar;
+#endif
+}
+
+bool thresholdBGRByHSVRangeWithKernel(
+    eHSVThresholdKernelType kernel_type,
+    const unsigned char *bgr, int bgr_stride,
+    unsigned char *mask, int mask_stride,
+    int width, int height,
+    const HSVThresholdRange &range)
+{
+    bool bSuccess = true;
+
+    switch (kernel_type)
+    {
+    case HSVThresholdKernel_Scalar:
+        for (int y = 0; y < height; ++y)
+        {
+            thresholdRowScalar(bgr + y*bgr_stride, mask + y*mask_stride, width, range);
+        }
+        break;
+#ifdef HSV_THRESHOLD_KERNEL_X86
+    case HSVThresholdKernel_SSE41:
+        bSuccess = getBestSupportedHSVThresholdKernel() >= HSVThresholdKernel_SSE41;
+        if (bSuccess)
+        {
+            thresholdImageSSE41(bgr, bgr_stride, mask, mask_stride, width, height, range);
+        }
+        break;
+    case HSVThresholdKernel_AVX2:
+        bSuccess = getBestSupportedHSVThresholdKernel() >= HSVThresholdKernel_AVX2;
+        if (bSuccess)
+        {
+            thresholdImageAVX2(bgr, bgr_stride, mask, mask_stride, width, height, range);
+        }
+        break;
+#endif
+    default:
+        bSuccess = false;
+        break;
+    }
+
+    return bSuccess;
+}
+
+void thresholdBGRByHSVRange(
+    const unsigned char *bgr, int bgr_stride,
+    unsigned char *mask, int mask_stride,
+    int width, int height,
+    const HSVThresholdRange &range)
+{
+    thresholdBGRByHSVRangeWithKernel(
+        getBestSupportedHSVThresholdKernel(),
+        bgr, bgr_stride, mask, mask_stride, width, height, range);
+}
@@ -0,0 +1,49 @@
+#ifndef HSV_THRESHOLD_KERNEL_H
+#define HSV_THRESHOLD_KERNEL_H
+
+//-- includes -----
+#include "DeviceInterface.h"
+
+// -- constants -----
+enum eHSVThresholdKernelType
+{
+    HSVThresholdKernel_Scalar,
+    HSVThresholdKernel_SSE41,
+    HSVThresholdKernel_AVX2,
+};
+
+// -- declarations -----
+// Integer HSV bounds in OpenCV's 8-bit HSV units (hue in [0, 180], saturation and value in [0, 255]).
+// The hue can be split into two intervals to handle ranges that wrap around the hue circle.
+struct HSVThresholdRange
+{
+    int hue_min[2], hue_max[2];
+    int saturation_min, saturation_max;
+    int value_min, value_max;
+
+    // Builds the same bounds the cv::inRange() path uses for the given color preset
+    static HSVThresholdRange fromColorRange(const CommonHSVColorRange &hsvColorRange);
+};
+
+// Writes 255 into the mask for every BGR pixel whose HSV color (as computed by cv::COLOR_BGR2HSV)
+// falls inside the given range and 0 otherwise, without ever materializing the HSV image.
+// Strides are in bytes.
+void thresholdBGRByHSVRange(
+    const unsigned char *bgr, int bgr_stride,
+    unsigned char *mask, int mask_stride,
+    int width, int height,
+    const HSVThresholdRange &range);
+
+// Same as above, but forces a specific kernel (used for benchmarking).
+// Returns false if the kernel isn't supported on this CPU.
+bool thresholdBGRByHSVRangeWithKernel(
+    eHSVThresholdKernelType kernel_type,
+    const unsigned char *bgr, int bgr_stride,
+    unsigned char *mask, int mask_stride,
+    int width, int height,
+    const HSVThresholdRange &range);
+
+// Returns the fastest kernel supported by the CPU we are running on
+eHSVThresholdKernelType getBestSupportedHSVThresholdKernel();
+
+#endif // HSV_THRESHOLD_KERNEL_H
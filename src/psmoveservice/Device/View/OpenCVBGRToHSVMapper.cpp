@@ -0,0 +1,308 @@
+//-- includes -----
+#include "OpenCVBGRToHSVMapper.h"
+#include "ServerLog.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+//-- constants -----
+// Bump this whenever the table layout or contents change
+static const uint32_t k_table_file_version = 1;
+static const char k_table_file_magic[8] = { 'P', 'S', 'M', 'H', 'S', 'V', 'L', 'T' };
+
+//-- definitions -----
+// The table file is this header followed by the hue table and then the saturation table
+struct BGRToHSVTableFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t bits_per_channel;
+    uint32_t hue_table_size;
+    uint32_t saturation_table_size;
+    char opencv_version[32]; // tables are built with cv::cvtColor, so rebuild them if OpenCV changes
+
+    void init(int bits, size_t hue_size, size_t saturation_size)
+    {
+        memset(this, 0, sizeof(BGRToHSVTableFileHeader));
+        memcpy(magic, k_table_file_magic, sizeof(magic));
+        version = k_table_file_version;
+        bits_per_channel = static_cast<uint32_t>(bits);
+        hue_table_size = static_cast<uint32_t>(hue_size);
+        saturation_table_size = static_cast<uint32_t>(saturation_size);
+        strncpy(opencv_version, CV_VERSION, sizeof(opencv_version) - 1);
+    }
+};
+
+//-- statics -----
+const int OpenCVBGRToHSVMapper::k_min_bits_per_channel;
+const int OpenCVBGRToHSVMapper::k_max_bits_per_channel;
+const size_t OpenCVBGRToHSVMapper::k_saturation_table_size;
+const int OpenCVBGRToHSVMapper::k_max_tracking_hue_error[OpenCVBGRToHSVMapper::k_max_bits_per_channel + 1] = {
+    180, 180, 180, 180, 3, 2, 1, 1, 0
+};
+OpenCVBGRToHSVMapper *OpenCVBGRToHSVMapper::m_instance = nullptr;
+int OpenCVBGRToHSVMapper::m_refCount = 0;
+
+//-- public methods -----
+OpenCVBGRToHSVMapper *OpenCVBGRToHSVMapper::allocate(int bits_per_channel, const std::string &table_cache_directory)
+{
+    if (m_refCount == 0)
+    {
+        assert(m_instance == nullptr);
+        m_instance = new OpenCVBGRToHSVMapper(bits_per_channel, table_cache_directory);
+    }
+    assert(m_instance != nullptr);
+
+    ++m_refCount;
+    return m_instance;
+}
+
+void OpenCVBGRToHSVMapper::dispose(OpenCVBGRToHSVMapper *instance)
+{
+    assert(m_instance != nullptr);
+    assert(m_instance == instance);
+    assert(m_refCount > 0);
+
+    --m_refCount;
+    if (m_refCount <= 0)
+    {
+        delete m_instance;
+        m_instance = nullptr;
+    }
+}
+
+void OpenCVBGRToHSVMapper::waitUntilReady()
+{
+    if (m_buildThread.joinable())
+    {
+        m_buildThread.join();
+    }
+}
+
+void OpenCVBGRToHSVMapper::cvtColor(const cv::Mat &bgrBuffer, cv::Mat &hsvBuffer) const
+{
+    assert(getIsReady());
+
+    hsvBuffer.forEach<ColorTuple>([&bgrBuffer, this](ColorTuple &hsvColor, const int position[]) -> void {
+        const ColorTuple &bgrColor = bgrBuffer.at<ColorTuple>(position[0], position[1]);
+
+        hsvColor = lookup(bgrColor.x, bgrColor.y, bgrColor.z);
+    });
+}
+
+//-- private methods -----
+OpenCVBGRToHSVMapper::OpenCVBGRToHSVMapper(int bits_per_channel, const std::string &table_cache_directory)
+    : m_bitsPerChannel(std::min(std::max(bits_per_channel, k_min_bits_per_channel), k_max_bits_per_channel))
+    , m_channelShift(k_max_bits_per_channel - m_bitsPerChannel)
+    , m_hueTableSize(static_cast<size_t>(1) << (3 * m_bitsPerChannel))
+    , m_tableFilePath()
+    , m_hueTable(nullptr)
+    , m_saturationTable(nullptr)
+    , m_builtHueTable(nullptr)
+    , m_builtSaturationTable(nullptr)
+    , m_mappedTableFile(nullptr)
+    , m_buildThread()
+    , m_bIsReady(false)
+{
+    if (!table_cache_directory.empty())
+    {
+        std::stringstream filename;
+        filename << table_cache_directory << "/BGRToHSVTable_" << m_bitsPerChannel << "bit.bin";
+        m_tableFilePath = filename.str();
+    }
+
+    if (loadTableFile())
+    {
+        m_bIsReady.store(true, std::memory_order_release);
+    }
+    else
+    {
+        // Don't block tracker startup on the table build
+        m_buildThread = std::thread(&OpenCVBGRToHSVMapper::buildTables, this);
+    }
+}
+
+OpenCVBGRToHSVMapper::~OpenCVBGRToHSVMapper()
+{
+    waitUntilReady();
+
+    if (m_mappedTableFile != nullptr)
+    {
+        delete m_mappedTableFile;
+    }
+
+    if (m_builtSaturationTable != nullptr)
+    {
+        delete m_builtSaturationTable;
+    }
+
+    if (m_builtHueTable != nullptr)
+    {
+        delete m_builtHueTable;
+    }
+}
+
+bool OpenCVBGRToHSVMapper::loadTableFile()
+{
+    bool bSuccess = false;
+
+    if (!m_tableFilePath.empty() && std::ifstream(m_tableFilePath.c_str()).good())
+    {
+        try
+        {
+            boost::interprocess::file_mapping mapping(m_tableFilePath.c_str(), boost::interprocess::read_only);
+            m_mappedTableFile = new boost::interprocess::mapped_region(mapping, boost::interprocess::read_only);
+
+            const unsigned char *file_data = static_cast<const unsigned char *>(m_mappedTableFile->get_address());
+            const size_t file_size = m_mappedTableFile->get_size();
+
+            BGRToHSVTableFileHeader expected_header;
+            expected_header.init(m_bitsPerChannel, m_hueTableSize, k_saturation_table_size);
+
+            if (file_size == sizeof(BGRToHSVTableFileHeader) + m_hueTableSize + k_saturation_table_size &&
+                memcmp(file_data, &expected_header, sizeof(BGRToHSVTableFileHeader)) == 0)
+            {
+                m_hueTable = file_data + sizeof(BGRToHSVTableFileHeader);
+                m_saturationTable = m_hueTable + m_hueTableSize;
+                bSuccess = true;
+
+                SERVER_LOG_INFO("OpenCVBGRToHSVMapper") << "Mapped BGR->HSV table file: " << m_tableFilePath;
+            }
+            else
+            {
+                SERVER_LOG_WARNING("OpenCVBGRToHSVMapper") << "Ignoring out of date BGR->HSV table file: " << m_tableFilePath;
+            }
+        }
+        catch (const boost::interprocess::interprocess_exception &e)
+        {
+            SERVER_LOG_WARNING("OpenCVBGRToHSVMapper") << "Failed to map BGR->HSV table file: " << m_tableFilePath
+                << ", reason: " << e.what();
+        }
+
+        if (!bSuccess && m_mappedTableFile != nullptr)
+        {
+            delete m_mappedTableFile;
+            m_mappedTableFile = nullptr;
+        }
+    }
+
+    return bSuccess;
+}
+
+bool OpenCVBGRToHSVMapper::saveTableFile() const
+{
+    bool bSuccess = false;
+
+    if (!m_tableFilePath.empty())
+    {
+        // Write to a temp file first so that a crash mid-write never leaves a truncated table behind
+        const std::string temp_path = m_tableFilePath + ".tmp";
+
+        {
+            BGRToHSVTableFileHeader header;
+            header.init(m_bitsPerChannel, m_hueTableSize, k_saturation_table_size);
+
+            std::ofstream file(temp_path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(m_hueTable), m_hueTableSize);
+            file.write(reinterpret_cast<const char *>(m_saturationTable), k_saturation_table_size);
+            file.close();
+            bSuccess = !file.fail();
+        }
+
+        if (bSuccess)
+        {
+            // rename() won't replace an existing file on Windows
+            remove(m_tableFilePath.c_str());
+            bSuccess = rename(temp_path.c_str(), m_tableFilePath.c_str()) == 0;
+        }
+
+        if (bSuccess)
+        {
+            SERVER_LOG_INFO("OpenCVBGRToHSVMapper") << "Saved BGR->HSV table file: " << m_tableFilePath;
+        }
+        else
+        {
+            remove(temp_path.c_str());
+            SERVER_LOG_WARNING("OpenCVBGRToHSVMapper") << "Failed to save BGR->HSV table file: " << m_tableFilePath;
+        }
+    }
+
+    return bSuccess;
+}
+
+void OpenCVBGRToHSVMapper::buildTables()
+{
+    const auto build_start = std::chrono::high_resolution_clock::now();
+    const int levels = 1 << m_bitsPerChannel;
+    const int cell_center = (1 << m_channelShift) >> 1;
+
+    // Let OpenCV compute the hue at the center of each quantized color cell
+    {
+        cv::Mat cellColors(levels*levels*levels, 1, CV_8UC3);
+
+        int LUTIndex = 0;
+        for (int r = 0; r < levels; ++r)
+        {
+            for (int g = 0; g < levels; ++g)
+            {
+                for (int b = 0; b < levels; ++b)
+                {
+                    cellColors.at<ColorTuple>(LUTIndex, 0) = ColorTuple(
+                        (b << m_channelShift) + cell_center,
+                        (g << m_channelShift) + cell_center,
+                        (r << m_channelShift) + cell_center);
+                    ++LUTIndex;
+                }
+            }
+        }
+
+        cv::cvtColor(cellColors, cellColors, cv::COLOR_BGR2HSV);
+
+        m_builtHueTable = new cv::Mat(levels*levels*levels, 1, CV_8UC1);
+        cv::extractChannel(cellColors, *m_builtHueTable, 0);
+    }
+
+    // Saturation only depends on the max channel and the max-min spread,
+    // so convert one color for every (max, spread) pair. Pairs with spread > max can't happen.
+    {
+        cv::Mat spreadColors(256*256, 1, CV_8UC3, cv::Scalar(0, 0, 0));
+
+        for (int v = 0; v < 256; ++v)
+        {
+            for (int diff = 0; diff <= v; ++diff)
+            {
+                spreadColors.at<ColorTuple>((v << 8) | diff, 0) = ColorTuple(v - diff, v - diff, v);
+            }
+        }
+
+        cv::cvtColor(spreadColors, spreadColors, cv::COLOR_BGR2HSV);
+
+        m_builtSaturationTable = new cv::Mat(256*256, 1, CV_8UC1);
+        cv::extractChannel(spreadColors, *m_builtSaturationTable, 1);
+    }
+
+    m_hueTable = m_builtHueTable->data;
+    m_saturationTable = m_builtSaturationTable->data;
+
+    const auto build_end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> build_time = build_end - build_start;
+    SERVER_LOG_INFO("OpenCVBGRToHSVMapper") << "Built " << m_bitsPerChannel << "-bit BGR->HSV table in "
+        << build_time.count() << "ms";
+
+    // Publish the tables to the tracker threads
+    m_bIsReady.store(true, std::memory_order_release);
+
+    saveTableFile();
+}
@@ -0,0 +1,115 @@
+#ifndef OPENCV_BGR_TO_HSV_MAPPER_H
+#define OPENCV_BGR_TO_HSV_MAPPER_H
+
+//-- includes -----
+#include "opencv2/core/core.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+// -- pre-declarations -----
+namespace boost
+{
+    namespace interprocess
+    {
+        class mapped_region;
+    };
+};
+
+// -- declarations -----
+// Shared lookup tables for converting BGR pixels to the same HSV values cv::COLOR_BGR2HSV produces.
+// Value is just max(b,g,r), and saturation only depends on the max and min channels,
+// so both are exact (saturation comes from a 64KB table indexed by [max][max-min]).
+// Hue comes from a one byte per entry table indexed by the top bits_per_channel bits of each channel:
+// at 8 bits it's exact (16MB), and every bit less shrinks it by 8x (6 bits = 256KB, 5 bits = 32KB)
+// so it can stay in cache, with each entry holding the hue at the center of its color cell.
+// For the bright saturated colors the tracking presets match (saturation and value >= 223)
+// that hue is off by at most k_max_tracking_hue_error[bits_per_channel] (1 at 6-7 bits, 2 at 5, 3 at 4).
+//
+// The tables are memory mapped from a versioned file in the given cache directory when possible.
+// Otherwise they get built on a background thread (and then saved to the cache directory),
+// and callers should fall back to cv::cvtColor until getIsReady() returns true.
+class OpenCVBGRToHSVMapper
+{
+public:
+    typedef cv::Point3_<uint8_t> ColorTuple;
+
+    static const int k_min_bits_per_channel = 4;
+    static const int k_max_bits_per_channel = 8;
+    // Max hue error of the table for tracking colors, indexed by bits per channel
+    static const int k_max_tracking_hue_error[k_max_bits_per_channel + 1];
+
+    // Returns the shared mapper, creating it on first use.
+    // All callers must use the same bits_per_channel.
+    // An empty table_cache_directory disables saving and loading the tables.
+    static OpenCVBGRToHSVMapper *allocate(
+        int bits_per_channel = k_max_bits_per_channel,
+        const std::string &table_cache_directory = std::string());
+    static void dispose(OpenCVBGRToHSVMapper *instance);
+
+    // True once the tables have been loaded or built
+    inline bool getIsReady() const { return m_bIsReady.load(std::memory_order_acquire); }
+
+    // Blocks until the background table build finishes.
+    // Only call from the thread that allocated the mapper.
+    void waitUntilReady();
+
+    // Requires getIsReady()
+    void cvtColor(const cv::Mat &bgrBuffer, cv::Mat &hsvBuffer) const;
+
+    inline int getBitsPerChannel() const { return m_bitsPerChannel; }
+    inline size_t getTableSizeBytes() const { return m_hueTableSize + k_saturation_table_size; }
+
+    // Requires getIsReady()
+    inline ColorTuple lookup(int b, int g, int r) const
+    {
+        const int v = std::max(std::max(b, g), r);
+        const int diff = v - std::min(std::min(b, g), r);
+
+        return ColorTuple(
+            m_hueTable[getHueIndex(r, g, b)],
+            m_saturationTable[(v << 8) | diff],
+            static_cast<uint8_t>(v));
+    }
+
+private:
+    static const size_t k_saturation_table_size = 256*256;
+
+    static OpenCVBGRToHSVMapper *m_instance;
+    static int m_refCount;
+
+    OpenCVBGRToHSVMapper(int bits_per_channel, const std::string &table_cache_directory);
+    ~OpenCVBGRToHSVMapper();
+
+    inline int getHueIndex(int r, int g, int b) const
+    {
+        return
+            ((r >> m_channelShift) << (2 * m_bitsPerChannel)) |
+            ((g >> m_channelShift) << m_bitsPerChannel) |
+            (b >> m_channelShift);
+    }
+
+    bool loadTableFile();
+    bool saveTableFile() const;
+    void buildTables();
+
+    int m_bitsPerChannel;
+    int m_channelShift;
+    size_t m_hueTableSize;
+    std::string m_tableFilePath;
+
+    const unsigned char *m_hueTable; // [r][g][b] quantized to m_bitsPerChannel
+    const unsigned char *m_saturationTable; // [max][max-min]
+
+    // Backing storage for the tables, either built in process or mapped from the table file
+    cv::Mat *m_builtHueTable;
+    cv::Mat *m_builtSaturationTable;
+    boost::interprocess::mapped_region *m_mappedTableFile;
+
+    std::thread m_buildThread;
+    std::atomic_bool m_bIsReady;
+};
+
+#endif // OPENCV_BGR_TO_HSV_MAPPER_H
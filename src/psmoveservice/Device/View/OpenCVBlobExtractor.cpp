@@ -0,0 +1,291 @@
+//-- includes -----
+#include "OpenCVBlobExtractor.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+//-- public methods -----
+OpenCVBlobExtractor::OpenCVBlobExtractor()
+    : m_runs()
+    , m_labelParents()
+    , m_labelAccumulators()
+    , m_labelBlobIndices()
+    , m_blobs()
+    , m_traceBuffer()
+    , m_traceContours()
+{
+}
+
+int OpenCVBlobExtractor::extractBlobs(const cv::Mat &mask)
+{
+    assert(mask.type() == CV_8UC1);
+
+    m_runs.clear();
+    m_labelParents.clear();
+    m_labelAccumulators.clear();
+    m_labelBlobIndices.clear();
+    m_blobs.clear();
+
+    // Runs of the previous row are [prev_row_begin, prev_row_end) in m_runs
+    int prev_row_begin = 0;
+    int prev_row_end = 0;
+
+    for (int y = 0; y < mask.rows; ++y)
+    {
+        const unsigned char *row = mask.ptr<unsigned char>(y);
+        const int row_begin = static_cast<int>(m_runs.size());
+        int prev_run_index = prev_row_begin;
+        int x = 0;
+
+        while (x < mask.cols)
+        {
+            while (x < mask.cols && row[x] == 0)
+            {
+                ++x;
+            }
+
+            if (x >= mask.cols)
+            {
+                break;
+            }
+
+            Run run;
+            run.y = y;
+            run.x_begin = x;
+            while (x < mask.cols && row[x] != 0)
+            {
+                ++x;
+            }
+            run.x_end = x;
+            run.label = -1;
+
+            // Skip previous row runs that end left of this run, even diagonally.
+            // They can't touch any later run on this row either.
+            while (prev_run_index < prev_row_end && m_runs[prev_run_index].x_end < run.x_begin)
+            {
+                ++prev_run_index;
+            }
+
+            // Join every previous row run overlapping [x_begin - 1, x_end] (8-connectivity)
+            for (int touching_index = prev_run_index;
+                touching_index < prev_row_end && m_runs[touching_index].x_begin <= run.x_end;
+                ++touching_index)
+            {
+                const int touching_label = m_runs[touching_index].label;
+
+                run.label = (run.label == -1) ? findRootLabel(touching_label) : mergeLabels(run.label, touching_label);
+            }
+
+            if (run.label == -1)
+            {
+                run.label = newLabel();
+            }
+
+            // Fold the run into its label's stats. Merged labels get combined once the scan is done.
+            BlobAccumulator &accumulator = m_labelAccumulators[run.label];
+            const int64_t run_length = run.x_end - run.x_begin;
+
+            accumulator.area += run_length;
+            accumulator.x_sum += (run_length * (run.x_begin + run.x_end - 1)) / 2;
+            accumulator.y_sum += run_length * y;
+            accumulator.x_min = std::min(accumulator.x_min, run.x_begin);
+            accumulator.x_max = std::max(accumulator.x_max, run.x_end - 1);
+            accumulator.y_min = std::min(accumulator.y_min, y);
+            accumulator.y_max = std::max(accumulator.y_max, y);
+
+            m_runs.push_back(run);
+        }
+
+        prev_row_begin = row_begin;
+        prev_row_end = static_cast<int>(m_runs.size());
+    }
+
+    // Collapse each label set into a blob.
+    // A root is always the smallest label in its set, so it gets its blob before any label that points at it.
+    const int label_count = static_cast<int>(m_labelParents.size());
+    m_labelBlobIndices.resize(label_count);
+
+    std::vector<BlobAccumulator> blob_accumulators;
+    for (int label = 0; label < label_count; ++label)
+    {
+        const int root_label = findRootLabel(label);
+        const BlobAccumulator &accumulator = m_labelAccumulators[label];
+
+        if (root_label == label)
+        {
+            m_labelBlobIndices[label] = static_cast<int>(blob_accumulators.size());
+            blob_accumulators.push_back(accumulator);
+        }
+        else
+        {
+            const int blob_index = m_labelBlobIndices[root_label];
+            BlobAccumulator &blob_accumulator = blob_accumulators[blob_index];
+
+            m_labelBlobIndices[label] = blob_index;
+            blob_accumulator.area += accumulator.area;
+            blob_accumulator.x_sum += accumulator.x_sum;
+            blob_accumulator.y_sum += accumulator.y_sum;
+            blob_accumulator.x_min = std::min(blob_accumulator.x_min, accumulator.x_min);
+            blob_accumulator.x_max = std::max(blob_accumulator.x_max, accumulator.x_max);
+            blob_accumulator.y_min = std::min(blob_accumulator.y_min, accumulator.y_min);
+            blob_accumulator.y_max = std::max(blob_accumulator.y_max, accumulator.y_max);
+        }
+    }
+
+    m_blobs.resize(blob_accumulators.size());
+    for (size_t blob_index = 0; blob_index < blob_accumulators.size(); ++blob_index)
+    {
+        const BlobAccumulator &accumulator = blob_accumulators[blob_index];
+        const double area = static_cast<double>(accumulator.area);
+        OpenCVBlob &blob = m_blobs[blob_index];
+
+        blob.area = static_cast<int>(accumulator.area);
+        blob.bounding_box = cv::Rect2i(
+            accumulator.x_min, accumulator.y_min,
+            accumulator.x_max - accumulator.x_min + 1, accumulator.y_max - accumulator.y_min + 1);
+        blob.centroid = cv::Point2f(
+            static_cast<float>(static_cast<double>(accumulator.x_sum) / area),
+            static_cast<float>(static_cast<double>(accumulator.y_sum) / area));
+    }
+
+    return static_cast<int>(m_blobs.size());
+}
+
+void OpenCVBlobExtractor::selectLargestBlobs(
+    int max_count,
+    std::vector<int> &out_blob_indices,
+    const cv::Rect2f *centroid_region) const
+{
+    // Strict ordering: bigger area first, then scan order
+    auto isLarger = [this](int a, int b) {
+        return m_blobs[a].area > m_blobs[b].area || (m_blobs[a].area == m_blobs[b].area && a < b);
+    };
+
+    out_blob_indices.clear();
+    if (max_count <= 0)
+    {
+        return;
+    }
+
+    // Bounded heap holding the max_count largest blobs seen so far, smallest on top
+    const int blob_count = static_cast<int>(m_blobs.size());
+    for (int blob_index = 0; blob_index < blob_count; ++blob_index)
+    {
+        if (centroid_region != nullptr && !centroid_region->contains(m_blobs[blob_index].centroid))
+        {
+            continue;
+        }
+
+        if (static_cast<int>(out_blob_indices.size()) < max_count)
+        {
+            out_blob_indices.push_back(blob_index);
+            std::push_heap(out_blob_indices.begin(), out_blob_indices.end(), isLarger);
+        }
+        else if (isLarger(blob_index, out_blob_indices.front()))
+        {
+            std::pop_heap(out_blob_indices.begin(), out_blob_indices.end(), isLarger);
+            out_blob_indices.back() = blob_index;
+            std::push_heap(out_blob_indices.begin(), out_blob_indices.end(), isLarger);
+        }
+    }
+
+    std::sort_heap(out_blob_indices.begin(), out_blob_indices.end(), isLarger);
+}
+
+bool OpenCVBlobExtractor::traceBlobContour(int blob_index, const cv::Point &offset, std::vector<cv::Point> &out_contour)
+{
+    assert(blob_index >= 0 && blob_index < getBlobCount());
+
+    const cv::Rect2i &bounding_box = m_blobs[blob_index].bounding_box;
+    out_contour.clear();
+
+    // Paint just this blob into a scratch image with a one pixel empty border,
+    // so that neighboring blobs and the image edge can't affect the trace
+    const int trace_width = bounding_box.width + 2;
+    const int trace_height = bounding_box.height + 2;
+    if (m_traceBuffer.cols < trace_width || m_traceBuffer.rows < trace_height)
+    {
+        m_traceBuffer.create(
+            std::max(m_traceBuffer.rows, trace_height),
+            std::max(m_traceBuffer.cols, trace_width),
+            CV_8UC1);
+    }
+
+    cv::Mat traceROI(m_traceBuffer, cv::Rect2i(0, 0, trace_width, trace_height));
+    traceROI.setTo(cv::Scalar(0));
+
+    for (auto it = m_runs.begin(); it != m_runs.end(); ++it)
+    {
+        const Run &run = *it;
+
+        if (run.y >= bounding_box.y && run.y < bounding_box.y + bounding_box.height &&
+            m_labelBlobIndices[run.label] == blob_index)
+        {
+            unsigned char *row = traceROI.ptr<unsigned char>(run.y - bounding_box.y + 1);
+
+            memset(row + run.x_begin - bounding_box.x + 1, 255, run.x_end - run.x_begin);
+        }
+    }
+
+    cv::findContours(
+        traceROI,
+        m_traceContours,
+        cv::RETR_EXTERNAL,
+        cv::CHAIN_APPROX_SIMPLE,
+        offset + bounding_box.tl() - cv::Point(1, 1));
+
+    // An 8-connected blob only ever has the one outer contour
+    if (m_traceContours.size() > 0)
+    {
+        out_contour.swap(m_traceContours[0]);
+    }
+
+    return out_contour.size() > 0;
+}
+
+//-- private methods -----
+int OpenCVBlobExtractor::newLabel()
+{
+    const int label = static_cast<int>(m_labelParents.size());
+    const BlobAccumulator empty_accumulator = { 0, 0, 0, INT_MAX, INT_MIN, INT_MAX, INT_MIN };
+
+    m_labelParents.push_back(label);
+    m_labelAccumulators.push_back(empty_accumulator);
+
+    return label;
+}
+
+int OpenCVBlobExtractor::findRootLabel(int label)
+{
+    int root_label = label;
+    while (m_labelParents[root_label] != root_label)
+    {
+        root_label = m_labelParents[root_label];
+    }
+
+    // Path compression
+    while (m_labelParents[label] != root_label)
+    {
+        const int parent_label = m_labelParents[label];
+        m_labelParents[label] = root_label;
+        label = parent_label;
+    }
+
+    return root_label;
+}
+
+int OpenCVBlobExtractor::mergeLabels(int label_a, int label_b)
+{
+    const int root_a = findRootLabel(label_a);
+    const int root_b = findRootLabel(label_b);
+    const int root_label = std::min(root_a, root_b);
+
+    m_labelParents[root_a] = root_label;
+    m_labelParents[root_b] = root_label;
+
+    return root_label;
+}
@@ -0,0 +1,81 @@
+#ifndef OPENCV_BLOB_EXTRACTOR_H
+#define OPENCV_BLOB_EXTRACTOR_H
+
+//-- includes -----
+#include "opencv2/core/core.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+// -- declarations -----
+struct OpenCVBlob
+{
+    int area; // pixel count
+    cv::Rect2i bounding_box; // in mask coordinates
+    cv::Point2f centroid; // in mask coordinates
+};
+
+// Finds the 8-connected blobs of non-zero pixels in a mask with a single run-length labeling pass,
+// gathering each blob's area, bounding box and centroid along the way.
+// Contours are only traced on request, one blob at a time, so callers that want the N biggest
+// contours don't pay for tracing (and sorting) every speck of noise in the mask.
+// Keeps its scratch buffers between calls, so hold onto one instance per mask.
+class OpenCVBlobExtractor
+{
+public:
+    OpenCVBlobExtractor();
+
+    // Labels the blobs in the given CV_8UC1 mask (which may be an ROI into a bigger image).
+    // Returns the number of blobs found.
+    int extractBlobs(const cv::Mat &mask);
+
+    inline int getBlobCount() const { return static_cast<int>(m_blobs.size()); }
+    inline const OpenCVBlob &getBlob(int blob_index) const { return m_blobs[blob_index]; }
+
+    // Writes the indices of the (up to) max_count largest blobs, largest first.
+    // Equal sized blobs stay in scan order, so asking for more blobs only appends to a previous answer.
+    // Only blobs whose centroid lies in the (optional) region are considered.
+    void selectLargestBlobs(
+        int max_count,
+        std::vector<int> &out_blob_indices,
+        const cv::Rect2f *centroid_region = nullptr) const;
+
+    // Traces the outer contour of a blob, matching what
+    // cv::findContours(RETR_EXTERNAL, CHAIN_APPROX_SIMPLE) would return for it on the whole mask.
+    // The offset gets added to every contour point.
+    bool traceBlobContour(int blob_index, const cv::Point &offset, std::vector<cv::Point> &out_contour);
+
+private:
+    // A horizontal span of mask pixels [x_begin, x_end) on one row
+    struct Run
+    {
+        int y;
+        int x_begin;
+        int x_end;
+        int label;
+    };
+
+    struct BlobAccumulator
+    {
+        int64_t area;
+        int64_t x_sum;
+        int64_t y_sum;
+        int x_min, x_max;
+        int y_min, y_max;
+    };
+
+    int newLabel();
+    int findRootLabel(int label);
+    int mergeLabels(int label_a, int label_b);
+
+    std::vector<Run> m_runs;
+    std::vector<int> m_labelParents; // union-find forest over the provisional run labels
+    std::vector<BlobAccumulator> m_labelAccumulators;
+    std::vector<int> m_labelBlobIndices;
+    std::vector<OpenCVBlob> m_blobs;
+
+    cv::Mat m_traceBuffer; // single blob image handed to cv::findContours
+    std::vector<std::vector<cv::Point> > m_traceContours;
+};
+
+#endif // OPENCV_BLOB_EXTRACTOR_H
@@ -0,0 +1,697 @@
+//-- includes -----
+#include "OpenCVPointCloudPoseSolver.h"
+
+#include "opencv2/calib3d/calib3d.hpp"
+
+#include <algorithm>
+#include <math.h>
+
+//-- constants -----
+static const double k_min_point_depth= 1.0; // LEDs closer to the camera than this (model units) are behind it
+static const double k_min_pair_separation_px= 4.0; // closer blob pairs don't pin down the depth
+static const int k_max_refinement_iterations= 10;
+static const double k_refinement_convergence_sqrd= 1e-12;
+static const int k_ransac_sample_size= 4; // P3P, plus one point to pick between its solutions
+static const int k_min_rotation_refinement_inliers= 4; // three points fit any rotation, so keep the prior one
+static const double k_degrees_to_radians= 3.14159265358979323846 / 180.0;
+
+typedef std::chrono::high_resolution_clock t_solver_clock;
+
+//-- private definitions -----
+struct OpenCVPointCloudPoseSolver::PoseScore
+{
+    int inlier_count;
+    double squared_error_sum;
+    int model_indices[MAX_POINT_CLOUD_SOLVER_POINT_COUNT];
+
+    void clear()
+    {
+        inlier_count = 0;
+        squared_error_sum = 0.0;
+        std::fill(model_indices, model_indices + MAX_POINT_CLOUD_SOLVER_POINT_COUNT, -1);
+    }
+
+    // More inliers wins, then less error
+    bool isBetterThan(const PoseScore &other) const
+    {
+        return
+            inlier_count > other.inlier_count ||
+            (inlier_count == other.inlier_count && squared_error_sum < other.squared_error_sum);
+    }
+
+    bool hasSameInliers(const PoseScore &other, int image_count) const
+    {
+        return
+            inlier_count == other.inlier_count &&
+            std::equal(model_indices, model_indices + image_count, other.model_indices);
+    }
+};
+
+//-- prototypes -----
+static cv::Matx33d skewSymmetricMatrix(const cv::Vec3d &v);
+static cv::Matx33d angleAxisVectorToRotationMatrix(const cv::Vec3d &angle_axis);
+static double computeAngleBetweenRotations(const cv::Matx33d &a, const cv::Matx33d &b);
+static bool solveTranslationFromPointPair(
+    const cv::Point2d &normalized_a, const cv::Vec3d &rotated_a,
+    const cv::Point2d &normalized_b, const cv::Vec3d &rotated_b,
+    cv::Vec3d &out_translation);
+
+//-- public methods -----
+PointCloudPoseSolverSettings::PointCloudPoseSolverSettings()
+    : time_budget(DEFAULT_POINT_CLOUD_POSE_BUDGET_US)
+    , max_correspondence_error_px(12.f)
+    , max_reprojection_error_px(2.f)
+    , min_inlier_count(3)
+    , max_prior_angle_error_degrees(15.f)
+    , max_ransac_iterations(500)
+{
+}
+
+OpenCVPointCloudPoseSolver::OpenCVPointCloudPoseSolver(
+    const std::vector<cv::Point3f> &model_points,
+    const cv::Matx33f &camera_matrix,
+    const PointCloudPoseSolverSettings &settings)
+    : m_modelPoints()
+    , m_fx(camera_matrix(0, 0))
+    , m_fy(camera_matrix(1, 1))
+    , m_cx(camera_matrix(0, 2))
+    , m_cy(camera_matrix(1, 2))
+    , m_settings(settings)
+{
+    const size_t model_point_count = std::min(model_points.size(), static_cast<size_t>(MAX_POINT_CLOUD_SOLVER_POINT_COUNT));
+
+    m_modelPoints.reserve(model_point_count);
+    for (size_t point_index = 0; point_index < model_point_count; ++point_index)
+    {
+        const cv::Point3f &point = model_points[point_index];
+
+        m_modelPoints.push_back(cv::Point3d(point.x, point.y, point.z));
+    }
+}
+
+bool OpenCVPointCloudPoseSolver::solve(
+    const std::vector<cv::Point2f> &image_points,
+    const PointCloudPose *pose_guess,
+    const cv::Matx33d *orientation_guess,
+    PointCloudPoseSolution &out_solution) const
+{
+    const t_solver_clock::time_point start_time = t_solver_clock::now();
+    const t_solver_clock::time_point deadline = start_time + m_settings.time_budget;
+    const int image_count = std::min(static_cast<int>(image_points.size()), MAX_POINT_CLOUD_SOLVER_POINT_COUNT);
+    const int model_count = static_cast<int>(m_modelPoints.size());
+    const int min_inlier_count = std::max(m_settings.min_inlier_count, 3);
+
+    out_solution.model_indices.assign(image_points.size(), -1);
+    out_solution.inlier_count = 0;
+    out_solution.reprojection_error_px = 0.f;
+    out_solution.stage = _PointCloudPoseSolverStage_None;
+    out_solution.hypothesis_count = 0;
+    out_solution.bBudgetExceeded = false;
+
+    if (image_count < min_inlier_count || model_count < min_inlier_count)
+    {
+        return false;
+    }
+
+    PointCloudPose best_pose;
+    PoseScore best_score;
+    best_score.clear();
+    bool bSuccess = false;
+
+    // 1) Match every blob to the nearest LED of the projected prior pose
+    if (pose_guess != nullptr)
+    {
+        best_pose = *pose_guess;
+        scorePose(image_points, image_count, best_pose, best_score);
+        ++out_solution.hypothesis_count;
+
+        bSuccess =
+            polishPose(image_points, image_count, &pose_guess->rotation, best_pose, best_score) &&
+            getIsPoseAcceptable(best_score, min_inlier_count, best_pose, &pose_guess->rotation);
+
+        if (bSuccess)
+        {
+            out_solution.stage = _PointCloudPoseSolverStage_PoseGuess;
+        }
+    }
+
+    // 2) Keep the prior orientation, try the translation given by every blob pair / LED pair
+    const cv::Matx33d *rotation_prior =
+        (orientation_guess != nullptr) ? orientation_guess : ((pose_guess != nullptr) ? &pose_guess->rotation : nullptr);
+
+    if (!bSuccess && rotation_prior != nullptr)
+    {
+        cv::Vec3d rotated_points[MAX_POINT_CLOUD_SOLVER_POINT_COUNT];
+        for (int model_index = 0; model_index < model_count; ++model_index)
+        {
+            rotated_points[model_index] = (*rotation_prior) * cv::Vec3d(m_modelPoints[model_index]);
+        }
+
+        cv::Point2d normalized_points[MAX_POINT_CLOUD_SOLVER_POINT_COUNT];
+        for (int image_index = 0; image_index < image_count; ++image_index)
+        {
+            normalized_points[image_index] = cv::Point2d(
+                (image_points[image_index].x - m_cx) / m_fx,
+                (image_points[image_index].y - m_cy) / m_fy);
+        }
+
+        // A hypothesis that explains every blob but one (a reflection, say) gets polished right away,
+        // and if it holds up the search stops there
+        const int good_enough_inlier_count = std::max(image_count - 1, std::min(image_count, min_inlier_count + 1));
+
+        PointCloudPose stage_pose;
+        PoseScore stage_score;
+        stage_score.clear();
+        stage_pose.rotation = *rotation_prior;
+
+        for (int image_a = 0; image_a < image_count && !bSuccess; ++image_a)
+        {
+            for (int image_b = image_a + 1; image_b < image_count && !bSuccess; ++image_b)
+            {
+                const cv::Point2f pair_offset = image_points[image_b] - image_points[image_a];
+                if (pair_offset.dot(pair_offset) < k_min_pair_separation_px*k_min_pair_separation_px)
+                {
+                    continue;
+                }
+
+                for (int model_a = 0; model_a < model_count && !bSuccess; ++model_a)
+                {
+                    if (t_solver_clock::now() > deadline)
+                    {
+                        out_solution.bBudgetExceeded = true;
+                        break;
+                    }
+
+                    for (int model_b = 0; model_b < model_count && !bSuccess; ++model_b)
+                    {
+                        PointCloudPose pose;
+                        PoseScore score;
+
+                        if (model_b == model_a ||
+                            !solveTranslationFromPointPair(
+                                normalized_points[image_a], rotated_points[model_a],
+                                normalized_points[image_b], rotated_points[model_b],
+                                pose.translation))
+                        {
+                            continue;
+                        }
+
+                        pose.rotation = *rotation_prior;
+
+                        // The pair itself has to line up before it's worth matching everything else
+                        if (!getIsPointWithinCorrespondenceError(image_points[image_a], rotated_points[model_a] + pose.translation) ||
+                            !getIsPointWithinCorrespondenceError(image_points[image_b], rotated_points[model_b] + pose.translation))
+                        {
+                            continue;
+                        }
+
+                        scorePose(image_points, image_count, pose, score);
+                        ++out_solution.hypothesis_count;
+
+                        if (score.isBetterThan(stage_score))
+                        {
+                            stage_pose = pose;
+                            stage_score = score;
+
+                            if (score.inlier_count >= good_enough_inlier_count &&
+                                polishPose(image_points, image_count, rotation_prior, pose, score) &&
+                                getIsPoseAcceptable(score, min_inlier_count, pose, rotation_prior))
+                            {
+                                best_pose = pose;
+                                best_score = score;
+                                bSuccess = true;
+                            }
+                        }
+                    }
+                }
+
+                if (out_solution.bBudgetExceeded)
+                {
+                    break;
+                }
+            }
+
+            if (out_solution.bBudgetExceeded)
+            {
+                break;
+            }
+        }
+
+        // Otherwise settle for the best partial match
+        if (!bSuccess &&
+            stage_score.inlier_count >= min_inlier_count &&
+            stage_score.inlier_count < good_enough_inlier_count &&
+            polishPose(image_points, image_count, rotation_prior, stage_pose, stage_score) &&
+            getIsPoseAcceptable(stage_score, min_inlier_count, stage_pose, rotation_prior))
+        {
+            best_pose = stage_pose;
+            best_score = stage_score;
+            bSuccess = true;
+        }
+
+        if (bSuccess)
+        {
+            out_solution.stage = _PointCloudPoseSolverStage_OrientationPrior;
+        }
+    }
+
+    // 3) No prior to go on: P3P over random blob/LED correspondences.
+    // Three points leave the pose ambiguous, so this needs at least four blobs.
+    const int min_ransac_inlier_count = std::max(min_inlier_count, k_ransac_sample_size);
+
+    if (!bSuccess && rotation_prior == nullptr &&
+        image_count >= min_ransac_inlier_count && model_count >= min_ransac_inlier_count)
+    {
+        const cv::Matx33d camera_matrix(
+            m_fx, 0.0, m_cx,
+            0.0, m_fy, m_cy,
+            0.0, 0.0, 1.0);
+        // Seeded from the clock so that successive frames try different correspondences
+        cv::RNG rng(static_cast<uint64>(start_time.time_since_epoch().count()));
+        std::vector<cv::Point3f> sample_model_points(k_ransac_sample_size);
+        std::vector<cv::Point2f> sample_image_points(k_ransac_sample_size);
+        cv::Mat rvec, tvec, rotation;
+
+        PointCloudPose stage_pose;
+        PoseScore stage_score;
+        stage_score.clear();
+
+        for (int iteration = 0;
+            iteration < m_settings.max_ransac_iterations && stage_score.inlier_count < image_count;
+            ++iteration)
+        {
+            if (t_solver_clock::now() > deadline)
+            {
+                out_solution.bBudgetExceeded = true;
+                break;
+            }
+
+            // Draw distinct blobs and distinct LEDs
+            int image_sample[k_ransac_sample_size];
+            int model_sample[k_ransac_sample_size];
+            for (int sample_index = 0; sample_index < k_ransac_sample_size; ++sample_index)
+            {
+                do
+                {
+                    image_sample[sample_index] = rng.uniform(0, image_count);
+                } while (std::find(image_sample, image_sample + sample_index, image_sample[sample_index]) != image_sample + sample_index);
+
+                do
+                {
+                    model_sample[sample_index] = rng.uniform(0, model_count);
+                } while (std::find(model_sample, model_sample + sample_index, model_sample[sample_index]) != model_sample + sample_index);
+
+                const cv::Point3d &model_point = m_modelPoints[model_sample[sample_index]];
+                sample_model_points[sample_index] = cv::Point3f(
+                    static_cast<float>(model_point.x), static_cast<float>(model_point.y), static_cast<float>(model_point.z));
+                sample_image_points[sample_index] = image_points[image_sample[sample_index]];
+            }
+
+            if (!cv::solvePnP(
+                    sample_model_points, sample_image_points,
+                    camera_matrix, cv::noArray(),
+                    rvec, tvec,
+                    false, cv::SOLVEPNP_P3P))
+            {
+                continue;
+            }
+
+            PointCloudPose pose;
+            PoseScore score;
+
+            cv::Rodrigues(rvec, rotation);
+            pose.rotation = cv::Matx33d(rotation.ptr<double>());
+            pose.translation = cv::Vec3d(tvec.ptr<double>());
+
+            scorePose(image_points, image_count, pose, score);
+            ++out_solution.hypothesis_count;
+
+            if (score.isBetterThan(stage_score))
+            {
+                stage_pose = pose;
+                stage_score = score;
+            }
+        }
+
+        if (stage_score.inlier_count >= min_ransac_inlier_count &&
+            polishPose(image_points, image_count, nullptr, stage_pose, stage_score) &&
+            getIsPoseAcceptable(stage_score, min_ransac_inlier_count, stage_pose, nullptr))
+        {
+            best_pose = stage_pose;
+            best_score = stage_score;
+            out_solution.stage = _PointCloudPoseSolverStage_Ransac;
+            bSuccess = true;
+        }
+    }
+
+    if (bSuccess)
+    {
+        out_solution.pose = best_pose;
+        out_solution.inlier_count = best_score.inlier_count;
+        out_solution.reprojection_error_px =
+            static_cast<float>(sqrt(best_score.squared_error_sum / static_cast<double>(best_score.inlier_count)));
+        std::copy(best_score.model_indices, best_score.model_indices + image_count, out_solution.model_indices.begin());
+    }
+
+    return bSuccess;
+}
+
+//-- private methods -----
+void OpenCVPointCloudPoseSolver::scorePose(
+    const std::vector<cv::Point2f> &image_points,
+    int image_count,
+    const PointCloudPose &pose,
+    PoseScore &out_score) const
+{
+    const int model_count = static_cast<int>(m_modelPoints.size());
+    const double max_error_sqrd = m_settings.max_correspondence_error_px*m_settings.max_correspondence_error_px;
+
+    // Project the model
+    cv::Point2d projected_points[MAX_POINT_CLOUD_SOLVER_POINT_COUNT];
+    bool model_available[MAX_POINT_CLOUD_SOLVER_POINT_COUNT];
+    for (int model_index = 0; model_index < model_count; ++model_index)
+    {
+        const cv::Vec3d camera_point = pose.rotation*cv::Vec3d(m_modelPoints[model_index]) + pose.translation;
+
+        model_available[model_index] = camera_point[2] >= k_min_point_depth;
+        if (model_available[model_index])
+        {
+            projected_points[model_index] = cv::Point2d(
+                m_fx*camera_point[0] / camera_point[2] + m_cx,
+                m_fy*camera_point[1] / camera_point[2] + m_cy);
+        }
+    }
+
+    // Greedily pair up the closest blob and LED until nothing is left within the correspondence error
+    bool image_available[MAX_POINT_CLOUD_SOLVER_POINT_COUNT];
+    std::fill(image_available, image_available + image_count, true);
+    out_score.clear();
+
+    for (;;)
+    {
+        double best_error_sqrd = max_error_sqrd;
+        int best_image_index = -1;
+        int best_model_index = -1;
+
+        for (int image_index = 0; image_index < image_count; ++image_index)
+        {
+            if (!image_available[image_index])
+            {
+                continue;
+            }
+
+            for (int model_index = 0; model_index < model_count; ++model_index)
+            {
+                if (!model_available[model_index])
+                {
+                    continue;
+                }
+
+                const double dx = projected_points[model_index].x - image_points[image_index].x;
+                const double dy = projected_points[model_index].y - image_points[image_index].y;
+                const double error_sqrd = dx*dx + dy*dy;
+
+                if (error_sqrd < best_error_sqrd)
+                {
+                    best_error_sqrd = error_sqrd;
+                    best_image_index = image_index;
+                    best_model_index = model_index;
+                }
+            }
+        }
+
+        if (best_image_index == -1)
+        {
+            break;
+        }
+
+        image_available[best_image_index] = false;
+        model_available[best_model_index] = false;
+        out_score.model_indices[best_image_index] = best_model_index;
+        out_score.squared_error_sum += best_error_sqrd;
+        ++out_score.inlier_count;
+    }
+}
+
+double OpenCVPointCloudPoseSolver::computeSquaredError(
+    const std::vector<cv::Point2f> &image_points,
+    int image_count,
+    const PoseScore &score,
+    const PointCloudPose &pose) const
+{
+    double squared_error_sum = 0.0;
+
+    for (int image_index = 0; image_index < image_count; ++image_index)
+    {
+        const int model_index = score.model_indices[image_index];
+        if (model_index == -1)
+        {
+            continue;
+        }
+
+        const cv::Vec3d camera_point = pose.rotation*cv::Vec3d(m_modelPoints[model_index]) + pose.translation;
+        if (camera_point[2] < k_min_point_depth)
+        {
+            return HUGE_VAL;
+        }
+
+        const double dx = m_fx*camera_point[0] / camera_point[2] + m_cx - image_points[image_index].x;
+        const double dy = m_fy*camera_point[1] / camera_point[2] + m_cy - image_points[image_index].y;
+        squared_error_sum += dx*dx + dy*dy;
+    }
+
+    return squared_error_sum;
+}
+
+// Levenberg-Marquardt over the inliers of the given score.
+// The rotation gets updated by a small angle-axis rotation applied in camera space.
+bool OpenCVPointCloudPoseSolver::refinePose(
+    const std::vector<cv::Point2f> &image_points,
+    int image_count,
+    const PoseScore &score,
+    bool bRefineRotation,
+    PointCloudPose &pose) const
+{
+    double squared_error_sum = computeSquaredError(image_points, image_count, score, pose);
+    double lambda = 1e-3;
+
+    if (squared_error_sum == HUGE_VAL)
+    {
+        return false;
+    }
+
+    for (int iteration = 0; iteration < k_max_refinement_iterations; ++iteration)
+    {
+        cv::Matx66d JtJ = cv::Matx66d::zeros();
+        cv::Vec6d Jtr = cv::Vec6d::all(0.0);
+
+        for (int image_index = 0; image_index < image_count; ++image_index)
+        {
+            const int model_index = score.model_indices[image_index];
+            if (model_index == -1)
+            {
+                continue;
+            }
+
+            const cv::Vec3d rotated_point = pose.rotation*cv::Vec3d(m_modelPoints[model_index]);
+            const cv::Vec3d camera_point = rotated_point + pose.translation;
+            const double inv_z = 1.0 / camera_point[2];
+            const double residual_u = m_fx*camera_point[0]*inv_z + m_cx - image_points[image_index].x;
+            const double residual_v = m_fy*camera_point[1]*inv_z + m_cy - image_points[image_index].y;
+
+            // Derivatives of the pixel coordinates w.r.t. the camera space point
+            const cv::Vec3d du_dpoint(m_fx*inv_z, 0.0, -m_fx*camera_point[0]*inv_z*inv_z);
+            const cv::Vec3d dv_dpoint(0.0, m_fy*inv_z, -m_fy*camera_point[1]*inv_z*inv_z);
+            // ... chained through the rotation update (d point / d angle = -[rotated_point]x)
+            const cv::Vec3d du_dangle = rotated_point.cross(du_dpoint);
+            const cv::Vec3d dv_dangle = rotated_point.cross(dv_dpoint);
+
+            const cv::Vec6d Ju(du_dangle[0], du_dangle[1], du_dangle[2], du_dpoint[0], du_dpoint[1], du_dpoint[2]);
+            const cv::Vec6d Jv(dv_dangle[0], dv_dangle[1], dv_dangle[2], dv_dpoint[0], dv_dpoint[1], dv_dpoint[2]);
+
+            JtJ += Ju*Ju.t() + Jv*Jv.t();
+            Jtr += Ju*residual_u + Jv*residual_v;
+        }
+
+        cv::Matx66d damped_JtJ = JtJ;
+        for (int diagonal_index = 0; diagonal_index < 6; ++diagonal_index)
+        {
+            damped_JtJ(diagonal_index, diagonal_index) *= 1.0 + lambda;
+        }
+
+        // Pin the rotation by decoupling its parameters and zeroing their gradient
+        if (!bRefineRotation)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int col = 0; col < 6; ++col)
+                {
+                    damped_JtJ(row, col) = (row == col) ? 1.0 : 0.0;
+                    damped_JtJ(col, row) = (row == col) ? 1.0 : 0.0;
+                }
+                Jtr[row] = 0.0;
+            }
+        }
+
+        const cv::Vec6d step = damped_JtJ.solve(-Jtr, cv::DECOMP_CHOLESKY);
+
+        PointCloudPose candidate_pose;
+        candidate_pose.rotation = angleAxisVectorToRotationMatrix(cv::Vec3d(step[0], step[1], step[2]))*pose.rotation;
+        candidate_pose.translation = pose.translation + cv::Vec3d(step[3], step[4], step[5]);
+
+        const double candidate_error_sum = computeSquaredError(image_points, image_count, score, candidate_pose);
+        if (candidate_error_sum < squared_error_sum)
+        {
+            pose = candidate_pose;
+            squared_error_sum = candidate_error_sum;
+            lambda *= 0.1;
+
+            if (step.dot(step) < k_refinement_convergence_sqrd)
+            {
+                break;
+            }
+        }
+        else
+        {
+            lambda *= 10.0;
+        }
+    }
+
+    return true;
+}
+
+// Refine against the current inliers, then re-match with the refined pose
+// (which can pick up blobs the rough pose was too far off for) and refine once more if that changed anything.
+// Without a rotation prior, a minimal set of three inliers can't be refined.
+bool OpenCVPointCloudPoseSolver::polishPose(
+    const std::vector<cv::Point2f> &image_points,
+    int image_count,
+    const cv::Matx33d *rotation_prior,
+    PointCloudPose &pose,
+    PoseScore &score) const
+{
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        PoseScore refined_score;
+        const bool bRefineRotation = score.inlier_count >= k_min_rotation_refinement_inliers;
+
+        if (score.inlier_count < 3 ||
+            (!bRefineRotation && rotation_prior == nullptr) ||
+            !refinePose(image_points, image_count, score, bRefineRotation, pose))
+        {
+            return false;
+        }
+
+        scorePose(image_points, image_count, pose, refined_score);
+
+        const bool bSameInliers = refined_score.hasSameInliers(score, image_count);
+        score = refined_score;
+
+        if (bSameInliers)
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+// Few LEDs can line up with the wrong ones under a wrong pose,
+// so a pose that wandered far from the prior orientation doesn't count either
+bool OpenCVPointCloudPoseSolver::getIsPoseAcceptable(
+    const PoseScore &score,
+    int min_inlier_count,
+    const PointCloudPose &pose,
+    const cv::Matx33d *rotation_prior) const
+{
+    const double max_error_sqrd = m_settings.max_reprojection_error_px*m_settings.max_reprojection_error_px;
+
+    return
+        score.inlier_count >= min_inlier_count &&
+        score.squared_error_sum <= max_error_sqrd*static_cast<double>(score.inlier_count) &&
+        (rotation_prior == nullptr ||
+         computeAngleBetweenRotations(pose.rotation, *rotation_prior) <= m_settings.max_prior_angle_error_degrees*k_degrees_to_radians);
+}
+
+bool OpenCVPointCloudPoseSolver::getIsPointWithinCorrespondenceError(
+    const cv::Point2f &image_point,
+    const cv::Vec3d &camera_point) const
+{
+    const double dx = m_fx*camera_point[0] / camera_point[2] + m_cx - image_point.x;
+    const double dy = m_fy*camera_point[1] / camera_point[2] + m_cy - image_point.y;
+
+    return dx*dx + dy*dy < m_settings.max_correspondence_error_px*m_settings.max_correspondence_error_px;
+}
+
+//-- private functions -----
+static cv::Matx33d skewSymmetricMatrix(const cv::Vec3d &v)
+{
+    return cv::Matx33d(
+        0.0, -v[2], v[1],
+        v[2], 0.0, -v[0],
+        -v[1], v[0], 0.0);
+}
+
+// Rodrigues' rotation formula
+static cv::Matx33d angleAxisVectorToRotationMatrix(const cv::Vec3d &angle_axis)
+{
+    const double radians = sqrt(angle_axis.dot(angle_axis));
+
+    if (radians < 1e-12)
+    {
+        return cv::Matx33d::eye() + skewSymmetricMatrix(angle_axis);
+    }
+
+    const cv::Matx33d K = skewSymmetricMatrix(angle_axis*(1.0 / radians));
+
+    return cv::Matx33d::eye() + K*sin(radians) + (K*K)*(1.0 - cos(radians));
+}
+
+static double computeAngleBetweenRotations(const cv::Matx33d &a, const cv::Matx33d &b)
+{
+    const cv::Matx33d delta = a.t()*b;
+    const double cos_angle = 0.5*(delta(0, 0) + delta(1, 1) + delta(2, 2) - 1.0);
+
+    return acos(std::min(std::max(cos_angle, -1.0), 1.0));
+}
+
+// With the rotation known, each blob/LED correspondence gives two equations linear in the translation:
+//   t.x - n.x*t.z = n.x*q.z - q.x
+//   t.y - n.y*t.z = n.y*q.z - q.y
+// where n is the normalized blob position and q the rotated LED position.
+// Two correspondences over-determine the translation, so solve the normal equations,
+// which are simple enough to eliminate t.x and t.y by hand.
+static bool solveTranslationFromPointPair(
+    const cv::Point2d &normalized_a, const cv::Vec3d &rotated_a,
+    const cv::Point2d &normalized_b, const cv::Vec3d &rotated_b,
+    cv::Vec3d &out_translation)
+{
+    const double b0 = normalized_a.x*rotated_a[2] - rotated_a[0];
+    const double b1 = normalized_a.y*rotated_a[2] - rotated_a[1];
+    const double b2 = normalized_b.x*rotated_b[2] - rotated_b[0];
+    const double b3 = normalized_b.y*rotated_b[2] - rotated_b[1];
+
+    const double sum_x = normalized_a.x + normalized_b.x;
+    const double sum_y = normalized_a.y + normalized_b.y;
+    const double Atb_x = b0 + b2;
+    const double Atb_y = b1 + b3;
+    const double Atb_z = -(normalized_a.x*b0 + normalized_a.y*b1 + normalized_b.x*b2 + normalized_b.y*b3);
+
+    // Half the squared distance between the normalized blob positions
+    const double dx = normalized_a.x - normalized_b.x;
+    const double dy = normalized_a.y - normalized_b.y;
+    const double denominator = 0.5*(dx*dx + dy*dy);
+
+    if (denominator < 1e-12)
+    {
+        return false;
+    }
+
+    const double t_z = (Atb_z + 0.5*(sum_x*Atb_x + sum_y*Atb_y)) / denominator;
+    out_translation = cv::Vec3d(0.5*(Atb_x + sum_x*t_z), 0.5*(Atb_y + sum_y*t_z), t_z);
+
+    // Both LEDs have to end up in front of the camera
+    return
+        rotated_a[2] + out_translation[2] >= k_min_point_depth &&
+        rotated_b[2] + out_translation[2] >= k_min_point_depth;
+}
@@ -0,0 +1,109 @@
+#ifndef OPENCV_POINT_CLOUD_POSE_SOLVER_H
+#define OPENCV_POINT_CLOUD_POSE_SOLVER_H
+
+//-- includes -----
+#include "opencv2/core/core.hpp"
+
+#include <chrono>
+#include <vector>
+
+// -- constants -----
+// Hard limit on the time spent solving one point cloud pose, in microseconds.
+// Leaves most of a 60Hz frame for the other trackers and devices.
+#define DEFAULT_POINT_CLOUD_POSE_BUDGET_US 800
+
+// Image and model points past this many are ignored
+#define MAX_POINT_CLOUD_SOLVER_POINT_COUNT 16
+
+// -- declarations -----
+struct PointCloudPoseSolverSettings
+{
+    // Every stage checks this between hypotheses and gives up with the best pose found so far
+    std::chrono::microseconds time_budget;
+    // An image point further than this from every projected model point is an outlier
+    float max_correspondence_error_px;
+    // Highest RMS reprojection error of an accepted pose
+    float max_reprojection_error_px;
+    // Fewest image points that have to agree with an accepted pose (at least 3)
+    int min_inlier_count;
+    // Furthest an accepted pose may turn away from the prior orientation
+    float max_prior_angle_error_degrees;
+    // Cap on the hypotheses tried when there is no prior orientation at all
+    int max_ransac_iterations;
+
+    PointCloudPoseSolverSettings();
+};
+
+// Transforms model points into camera space: camera_point = rotation*model_point + translation
+struct PointCloudPose
+{
+    cv::Matx33d rotation;
+    cv::Vec3d translation;
+};
+
+enum ePointCloudPoseSolverStage
+{
+    _PointCloudPoseSolverStage_None,
+    _PointCloudPoseSolverStage_PoseGuess,         // correspondence from the projected prior pose
+    _PointCloudPoseSolverStage_OrientationPrior,  // translation searched from point pairs, prior rotation
+    _PointCloudPoseSolverStage_Ransac             // P3P over random correspondences
+};
+
+struct PointCloudPoseSolution
+{
+    PointCloudPose pose;
+    // Model point matched to each image point, -1 for outliers
+    std::vector<int> model_indices;
+    int inlier_count;
+    // RMS over the inliers
+    float reprojection_error_px;
+    ePointCloudPoseSolverStage stage;
+    int hypothesis_count;
+    // The search ran out of time before trying every hypothesis
+    bool bBudgetExceeded;
+};
+
+// Solves the pose of a rigid constellation of LEDs (e.g. the Morpheus point cloud)
+// from an unlabeled set of blob centers seen by one camera.
+// The LEDs all look alike, so the hard part is the correspondence, not the pose:
+//  1) The prior pose gets projected and each blob is matched to the nearest LED.
+//     This is the every-frame path and costs a few microseconds.
+//  2) If that fails, the prior orientation (which the IMU keeps good even while
+//     the device is optically lost) is held fixed and every pair of blobs against
+//     every pair of LEDs gives a translation in closed form.
+//  3) With no prior at all, random 4-point correspondences get solved with P3P.
+// The winner is polished with a few Levenberg-Marquardt steps over all of its inliers.
+// Every stage is bounded by the time budget, so losing LEDs to occlusion costs
+// tracking quality rather than frame rate.
+class OpenCVPointCloudPoseSolver
+{
+public:
+    OpenCVPointCloudPoseSolver(
+        const std::vector<cv::Point3f> &model_points,
+        const cv::Matx33f &camera_matrix,
+        const PointCloudPoseSolverSettings &settings);
+
+    // image_points have to be undistorted pixels (see OpenCVUndistortionCache::undistortPointsPixels).
+    // pose_guess and orientation_guess are optional (nullptr).
+    bool solve(
+        const std::vector<cv::Point2f> &image_points,
+        const PointCloudPose *pose_guess,
+        const cv::Matx33d *orientation_guess,
+        PointCloudPoseSolution &out_solution) const;
+
+private:
+    struct PoseScore;
+
+    void scorePose(const std::vector<cv::Point2f> &image_points, int image_count, const PointCloudPose &pose, PoseScore &out_score) const;
+    double computeSquaredError(const std::vector<cv::Point2f> &image_points, int image_count, const PoseScore &score, const PointCloudPose &pose) const;
+    bool refinePose(const std::vector<cv::Point2f> &image_points, int image_count, const PoseScore &score, bool bRefineRotation, PointCloudPose &pose) const;
+    bool polishPose(const std::vector<cv::Point2f> &image_points, int image_count, const cv::Matx33d *rotation_prior, PointCloudPose &pose, PoseScore &score) const;
+    bool getIsPoseAcceptable(const PoseScore &score, int min_inlier_count, const PointCloudPose &pose, const cv::Matx33d *rotation_prior) const;
+    bool getIsPointWithinCorrespondenceError(const cv::Point2f &image_point, const cv::Vec3d &camera_point) const;
+
+    std::vector<cv::Point3d> m_modelPoints;
+    double m_fx, m_fy, m_cx, m_cy;
+    PointCloudPoseSolverSettings m_settings;
+};
+
+#endif // OPENCV_POINT_CLOUD_POSE_SOLVER_H
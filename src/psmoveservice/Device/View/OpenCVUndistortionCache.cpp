@@ -0,0 +1,171 @@
+//-- includes -----
+#include "OpenCVUndistortionCache.h"
+
+#include "opencv2/calib3d/calib3d.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+//-- public methods -----
+OpenCVUndistortionCache::OpenCVUndistortionCache()
+    : m_cameraMatrix()
+    , m_distortions()
+    , m_frameWidth(0)
+    , m_frameHeight(0)
+    , m_gridStep(0)
+    , m_inverseGridStep(0.f)
+    , m_gridColumns(0)
+    , m_gridRows(0)
+    , m_gridMaxX(0.f)
+    , m_gridMaxY(0.f)
+    , m_gridNodes()
+{
+}
+
+void OpenCVUndistortionCache::build(
+    const cv::Matx33f &camera_matrix,
+    const cv::Matx<float, 5, 1> &distortions,
+    int frame_width,
+    int frame_height,
+    int grid_step)
+{
+    assert(frame_width > 0 && frame_height > 0);
+
+    m_cameraMatrix = camera_matrix;
+    m_distortions = distortions;
+    m_frameWidth = frame_width;
+    m_frameHeight = frame_height;
+    m_gridStep = std::max(grid_step, 1);
+    m_inverseGridStep = 1.f / static_cast<float>(m_gridStep);
+
+    // Enough nodes that the last row and column lie on or past the far edge of the frame
+    m_gridColumns = (frame_width - 1 + m_gridStep - 1) / m_gridStep + 1;
+    m_gridRows = (frame_height - 1 + m_gridStep - 1) / m_gridStep + 1;
+    m_gridColumns = std::max(m_gridColumns, 2);
+    m_gridRows = std::max(m_gridRows, 2);
+    m_gridMaxX = static_cast<float>((m_gridColumns - 1)*m_gridStep);
+    m_gridMaxY = static_cast<float>((m_gridRows - 1)*m_gridStep);
+
+    std::vector<cv::Point2f> distorted_nodes;
+    distorted_nodes.reserve(m_gridColumns*m_gridRows);
+    for (int row = 0; row < m_gridRows; ++row)
+    {
+        for (int column = 0; column < m_gridColumns; ++column)
+        {
+            distorted_nodes.push_back(
+                cv::Point2f(static_cast<float>(column*m_gridStep), static_cast<float>(row*m_gridStep)));
+        }
+    }
+
+    cv::undistortPoints(distorted_nodes, m_gridNodes, m_cameraMatrix, m_distortions);
+}
+
+bool OpenCVUndistortionCache::getIsBuiltFor(
+    const cv::Matx33f &camera_matrix,
+    const cv::Matx<float, 5, 1> &distortions,
+    int frame_width,
+    int frame_height) const
+{
+    return
+        m_gridNodes.size() > 0 &&
+        m_frameWidth == frame_width &&
+        m_frameHeight == frame_height &&
+        m_cameraMatrix == camera_matrix &&
+        m_distortions == distortions;
+}
+
+void OpenCVUndistortionCache::undistortPointsNormalized(
+    const std::vector<cv::Point2f> &points,
+    std::vector<cv::Point2f> &out_points) const
+{
+    undistortPoints(points, false, out_points);
+}
+
+void OpenCVUndistortionCache::undistortPointsPixels(
+    const std::vector<cv::Point2f> &points,
+    std::vector<cv::Point2f> &out_points) const
+{
+    undistortPoints(points, true, out_points);
+}
+
+//-- private methods -----
+bool OpenCVUndistortionCache::lookupNormalizedPoint(const cv::Point2f &point, cv::Point2f &out_point) const
+{
+    if (!(point.x >= 0.f && point.x <= m_gridMaxX && point.y >= 0.f && point.y <= m_gridMaxY))
+    {
+        return false;
+    }
+
+    const float grid_x = point.x*m_inverseGridStep;
+    const float grid_y = point.y*m_inverseGridStep;
+    // Points on the far edge use the last cell
+    const int cell_x = std::min(static_cast<int>(grid_x), m_gridColumns - 2);
+    const int cell_y = std::min(static_cast<int>(grid_y), m_gridRows - 2);
+    const float u = grid_x - static_cast<float>(cell_x);
+    const float v = grid_y - static_cast<float>(cell_y);
+
+    const cv::Point2f *top = &m_gridNodes[cell_y*m_gridColumns + cell_x];
+    const cv::Point2f *bottom = top + m_gridColumns;
+
+    out_point =
+        (top[0]*(1.f - u) + top[1]*u)*(1.f - v) +
+        (bottom[0]*(1.f - u) + bottom[1]*u)*v;
+
+    return true;
+}
+
+void OpenCVUndistortionCache::undistortPoints(
+    const std::vector<cv::Point2f> &points,
+    bool bPixelOutput,
+    std::vector<cv::Point2f> &out_points) const
+{
+    assert(m_gridNodes.size() > 0);
+    assert(&points != &out_points);
+
+    out_points.resize(points.size());
+
+    std::vector<int> fallback_indices;
+    for (size_t point_index = 0; point_index < points.size(); ++point_index)
+    {
+        if (!lookupNormalizedPoint(points[point_index], out_points[point_index]))
+        {
+            fallback_indices.push_back(static_cast<int>(point_index));
+        }
+    }
+
+    // Solve whatever landed outside of the grid the slow way, in one batch
+    if (fallback_indices.size() > 0)
+    {
+        std::vector<cv::Point2f> fallback_points;
+        std::vector<cv::Point2f> undistorted_fallback_points;
+
+        fallback_points.reserve(fallback_indices.size());
+        for (auto it = fallback_indices.begin(); it != fallback_indices.end(); ++it)
+        {
+            fallback_points.push_back(points[*it]);
+        }
+
+        cv::undistortPoints(fallback_points, undistorted_fallback_points, m_cameraMatrix, m_distortions);
+
+        for (size_t fallback_index = 0; fallback_index < fallback_indices.size(); ++fallback_index)
+        {
+            out_points[fallback_indices[fallback_index]] = undistorted_fallback_points[fallback_index];
+        }
+    }
+
+    if (bPixelOutput)
+    {
+        // Reproject through the camera matrix (no skew)
+        const float fx = m_cameraMatrix(0, 0);
+        const float fy = m_cameraMatrix(1, 1);
+        const float cx = m_cameraMatrix(0, 2);
+        const float cy = m_cameraMatrix(1, 2);
+
+        for (auto it = out_points.begin(); it != out_points.end(); ++it)
+        {
+            it->x = it->x*fx + cx;
+            it->y = it->y*fy + cy;
+        }
+    }
+}
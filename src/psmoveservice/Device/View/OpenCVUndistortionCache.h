@@ -0,0 +1,74 @@
+#ifndef OPENCV_UNDISTORTION_CACHE_H
+#define OPENCV_UNDISTORTION_CACHE_H
+
+//-- includes -----
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+
+// -- constants -----
+// Spacing of the lookup grid in pixels.
+// The lens distortion of the supported cameras is smooth enough that bilinear
+// interpolation between nodes this far apart stays within about a hundredth of a pixel
+// of cv::undistortPoints at 640x480.
+#define DEFAULT_UNDISTORTION_GRID_STEP 8
+
+// -- declarations -----
+// Replaces per-point cv::undistortPoints calls with a lookup into a grid of undistorted points
+// computed once from the camera intrinsics. cv::undistortPoints solves for every point iteratively,
+// which adds up when every contour point of every tracked device gets undistorted every frame.
+// Points outside of the grid (i.e. outside of the frame) fall back to cv::undistortPoints.
+// Immutable once built, so it can be shared with the vision worker thread.
+class OpenCVUndistortionCache
+{
+public:
+    OpenCVUndistortionCache();
+
+    // Undistorts every grid node in one batch
+    void build(
+        const cv::Matx33f &camera_matrix,
+        const cv::Matx<float, 5, 1> &distortions,
+        int frame_width,
+        int frame_height,
+        int grid_step = DEFAULT_UNDISTORTION_GRID_STEP);
+
+    // True if the cache was built from exactly these intrinsics and frame size
+    bool getIsBuiltFor(
+        const cv::Matx33f &camera_matrix,
+        const cv::Matx<float, 5, 1> &distortions,
+        int frame_width,
+        int frame_height) const;
+
+    // Same as cv::undistortPoints(points, out_points, camera_matrix, distortions),
+    // i.e. the results are in normalized camera space
+    void undistortPointsNormalized(
+        const std::vector<cv::Point2f> &points,
+        std::vector<cv::Point2f> &out_points) const;
+
+    // Same as cv::undistortPoints(points, out_points, camera_matrix, distortions, cv::noArray(), camera_matrix),
+    // i.e. the results are pixels of an ideal pinhole camera
+    void undistortPointsPixels(
+        const std::vector<cv::Point2f> &points,
+        std::vector<cv::Point2f> &out_points) const;
+
+private:
+    bool lookupNormalizedPoint(const cv::Point2f &point, cv::Point2f &out_point) const;
+    void undistortPoints(
+        const std::vector<cv::Point2f> &points,
+        bool bPixelOutput,
+        std::vector<cv::Point2f> &out_points) const;
+
+    cv::Matx33f m_cameraMatrix;
+    cv::Matx<float, 5, 1> m_distortions;
+    int m_frameWidth;
+    int m_frameHeight;
+    int m_gridStep;
+    float m_inverseGridStep;
+    int m_gridColumns;
+    int m_gridRows;
+    float m_gridMaxX;
+    float m_gridMaxY;
+    std::vector<cv::Point2f> m_gridNodes; // normalized undistorted position of each node, row major
+};
+
+#endif // OPENCV_UNDISTORTION_CACHE_H
@@ -0,0 +1,99 @@
+#ifndef OPTICAL_POSE_ESTIMATION_H
+#define OPTICAL_POSE_ESTIMATION_H
+
+//-- includes -----
+#include "DeviceInterface.h"
+#include <chrono>
+
+// -- constants -----
+// Consecutive frames further apart than this are too far apart to estimate a velocity from
+#define k_optical_max_velocity_frame_gap_seconds 0.1f
+// Weight of the previous velocity when smoothing in the newest one
+#define k_optical_velocity_smoothing 0.5f
+// Estimates are never extrapolated further than this to align them with another capture time
+#define k_optical_max_alignment_seconds 0.05f
+
+// -- interface -----
+// Shared by ControllerOpticalPoseEstimation and HMDOpticalPoseEstimation, which both have
+// position_cm, velocity_cm_per_sec, bVelocityValid, capture_timestamp and bValidCaptureTimestamp.
+
+// Estimates the velocity from the frame the previous estimate came from to this one.
+// Called on a new estimate before it replaces the previous one.
+template <typename t_optical_pose_estimation>
+void updateOpticalPoseEstimationVelocity(
+    t_optical_pose_estimation &estimate,
+    const t_optical_pose_estimation &previous,
+    bool bPreviousValid)
+{
+    const float dt = std::chrono::duration<float>(estimate.capture_timestamp - previous.capture_timestamp).count();
+
+    if (bPreviousValid && previous.bValidCaptureTimestamp && estimate.bValidCaptureTimestamp &&
+        dt > 0.f && dt <= k_optical_max_velocity_frame_gap_seconds)
+    {
+        const float vx = (estimate.position_cm.x - previous.position_cm.x) / dt;
+        const float vy = (estimate.position_cm.y - previous.position_cm.y) / dt;
+        const float vz = (estimate.position_cm.z - previous.position_cm.z) / dt;
+
+        if (previous.bVelocityValid)
+        {
+            estimate.velocity_cm_per_sec.set(
+                k_optical_velocity_smoothing*previous.velocity_cm_per_sec.i + (1.f - k_optical_velocity_smoothing)*vx,
+                k_optical_velocity_smoothing*previous.velocity_cm_per_sec.j + (1.f - k_optical_velocity_smoothing)*vy,
+                k_optical_velocity_smoothing*previous.velocity_cm_per_sec.k + (1.f - k_optical_velocity_smoothing)*vz);
+        }
+        else
+        {
+            estimate.velocity_cm_per_sec.set(vx, vy, vz);
+        }
+        estimate.bVelocityValid = true;
+    }
+    else if (dt != 0.f)
+    {
+        // Not enough history to tell how fast the device is moving
+        estimate.velocity_cm_per_sec.clear();
+        estimate.bVelocityValid = false;
+    }
+}
+
+// The position extrapolated from the capture time of its frame to reference_time,
+// so that estimates from unsynchronized trackers describe the same instant
+template <typename t_optical_pose_estimation>
+CommonDevicePosition getTimeAlignedOpticalPosition(
+    const t_optical_pose_estimation &estimate,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time)
+{
+    CommonDevicePosition result = estimate.position_cm;
+
+    if (estimate.bVelocityValid && estimate.bValidCaptureTimestamp)
+    {
+        float dt = std::chrono::duration<float>(reference_time - estimate.capture_timestamp).count();
+        dt = (dt < -k_optical_max_alignment_seconds) ? -k_optical_max_alignment_seconds : dt;
+        dt = (dt > k_optical_max_alignment_seconds) ? k_optical_max_alignment_seconds : dt;
+
+        result.x += estimate.velocity_cm_per_sec.i * dt;
+        result.y += estimate.velocity_cm_per_sec.j * dt;
+        result.z += estimate.velocity_cm_per_sec.k * dt;
+    }
+
+    return result;
+}
+
+// When the estimate's video frame was captured, on the high resolution clock the visibility timestamps use.
+// Falls back to now if the capture time is unknown.
+template <typename t_optical_pose_estimation>
+std::chrono::time_point<std::chrono::high_resolution_clock> getOpticalCaptureTime(
+    const t_optical_pose_estimation &estimate,
+    const std::chrono::time_point<std::chrono::high_resolution_clock> &now)
+{
+    if (!estimate.bValidCaptureTimestamp)
+    {
+        return now;
+    }
+
+    const std::chrono::steady_clock::duration capture_age =
+        std::chrono::steady_clock::now() - estimate.capture_timestamp;
+
+    return now - std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(capture_age);
+}
+
+#endif // OPTICAL_POSE_ESTIMATION_H
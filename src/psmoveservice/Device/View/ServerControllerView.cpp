@@ -24,6 +24,8 @@
 //-- constants -----
 static const float k_min_time_delta_seconds = 1 / 120.f;
 static const float k_max_time_delta_seconds = 1 / 30.f;
+// Longest gap between two IMU samples that still gets integrated in one step
+static const float k_max_sample_time_delta_seconds = 1 / 10.f;
 
 //-- macros -----
 #define SET_BUTTON_BIT(bitmask, bit_index, button_state) \
@@ -90,6 +92,7 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
     const TrackerManager* tracker_manager,
     const int *valid_projection_tracker_ids,
     const int projections_found,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time,
     ControllerOpticalPoseEstimation *tracker_pose_estimations,
     ControllerOpticalPoseEstimation *multicam_pose_estimation);
 static void computeLightBarPoseForControllerFromMultipleTrackers(
@@ -115,6 +118,8 @@ ServerControllerView::ServerControllerView(const int device_id)
     , m_lastPollSeqNumProcessed(-1)
     , m_last_filter_update_timestamp()
     , m_last_filter_update_timestamp_valid(false)
+    , m_imu_sample_clock()
+    , m_bUseImuSampleClock(false)
 {
     m_tracking_color = std::make_tuple(0x00, 0x00, 0x00);
     m_LED_override_color = std::make_tuple(0x00, 0x00, 0x00);
@@ -220,6 +225,8 @@ bool ServerControllerView::open(const class DeviceEnumerator *enumerator)
     bool bSuccess= ServerDeviceView::open(enumerator);
     bool bAllocateTrackingColor = false;
 
+    m_bUseImuSampleClock = false;
+
     // Setup the orientation filter based on the controller configuration
     if (bSuccess)
     {
@@ -239,6 +246,17 @@ bool ServerControllerView::open(const class DeviceEnumerator *enumerator)
                     resetPoseFilter();
                     m_multicam_pose_estimation->clear();
 
+                    // The units of the 16-bit report timestamp aren't documented,
+                    // so the tick period gets calibrated against host time
+                    DeviceSampleClock::Settings clock_settings;
+                    clock_settings.timestamp_bits = 16;
+                    clock_settings.sequence_bits = 4;
+                    clock_settings.seconds_per_tick = 0.f;
+                    clock_settings.nominal_sample_seconds = psmoveController->getConfig()->mean_update_time_delta;
+                    clock_settings.max_sample_seconds = k_max_sample_time_delta_seconds;
+                    m_imu_sample_clock.reset(clock_settings);
+                    m_bUseImuSampleClock = true;
+
                     bAllocateTrackingColor = true;
                 }
             } break;
@@ -258,6 +276,16 @@ bool ServerControllerView::open(const class DeviceEnumerator *enumerator)
                     resetPoseFilter();
                     m_multicam_pose_estimation->clear();
 
+                    // The 16-bit report timestamp advances ~188 ticks per 1.25ms report at full rate
+                    DeviceSampleClock::Settings clock_settings;
+                    clock_settings.timestamp_bits = 16;
+                    clock_settings.sequence_bits = 6;
+                    clock_settings.seconds_per_tick = 0.00125f / 188.f;
+                    clock_settings.nominal_sample_seconds = psdualshock4Controller->getConfig()->mean_update_time_delta;
+                    clock_settings.max_sample_seconds = k_max_sample_time_delta_seconds;
+                    m_imu_sample_clock.reset(clock_settings);
+                    m_bUseImuSampleClock = true;
+
                     bAllocateTrackingColor = true;
                 }
             } break;
@@ -459,9 +487,29 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
                     // Initially the newTrackerPoseEstimate is a copy of the existing pose
                     bool bIsVisibleThisUpdate= false;
 
+                    if (tracker->getIsVisionWorkerEnabled())
+                    {
+                        // Pick up the projection the tracker's vision thread computed since
+                        // the last update (if any), then queue up a request against the newest frame
+                        ControllerOpticalPoseEstimation newTrackerPoseEstimate= trackerPoseEstimateRef;
+
+                        if (tracker->fetchProjectionForController(this, &newTrackerPoseEstimate))
+                        {
+                            bIsVisibleThisUpdate= true;
+
+                            // Actually apply the pose estimate state
+                            newTrackerPoseEstimate.updateVelocity(trackerPoseEstimateRef, bWasTracking);
+                            trackerPoseEstimateRef= newTrackerPoseEstimate;
+                            // The projection came from the frame the previous update handed to the vision thread,
+                            // so it was last seen when that frame was captured
+                            trackerPoseEstimateRef.last_visible_timestamp = getOpticalCaptureTime(trackerPoseEstimateRef, now);
+                        }
+
+                        tracker->requestProjectionForController(this, &trackingShape);
+                    }
                     // If a new video frame is available this tick, 
                     // attempt to update the tracking location
-                    if (tracker->getHasUnpublishedState())
+                    else if (tracker->getHasUnpublishedState())
                     {
                         // Create a copy of the pose estimate state so that in event of a 
                         // failure part way through computing the projection we don't
@@ -476,6 +524,7 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
                             bIsVisibleThisUpdate= true;
 
                             // Actually apply the pose estimate state
+                            newTrackerPoseEstimate.updateVelocity(trackerPoseEstimateRef, bWasTracking);
                             trackerPoseEstimateRef= newTrackerPoseEstimate;
                             trackerPoseEstimateRef.last_visible_timestamp = now;
                         }
@@ -508,6 +557,32 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
             trackerPoseEstimateRef.bCurrentlyTracking = bCurrentlyTracking;
         }
 
+        // The trackers aren't synchronized, so each projection comes from a slightly different moment.
+        // Triangulation brings every tracker's estimate forward to the newest video frame among them.
+        std::chrono::time_point<std::chrono::steady_clock> optical_reference_time;
+        bool bValidOpticalReferenceTime= false;
+        // Lightbar triangulation works on the raw screen projections, which can't be brought forward,
+        // so its average describes the controller at the mean capture time of the trackers instead
+        std::chrono::steady_clock::duration capture_time_offset_sum = std::chrono::steady_clock::duration::zero();
+        int capture_time_count = 0;
+        for (int list_index = 0; list_index < projections_found; ++list_index)
+        {
+            const ControllerOpticalPoseEstimation &trackerPoseEstimate =
+                m_tracker_pose_estimations[valid_projection_tracker_ids[list_index]];
+
+            if (trackerPoseEstimate.bValidCaptureTimestamp)
+            {
+                capture_time_offset_sum += trackerPoseEstimate.capture_timestamp.time_since_epoch();
+                ++capture_time_count;
+
+                if (!bValidOpticalReferenceTime || trackerPoseEstimate.capture_timestamp > optical_reference_time)
+                {
+                    optical_reference_time= trackerPoseEstimate.capture_timestamp;
+                    bValidOpticalReferenceTime= true;
+                }
+            }
+        }
+
         // How we compute the final world pose estimate varies based on
         // * Number of trackers that currently have a valid projections of the controller
         // * The kind of projection shape (psmove sphere or ds4 lightbar)
@@ -523,6 +598,7 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
                     tracker_manager,
                     valid_projection_tracker_ids,
                     projections_found,
+                    optical_reference_time,
                     m_tracker_pose_estimations,
                     m_multicam_pose_estimation);
                 break;
@@ -534,6 +610,12 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
                     projections_found,
                     m_tracker_pose_estimations,
                     m_multicam_pose_estimation);
+
+                if (capture_time_count > 0)
+                {
+                    optical_reference_time=
+                        std::chrono::time_point<std::chrono::steady_clock>(capture_time_offset_sum / capture_time_count);
+                }
                 break;
             default:
                 assert(false && "unreachable");
@@ -576,6 +658,13 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
         if (m_multicam_pose_estimation->bCurrentlyTracking)
         {
             m_multicam_pose_estimation->last_visible_timestamp = now;
+
+            // The combined estimate describes the device at the reference time
+            if (bValidOpticalReferenceTime)
+            {
+                m_multicam_pose_estimation->capture_timestamp = optical_reference_time;
+                m_multicam_pose_estimation->bValidCaptureTimestamp = true;
+            }
         }
         m_multicam_pose_estimation->last_update_timestamp = now;
         m_multicam_pose_estimation->bValidTimestamps = true;
@@ -602,7 +691,8 @@ void ServerControllerView::updateStateAndPredict()
     }
     assert(firstLookBackIndex >= 0);
 
-    // Compute the time in seconds since the last update
+    // Compute the time in seconds since the last update.
+    // Only controllers without a sample clock of their own integrate over host time.
     const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
     float time_delta_seconds;
     if (m_last_filter_update_timestamp_valid)
@@ -635,11 +725,14 @@ void ServerControllerView::updateStateAndPredict()
             {
                 const PSMoveController *psmoveController= this->castCheckedConst<PSMoveController>();
                 const PSMoveControllerState *psmoveState= static_cast<const PSMoveControllerState *>(controllerState);
+                const float sample_time_delta_seconds = m_bUseImuSampleClock
+                    ? m_imu_sample_clock.update(psmoveState->RawTimeStamp, psmoveState->RawSequence, psmoveState->ArrivalTime)
+                    : per_state_time_delta_seconds;
 
                 // Only update the position filter when tracking is enabled
                 update_filters_for_psmove(
                     psmoveController, psmoveState, 
-                    per_state_time_delta_seconds,
+                    sample_time_delta_seconds,
                     m_multicam_pose_estimation, 
                     m_pose_filter_space,
                     m_pose_filter);
@@ -654,11 +747,14 @@ void ServerControllerView::updateStateAndPredict()
                 const PSDualShock4Controller *psdualshock4Controller = this->castCheckedConst<PSDualShock4Controller>();
                 const PSDualShock4ControllerState *psdualshock4State = 
                     static_cast<const PSDualShock4ControllerState *>(controllerState);
+                const float sample_time_delta_seconds = m_bUseImuSampleClock
+                    ? m_imu_sample_clock.update(psdualshock4State->RawTimeStamp, psdualshock4State->RawSequence, psdualshock4State->ArrivalTime)
+                    : per_state_time_delta_seconds;
 
                 // Only update the position filter when tracking is enabled
                 update_filters_for_psdualshock4(
                     psdualshock4Controller, psdualshock4State,
-                    per_state_time_delta_seconds,
+                    sample_time_delta_seconds,
                     m_multicam_pose_estimation,
                     m_pose_filter_space,
                     m_pose_filter);
@@ -1125,6 +1221,15 @@ void ServerControllerView::generate_controller_data_frame_for_stream(
     controller_data_frame->set_sequence_num(controller_view->m_sequence_number);
     controller_data_frame->set_isconnected(controller_view->getDevice()->getIsOpen());
 
+    if (controller_view->getIsCurrentlyTracking() && controller_view->getMulticamPoseEstimate()->bValidCaptureTimestamp)
+    {
+        const auto *pose_estimate= controller_view->getMulticamPoseEstimate();
+
+        controller_data_frame->set_optical_capture_timestamp_us(
+            std::chrono::duration_cast<std::chrono::microseconds>(pose_estimate->capture_timestamp.time_since_epoch()).count());
+        controller_data_frame->set_optical_sample_age_ms(pose_estimate->getCaptureAgeSeconds() * 1000.f);
+    }
+
     switch (controller_view->getControllerDeviceType())
     {
     case CommonControllerState::PSMove:
@@ -1999,6 +2104,10 @@ update_filters_for_psmove(
     {
         PoseSensorPacket sensorPacket;
 
+        // How old the optical readings are by the time the filter sees them
+        sensorPacket.optical_sample_age_seconds =
+            poseEstimation->bCurrentlyTracking ? poseEstimation->getCaptureAgeSeconds() : 0.f;
+
         // PSMove cant do optical orientation
         sensorPacket.optical_orientation = Eigen::Quaternionf::Identity();
 
@@ -2026,30 +2135,28 @@ update_filters_for_psmove(
                 psmoveState->CalibratedMag[2]);
 
         // Each state update contains two readings (one earlier and one later) of accelerometer and gyro data
+        PoseSensorIMUSubSample subSamples[2];
         for (int frame = 0; frame < 2; ++frame)
         {
-            PoseFilterPacket filterPacket;
-
-            sensorPacket.imu_accelerometer_g_units =
+            subSamples[frame].imu_accelerometer_g_units =
                 Eigen::Vector3f(
                     psmoveState->CalibratedAccel[frame][0], 
                     psmoveState->CalibratedAccel[frame][1], 
                     psmoveState->CalibratedAccel[frame][2]);
-            sensorPacket.imu_gyroscope_rad_per_sec =
+            subSamples[frame].imu_gyroscope_rad_per_sec =
                 Eigen::Vector3f(
                     psmoveState->CalibratedGyro[frame][0], 
                     psmoveState->CalibratedGyro[frame][1], 
                     psmoveState->CalibratedGyro[frame][2]);
-
-            // Create a filter input packet from the sensor data 
-            // and the filter's previous orientation and position
-            poseFilterSpace->createFilterPacket(
-                sensorPacket, 
-                poseFilter,
-                filterPacket);
-
-            poseFilter->update(delta_time / 2.f, filterPacket);
         }
+
+        // One filter update per reading, each over half of the time since the previous state
+        poseFilterSpace->updateFilterWithSubSamples(
+            sensorPacket,
+            subSamples,
+            2,
+            delta_time,
+            poseFilter);
         }
                 }
 
@@ -2128,6 +2235,10 @@ update_filters_for_psdualshock4(
     {
         PoseSensorPacket sensorPacket;
 
+        // How old the optical readings are by the time the filter sees them
+        sensorPacket.optical_sample_age_seconds =
+            poseEstimation->bCurrentlyTracking ? poseEstimation->getCaptureAgeSeconds() : 0.f;
+
         if (poseEstimation->bOrientationValid)
         {
             sensorPacket.optical_orientation = 
@@ -2250,6 +2361,10 @@ static void update_filters_for_virtual_controller(
 	{
 		PoseSensorPacket sensorPacket;
 
+		// How old the optical readings are by the time the filter sees them
+		sensorPacket.optical_sample_age_seconds =
+			poseEstimation->bCurrentlyTracking ? poseEstimation->getCaptureAgeSeconds() : 0.f;
+
 		sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 		sensorPacket.optical_orientation = Eigen::Quaternionf::Identity();
 
@@ -2353,6 +2468,7 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
     const TrackerManager* tracker_manager,
     const int *valid_projection_tracker_ids,
     const int projections_found,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time,
     ControllerOpticalPoseEstimation *tracker_pose_estimations,
     ControllerOpticalPoseEstimation *multicam_pose_estimation)
 {
@@ -2368,26 +2484,35 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
         const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
         const ControllerOpticalPoseEstimation &poseEstimate = tracker_pose_estimations[tracker_id];
 
-        position2d_list[list_index] = tracker->projectTrackerRelativePosition(&poseEstimate.position_cm);
+        // Every tracker's position is extrapolated to the same moment before triangulating
+        const CommonDevicePosition aligned_position = poseEstimate.getTimeAlignedPosition(reference_time);
+
+        position2d_list[list_index] = tracker->projectTrackerRelativePosition(&aligned_position);
         screen_area_sum += poseEstimate.projection.screen_area;
     }
 
-    // Compute triangulations amongst all pairs of projections
-    int pair_count = 0;
+    // Gather every tracker that has at least one other tracker it can be triangulated against
+    const ServerTrackerView *triangulation_trackers[TrackerManager::k_max_devices];
+    CommonDeviceScreenLocation triangulation_screen_locations[TrackerManager::k_max_devices];
+    float triangulation_weights[TrackerManager::k_max_devices];
+    int triangulation_tracker_count = 0;
     int biggest_prjection_id = -1;
-    CommonDevicePosition average_world_position = { 0.f, 0.f, 0.f };
     for (int list_index = 0; list_index < projections_found; ++list_index)
     {
         const int tracker_id = valid_projection_tracker_ids[list_index];
-        const CommonDeviceScreenLocation &screen_location = position2d_list[list_index];
         const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
+        bool bHasPartner = false;
 
-        for (int other_list_index = list_index + 1; other_list_index < projections_found; ++other_list_index)
+        for (int other_list_index = 0; other_list_index < projections_found; ++other_list_index)
         {
+            if (other_list_index == list_index)
+            {
+                continue;
+            }
+
             const int other_tracker_id = valid_projection_tracker_ids[other_list_index];
-            const CommonDeviceScreenLocation &other_screen_location = position2d_list[other_list_index];
             const ServerTrackerViewPtr other_tracker = tracker_manager->getTrackerViewPtr(other_tracker_id);
-            // if trackers are on poposite sides
+            // if trackers are on opposite sides
             if (cfg.exclude_opposed_cameras)
             {
                 if ((tracker->getTrackerPose().PositionCm.x > 0) == (other_tracker->getTrackerPose().PositionCm.x < 0) &&
@@ -2402,21 +2527,34 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
                 }
             }
 
-            // Using the screen locations on two different trackers we can triangulate a world position
-            CommonDevicePosition world_position =
-                ServerTrackerView::triangulateWorldPosition(
-                    tracker.get(), &screen_location,
-                    other_tracker.get(), &other_screen_location);
+            bHasPartner = true;
+            break;
+        }
 
-            average_world_position.x += world_position.x;
-            average_world_position.y += world_position.y;
-            average_world_position.z += world_position.z;
+        if (bHasPartner)
+        {
+            const float screen_area = tracker_pose_estimations[tracker_id].projection.screen_area;
 
-            ++pair_count;
+            triangulation_trackers[triangulation_tracker_count] = tracker.get();
+            triangulation_screen_locations[triangulation_tracker_count] = position2d_list[list_index];
+            // Bigger projections have less noisy centers
+            triangulation_weights[triangulation_tracker_count] = (screen_area > 0.f) ? screen_area : 1.f;
+            ++triangulation_tracker_count;
         }
     }
 
-    if (pair_count == 0 && biggest_prjection_id >= 0 && !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker)
+    // Triangulate a single world position from all of the trackers at once
+    CommonDevicePosition triangulated_world_position;
+    const bool bTriangulated =
+        triangulation_tracker_count >= 2 &&
+        ServerTrackerView::triangulateWorldPositionFromTrackers(
+            triangulation_trackers,
+            triangulation_screen_locations,
+            triangulation_weights,
+            triangulation_tracker_count,
+            &triangulated_world_position);
+
+    if (!bTriangulated && biggest_prjection_id >= 0 && !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker)
     {
         // Position not triangulated from opposed camera, estimate from one tracker only.
 
@@ -2426,26 +2564,19 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
             &tracker_pose_estimations[biggest_prjection_id],
             multicam_pose_estimation);		
     }
-    else if(pair_count > 0)
+    else if (bTriangulated)
     {
-        // Compute the average position
-        const float N = static_cast<float>(pair_count);
-
-        average_world_position.x /= N;
-        average_world_position.y /= N;
-        average_world_position.z /= N;
-
-        // Store the averaged tracking position
+        // Store the triangulated tracking position
         const float q = tracker_manager->getConfig().controller_position_smoothing;
         if (q <= 0.01f)
         {
-            multicam_pose_estimation->position_cm = average_world_position;
+            multicam_pose_estimation->position_cm = triangulated_world_position;
         }
         else
         {
-            multicam_pose_estimation->position_cm.x = q * multicam_pose_estimation->position_cm.x + (1 - q) * average_world_position.x;
-            multicam_pose_estimation->position_cm.y = q * multicam_pose_estimation->position_cm.y + (1 - q) * average_world_position.y;
-            multicam_pose_estimation->position_cm.z = q * multicam_pose_estimation->position_cm.z + (1 - q) * average_world_position.z;
+            multicam_pose_estimation->position_cm.x = q * multicam_pose_estimation->position_cm.x + (1 - q) * triangulated_world_position.x;
+            multicam_pose_estimation->position_cm.y = q * multicam_pose_estimation->position_cm.y + (1 - q) * triangulated_world_position.y;
+            multicam_pose_estimation->position_cm.z = q * multicam_pose_estimation->position_cm.z + (1 - q) * triangulated_world_position.z;
         }
 
         multicam_pose_estimation->bCurrentlyTracking = true;
@@ -3,6 +3,8 @@
 
 //-- includes -----
 #include "DeviceInterface.h"
+#include "DeviceSampleClock.h"
+#include "OpticalPoseEstimation.h"
 #include "ServerDeviceView.h"
 #include "PSMoveProtocolInterface.h"
 #include "TrackerManager.h"
@@ -16,7 +18,14 @@ struct ControllerOpticalPoseEstimation
     std::chrono::time_point<std::chrono::high_resolution_clock> last_visible_timestamp;
     bool bValidTimestamps;
 
+    // When the video frame(s) the estimate came from were captured
+    std::chrono::time_point<std::chrono::steady_clock> capture_timestamp;
+    bool bValidCaptureTimestamp;
+
     CommonDevicePosition position_cm; // centimeters
+    // Tracker relative velocity from consecutive frames of the same tracker
+    CommonDeviceVector velocity_cm_per_sec; // cm/s
+    bool bVelocityValid;
     CommonDeviceTrackingProjection projection;
     bool bCurrentlyTracking;
 
@@ -29,7 +38,12 @@ struct ControllerOpticalPoseEstimation
         last_visible_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>();
         bValidTimestamps= false;
 
+        capture_timestamp = std::chrono::time_point<std::chrono::steady_clock>();
+        bValidCaptureTimestamp= false;
+
         position_cm.clear();
+        velocity_cm_per_sec.clear();
+        bVelocityValid= false;
         bCurrentlyTracking= false;
 
         orientation.clear();
@@ -38,6 +52,28 @@ struct ControllerOpticalPoseEstimation
         memset(&projection, 0, sizeof(CommonDeviceTrackingProjection));
         projection.shape_type= eCommonTrackingProjectionType::INVALID_PROJECTION;
     }
+
+    // How long ago the video frame(s) behind the estimate were captured (0 if unknown)
+    inline float getCaptureAgeSeconds() const
+    {
+        return bValidCaptureTimestamp
+            ? std::chrono::duration<float>(std::chrono::steady_clock::now() - capture_timestamp).count()
+            : 0.f;
+    }
+
+    // Estimates the velocity from the frame the previous estimate came from to this one.
+    // Called on a new estimate before it replaces the previous one.
+    inline void updateVelocity(const ControllerOpticalPoseEstimation &previous, bool bPreviousValid)
+    {
+        updateOpticalPoseEstimationVelocity(*this, previous, bPreviousValid);
+    }
+
+    // The position extrapolated from the capture time of its frame to reference_time
+    inline CommonDevicePosition getTimeAlignedPosition(
+        const std::chrono::time_point<std::chrono::steady_clock> &reference_time) const
+    {
+        return getTimeAlignedOpticalPosition(*this, reference_time);
+    }
 };
 
 class ServerControllerView : public ServerDeviceView
@@ -209,6 +245,8 @@ private:
     int m_lastPollSeqNumProcessed;
     std::chrono::time_point<std::chrono::high_resolution_clock> m_last_filter_update_timestamp;
     bool m_last_filter_update_timestamp_valid;
+    DeviceSampleClock m_imu_sample_clock; // Time between IMU samples from the controller's timestamps
+    bool m_bUseImuSampleClock;
 };
 
 #endif // SERVER_CONTROLLER_VIEW_H
@@ -62,6 +62,7 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
     const TrackerManager* tracker_manager,
     const int *valid_projection_tracker_ids,
     const int projections_found,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time,
     HMDOpticalPoseEstimation *tracker_pose_estimations,
     HMDOpticalPoseEstimation *multicam_pose_estimation);
 static void computePointCloudPoseForHmdFromMultipleTrackers(
@@ -69,6 +70,7 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
     const TrackerManager* tracker_manager,
     const int *valid_projection_tracker_ids,
     const int projections_found,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time,
     HMDOpticalPoseEstimation *tracker_pose_estimations,
     HMDOpticalPoseEstimation *multicam_pose_estimation);
 
@@ -319,9 +321,29 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                     // Initially the newTrackerPoseEstimate is a copy of the existing pose
                     bool bIsVisibleThisUpdate= false;
 
+                    if (tracker->getIsVisionWorkerEnabled())
+                    {
+                        // Pick up the projection the tracker's vision thread computed since
+                        // the last update (if any), then queue up a request against the newest frame
+                        HMDOpticalPoseEstimation newTrackerPoseEstimate= trackerPoseEstimateRef;
+
+                        if (tracker->fetchProjectionForHMD(this, &newTrackerPoseEstimate))
+                        {
+                            bIsVisibleThisUpdate= true;
+
+                            // Actually apply the pose estimate state
+                            newTrackerPoseEstimate.updateVelocity(trackerPoseEstimateRef, bWasTracking);
+                            trackerPoseEstimateRef= newTrackerPoseEstimate;
+                            // The projection came from the frame the previous update handed to the vision thread,
+                            // so it was last seen when that frame was captured
+                            trackerPoseEstimateRef.last_visible_timestamp = getOpticalCaptureTime(trackerPoseEstimateRef, now);
+                        }
+
+                        tracker->requestProjectionForHMD(this, &trackingShape);
+                    }
                     // If a new video frame is available this tick, 
                     // attempt to update the tracking location
-                    if (tracker->getHasUnpublishedState())
+                    else if (tracker->getHasUnpublishedState())
                     {
                         // Create a copy of the pose estimate state so that in event of a 
                         // failure part way through computing the projection we don't
@@ -336,6 +358,7 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                             bIsVisibleThisUpdate= true;
 
                             // Actually apply the pose estimate state
+                            newTrackerPoseEstimate.updateVelocity(trackerPoseEstimateRef, bWasTracking);
                             trackerPoseEstimateRef= newTrackerPoseEstimate;
                             trackerPoseEstimateRef.last_visible_timestamp = now;
                         }
@@ -368,6 +391,23 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
             trackerPoseEstimateRef.bCurrentlyTracking = bCurrentlyTracking;
         }
 
+        // The trackers aren't synchronized, so each projection comes from a slightly different moment.
+        // Triangulation brings every tracker's estimate forward to the newest video frame among them.
+        std::chrono::time_point<std::chrono::steady_clock> optical_reference_time;
+        bool bValidOpticalReferenceTime= false;
+        for (int list_index = 0; list_index < projections_found; ++list_index)
+        {
+            const HMDOpticalPoseEstimation &trackerPoseEstimate =
+                m_tracker_pose_estimations[valid_projection_tracker_ids[list_index]];
+
+            if (trackerPoseEstimate.bValidCaptureTimestamp &&
+                (!bValidOpticalReferenceTime || trackerPoseEstimate.capture_timestamp > optical_reference_time))
+            {
+                optical_reference_time= trackerPoseEstimate.capture_timestamp;
+                bValidOpticalReferenceTime= true;
+            }
+        }
+
         // How we compute the final world pose estimate varies based on
         // * Number of trackers that currently have a valid projections of the controller
         // * The kind of projection shape (psmove sphere or ds4 lightbar)
@@ -383,6 +423,7 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                     tracker_manager,
                     valid_projection_tracker_ids,
                     projections_found,
+                    optical_reference_time,
                     m_tracker_pose_estimations,
                     m_multicam_pose_estimation);
                 break;
@@ -392,6 +433,7 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                     tracker_manager,
                     valid_projection_tracker_ids,
                     projections_found,
+                    optical_reference_time,
                     m_tracker_pose_estimations,
                     m_multicam_pose_estimation);
                 break;
@@ -436,6 +478,13 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
         if (m_multicam_pose_estimation->bCurrentlyTracking)
         {
             m_multicam_pose_estimation->last_visible_timestamp = now;
+
+            // The combined estimate describes the device at the reference time
+            if (bValidOpticalReferenceTime)
+            {
+                m_multicam_pose_estimation->capture_timestamp = optical_reference_time;
+                m_multicam_pose_estimation->bValidCaptureTimestamp = true;
+            }
         }
         m_multicam_pose_estimation->last_update_timestamp = now;
         m_multicam_pose_estimation->bValidTimestamps = true;
@@ -746,6 +795,15 @@ void ServerHMDView::generate_hmd_data_frame_for_stream(
     hmd_data_frame->set_sequence_num(hmd_view->m_sequence_number);
     hmd_data_frame->set_isconnected(hmd_view->getDevice()->getIsOpen());
 
+    if (hmd_view->getIsCurrentlyTracking() && hmd_view->getMulticamPoseEstimate()->bValidCaptureTimestamp)
+    {
+        const auto *pose_estimate= hmd_view->getMulticamPoseEstimate();
+
+        hmd_data_frame->set_optical_capture_timestamp_us(
+            std::chrono::duration_cast<std::chrono::microseconds>(pose_estimate->capture_timestamp.time_since_epoch()).count());
+        hmd_data_frame->set_optical_sample_age_ms(pose_estimate->getCaptureAgeSeconds() * 1000.f);
+    }
+
     switch (hmd_view->getHMDDeviceType())
     {
     case CommonHMDState::Morpheus:
@@ -982,6 +1040,10 @@ update_filters_for_morpheus_hmd(
 	{
 		PoseSensorPacket sensorPacket;
 
+		// How old the optical readings are by the time the filter sees them
+		sensorPacket.optical_sample_age_seconds =
+			poseEstimation->bCurrentlyTracking ? poseEstimation->getCaptureAgeSeconds() : 0.f;
+
 		sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 
 		if (poseEstimation->bOrientationValid)
@@ -1014,35 +1076,30 @@ update_filters_for_morpheus_hmd(
 		}
 
 		// Each state update contains two readings (one earlier and one later) of accelerometer and gyro data
+		PoseSensorIMUSubSample subSamples[2];
 		for (int frame = 0; frame < 2; ++frame)
 		{
 			const MorpheusHMDSensorFrame &sensorFrame= morpheusHMDState->SensorFrames[frame];
 
-			sensorPacket.imu_accelerometer_g_units =
+			subSamples[frame].imu_accelerometer_g_units =
 				Eigen::Vector3f(
 					sensorFrame.CalibratedAccel.i,
 					sensorFrame.CalibratedAccel.j,
 					sensorFrame.CalibratedAccel.k);
-			sensorPacket.imu_gyroscope_rad_per_sec =
+			subSamples[frame].imu_gyroscope_rad_per_sec =
 				Eigen::Vector3f(
 					sensorFrame.CalibratedGyro.i,
 					sensorFrame.CalibratedGyro.j,
 					sensorFrame.CalibratedGyro.k);
-			sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
-
-			{
-				PoseFilterPacket filterPacket;
-
-				// Create a filter input packet from the sensor data 
-				// and the filter's previous orientation and position
-				poseFilterSpace->createFilterPacket(
-					sensorPacket,
-					poseFilter,
-					filterPacket);
-
-				poseFilter->update(delta_time / 2.f, filterPacket);
-			}
 		}
+
+		// One filter update per reading, each over half of the time since the previous state
+		poseFilterSpace->updateFilterWithSubSamples(
+			sensorPacket,
+			subSamples,
+			2,
+			delta_time,
+			poseFilter);
 	}
 }
 
@@ -1062,6 +1119,10 @@ update_filters_for_virtual_hmd(
 	{
 		PoseSensorPacket sensorPacket;
 
+		// How old the optical readings are by the time the filter sees them
+		sensorPacket.optical_sample_age_seconds =
+			poseEstimation->bCurrentlyTracking ? poseEstimation->getCaptureAgeSeconds() : 0.f;
+
 		sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 		sensorPacket.optical_orientation = Eigen::Quaternionf::Identity();
 
@@ -1466,6 +1527,7 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
     const TrackerManager* tracker_manager,
     const int *valid_projection_tracker_ids,
     const int projections_found,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time,
     HMDOpticalPoseEstimation *tracker_pose_estimations,
     HMDOpticalPoseEstimation *multicam_pose_estimation)
 {
@@ -1481,24 +1543,33 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
         const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
         const HMDOpticalPoseEstimation &poseEstimate = tracker_pose_estimations[tracker_id];
 
-        position2d_list[list_index] = tracker->projectTrackerRelativePosition(&poseEstimate.position_cm);
+        // Every tracker's position is extrapolated to the same moment before triangulating
+        const CommonDevicePosition aligned_position = poseEstimate.getTimeAlignedPosition(reference_time);
+
+        position2d_list[list_index] = tracker->projectTrackerRelativePosition(&aligned_position);
         screen_area_sum += poseEstimate.projection.screen_area;
     }
 
-    // Compute triangulations amongst all pairs of projections
-    int pair_count = 0;
+    // Gather every tracker that has at least one other tracker it can be triangulated against
+    const ServerTrackerView *triangulation_trackers[TrackerManager::k_max_devices];
+    CommonDeviceScreenLocation triangulation_screen_locations[TrackerManager::k_max_devices];
+    float triangulation_weights[TrackerManager::k_max_devices];
+    int triangulation_tracker_count = 0;
     int biggest_prjection_id = -1;
-    CommonDevicePosition average_world_position = { 0.f, 0.f, 0.f };
     for (int list_index = 0; list_index < projections_found; ++list_index)
     {
         const int tracker_id = valid_projection_tracker_ids[list_index];
-        const CommonDeviceScreenLocation &screen_location = position2d_list[list_index];
         const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
+        bool bHasPartner = false;
 
-        for (int other_list_index = list_index + 1; other_list_index < projections_found; ++other_list_index)
+        for (int other_list_index = 0; other_list_index < projections_found; ++other_list_index)
         {
+            if (other_list_index == list_index)
+            {
+                continue;
+            }
+
             const int other_tracker_id = valid_projection_tracker_ids[other_list_index];
-            const CommonDeviceScreenLocation &other_screen_location = position2d_list[other_list_index];
             const ServerTrackerViewPtr other_tracker = tracker_manager->getTrackerViewPtr(other_tracker_id);
             // if trackers are on opposite sides
             if (cfg.exclude_opposed_cameras)
@@ -1515,21 +1586,34 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
                 }
             }
 
-            // Using the screen locations on two different trackers we can triangulate a world position
-            CommonDevicePosition world_position =
-                ServerTrackerView::triangulateWorldPosition(
-                    tracker.get(), &screen_location,
-                    other_tracker.get(), &other_screen_location);
+            bHasPartner = true;
+            break;
+        }
 
-            average_world_position.x += world_position.x;
-            average_world_position.y += world_position.y;
-            average_world_position.z += world_position.z;
+        if (bHasPartner)
+        {
+            const float screen_area = tracker_pose_estimations[tracker_id].projection.screen_area;
 
-            ++pair_count;
+            triangulation_trackers[triangulation_tracker_count] = tracker.get();
+            triangulation_screen_locations[triangulation_tracker_count] = position2d_list[list_index];
+            // Bigger projections have less noisy centers
+            triangulation_weights[triangulation_tracker_count] = (screen_area > 0.f) ? screen_area : 1.f;
+            ++triangulation_tracker_count;
         }
     }
 
-    if (pair_count == 0 && biggest_prjection_id >= 0 && !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker)
+    // Triangulate a single world position from all of the trackers at once
+    CommonDevicePosition triangulated_world_position;
+    const bool bTriangulated =
+        triangulation_tracker_count >= 2 &&
+        ServerTrackerView::triangulateWorldPositionFromTrackers(
+            triangulation_trackers,
+            triangulation_screen_locations,
+            triangulation_weights,
+            triangulation_tracker_count,
+            &triangulated_world_position);
+
+    if (!bTriangulated && biggest_prjection_id >= 0 && !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker)
     {
         // Position not triangulated from opposed camera, estimate from one tracker only.
         computeSpherePoseForHmdFromSingleTracker(
@@ -1538,26 +1622,19 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
             &tracker_pose_estimations[biggest_prjection_id],
             multicam_pose_estimation);		
     }
-    else if(pair_count > 0)
+    else if (bTriangulated)
     {
-        // Compute the average position
-        const float N = static_cast<float>(pair_count);
-
-        average_world_position.x /= N;
-        average_world_position.y /= N;
-        average_world_position.z /= N;
-
-        // Store the averaged tracking position
+        // Store the triangulated tracking position
         const float q = tracker_manager->getConfig().controller_position_smoothing;
         if (q <= 0.01f)
         {
-            multicam_pose_estimation->position_cm = average_world_position;
+            multicam_pose_estimation->position_cm = triangulated_world_position;
         }
         else
         {
-            multicam_pose_estimation->position_cm.x = q * multicam_pose_estimation->position_cm.x + (1 - q) * average_world_position.x;
-            multicam_pose_estimation->position_cm.y = q * multicam_pose_estimation->position_cm.y + (1 - q) * average_world_position.y;
-            multicam_pose_estimation->position_cm.z = q * multicam_pose_estimation->position_cm.z + (1 - q) * average_world_position.z;
+            multicam_pose_estimation->position_cm.x = q * multicam_pose_estimation->position_cm.x + (1 - q) * triangulated_world_position.x;
+            multicam_pose_estimation->position_cm.y = q * multicam_pose_estimation->position_cm.y + (1 - q) * triangulated_world_position.y;
+            multicam_pose_estimation->position_cm.z = q * multicam_pose_estimation->position_cm.z + (1 - q) * triangulated_world_position.z;
         }
 
         multicam_pose_estimation->bCurrentlyTracking = true;
@@ -1578,6 +1655,7 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
     const TrackerManager* tracker_manager,
     const int *valid_projection_tracker_ids,
     const int projections_found,
+    const std::chrono::time_point<std::chrono::steady_clock> &reference_time,
     HMDOpticalPoseEstimation *tracker_pose_estimations,
     HMDOpticalPoseEstimation *multicam_pose_estimation)
 {
@@ -1593,24 +1671,33 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
         const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
         const HMDOpticalPoseEstimation &poseEstimate = tracker_pose_estimations[tracker_id];
 
-        position2d_list[list_index] = tracker->projectTrackerRelativePosition(&poseEstimate.position_cm);
+        // Every tracker's position is extrapolated to the same moment before triangulating
+        const CommonDevicePosition aligned_position = poseEstimate.getTimeAlignedPosition(reference_time);
+
+        position2d_list[list_index] = tracker->projectTrackerRelativePosition(&aligned_position);
         screen_area_sum += poseEstimate.projection.screen_area;
     }
 
-    // Compute triangulations amongst all pairs of projections
-    int pair_count = 0;
+    // Gather every tracker that has at least one other tracker it can be triangulated against
+    const ServerTrackerView *triangulation_trackers[TrackerManager::k_max_devices];
+    CommonDeviceScreenLocation triangulation_screen_locations[TrackerManager::k_max_devices];
+    float triangulation_weights[TrackerManager::k_max_devices];
+    int triangulation_tracker_count = 0;
     int biggest_prjection_id = -1;
-    CommonDevicePosition average_world_position = { 0.f, 0.f, 0.f };
     for (int list_index = 0; list_index < projections_found; ++list_index)
     {
         const int tracker_id = valid_projection_tracker_ids[list_index];
-        const CommonDeviceScreenLocation &screen_location = position2d_list[list_index];
         const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
+        bool bHasPartner = false;
 
-        for (int other_list_index = list_index + 1; other_list_index < projections_found; ++other_list_index)
+        for (int other_list_index = 0; other_list_index < projections_found; ++other_list_index)
         {
+            if (other_list_index == list_index)
+            {
+                continue;
+            }
+
             const int other_tracker_id = valid_projection_tracker_ids[other_list_index];
-            const CommonDeviceScreenLocation &other_screen_location = position2d_list[other_list_index];
             const ServerTrackerViewPtr other_tracker = tracker_manager->getTrackerViewPtr(other_tracker_id);
             // if trackers are on opposite sides
             if (cfg.exclude_opposed_cameras)
@@ -1627,21 +1714,34 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
                 }
             }
 
-            // Using the screen locations on two different trackers we can triangulate a world position
-            CommonDevicePosition world_position =
-                ServerTrackerView::triangulateWorldPosition(
-                    tracker.get(), &screen_location,
-                    other_tracker.get(), &other_screen_location);
+            bHasPartner = true;
+            break;
+        }
 
-            average_world_position.x += world_position.x;
-            average_world_position.y += world_position.y;
-            average_world_position.z += world_position.z;
+        if (bHasPartner)
+        {
+            const float screen_area = tracker_pose_estimations[tracker_id].projection.screen_area;
 
-            ++pair_count;
+            triangulation_trackers[triangulation_tracker_count] = tracker.get();
+            triangulation_screen_locations[triangulation_tracker_count] = position2d_list[list_index];
+            // Bigger projections have less noisy centers
+            triangulation_weights[triangulation_tracker_count] = (screen_area > 0.f) ? screen_area : 1.f;
+            ++triangulation_tracker_count;
         }
     }
 
-    if (pair_count == 0 && biggest_prjection_id >= 0 && !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker)
+    // Triangulate a single world position from all of the trackers at once
+    CommonDevicePosition triangulated_world_position;
+    const bool bTriangulated =
+        triangulation_tracker_count >= 2 &&
+        ServerTrackerView::triangulateWorldPositionFromTrackers(
+            triangulation_trackers,
+            triangulation_screen_locations,
+            triangulation_weights,
+            triangulation_tracker_count,
+            &triangulated_world_position);
+
+    if (!bTriangulated && biggest_prjection_id >= 0 && !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker)
     {
         // Position not triangulated from opposed camera, estimate from one tracker only.
         computePointCloudPoseForHmdFromSingleTracker(
@@ -1650,26 +1750,19 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
             &tracker_pose_estimations[biggest_prjection_id],
             multicam_pose_estimation);		
     }
-    else if(pair_count > 0)
+    else if (bTriangulated)
     {
-        // Compute the average position
-        const float N = static_cast<float>(pair_count);
-
-        average_world_position.x /= N;
-        average_world_position.y /= N;
-        average_world_position.z /= N;
-
-        // Store the averaged tracking position
+        // Store the triangulated tracking position
         const float q = tracker_manager->getConfig().controller_position_smoothing;
         if (q <= 0.01f)
         {
-            multicam_pose_estimation->position_cm = average_world_position;
+            multicam_pose_estimation->position_cm = triangulated_world_position;
         }
         else
         {
-            multicam_pose_estimation->position_cm.x = q * multicam_pose_estimation->position_cm.x + (1 - q) * average_world_position.x;
-            multicam_pose_estimation->position_cm.y = q * multicam_pose_estimation->position_cm.y + (1 - q) * average_world_position.y;
-            multicam_pose_estimation->position_cm.z = q * multicam_pose_estimation->position_cm.z + (1 - q) * average_world_position.z;
+            multicam_pose_estimation->position_cm.x = q * multicam_pose_estimation->position_cm.x + (1 - q) * triangulated_world_position.x;
+            multicam_pose_estimation->position_cm.y = q * multicam_pose_estimation->position_cm.y + (1 - q) * triangulated_world_position.y;
+            multicam_pose_estimation->position_cm.z = q * multicam_pose_estimation->position_cm.z + (1 - q) * triangulated_world_position.z;
         }
 
         multicam_pose_estimation->bCurrentlyTracking = true;
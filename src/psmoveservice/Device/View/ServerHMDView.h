@@ -2,6 +2,7 @@
 #define SERVER_HMD_VIEW_H
 
 //-- includes -----
+#include "OpticalPoseEstimation.h"
 #include "ServerDeviceView.h"
 #include "PSMoveProtocolInterface.h"
 #include <cstring>
@@ -16,7 +17,14 @@ struct HMDOpticalPoseEstimation
 	std::chrono::time_point<std::chrono::high_resolution_clock> last_visible_timestamp;
 	bool bValidTimestamps;
 
+	// When the video frame(s) the estimate came from were captured
+	std::chrono::time_point<std::chrono::steady_clock> capture_timestamp;
+	bool bValidCaptureTimestamp;
+
 	CommonDevicePosition position_cm;
+	// Tracker relative velocity from consecutive frames of the same tracker
+	CommonDeviceVector velocity_cm_per_sec; // cm/s
+	bool bVelocityValid;
 	CommonDeviceTrackingProjection projection;
 	bool bCurrentlyTracking;
 
@@ -29,7 +37,12 @@ struct HMDOpticalPoseEstimation
 		last_visible_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>();
 		bValidTimestamps = false;
 
+		capture_timestamp = std::chrono::time_point<std::chrono::steady_clock>();
+		bValidCaptureTimestamp = false;
+
 		position_cm.clear();
+		velocity_cm_per_sec.clear();
+		bVelocityValid = false;
 		bCurrentlyTracking = false;
 
 		orientation.clear();
@@ -38,6 +51,28 @@ struct HMDOpticalPoseEstimation
 		memset(&projection, 0, sizeof(CommonDeviceTrackingProjection));
 		projection.shape_type = eCommonTrackingProjectionType::INVALID_PROJECTION;
 	}
+
+	// How long ago the video frame(s) behind the estimate were captured (0 if unknown)
+	inline float getCaptureAgeSeconds() const
+	{
+		return bValidCaptureTimestamp
+			? std::chrono::duration<float>(std::chrono::steady_clock::now() - capture_timestamp).count()
+			: 0.f;
+	}
+
+	// Estimates the velocity from the frame the previous estimate came from to this one.
+	// Called on a new estimate before it replaces the previous one.
+	inline void updateVelocity(const HMDOpticalPoseEstimation &previous, bool bPreviousValid)
+	{
+		updateOpticalPoseEstimationVelocity(*this, previous, bPreviousValid);
+	}
+
+	// The position extrapolated from the capture time of its frame to reference_time
+	inline CommonDevicePosition getTimeAlignedPosition(
+		const std::chrono::time_point<std::chrono::steady_clock> &reference_time) const
+	{
+		return getTimeAlignedOpticalPosition(*this, reference_time);
+	}
 };
 
 class ServerHMDView : public ServerDeviceView
@@ -1,6 +1,7 @@
 //-- includes -----
 #include "DeviceEnumerator.h"
 #include "DeviceManager.h"
+#include "HSVThresholdKernel.h"
 #include "ServerTrackerView.h"
 #include "ServerControllerView.h"
 #include "ServerHMDView.h"
@@ -8,29 +9,50 @@
 #include "MathEigen.h"
 #include "MathGLM.h"
 #include "MathAlignment.h"
+#include "OpenCVBGRToHSVMapper.h"
+#include "OpenCVBlobExtractor.h"
+#include "OpenCVPointCloudPoseSolver.h"
+#include "OpenCVUndistortionCache.h"
 #include "PS3EyeTracker.h"
 #include "PSMoveProtocol.pb.h"
 #include "ServerUtility.h"
 #include "ServerLog.h"
 #include "ServerRequestHandler.h"
+#include "ServerUpdateSignal.h"
 #include "SharedTrackerState.h"
+#include "TrackerDebugOverlay.h"
 #include "TrackerManager.h"
+#include "TrackerSegmentationPlan.h"
+#include "TrackerVideoFrameRing.h"
 #include "PoseFilterInterface.h"
 
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/mapped_region.hpp>
-#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <Eigen/Cholesky>
+#include <Eigen/Eigenvalues>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "opencv2/opencv.hpp"
 #include "opencv2/calib3d/calib3d.hpp"
 
 #include <algorithm>
+#include <limits>
 
 #define USE_OPEN_CV_ELLIPSE_FIT
 
 //-- constants ----
 static const int k_min_roi_size= 32;
+static const int k_roi_margin_px= 4; // room around the expected blob for contour extraction
+static const float k_roi_sigma_count= 3.f; // how much of the position uncertainty the ROI covers
+static const float k_max_roi_prediction_time= 0.1f; // seconds
+static const int k_hsv_cache_tile_size= 16; // pixels per side of a tile in the per-frame HSV cache
+static const int k_max_reacquisition_pyramid_levels= 3; // 1/8 scale, any coarser and the blobs vanish
+static const int k_reacquisition_margin_px= 8; // room around a coarse reacquisition candidate for the full resolution search
 
 //-- typedefs ----
 typedef std::vector<cv::Point> t_opencv_int_contour;
@@ -57,7 +79,7 @@ public:
         dispose();
     }
 
-    bool initialize(const char *shared_memory_name, int width, int height, int stride)
+    bool initialize(const char *shared_memory_name, eSharedVideoFrameFormat format, int width, int height, int stride)
     {
         bool bSuccess = false;
 
@@ -84,23 +106,22 @@ public:
                     permissions);
 
             // Resize the shared memory
-            m_shared_memory_object->truncate(SharedVideoFrameHeader::computeTotalSize(stride, width));
+            m_shared_memory_object->truncate(SharedVideoFrameHeader::computeTotalSize(stride, height));
 
             // Map all of the shared memory for read/write access
             m_region = new boost::interprocess::mapped_region(*m_shared_memory_object, boost::interprocess::read_write);
 
             // Initialize the shared memory (call constructor using placement new)
-            // This make sure the mutex has the constructor called on it.
-            SharedVideoFrameHeader *frameState = new (getFrameHeader()) SharedVideoFrameHeader();
-            
-            frameState->width = width;
-            frameState->height = height;
-            frameState->stride = stride;
-            frameState->frame_index = 0;
-            std::memset(
-                frameState->getBufferMutable(),
-                0,
-                SharedVideoFrameHeader::computeVideoBufferSize(stride, height));
+            // This make sure the slot sequence numbers have the constructor called on them.
+            SharedVideoFrameHeader *frameState = new (getFrameHeader()) SharedVideoFrameHeader(format, width, height, stride);
+
+            for (int slot_index = 0; slot_index < SharedVideoFrameHeader::k_slot_count; ++slot_index)
+            {
+                std::memset(
+                    frameState->getSlotBufferMutable(slot_index),
+                    0,
+                    SharedVideoFrameHeader::computeVideoBufferSize(stride, height));
+            }
 
             bSuccess = true;
         }
@@ -119,7 +140,6 @@ public:
         if (m_region != nullptr)
         {
             // Call the destructor manually on the frame header since it was constructed via placement new
-            // This will make sure the mutex has the destructor called on it.
             getFrameHeader()->~SharedVideoFrameHeader();
             
             delete m_region;
@@ -132,25 +152,26 @@ public:
             m_shared_memory_object = nullptr;
         }
 
-        if (!boost::interprocess::shared_memory_object::remove(m_shared_memory_name))
+        if (!m_shared_memory_name.empty() &&
+            !boost::interprocess::shared_memory_object::remove(m_shared_memory_name.c_str()))
         {
             SERVER_LOG_ERROR("SharedMemory::dispose") << "Failed to free shared memory: " << m_shared_memory_name;
         }
     }
 
-    void writeVideoFrame(const unsigned char *buffer)
+    // Never blocks, no matter how many clients are reading the video stream
+    void writeVideoFrame(const unsigned char *buffer, const std::chrono::steady_clock::time_point &capture_time)
     {
         SharedVideoFrameHeader *sharedFrameState = getFrameHeader();
-        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(sharedFrameState->mutex);
 
-        size_t buffer_size = 
-            SharedVideoFrameHeader::computeVideoBufferSize(sharedFrameState->stride, sharedFrameState->height);
         size_t total_shared_mem_size =
             SharedVideoFrameHeader::computeTotalSize(sharedFrameState->stride, sharedFrameState->height);
         assert(m_region->get_size() >= total_shared_mem_size);
 
-        ++sharedFrameState->frame_index;
-        std::memcpy(sharedFrameState->getBufferMutable(), buffer, buffer_size);
+        const uint64_t capture_timestamp_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(capture_time.time_since_epoch()).count();
+
+        sharedFrameState->writeVideoFrame(buffer, capture_timestamp_us);
     }
 
 protected:
@@ -160,7 +181,7 @@ protected:
     }
 
 private:
-    const char *m_shared_memory_name;
+    std::string m_shared_memory_name;
     boost::interprocess::shared_memory_object *m_shared_memory_object;
     boost::interprocess::mapped_region *m_region;
 };
@@ -248,89 +269,126 @@ struct OpenCVPlane2D
     }
 };
 
-class OpenCVBGRToHSVMapper
+// Per-channel bitmasks of the tracking colors whose HSV range contains each channel value.
+// A pixel matches a tracking color if that color's bit is set in all three channel masks,
+// so every tracked color can be classified with three table lookups per pixel.
+// Each color has one bit, so a color that devices track with different HSV ranges is left out of the table
+// and those devices fall back to thresholding their own range (see OpenCVBufferState::getIsColorLabeled).
+struct OpenCVColorLabelTable
 {
-public:
-    typedef cv::Point3_<uint8_t> ColorTuple;
-
-    static OpenCVBGRToHSVMapper *allocate()
+    unsigned char hue[256];
+    unsigned char saturation[256];
+    unsigned char value[256];
+    unsigned char color_mask; // bits for every color present in the table
+    unsigned char conflicting_color_mask; // bits for every color added with more than one range
+    CommonHSVColorRange color_ranges[eCommonTrackingColorID::MAX_TRACKING_COLOR_TYPES];
+
+    void clear()
     {
-        if (m_refCount == 0)
-        {
-            assert(m_instance == nullptr);
-            m_instance = new OpenCVBGRToHSVMapper();
-        }
-        assert(m_instance != nullptr);
-
-        ++m_refCount;
-        return m_instance;
+        memset(hue, 0, sizeof(hue));
+        memset(saturation, 0, sizeof(saturation));
+        memset(value, 0, sizeof(value));
+        color_mask = 0;
+        conflicting_color_mask = 0;
     }
 
-    static void dispose(OpenCVBGRToHSVMapper *instance)
+    // Mirrors the ranges used by the cv::inRange() path in OpenCVBufferState::computeBiggestNContours
+    void addColor(const eCommonTrackingColorID color_id, const CommonHSVColorRange &hsvColorRange)
     {
-        assert(m_instance != nullptr);
-        assert(m_instance == instance);
-        assert(m_refCount > 0);
+        const unsigned char bit = static_cast<unsigned char>(1 << color_id);
 
-        --m_refCount;
-        if (m_refCount <= 0)
+        if ((conflicting_color_mask & bit) != 0)
         {
-            delete m_instance;
-            m_instance = nullptr;
+            return;
         }
-    }
 
-    void cvtColor(const cv::Mat &bgrBuffer, cv::Mat &hsvBuffer)
-    {
-        hsvBuffer.forEach<ColorTuple>([&bgrBuffer, this](ColorTuple &hsvColor, const int position[]) -> void {
-            const ColorTuple &bgrColor = bgrBuffer.at<ColorTuple>(position[0], position[1]);
-            const int b = bgrColor.x;
-            const int g = bgrColor.y;
-            const int r = bgrColor.z;
-            const int LUTIndex = OpenCVBGRToHSVMapper::getLUTIndex(r, g, b);
+        if ((color_mask & bit) != 0)
+        {
+            if (!isSameRange(color_ranges[color_id], hsvColorRange))
+            {
+                // Unioning the two ranges would make both devices match each other's background,
+                // so neither gets the color's bit
+                SERVER_LOG_WARNING("OpenCVColorLabelTable::addColor") << "Tracking color " << color_id
+                    << " is used with different HSV ranges, segmenting it per device instead";
+                conflicting_color_mask |= bit;
+                color_mask &= ~bit;
+                rebuildTables();
+            }
+            return;
+        }
 
-            hsvColor = bgr2hsv->at<ColorTuple>(LUTIndex, 0);
-        });
+        color_ranges[color_id] = hsvColorRange;
+        color_mask |= bit;
+        addColorRange(hsvColorRange, bit);
     }
 
 private:
-    static OpenCVBGRToHSVMapper *m_instance;
-    static int m_refCount;
+    static bool isSameRange(const CommonHSVColorRange &a, const CommonHSVColorRange &b)
+    {
+        return
+            a.hue_range.center == b.hue_range.center && a.hue_range.range == b.hue_range.range &&
+            a.saturation_range.center == b.saturation_range.center && a.saturation_range.range == b.saturation_range.range &&
+            a.value_range.center == b.value_range.center && a.value_range.range == b.value_range.range;
+    }
 
-    OpenCVBGRToHSVMapper()
+    void rebuildTables()
     {
-        bgr2hsv = new cv::Mat(256*256*256, 1, CV_8UC3);
+        memset(hue, 0, sizeof(hue));
+        memset(saturation, 0, sizeof(saturation));
+        memset(value, 0, sizeof(value));
 
-        int LUTIndex = 0;
-        for (int r = 0; r < 256; ++r)
+        for (int color_index = 0; color_index < eCommonTrackingColorID::MAX_TRACKING_COLOR_TYPES; ++color_index)
         {
-            for (int g = 0; g < 256; ++g)
+            const unsigned char bit = static_cast<unsigned char>(1 << color_index);
+
+            if ((color_mask & bit) != 0)
             {
-                for (int b = 0; b < 256; ++b)
-                {
-                    bgr2hsv->at<ColorTuple>(LUTIndex, 0) = ColorTuple(b, g, r);
-                    ++LUTIndex;
-                }
+                addColorRange(color_ranges[color_index], bit);
             }
         }
-
-        cv::cvtColor(*bgr2hsv, *bgr2hsv, cv::COLOR_BGR2HSV);
     }
 
-    ~OpenCVBGRToHSVMapper()
+    void addColorRange(const CommonHSVColorRange &hsvColorRange, const unsigned char bit)
     {
-        delete bgr2hsv;
+        const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
+        const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
+
+        if (hue_min < 0)
+        {
+            setRange(hue, 0, clampf(hue_max, 0, 180), bit);
+            setRange(hue, clampf(180 + hue_min, 0, 180), 180, bit);
+        }
+        else if (hue_max > 180)
+        {
+            setRange(hue, 0, clampf(hue_max - 180, 0, 180), bit);
+            setRange(hue, clampf(hue_min, 0, 180), 180, bit);
+        }
+        else
+        {
+            setRange(hue, hue_min, hue_max, bit);
+        }
+
+        setRange(saturation,
+            clampf(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255),
+            clampf(hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range, 0, 255),
+            bit);
+        setRange(value,
+            clampf(hsvColorRange.value_range.center - hsvColorRange.value_range.range, 0, 255),
+            clampf(hsvColorRange.value_range.center + hsvColorRange.value_range.range, 0, 255),
+            bit);
     }
 
-    static int getLUTIndex(int r, int g, int b)
+    static void setRange(unsigned char *table, const float range_min, const float range_max, const unsigned char bit)
     {
-        return (256 * 256)*r + 256*g + b;
+        for (int channel_value = 0; channel_value < 256; ++channel_value)
+        {
+            if (channel_value >= range_min && channel_value <= range_max)
+            {
+                table[channel_value] |= bit;
+            }
+        }
     }
-
-    cv::Mat *bgr2hsv;
 };
-OpenCVBGRToHSVMapper *OpenCVBGRToHSVMapper::m_instance = nullptr;
-int OpenCVBGRToHSVMapper::m_refCount= 0;
 
 class OpenCVBufferState
 {
@@ -342,25 +400,44 @@ public:
         , gsLowerBuffer(nullptr)
         , gsUpperBuffer(nullptr)
         , maskedBuffer(nullptr)
+        , labelBuffer(nullptr)
+        , frameIndex(0)
+        , pyramidFrameIndex(-1)
+        , pyramidLevels(0)
+        , bUseFusedHsvThreshold(false)
     {
         device->getVideoFrameDimensions(&frameWidth, &frameHeight, nullptr);
 
+        // Every tile in the HSV cache starts out as stale
+        hsvTileColumns = (frameWidth + k_hsv_cache_tile_size - 1) / k_hsv_cache_tile_size;
+        hsvTileRows = (frameHeight + k_hsv_cache_tile_size - 1) / k_hsv_cache_tile_size;
+        hsvTileFrameIndex.assign(hsvTileColumns*hsvTileRows, -1);
+        labelTileFrameIndex.assign(hsvTileColumns*hsvTileRows, -1);
+        colorLabelTable.clear();
+
+        // Just a placeholder until the first video frame gets written
         bgrBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
         bgrShmemBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
         hsvBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
         gsLowerBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC1);
         gsUpperBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC1);
         maskedBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC3);
+        labelBuffer = new cv::Mat(frameHeight, frameWidth, CV_8UC1);
         
         const TrackerManagerConfig &cfg= DeviceManager::getInstance()->m_tracker_manager->getConfig();
         if (cfg.use_bgr_to_hsv_lookup_table)
         {
-            bgr2hsv = OpenCVBGRToHSVMapper::allocate();
+            // Cache the tables next to the config files so later runs can just map them in
+            bgr2hsv = OpenCVBGRToHSVMapper::allocate(
+                cfg.bgr_to_hsv_lookup_table_bits,
+                PSMoveConfig::getConfigDirectoryPath());
         }
         else
         {
             bgr2hsv = nullptr;
         }
+
+        bUseFusedHsvThreshold = cfg.use_fused_hsv_threshold_kernel;
         
         //Apply default ROI (full frame).
         applyROI(cv::Rect2i(cv::Point(0,0), cv::Size(frameWidth, frameHeight)));
@@ -368,6 +445,11 @@ public:
 
     virtual ~OpenCVBufferState()
     {
+        if (labelBuffer != nullptr)
+        {
+            delete labelBuffer;
+        }
+
         if (maskedBuffer != nullptr)
         {
             delete maskedBuffer;
@@ -404,30 +486,134 @@ public:
         }
     }
 
-    void writeVideoFrame(const unsigned char *video_buffer)
+    // Points bgrBuffer at the captured frame (no copy) and holds onto the frame until the next one.
+    // Debug overlays get recorded for the given layers (none if nobody is watching the video stream).
+    bool writeVideoFrame(const TrackerVideoFrameRef &video_frame, unsigned int debug_overlay_layers)
     {
-        const cv::Mat videoBufferMat(frameHeight, frameWidth, CV_8UC3, const_cast<unsigned char *>(video_buffer));
+        if (video_frame.getWidth() != frameWidth || video_frame.getHeight() != frameHeight)
+        {
+            return false;
+        }
+
+        videoFrame = video_frame;
+        *bgrBuffer = cv::Mat(
+            frameHeight, frameWidth, CV_8UC3,
+            const_cast<unsigned char *>(videoFrame.getBuffer()),
+            videoFrame.getStride());
 
-        videoBufferMat.copyTo(*bgrBuffer);
-        videoBufferMat.copyTo(*bgrShmemBuffer);
+        debugOverlay.beginFrame(debug_overlay_layers);
+
+        // All of the cached HSV tiles are now out of date
+        ++frameIndex;
+
+        // Re-point the ROI at the new frame
+        bgrROI = cv::Mat(*bgrBuffer, currentROI);
+
+        return true;
     }
     
-    void updateHsvBuffer()
+    // Replace the color label table used for single pass segmentation.
+    // Should be called right after a new video frame is written.
+    void setColorLabelTable(const OpenCVColorLabelTable &table)
+    {
+        colorLabelTable = table;
+        labelTileFrameIndex.assign(labelTileFrameIndex.size(), -1);
+    }
+
+    // Convert the tiles overlapping the given ROI to HSV,
+    // skipping any tiles already converted for the current frame.
+    void updateHsvBuffer(const cv::Rect2i &ROI)
+    {
+        updateStaleTiles(ROI, hsvTileFrameIndex, &OpenCVBufferState::convertToHsv);
+    }
+
+    // Same as above for the color label buffer
+    void updateLabelBuffer(const cv::Rect2i &ROI)
+    {
+        updateHsvBuffer(ROI);
+        updateStaleTiles(ROI, labelTileFrameIndex, &OpenCVBufferState::convertToColorLabels);
+    }
+
+    void updateStaleTiles(
+        const cv::Rect2i &ROI,
+        std::vector<int> &tileFrameIndex,
+        void (OpenCVBufferState::*convertRegion)(const cv::Rect2i &))
+    {
+        const int tile_x0 = ROI.x / k_hsv_cache_tile_size;
+        const int tile_y0 = ROI.y / k_hsv_cache_tile_size;
+        const int tile_x1 = (ROI.x + ROI.width - 1) / k_hsv_cache_tile_size;
+        const int tile_y1 = (ROI.y + ROI.height - 1) / k_hsv_cache_tile_size;
+
+        for (int tile_y = tile_y0; tile_y <= tile_y1; ++tile_y)
+        {
+            int *tile_row = &tileFrameIndex[tile_y*hsvTileColumns];
+            int run_start = -1;
+
+            // Convert each horizontal run of stale tiles with a single call
+            for (int tile_x = tile_x0; tile_x <= tile_x1 + 1; ++tile_x)
+            {
+                const bool bIsStale = tile_x <= tile_x1 && tile_row[tile_x] != frameIndex;
+
+                if (bIsStale)
+                {
+                    if (run_start < 0)
+                    {
+                        run_start = tile_x;
+                    }
+
+                    tile_row[tile_x] = frameIndex;
+                }
+                else if (run_start >= 0)
+                {
+                    const int x0 = run_start*k_hsv_cache_tile_size;
+                    const int y0 = tile_y*k_hsv_cache_tile_size;
+                    const int x1 = std::min(tile_x*k_hsv_cache_tile_size, frameWidth);
+                    const int y1 = std::min(y0 + k_hsv_cache_tile_size, frameHeight);
+
+                    (this->*convertRegion)(cv::Rect2i(x0, y0, x1 - x0, y1 - y0));
+                    run_start = -1;
+                }
+            }
+        }
+    }
+
+    void convertToHsv(const cv::Rect2i &region)
     {
+        const cv::Mat bgrRegion(*bgrBuffer, region);
+        cv::Mat hsvRegion(*hsvBuffer, region);
+
         // Convert the video buffer to the HSV color space
-        if (bgr2hsv != nullptr)
+        // (the lookup table may still be building in the background)
+        if (bgr2hsv != nullptr && bgr2hsv->getIsReady())
         {
-            bgr2hsv->cvtColor(bgrROI, hsvROI);
+            bgr2hsv->cvtColor(bgrRegion, hsvRegion);
         }
         else
         {
-            cv::cvtColor(bgrROI, hsvROI, cv::COLOR_BGR2HSV);
+            cv::cvtColor(bgrRegion, hsvRegion, cv::COLOR_BGR2HSV);
+        }
+    }
+
+    void convertToColorLabels(const cv::Rect2i &region)
+    {
+        for (int y = region.y; y < region.y + region.height; ++y)
+        {
+            const unsigned char *hsv = hsvBuffer->ptr<unsigned char>(y) + 3*region.x;
+            unsigned char *label = labelBuffer->ptr<unsigned char>(y) + region.x;
+
+            for (int x = 0; x < region.width; ++x, hsv += 3)
+            {
+                label[x] = 
+                    colorLabelTable.hue[hsv[0]] & 
+                    colorLabelTable.saturation[hsv[1]] & 
+                    colorLabelTable.value[hsv[2]];
+            }
         }
     }
     
-    void applyROI(cv::Rect2i ROI)
+    // Make sure the ROI box is always clamped in bounds of the frame buffer
+    cv::Rect2i clampROI(cv::Rect2i ROI) const
     {
-        // Make sure the ROI box is always clamped in bounds of the frame buffer
         int x0= std::min(std::max(ROI.tl().x, 0), frameWidth-1);
         int y0= std::min(std::max(ROI.tl().y, 0), frameHeight-1);
         int x1= std::min(std::max(ROI.br().x, 0), frameWidth-1);
@@ -451,7 +637,14 @@ public:
             ROI.width = frameWidth;
             ROI.height = frameHeight;
         }
-       
+
+        return ROI;
+    }
+
+    void applyROI(const cv::Rect2i &requestedROI)
+    {
+        const cv::Rect2i ROI = clampROI(requestedROI);
+
         //Create the ROI matrices.
         //It's not a full copy, so this isn't too slow.
         //adjustROI is probably slightly faster but I ran into trouble with it.
@@ -459,17 +652,74 @@ public:
         hsvROI = cv::Mat(*hsvBuffer, ROI);
         gsLowerROI = cv::Mat(*gsLowerBuffer, ROI);
         gsUpperROI = cv::Mat(*gsUpperBuffer, ROI);
-        
-        updateHsvBuffer();
+        labelROI = cv::Mat(*labelBuffer, ROI);
+        currentROI = ROI;
         
         //Draw ROI.
-        cv::rectangle(*bgrShmemBuffer, ROI, cv::Scalar(255, 0, 0));
+        debugOverlay.addRectangle(TrackerDebugOverlay_SearchROI, ROI, cv::Scalar(255, 0, 0));
+    }
+
+    // Searches a downscaled copy of the frame (1/2^pyramid_levels per side) for the given color
+    // and returns a full resolution ROI around the (up to) max_candidate_count biggest blobs.
+    // Returns false if nothing of that color is visible, in which case the full resolution search can be skipped.
+    // Blobs only a few pixels across can average out at the coarse level, so this trades reach for speed.
+    bool computeReacquisitionROI(
+        const CommonHSVColorRange &hsvColorRange,
+        const int pyramid_levels,
+        const int max_candidate_count,
+        cv::Rect2i &out_roi)
+    {
+        const int scale = 1 << pyramid_levels;
+
+        // The downscaled frame is shared by every lost device searched this frame
+        if (pyramidFrameIndex != frameIndex || pyramidLevels != pyramid_levels)
+        {
+            cv::resize(
+                *bgrBuffer, pyramidBgrBuffer,
+                cv::Size(std::max(frameWidth / scale, 1), std::max(frameHeight / scale, 1)),
+                0, 0, cv::INTER_AREA);
+            pyramidFrameIndex = frameIndex;
+            pyramidLevels = pyramid_levels;
+        }
+
+        // The fused kernel never writes out an HSV image, so there is nothing to cache at this level
+        pyramidMask.create(pyramidBgrBuffer.rows, pyramidBgrBuffer.cols, CV_8UC1);
+        thresholdBGRByHSVRange(
+            pyramidBgrBuffer.data, static_cast<int>(pyramidBgrBuffer.step),
+            pyramidMask.data, static_cast<int>(pyramidMask.step),
+            pyramidBgrBuffer.cols, pyramidBgrBuffer.rows,
+            HSVThresholdRange::fromColorRange(hsvColorRange));
+
+        if (blobExtractor.extractBlobs(pyramidMask) <= 0)
+        {
+            return false;
+        }
+
+        std::vector<int> candidate_blob_indices;
+        blobExtractor.selectLargestBlobs(max_candidate_count, candidate_blob_indices);
+
+        cv::Rect2i candidate_bounds = blobExtractor.getBlob(candidate_blob_indices[0]).bounding_box;
+        for (size_t candidate_index = 1; candidate_index < candidate_blob_indices.size(); ++candidate_index)
+        {
+            candidate_bounds |= blobExtractor.getBlob(candidate_blob_indices[candidate_index]).bounding_box;
+        }
+
+        // Scale back up, padding by a coarse pixel to cover the blob edges that averaged away
+        const int padding = scale + k_reacquisition_margin_px;
+        out_roi = cv::Rect2i(
+            candidate_bounds.x*scale - padding,
+            candidate_bounds.y*scale - padding,
+            candidate_bounds.width*scale + 2*padding,
+            candidate_bounds.height*scale + 2*padding);
+
+        return true;
     }
 
     // Return points in raw image space:
     // i.e. [0, 0] at lower left  to [frameWidth-1, frameHeight-1] at lower right
     bool computeBiggestNContours(
         const CommonHSVColorRange &hsvColorRange,
+        const eCommonTrackingColorID colorID,
         t_opencv_int_contour_list &out_biggest_N_contours,
         std::vector<double> &out_contour_areas,
         const int max_contour_count,
@@ -478,8 +728,25 @@ public:
         out_biggest_N_contours.clear();
         out_contour_areas.clear();
         
+        if (getIsColorLabeled(colorID))
+        {
+            extractColorLabelMask(colorID);
+        }
+        else if (bUseFusedHsvThreshold)
+        {
+            // Threshold the BGR pixels directly without writing out the HSV image
+            thresholdBGRByHSVRange(
+                bgrROI.data, static_cast<int>(bgrROI.step),
+                gsLowerROI.data, static_cast<int>(gsLowerROI.step),
+                bgrROI.cols, bgrROI.rows,
+                HSVThresholdRange::fromColorRange(hsvColorRange));
+        }
         // Clamp the HSV image, taking into account wrapping the hue angle
+        else
         {
+            // Only converts the parts of the ROI not already converted this frame
+            updateHsvBuffer(currentROI);
+
             const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
             const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
             const float saturation_min = clampf(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255);
@@ -527,77 +794,109 @@ public:
         
         //TODO: Why no blurring of the gsLowerBuffer?
 
-        // Find the largest convex blob in the filtered grayscale buffer
+        draw_mask();
+
+        // Label every blob in the mask, but only trace the contours of the biggest ones
+        blobExtractor.extractBlobs(gsLowerROI);
+
+        return selectBiggestNContours(
+            nullptr, out_biggest_N_contours, out_contour_areas, max_contour_count, min_points_in_contour);
+    }
+
+    // Classifies the current ROI against every tracked color at once (cached for the rest of the frame)
+    // and then pulls this color's mask out of the label image into gsLowerROI.
+    // A pixel inside several colors' ranges carries all of their bits, so it counts for each of them.
+    // Only valid for colors in the color label table (see getIsColorLabeled).
+    void extractColorLabelMask(const eCommonTrackingColorID colorID)
+    {
+        updateLabelBuffer(currentROI);
+        cv::bitwise_and(labelROI, cv::Scalar(1 << colorID), gsLowerROI);
+    }
+
+    // Records the mask last written to gsLowerROI on the debug overlay
+    void draw_mask()
+    {
+        cv::Size size; cv::Point ofs;
+        gsLowerROI.locateROI(size, ofs);
+        debugOverlay.addMask(TrackerDebugOverlay_Masks, gsLowerROI, ofs, cv::Scalar(0, 255, 0));
+    }
+
+    inline bool getIsColorLabeled(const eCommonTrackingColorID colorID) const
+    {
+        return
+            colorID != eCommonTrackingColorID::INVALID_COLOR &&
+            (colorLabelTable.color_mask & (1 << colorID)) != 0;
+    }
+
+    // Traces the biggest N blobs last extracted from gsLowerROI
+    // whose centroid lies within centroid_region (in ROI coordinates, optional).
+    // Return points in raw image space.
+    bool selectBiggestNContours(
+        const cv::Rect2f *centroid_region,
+        t_opencv_int_contour_list &out_biggest_N_contours,
+        std::vector<double> &out_contour_areas,
+        const int max_contour_count,
+        const int min_points_in_contour = 6)
+    {
+        out_biggest_N_contours.clear();
+        out_contour_areas.clear();
+
+        cv::Size size; cv::Point ofs;
+        gsLowerROI.locateROI(size, ofs);
+
+        // Find the largest blobs in the filtered grayscale buffer
         {
-            struct ContourInfo
-            {
-                int contour_index;
-                double contour_area;
-            };
-            std::vector<ContourInfo> sorted_contour_list;
-
-            // Find all counters in the image buffer
-            cv::Size size; cv::Point ofs;
-            gsLowerROI.locateROI(size, ofs);
-            t_opencv_int_contour_list contours;
-            cv::findContours(gsLowerROI,
-                             contours,
-                             CV_RETR_EXTERNAL,
-                             CV_CHAIN_APPROX_SIMPLE,  //CV_CHAIN_APPROX_NONE?
-                             ofs);
-
-            // Compute the area of each contour
-            int contour_index = 0;
-            for (auto it = contours.begin(); it != contours.end(); ++it) 
-            {
-                const double contour_area = cv::contourArea(*it);
-                const ContourInfo contour_info = { contour_index, contour_area };
+            const int blob_count = blobExtractor.getBlobCount();
 
-                sorted_contour_list.push_back(contour_info);
-                ++contour_index;
-            }
-            
-            // Sort the list of contours by area, largest to smallest
-            if (sorted_contour_list.size() > 1)
-            {
-                std::sort(
-                    sorted_contour_list.begin(), sorted_contour_list.end(), 
-                    [](const ContourInfo &a, const ContourInfo &b) {
-                        return b.contour_area < a.contour_area;
-                });
-            }
+            // Blobs whose contour is too short get skipped,
+            // so keep widening the candidate list until we have N valid contours or run out of blobs
+            std::vector<int> candidate_blob_indices;
+            int candidate_count = max_contour_count;
+            int tested_count = 0;
 
-            // Copy up to N valid contours
-            for (auto it = sorted_contour_list.begin(); 
-                it != sorted_contour_list.end() && static_cast<int>(out_biggest_N_contours.size()) < max_contour_count; 
-                ++it)
+            while (static_cast<int>(out_biggest_N_contours.size()) < max_contour_count && tested_count < blob_count)
             {
-                const ContourInfo &contour_info = *it;
-                t_opencv_int_contour &contour = contours[contour_info.contour_index];
+                // Candidates come back largest first, and each wider list starts with the previous one
+                blobExtractor.selectLargestBlobs(candidate_count, candidate_blob_indices, centroid_region);
 
-                if (contour.size() > min_points_in_contour)
+                for (int candidate_index = tested_count;
+                    candidate_index < static_cast<int>(candidate_blob_indices.size()) &&
+                    static_cast<int>(out_biggest_N_contours.size()) < max_contour_count;
+                    ++candidate_index)
                 {
-                    // Remove any points in contour on edge of camera/ROI
-                    // TODO: Contours touching image border will be clipped,
-                    // so this might not be necessary.
-                    t_opencv_int_contour::iterator it = contour.begin();
-                    while (it != contour.end()) 
+                    t_opencv_int_contour contour;
+
+                    if (blobExtractor.traceBlobContour(candidate_blob_indices[candidate_index], ofs, contour) &&
+                        contour.size() > min_points_in_contour)
                     {
-                        if (it->x == 0 || it->x == (frameWidth - 1) || it->y == 0 || it->y == (frameHeight - 1))
-                        {
-                            it = contour.erase(it);
-                        }
-                        else
-                        {
-                            ++it;
-                        }
+                        const double contour_area = cv::contourArea(contour);
+
+                        // Remove any points in contour on edge of camera/ROI
+                        // TODO: Contours touching image border will be clipped,
+                        // so this might not be necessary.
+                        contour.erase(
+                            std::remove_if(
+                                contour.begin(), contour.end(),
+                                [this](const cv::Point &point) {
+                                    return point.x == 0 || point.x == (frameWidth - 1) || point.y == 0 || point.y == (frameHeight - 1);
+                                }),
+                            contour.end());
+
+                        // Add cleaned up contour to the output list
+                        out_biggest_N_contours.push_back(std::move(contour));
+                        // Add its area to the output list too.
+                        out_contour_areas.push_back(contour_area);
                     }
+                }
 
-                    // Add cleaned up contour to the output list
-                    out_biggest_N_contours.push_back(contour);
-                    // Add its area to the output list too.
-                    out_contour_areas.push_back(contour_info.contour_area);
+                // Ran out of blobs that pass the filter
+                if (static_cast<int>(candidate_blob_indices.size()) <= tested_count)
+                {
+                    break;
                 }
+
+                tested_count = static_cast<int>(candidate_blob_indices.size());
+                candidate_count *= 2;
             }
         }
 
@@ -607,21 +906,38 @@ public:
     void
     draw_contour(const t_opencv_int_contour &contour)
     {
-        // Draws the contour directly onto the shared mem buffer.
+        // Records the contour on the debug overlay.
         // This is useful for debugging
-        std::vector<t_opencv_int_contour> contours = {contour};
+        if (!debugOverlay.getIsLayerEnabled(TrackerDebugOverlay_Contours))
+        {
+            return;
+        }
+
         const cv::Point2f massCenter = computeSafeCenterOfMassForContour<t_opencv_int_contour>(contour);
-        cv::drawContours(*bgrShmemBuffer, contours, 0, cv::Scalar(255, 255, 255));
-        cv::rectangle(*bgrShmemBuffer, cv::boundingRect(contour), cv::Scalar(255, 255, 255));
-        cv::drawMarker(*bgrShmemBuffer, massCenter, cv::Scalar(255, 255, 255), 0,
-            (cv::boundingRect(contour).height < cv::boundingRect(contour).width) ?
-            cv::boundingRect(contour).height : cv::boundingRect(contour).width);
+        const cv::Rect2i boundingRect = cv::boundingRect(contour);
+        debugOverlay.addContour(TrackerDebugOverlay_Contours, contour, cv::Scalar(255, 255, 255));
+        debugOverlay.addRectangle(TrackerDebugOverlay_Contours, boundingRect, cv::Scalar(255, 255, 255));
+        debugOverlay.addMarker(TrackerDebugOverlay_Contours, massCenter,
+            (boundingRect.height < boundingRect.width) ? boundingRect.height : boundingRect.width,
+            cv::Scalar(255, 255, 255));
+    }
+
+    void
+    draw_predicted_roi(const cv::Rect2i &roi)
+    {
+        // Records the ROI the pose filter predicted, before it gets clamped to the frame
+        debugOverlay.addRectangle(TrackerDebugOverlay_PredictedROI, roi, cv::Scalar(0, 255, 255));
     }
     
     void
     draw_pose_projection(const CommonDeviceTrackingProjection &pose_projection)
     {
-        // Draw the projection of the pose onto the shared mem buffer.
+        // Record the projection of the pose on the debug overlay.
+        if (!debugOverlay.getIsLayerEnabled(TrackerDebugOverlay_Projections))
+        {
+            return;
+        }
+
         switch (pose_projection.shape_type)
         {
         case eCommonTrackingProjectionType::ProjectionType_Ellipse:
@@ -637,14 +953,15 @@ public:
                     static_cast<int>(pose_projection.shape.ellipse.half_x_extent),
                     static_cast<int>(pose_projection.shape.ellipse.half_y_extent));
 
-                //Draw ellipse on bgrShmemBuffer
-                cv::ellipse(*bgrShmemBuffer,
+                //Draw ellipse on the overlay
+                debugOverlay.addEllipse(TrackerDebugOverlay_Projections,
                     ell_center,
                     ell_size,
                     pose_projection.shape.ellipse.angle,
-                    0, 360, cv::Scalar(0, 0, 255));
-                cv::drawMarker(*bgrShmemBuffer, ell_center, cv::Scalar(0, 0, 255), 0,
-                    (ell_size.height < ell_size.width) ? ell_size.height * 2 : ell_size.width * 2);
+                    cv::Scalar(0, 0, 255));
+                debugOverlay.addMarker(TrackerDebugOverlay_Projections, ell_center,
+                    (ell_size.height < ell_size.width) ? ell_size.height * 2 : ell_size.width * 2,
+                    cv::Scalar(0, 0, 255));
             } break;
         case eCommonTrackingProjectionType::ProjectionType_LightBar:
             {
@@ -659,7 +976,7 @@ public:
                     cv::Point pt2(
                         static_cast<int>(pose_projection.shape.lightbar.quad[point_index].x),
                         static_cast<int>(pose_projection.shape.lightbar.quad[point_index].y));
-                    cv::line(*bgrShmemBuffer, pt1, pt2, cv::Scalar(0, 0, 255));
+                    debugOverlay.addLine(TrackerDebugOverlay_Projections, pt1, pt2, cv::Scalar(0, 0, 255));
 
                     prev_point_index = point_index;
                 }
@@ -673,7 +990,7 @@ public:
                     cv::Point pt2(
                         static_cast<int>(pose_projection.shape.lightbar.triangle[point_index].x),
                         static_cast<int>(pose_projection.shape.lightbar.triangle[point_index].y));
-                    cv::line(*bgrShmemBuffer, pt1, pt2, cv::Scalar(0, 0, 255));
+                    debugOverlay.addLine(TrackerDebugOverlay_Projections, pt1, pt2, cv::Scalar(0, 0, 255));
 
                     prev_point_index = point_index;
                 }
@@ -686,7 +1003,7 @@ public:
                     cv::Point pt(
                         static_cast<int>(pose_projection.shape.points.point[point_index].x),
                         static_cast<int>(pose_projection.shape.points.point[point_index].y));
-                    cv::drawMarker(*bgrShmemBuffer, pt, cv::Scalar(0, 0, 255));
+                    debugOverlay.addMarker(TrackerDebugOverlay_Projections, pt, 20, cv::Scalar(0, 0, 255));
                 }
             } break;
         default:
@@ -695,11 +1012,18 @@ public:
         }		
     }
 
+    // Draws the given layers of the recorded debug overlay over a copy of the current frame in bgrShmemBuffer
+    void renderDebugOverlay(unsigned int layers)
+    {
+        debugOverlay.render(*bgrBuffer, *bgrShmemBuffer, layers);
+    }
+
     int frameWidth;
     int frameHeight;
 
-    cv::Mat *bgrBuffer; // source video frame
-    cv::Mat *bgrShmemBuffer; //Frame onto which we draw debug lines, and transmit via shared mem.
+    TrackerVideoFrameRef videoFrame; // keeps the captured frame bgrBuffer points into from being captured over
+    cv::Mat *bgrBuffer; // source video frame (read only, points into videoFrame)
+    cv::Mat *bgrShmemBuffer; //Frame onto which we render the debug overlay, and transmit via shared mem.
     cv::Mat bgrROI;
     cv::Mat *hsvBuffer; // source frame converted to HSV color space
     cv::Mat hsvROI;
@@ -708,10 +1032,90 @@ public:
     cv::Mat *gsUpperBuffer; // HSV image clamped by HSV range into grayscale mask
     cv::Mat gsUpperROI;
     cv::Mat *maskedBuffer; // bgr image ANDed together with grayscale mask
+    cv::Mat *labelBuffer; // bitmask of the tracking colors each HSV pixel matches
+    cv::Mat labelROI;
+    cv::Mat pyramidBgrBuffer; // downscaled source frame for reacquisition searches
+    cv::Mat pyramidMask; // pyramidBgrBuffer thresholded by the color being reacquired
+    cv::Rect2i currentROI;
     OpenCVBGRToHSVMapper *bgr2hsv; // Used to convert an rgb image to an hsv image
+    OpenCVColorLabelTable colorLabelTable; // Used to convert an hsv image to a color label image
+    OpenCVBlobExtractor blobExtractor; // Used to find the biggest blobs in gsLowerROI
+    TrackerDebugOverlay debugOverlay; // Debug drawing recorded for the current frame
+
+    int frameIndex; // incremented every time a new video frame is written
+    int hsvTileColumns;
+    int hsvTileRows;
+    std::vector<int> hsvTileFrameIndex; // frame index each HSV tile was last converted on
+    std::vector<int> labelTileFrameIndex; // frame index each label tile was last converted on
+    int pyramidFrameIndex; // frame index pyramidBgrBuffer was last downscaled on
+    int pyramidLevels; // number of halvings pyramidBgrBuffer was downscaled by
+
+    bool bUseFusedHsvThreshold; // threshold straight from BGR instead of going through hsvBuffer
+};
+
+enum eTrackerVisionTargetType
+{
+    _TrackerVisionTarget_Controller,
+    _TrackerVisionTarget_HMD
+};
+
+// Everything needed to find the projection of one tracked device in a video frame.
+// Gathered on the main thread so that the projection can be computed without
+// touching any controller, HMD or tracker state (i.e. on the vision worker thread).
+struct TrackerVisionRequest
+{
+    eTrackerVisionTargetType target_type;
+    int target_device_id;
+    CommonDeviceTrackingShape tracking_shape;
+    CommonHSVColorRange hsv_color_range;
+    eCommonTrackingColorID tracked_color_id;
+    cv::Rect2i roi;
+    bool bRoiDisabled;
+    // Device isn't being tracked, so the roi is the full frame
+    bool bReacquiring;
+    // Pyramid level searched first when reacquiring (0 = search the full resolution frame)
+    int reacquisition_pyramid_levels;
+    float min_valid_projection_area;
+    cv::Matx33f camera_matrix;
+    cv::Matx<float, 5, 1> distortions;
+    // Built from camera_matrix and distortions, shared with the tracker so it outlives intrinsics changes
+    std::shared_ptr<const OpenCVUndistortionCache> undistortion_cache;
+    CommonDevicePose tracker_pose_guess;
+    bool bTrackerPoseGuessValid;
+    // The IMU keeps the orientation good even when the position guess isn't
+    bool bTrackerOrientationGuessValid;
+    // Point cloud pose solver time limit
+    int point_cloud_pose_budget_us;
+};
+
+struct TrackerVisionResult
+{
+    eTrackerVisionTargetType target_type;
+    int target_device_id;
+    CommonDeviceTrackingProjection projection;
+    CommonDevicePosition position_cm;
+    CommonDeviceQuaternion orientation;
+    bool bPositionValid;
+    bool bOrientationValid;
+    // Capture time of the video frame the projection was found in
+    std::chrono::steady_clock::time_point capture_time;
 };
 
 // -- Utility Methods -----
+static bool computeProjectionForVisionRequest(
+    OpenCVBufferState *buffer_state,
+    const ITrackerInterface *tracker_device,
+    const TrackerVisionRequest &request,
+    TrackerVisionResult &out_result);
+static void computeProjectionsForVisionRequests(
+    OpenCVBufferState *buffer_state,
+    const ITrackerInterface *tracker_device,
+    const std::vector<TrackerVisionRequest> &requests,
+    std::vector<TrackerVisionResult> &out_results);
+template <typename t_optical_pose_estimation>
+static void applyVisionResultToPoseEstimate(
+    const TrackerVisionResult &result,
+    t_optical_pose_estimation *out_pose_estimate);
 static glm::quat computeGLMCameraTransformQuaternion(const ITrackerInterface *tracker_device);
 static glm::mat4 computeGLMCameraTransformMatrix(const ITrackerInterface *tracker_device);
 static void computeOpenCVCameraExtrinsicMatrix(const ITrackerInterface *tracker_device,
@@ -732,16 +1136,16 @@ static bool computeTrackerRelativeLightBarPose(
     const CommonDevicePose *tracker_relative_pose_guess,
     ControllerOpticalPoseEstimation *out_pose_estimate);
 static bool computeTrackerRelativePointCloudContourPose(
-    const ITrackerInterface *tracker_device,
-    const CommonDeviceTrackingShape *tracking_shape,
+    const TrackerVisionRequest &request,
     const t_opencv_float_contour_list &opencv_contours,
-    const CommonDevicePose *tracker_relative_pose_guess,
     HMDOpticalPoseEstimation *out_pose_estimate);
 static cv::Rect2i computeTrackerROIForPoseProjection(
     const bool disabled_roi,
     const ServerTrackerView *tracker,
     const IPoseFilter* pose_filter,
     const CommonDeviceTrackingProjection *prior_tracking_projection,
+    const CommonDeviceVector *prior_tracker_relative_velocity,
+    const float prior_projection_age,
     const CommonDeviceTrackingShape *tracking_shape);
 static bool computeBestFitTriangleForContour(
     const t_opencv_float_contour &opencv_contour,
@@ -769,116 +1173,623 @@ static void angleAxisVectorToCommonDeviceOrientation(
     const float axis_x, const float axis_y, const float axis_z, const float radians,
     CommonDeviceQuaternion &orientation);
 
-//-- public implementation -----
-ServerTrackerView::ServerTrackerView(const int device_id)
-    : ServerDeviceView(device_id)
-    , m_shared_memory_accesor(nullptr)
-    , m_shared_memory_video_stream_count(0)
-    , m_opencv_buffer_state(nullptr)
-    , m_device(nullptr)
-{
-    ServerUtility::format_string(m_shared_memory_name, sizeof(m_shared_memory_name), "tracker_view_%d", device_id);
-}
-
-ServerTrackerView::~ServerTrackerView()
+// The shared memory blocks a tracker's video gets streamed through, one per requested format.
+// The full BGR block always exists (clients find it by the tracker's shared memory name).
+// The other formats get a block while at least one client streams them.
+// Each frame is converted once per active format, regardless of how many clients read it.
+class SharedVideoFrameStreamSet
 {
-    if (m_shared_memory_accesor != nullptr)
+public:
+    SharedVideoFrameStreamSet(const char *base_name)
+        : m_base_name(base_name)
+        , m_frame_width(0)
+        , m_frame_height(0)
+        , m_bAllocated(false)
     {
-        delete m_shared_memory_accesor;
+        for (int format_index = 0; format_index < SharedVideoFrameFormat_Count; ++format_index)
+        {
+            m_accesors[format_index] = nullptr;
+        }
     }
 
-    if (m_opencv_buffer_state != nullptr)
+    ~SharedVideoFrameStreamSet()
     {
-        delete m_opencv_buffer_state;
+        dispose();
     }
 
-    if (m_device != nullptr)
+    // (Re)creates the blocks of every format in use for the given capture size
+    void allocate(int frame_width, int frame_height)
     {
-        delete m_device;
-    }
-}
+        dispose();
 
-CommonDeviceState::eDeviceType
-ServerTrackerView::getTrackerDeviceType() const
-{
-    return m_device->getDeviceType();
-}
+        m_frame_width = frame_width;
+        m_frame_height = frame_height;
+        m_bAllocated = true;
 
-ITrackerInterface::eDriverType 
-ServerTrackerView::getTrackerDriverType() const
-{
-    return m_device->getDriverType();
-}
+        for (int format_index = 0; format_index < SharedVideoFrameFormat_Count; ++format_index)
+        {
+            const eSharedVideoFrameFormat format = static_cast<eSharedVideoFrameFormat>(format_index);
 
-std::string
-ServerTrackerView::getUSBDevicePath() const
-{
-    return m_device->getUSBDevicePath();
-}
+            if (format == SharedVideoFrameFormat_BGR || m_stream_layers[format_index].size() > 0)
+            {
+                allocateFormat(format);
+            }
+        }
+    }
 
-std::string 
-ServerTrackerView::getSharedMemoryStreamName() const
-{
-    return std::string(m_shared_memory_name);
-}
+    // Frees all of the blocks, but remembers which streams are running
+    void dispose()
+    {
+        for (int format_index = 0; format_index < SharedVideoFrameFormat_Count; ++format_index)
+        {
+            freeFormat(static_cast<eSharedVideoFrameFormat>(format_index));
+        }
 
-bool ServerTrackerView::open(const class DeviceEnumerator *enumerator)
-{
-    bool bSuccess = ServerDeviceView::open(enumerator);
+        m_bAllocated = false;
+    }
 
-    if (bSuccess)
+    // Keeps track of a client streaming the given format with the given (resolved) overlay layers
+    void startStream(eSharedVideoFrameFormat format, unsigned int debug_overlay_layers)
     {
-        int width, height, stride;
-
-        // Make sure the shared memory block has been removed first
-        boost::interprocess::shared_memory_object::remove(m_shared_memory_name);
+        m_stream_layers[format].push_back(debug_overlay_layers);
 
-        // Query the video frame first so that we know how big to make the buffer
-        if (m_device->getVideoFrameDimensions(&width, &height, &stride))
+        if (m_bAllocated && m_accesors[format] == nullptr)
         {
-            assert(m_shared_memory_accesor == nullptr);
-            m_shared_memory_accesor = new SharedVideoFrameReadWriteAccessor();
-
-            if (!m_shared_memory_accesor->initialize(m_shared_memory_name, width, height, stride))
-            {
-                delete m_shared_memory_accesor;
-                m_shared_memory_accesor = nullptr;
+            allocateFormat(format);
+        }
+    }
 
-                SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to allocated shared memory: " << m_shared_memory_name;
-            }
+    void stopStream(eSharedVideoFrameFormat format, unsigned int debug_overlay_layers)
+    {
+        std::vector<unsigned int> &stream_layers = m_stream_layers[format];
 
-            // Allocate the OpenCV scratch buffers used for finding tracking blobs
-            m_opencv_buffer_state = new OpenCVBufferState(m_device);
+        auto it = std::find(stream_layers.begin(), stream_layers.end(), debug_overlay_layers);
+        assert(it != stream_layers.end());
+        if (it != stream_layers.end())
+        {
+            stream_layers.erase(it);
         }
-        else
+
+        if (stream_layers.size() == 0 && format != SharedVideoFrameFormat_BGR)
         {
-            SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to video frame dimensions";
+            freeFormat(format);
         }
     }
 
-    return bSuccess;
-}
-
-void ServerTrackerView::close()
-{
-    if (m_shared_memory_accesor != nullptr)
+    inline bool getIsAllocated() const
     {
-        delete m_shared_memory_accesor;
-        m_shared_memory_accesor = nullptr;
+        return m_bAllocated;
     }
 
-    ServerDeviceView::close();
-}
-
-void ServerTrackerView::startSharedMemoryVideoStream()
-{
-    ++m_shared_memory_video_stream_count;
-}
+    // True if any client is streaming a format that has a block
+    bool getHasActiveStreams() const
+    {
+        for (int format_index = 0; format_index < SharedVideoFrameFormat_Count; ++format_index)
+        {
+            if (m_accesors[format_index] != nullptr && m_stream_layers[format_index].size() > 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Debug overlay layers the vision stage has to record to serve every stream (0 when nobody is watching)
+    unsigned int getRecordedLayers() const
+    {
+        unsigned int layers = 0;
+
+        for (int format_index = 0; format_index < SharedVideoFrameFormat_Count; ++format_index)
+        {
+            if (m_accesors[format_index] != nullptr)
+            {
+                layers |= computeFormatLayers(static_cast<eSharedVideoFrameFormat>(format_index));
+            }
+        }
+
+        return layers;
+    }
+
+    // Converts the buffer state's current frame into every format being streamed and publishes it
+    void writeVideoFrame(OpenCVBufferState *buffer_state)
+    {
+        const std::chrono::steady_clock::time_point capture_time = buffer_state->videoFrame.getCaptureTime();
+        const cv::Mat &overlayFrame = *buffer_state->bgrShmemBuffer;
+        bool bOverlayRendered = false;
+        unsigned int overlay_layers = 0;
+
+        for (int format_index = 0; format_index < SharedVideoFrameFormat_Count; ++format_index)
+        {
+            const eSharedVideoFrameFormat format = static_cast<eSharedVideoFrameFormat>(format_index);
+            SharedVideoFrameReadWriteAccessor *accesor = m_accesors[format_index];
+
+            if (accesor == nullptr || m_stream_layers[format_index].size() == 0)
+            {
+                continue;
+            }
+
+            const unsigned int format_layers = computeFormatLayers(format);
+            cv::Mat &formatFrame = m_format_buffers[format_index];
+
+            // The BGR and gray formats start from the frame with the overlay drawn over it.
+            // Formats showing the same layers share one render.
+            if (format != SharedVideoFrameFormat_Mask &&
+                format != SharedVideoFrameFormat_MaskOverlay &&
+                (!bOverlayRendered || overlay_layers != format_layers))
+            {
+                buffer_state->renderDebugOverlay(format_layers);
+                bOverlayRendered = true;
+                overlay_layers = format_layers;
+            }
+
+            switch (format)
+            {
+            case SharedVideoFrameFormat_BGR:
+                {
+                    accesor->writeVideoFrame(overlayFrame.data, capture_time);
+                } break;
+            case SharedVideoFrameFormat_HalfBGR:
+            case SharedVideoFrameFormat_QuarterBGR:
+                {
+                    cv::resize(overlayFrame, formatFrame, computeFormatSize(format), 0, 0, cv::INTER_AREA);
+                    accesor->writeVideoFrame(formatFrame.data, capture_time);
+                } break;
+            case SharedVideoFrameFormat_Gray:
+                {
+                    cv::cvtColor(overlayFrame, formatFrame, cv::COLOR_BGR2GRAY);
+                    accesor->writeVideoFrame(formatFrame.data, capture_time);
+                } break;
+            case SharedVideoFrameFormat_Mask:
+                {
+                    buffer_state->debugOverlay.renderMasks(computeFormatSize(format), formatFrame);
+                    accesor->writeVideoFrame(formatFrame.data, capture_time);
+                } break;
+            case SharedVideoFrameFormat_MaskOverlay:
+                {
+                    formatFrame.create(computeFormatSize(format), CV_8UC3);
+                    formatFrame.setTo(cv::Scalar(0, 0, 0));
+                    buffer_state->debugOverlay.draw(formatFrame, format_layers);
+                    accesor->writeVideoFrame(formatFrame.data, capture_time);
+                } break;
+            default:
+                assert(0 && "unreachable");
+            }
+        }
+    }
+
+private:
+    // Layers shown by every stream of the format.
+    // The mask formats are built from the recorded masks, so they always need them.
+    unsigned int computeFormatLayers(eSharedVideoFrameFormat format) const
+    {
+        const std::vector<unsigned int> &stream_layers = m_stream_layers[format];
+        unsigned int layers = 0;
+
+        for (unsigned int layer_mask : stream_layers)
+        {
+            layers |= layer_mask;
+        }
+
+        if (stream_layers.size() > 0)
+        {
+            if (format == SharedVideoFrameFormat_Mask)
+            {
+                layers = TrackerDebugOverlay_Masks;
+            }
+            else if (format == SharedVideoFrameFormat_MaskOverlay)
+            {
+                layers |= TrackerDebugOverlay_Masks;
+            }
+        }
+
+        return layers;
+    }
+
+    cv::Size computeFormatSize(eSharedVideoFrameFormat format) const
+    {
+        const int downscale = getSharedVideoFrameFormatDownscale(format);
+
+        return cv::Size(std::max(m_frame_width / downscale, 1), std::max(m_frame_height / downscale, 1));
+    }
+
+    void allocateFormat(eSharedVideoFrameFormat format)
+    {
+        assert(m_accesors[format] == nullptr);
+
+        const cv::Size format_size = computeFormatSize(format);
+        const int stride = format_size.width * getSharedVideoFrameFormatChannelCount(format);
+        const std::string name = getSharedVideoFrameStreamName(m_base_name, format);
+
+        SharedVideoFrameReadWriteAccessor *accesor = new SharedVideoFrameReadWriteAccessor();
+        if (accesor->initialize(name.c_str(), format, format_size.width, format_size.height, stride))
+        {
+            m_accesors[format] = accesor;
+        }
+        else
+        {
+            delete accesor;
+
+            SERVER_LOG_ERROR("SharedVideoFrameStreamSet::allocateFormat()") << "Failed to allocated shared memory: " << name;
+        }
+    }
+
+    void freeFormat(eSharedVideoFrameFormat format)
+    {
+        if (m_accesors[format] != nullptr)
+        {
+            delete m_accesors[format];
+            m_accesors[format] = nullptr;
+        }
+
+        m_format_buffers[format].release();
+    }
+
+    std::string m_base_name;
+    int m_frame_width;
+    int m_frame_height;
+    bool m_bAllocated;
+    SharedVideoFrameReadWriteAccessor *m_accesors[SharedVideoFrameFormat_Count];
+    std::vector<unsigned int> m_stream_layers[SharedVideoFrameFormat_Count]; // resolved overlay layers of each client stream
+    cv::Mat m_format_buffers[SharedVideoFrameFormat_Count]; // converted frames waiting to be copied to shared memory
+};
+
+// Runs the blob finding for a single tracker on a dedicated thread.
+// The main thread fills the OpenCVBufferState with a new frame while the worker is idle,
+// queues up requests against that frame and then dispatches them. 
+// The worker owns the buffer state until it has finished processing the frame.
+class TrackerVisionWorker
+{
+public:
+    TrackerVisionWorker(const int tracker_id)
+        : m_tracker_id(tracker_id)
+        , m_thread_started(false)
+        , m_buffer_state(nullptr)
+        , m_device(nullptr)
+        , m_shared_memory_streams(nullptr)
+        , m_exit_signaled(false)
+        , m_work_pending(false)
+    {}
+
+    ~TrackerVisionWorker()
+    {
+        stopWorkerThread();
+    }
+
+    void startWorkerThread()
+    {
+        if (!m_thread_started)
+        {
+            SERVER_LOG_INFO("TrackerVisionWorker::startWorkerThread") << "Starting vision thread for tracker " << m_tracker_id;
+            m_exit_signaled = false;
+            m_worker_thread = std::thread(&TrackerVisionWorker::workerThreadFunc, this);
+            m_thread_started = true;
+        }
+    }
+
+    void stopWorkerThread()
+    {
+        if (m_thread_started)
+        {
+            SERVER_LOG_INFO("TrackerVisionWorker::stopWorkerThread") << "Stopping vision thread for tracker " << m_tracker_id;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_exit_signaled = true;
+            }
+            m_work_condition.notify_one();
+            m_worker_thread.join();
+
+            m_thread_started = false;
+            m_work_pending = false;
+            m_queued_requests.clear();
+            m_active_requests.clear();
+            m_completed_results.clear();
+        }
+    }
+
+    // Returns true while the worker thread still owns the buffer state of the last dispatched frame
+    inline bool getIsBusy() const
+    {
+        return m_work_pending;
+    }
+
+    // Blocks until the worker thread has finished the last dispatched frame
+    void waitForIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle_condition.wait(lock, [this] { return !m_work_pending; });
+    }
+
+    inline void addRequest(const TrackerVisionRequest &request)
+    {
+        m_queued_requests.push_back(request);
+    }
+
+    inline void clearRequests()
+    {
+        m_queued_requests.clear();
+    }
+
+    inline bool getHasQueuedRequests() const
+    {
+        return m_queued_requests.size() > 0;
+    }
+
+    // Hand the queued requests to the worker thread.
+    // The buffer state must already hold the frame the requests were made against.
+    // If a shared memory stream set is given the worker also publishes the (debug annotated) frame.
+    bool dispatchRequests(
+        OpenCVBufferState *buffer_state,
+        const ITrackerInterface *device,
+        SharedVideoFrameStreamSet *shared_memory_streams)
+    {
+        bool bDispatched = false;
+
+        if (!m_work_pending && m_thread_started &&
+            (m_queued_requests.size() > 0 || shared_memory_streams != nullptr))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_active_requests.swap(m_queued_requests);
+            m_queued_requests.clear();
+            m_buffer_state = buffer_state;
+            m_device = device;
+            m_shared_memory_streams = shared_memory_streams;
+            m_work_pending = true;
+
+            bDispatched = true;
+        }
+
+        if (bDispatched)
+        {
+            m_work_condition.notify_one();
+        }
 
-void ServerTrackerView::stopSharedMemoryVideoStream()
+        return bDispatched;
+    }
+
+    // Remove the result for the given device from the completed result list (if any)
+    bool fetchResult(
+        const eTrackerVisionTargetType target_type,
+        const int target_device_id,
+        TrackerVisionResult &out_result)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bool bFound = false;
+
+        for (auto it = m_completed_results.begin(); it != m_completed_results.end(); ++it)
+        {
+            if (it->target_type == target_type && it->target_device_id == target_device_id)
+            {
+                out_result = *it;
+                m_completed_results.erase(it);
+                bFound = true;
+                break;
+            }
+        }
+
+        return bFound;
+    }
+
+protected:
+    void workerThreadFunc()
+    {
+        std::vector<TrackerVisionResult> results;
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (!m_exit_signaled)
+        {
+            m_work_condition.wait(lock, [this] { return m_exit_signaled || m_work_pending; });
+
+            if (m_exit_signaled)
+            {
+                break;
+            }
+
+            // The main thread won't touch the request list or buffer state while work is pending
+            lock.unlock();
+
+            results.clear();
+            computeProjectionsForVisionRequests(m_buffer_state, m_device, m_active_requests, results);
+
+            if (m_shared_memory_streams != nullptr)
+            {
+                m_shared_memory_streams->writeVideoFrame(m_buffer_state);
+            }
+
+            lock.lock();
+
+            // Any results from the previous frame that never got fetched are stale now
+            m_completed_results.swap(results);
+            m_work_pending = false;
+            m_idle_condition.notify_all();
+
+            // Wake the main thread to fold the results into the pose filters
+            ServerUpdateSignal::signal();
+        }
+
+        m_work_pending = false;
+        m_idle_condition.notify_all();
+    }
+
+private:
+    int m_tracker_id;
+
+    // Main thread state
+    std::vector<TrackerVisionRequest> m_queued_requests;
+    bool m_thread_started;
+
+    // Worker thread state (only touched by the main thread while no work is pending)
+    std::vector<TrackerVisionRequest> m_active_requests;
+    OpenCVBufferState *m_buffer_state;
+    const ITrackerInterface *m_device;
+    SharedVideoFrameStreamSet *m_shared_memory_streams;
+
+    // Shared state
+    std::mutex m_mutex;
+    std::condition_variable m_work_condition;
+    std::condition_variable m_idle_condition;
+    std::atomic_bool m_exit_signaled;
+    std::atomic_bool m_work_pending;
+    std::vector<TrackerVisionResult> m_completed_results;
+    std::thread m_worker_thread;
+};
+
+//-- public implementation -----
+ServerTrackerView::ServerTrackerView(const int device_id)
+    : ServerDeviceView(device_id)
+    , m_shared_memory_streams(nullptr)
+    , m_opencv_buffer_state(nullptr)
+    , m_vision_worker(nullptr)
+    , m_bHasVisionFrame(false)
+    , m_undistortion_cache()
+    , m_projection_matrix()
+    , m_bProjectionMatrixValid(false)
+    , m_vision_frame_index(0)
+    , m_full_frame_search_count(0)
+    , m_oldest_deferred_search_frame(std::numeric_limits<int>::max())
+    , m_next_oldest_deferred_search_frame(std::numeric_limits<int>::max())
+    , m_last_full_frame_search_frames()
+    , m_processed_vision_frame_count(0)
+    , m_dropped_vision_frame_count(0)
+    , m_bVisionFrameProcessed(false)
+    , m_bVisionFrameSkipped(false)
+    , m_device(nullptr)
+{
+    ServerUtility::format_string(m_shared_memory_name, sizeof(m_shared_memory_name), "tracker_view_%d", device_id);
+    m_shared_memory_streams = new SharedVideoFrameStreamSet(m_shared_memory_name);
+}
+
+ServerTrackerView::~ServerTrackerView()
+{
+    if (m_vision_worker != nullptr)
+    {
+        delete m_vision_worker;
+    }
+
+    if (m_shared_memory_streams != nullptr)
+    {
+        delete m_shared_memory_streams;
+    }
+
+    if (m_opencv_buffer_state != nullptr)
+    {
+        delete m_opencv_buffer_state;
+    }
+
+    if (m_device != nullptr)
+    {
+        delete m_device;
+    }
+}
+
+CommonDeviceState::eDeviceType
+ServerTrackerView::getTrackerDeviceType() const
+{
+    return m_device->getDeviceType();
+}
+
+ITrackerInterface::eDriverType 
+ServerTrackerView::getTrackerDriverType() const
+{
+    return m_device->getDriverType();
+}
+
+std::string
+ServerTrackerView::getUSBDevicePath() const
+{
+    return m_device->getUSBDevicePath();
+}
+
+std::string 
+ServerTrackerView::getSharedMemoryStreamName() const
+{
+    return std::string(m_shared_memory_name);
+}
+
+bool ServerTrackerView::open(const class DeviceEnumerator *enumerator)
+{
+    bool bSuccess = ServerDeviceView::open(enumerator);
+
+    if (bSuccess)
+    {
+        int width, height, stride;
+
+        // Query the video frame first so that we know how big to make the buffer
+        if (m_device->getVideoFrameDimensions(&width, &height, &stride))
+        {
+            assert(!m_shared_memory_streams->getIsAllocated());
+            m_shared_memory_streams->allocate(width, height);
+
+            // Allocate the OpenCV scratch buffers used for finding tracking blobs
+            m_opencv_buffer_state = new OpenCVBufferState(m_device);
+
+            // Optionally move the blob finding off of the main thread
+            const TrackerManagerConfig &cfg= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+            if (cfg.use_vision_worker_threads && m_vision_worker == nullptr)
+            {
+                m_vision_worker = new TrackerVisionWorker(getDeviceID());
+                m_vision_worker->startWorkerThread();
+            }
+        }
+        else
+        {
+            SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to video frame dimensions";
+        }
+    }
+
+    return bSuccess;
+}
+
+void ServerTrackerView::close()
 {
-    assert(m_shared_memory_video_stream_count > 0);
-    --m_shared_memory_video_stream_count;
+    // Stop the vision thread before freeing anything it might be using
+    if (m_vision_worker != nullptr)
+    {
+        delete m_vision_worker;
+        m_vision_worker = nullptr;
+        m_bHasVisionFrame = false;
+    }
+
+    m_shared_memory_streams->dispose();
+    m_undistortion_cache.reset();
+    m_bProjectionMatrixValid = false;
+
+    ServerDeviceView::close();
+}
+
+void ServerTrackerView::startSharedMemoryVideoStream(unsigned int debug_overlay_layers, int video_stream_format)
+{
+    assert(getIsSharedVideoFrameFormatValid(video_stream_format));
+
+    // The vision worker might be publishing to the blocks we're about to change
+    if (m_vision_worker != nullptr)
+    {
+        m_vision_worker->waitForIdle();
+    }
+
+    m_shared_memory_streams->startStream(
+        static_cast<eSharedVideoFrameFormat>(video_stream_format),
+        resolveTrackerDebugOverlayLayers(debug_overlay_layers));
+}
+
+void ServerTrackerView::stopSharedMemoryVideoStream(unsigned int debug_overlay_layers, int video_stream_format)
+{
+    assert(getIsSharedVideoFrameFormatValid(video_stream_format));
+
+    if (m_vision_worker != nullptr)
+    {
+        m_vision_worker->waitForIdle();
+    }
+
+    m_shared_memory_streams->stopStream(
+        static_cast<eSharedVideoFrameFormat>(video_stream_format),
+        resolveTrackerDebugOverlayLayers(debug_overlay_layers));
+}
+
+unsigned int ServerTrackerView::getDebugOverlayLayers() const
+{
+    return m_shared_memory_streams->getRecordedLayers();
 }
 
 bool ServerTrackerView::poll()
@@ -887,14 +1798,45 @@ bool ServerTrackerView::poll()
 
     if (bSuccess && m_device != nullptr)
     {
-        const unsigned char *buffer = m_device->getVideoFrameBuffer();
+        const TrackerVideoFrameRef video_frame = m_device->getVideoFrame();
 
-        if (buffer != nullptr)
+        if (video_frame.getIsValid() && m_opencv_buffer_state != nullptr)
         {
-            // Cache the raw video frame
-            if (m_opencv_buffer_state != nullptr)
+            // Only bother recording debug overlays someone is watching
+            const unsigned int debug_overlay_layers = getDebugOverlayLayers();
+
+            if (m_vision_worker != nullptr)
             {
-                m_opencv_buffer_state->writeVideoFrame(buffer);
+                // Requests made against the previous frame that never got dispatched are stale
+                m_vision_worker->clearRequests();
+                m_bHasVisionFrame = false;
+
+                // The vision worker owns the buffer state until it's done with the last frame.
+                // If it's still busy this frame gets skipped by the vision stage.
+                if (getHasUnpublishedState())
+                {
+                    if (m_vision_worker->getIsBusy())
+                    {
+                        ++m_dropped_vision_frame_count;
+                    }
+                    else if (m_opencv_buffer_state->writeVideoFrame(video_frame, debug_overlay_layers))
+                    {
+                        m_bHasVisionFrame = true;
+
+                        updateColorLabelTable();
+                        beginVisionFrame();
+                    }
+                }
+            }
+            else
+            {
+                // Reference the raw video frame
+                if (m_opencv_buffer_state->writeVideoFrame(video_frame, debug_overlay_layers) &&
+                    getHasUnpublishedState())
+                {
+                    updateColorLabelTable();
+                    beginVisionFrame();
+                }
             }
         }
     }
@@ -902,6 +1844,59 @@ bool ServerTrackerView::poll()
     return bSuccess;
 }
 
+void ServerTrackerView::updateColorLabelTable()
+{
+    const TrackerManagerConfig &cfg= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+
+    if (cfg.use_color_label_segmentation)
+    {
+        DeviceManager *device_manager= DeviceManager::getInstance();
+
+        // Gather the color presets of everything being tracked so that one pass
+        // over the frame can segment all of the tracked colors at once
+        OpenCVColorLabelTable table;
+        table.clear();
+
+        for (int controller_id = 0; controller_id < device_manager->getControllerViewMaxCount(); ++controller_id)
+        {
+            ServerControllerViewPtr controller_view= device_manager->getControllerViewPtr(controller_id);
+
+            if (controller_view->getIsOpen() && controller_view->getIsTrackingEnabled())
+            {
+                const eCommonTrackingColorID color_id= controller_view->getTrackingColorID();
+
+                if (color_id != eCommonTrackingColorID::INVALID_COLOR)
+                {
+                    CommonHSVColorRange hsvColorRange;
+
+                    getControllerTrackingColorPreset(controller_view.get(), color_id, &hsvColorRange);
+                    table.addColor(color_id, hsvColorRange);
+                }
+            }
+        }
+
+        for (int hmd_id = 0; hmd_id < device_manager->getHMDViewMaxCount(); ++hmd_id)
+        {
+            ServerHMDViewPtr hmd_view= device_manager->getHMDViewPtr(hmd_id);
+
+            if (hmd_view->getIsOpen() && hmd_view->getIsTrackingEnabled())
+            {
+                const eCommonTrackingColorID color_id= hmd_view->getTrackingColorID();
+
+                if (color_id != eCommonTrackingColorID::INVALID_COLOR)
+                {
+                    CommonHSVColorRange hsvColorRange;
+
+                    getHMDTrackingColorPreset(hmd_view.get(), color_id, &hsvColorRange);
+                    table.addColor(color_id, hsvColorRange);
+                }
+            }
+        }
+
+        m_opencv_buffer_state->setColorLabelTable(table);
+    }
+}
+
 bool ServerTrackerView::allocate_device_interface(const class DeviceEnumerator *enumerator)
 {
     switch (enumerator->get_device_type())
@@ -931,10 +1926,11 @@ void ServerTrackerView::free_device_interface()
 
 void ServerTrackerView::publish_device_data_frame()
 {
-    // Copy the video frame to shared memory (if requested)
-    if (m_shared_memory_accesor != nullptr && m_shared_memory_video_stream_count > 0)
+    // Copy the video frame to shared memory (if requested).
+    // When a vision worker is active it publishes the frame once it's done annotating it.
+    if (m_shared_memory_streams->getHasActiveStreams() && m_vision_worker == nullptr)
     {
-        m_shared_memory_accesor->writeVideoFrame(m_opencv_buffer_state->bgrShmemBuffer->data);
+        m_shared_memory_streams->writeVideoFrame(m_opencv_buffer_state);
     }
     
     // Tell the server request handler we want to send out tracker updates.
@@ -954,6 +1950,8 @@ void ServerTrackerView::generate_tracker_data_frame_for_stream(
     tracker_data_frame->set_tracker_id(tracker_view->getDeviceID());
     tracker_data_frame->set_sequence_num(tracker_view->m_sequence_number);
     tracker_data_frame->set_isconnected(tracker_view->getIsOpen());
+    tracker_data_frame->set_processed_vision_frame_count(tracker_view->getProcessedVisionFrameCount());
+    tracker_data_frame->set_dropped_vision_frame_count(tracker_view->getDroppedVisionFrameCount());
 
     switch (tracker_view->getTrackerDeviceType())
     {
@@ -971,6 +1969,9 @@ void ServerTrackerView::generate_tracker_data_frame_for_stream(
 void ServerTrackerView::loadSettings()
 {
     m_device->loadSettings();
+
+    // The pose and intrinsics may have changed
+    m_bProjectionMatrixValid = false;
 }
 
 void ServerTrackerView::saveSettings()
@@ -987,37 +1988,35 @@ void ServerTrackerView::setFrameWidth(double value, bool bUpdateConfig)
 {
     if (value == m_device->getFrameWidth()) return;
 
-    // close buffer
-    if (m_shared_memory_accesor != nullptr)
+    // Make sure the vision thread is done with the current buffers
+    if (m_vision_worker != nullptr)
     {
-        delete m_shared_memory_accesor;
-        m_shared_memory_accesor = nullptr;
+        m_vision_worker->waitForIdle();
+        m_vision_worker->clearRequests();
+        m_bHasVisionFrame = false;
     }
 
+    // close buffer
+    m_shared_memory_streams->dispose();
+    m_undistortion_cache.reset();
+    m_bProjectionMatrixValid = false;
+
     // change frame width
     m_device->setFrameWidth(value, bUpdateConfig);
 
     // reopen buffer
     int width, height, stride;
 
-    // Make sure the shared memory block has been removed first
-    boost::interprocess::shared_memory_object::remove(m_shared_memory_name);
-
     // Query the video frame first so that we know how big to make the buffer
     if (m_device->getVideoFrameDimensions(&width, &height, &stride))
     {
-        assert(m_shared_memory_accesor == nullptr);
-        m_shared_memory_accesor = new SharedVideoFrameReadWriteAccessor();
+        m_shared_memory_streams->allocate(width, height);
 
-        if (!m_shared_memory_accesor->initialize(m_shared_memory_name, width, height, stride))
+        // Allocate the OpenCV scratch buffers used for finding tracking blobs
+        if (m_opencv_buffer_state != nullptr)
         {
-            delete m_shared_memory_accesor;
-            m_shared_memory_accesor = nullptr;
-
-            SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to allocated shared memory: " << m_shared_memory_name;
+            delete m_opencv_buffer_state;
         }
-
-        // Allocate the OpenCV scratch buffers used for finding tracking blobs
         m_opencv_buffer_state = new OpenCVBufferState(m_device);
     }
     else
@@ -1035,37 +2034,35 @@ void ServerTrackerView::setFrameHeight(double value, bool bUpdateConfig)
 {
     if (value == m_device->getFrameHeight()) return;
 
-    // close buffer
-    if (m_shared_memory_accesor != nullptr)
+    // Make sure the vision thread is done with the current buffers
+    if (m_vision_worker != nullptr)
     {
-        delete m_shared_memory_accesor;
-        m_shared_memory_accesor = nullptr;
+        m_vision_worker->waitForIdle();
+        m_vision_worker->clearRequests();
+        m_bHasVisionFrame = false;
     }
 
+    // close buffer
+    m_shared_memory_streams->dispose();
+    m_undistortion_cache.reset();
+    m_bProjectionMatrixValid = false;
+
     // change frame height
     m_device->setFrameHeight(value, bUpdateConfig);
 
     // reopen buffer
     int width, height, stride;
 
-    // Make sure the shared memory block has been removed first
-    boost::interprocess::shared_memory_object::remove(m_shared_memory_name);
-
     // Query the video frame first so that we know how big to make the buffer
     if (m_device->getVideoFrameDimensions(&width, &height, &stride))
     {
-        assert(m_shared_memory_accesor == nullptr);
-        m_shared_memory_accesor = new SharedVideoFrameReadWriteAccessor();
+        m_shared_memory_streams->allocate(width, height);
 
-        if (!m_shared_memory_accesor->initialize(m_shared_memory_name, width, height, stride))
+        // Allocate the OpenCV scratch buffers used for finding tracking blobs
+        if (m_opencv_buffer_state != nullptr)
         {
-            delete m_shared_memory_accesor;
-            m_shared_memory_accesor = nullptr;
-
-            SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to allocated shared memory: " << m_shared_memory_name;
+            delete m_opencv_buffer_state;
         }
-
-        // Allocate the OpenCV scratch buffers used for finding tracking blobs
         m_opencv_buffer_state = new OpenCVBufferState(m_device);
     }
     else
@@ -1128,6 +2125,11 @@ void ServerTrackerView::setCameraIntrinsics(
         principalX, principalY,
         distortionK1, distortionK2, distortionK3,
         distortionP1, distortionP2);
+
+    // Rebuilt from the new intrinsics by the next vision request.
+    // Requests already in flight keep their own reference to the old cache.
+    m_undistortion_cache.reset();
+    m_bProjectionMatrixValid = false;
 }
 
 CommonDevicePose ServerTrackerView::getTrackerPose() const
@@ -1139,6 +2141,18 @@ void ServerTrackerView::setTrackerPose(
     const struct CommonDevicePose *pose)
 {
     m_device->setTrackerPose(pose);
+    m_bProjectionMatrixValid = false;
+}
+
+const cv::Matx34f &ServerTrackerView::getProjectionMatrix() const
+{
+    if (!m_bProjectionMatrixValid)
+    {
+        m_projection_matrix = computeOpenCVCameraPinholeMatrix(m_device);
+        m_bProjectionMatrixValid = true;
+    }
+
+    return m_projection_matrix;
 }
 
 void ServerTrackerView::getPixelDimensions(float &outWidth, float &outHeight) const
@@ -1182,417 +2196,421 @@ void ServerTrackerView::gatherTrackingColorPresets(
 {
     std::string controller_id= (controller != nullptr) ? controller->getConfigIdentifier() : "";
 
-    return m_device->gatherTrackingColorPresets(controller_id, settings);
+    return m_device->gatherTrackingColorPresets(controller_id, settings);
+}
+
+void ServerTrackerView::gatherTrackingColorPresets(
+    const class ServerHMDView *hmd,
+    PSMoveProtocol::Response_ResultTrackerSettings* settings) const
+{
+    std::string hmd_id = (hmd != nullptr) ? hmd->getConfigIdentifier() : "";
+
+    return m_device->gatherTrackingColorPresets(hmd_id, settings);
+}
+
+void ServerTrackerView::setControllerTrackingColorPreset(
+    const class ServerControllerView *controller,
+    eCommonTrackingColorID color, 
+    const CommonHSVColorRange *preset)
+{
+    std::string controller_id= (controller != nullptr) ? controller->getConfigIdentifier() : "";
+
+    return m_device->setTrackingColorPreset(controller_id, color, preset);
+}
+
+void ServerTrackerView::getControllerTrackingColorPreset(
+    const class ServerControllerView *controller,
+    eCommonTrackingColorID color,
+    CommonHSVColorRange *out_preset) const
+{
+    std::string controller_id= (controller != nullptr) ? controller->getConfigIdentifier() : "";
+
+    return m_device->getTrackingColorPreset(controller_id, color, out_preset);
+}
+
+void ServerTrackerView::setHMDTrackingColorPreset(
+    const class ServerHMDView *hmd,
+    eCommonTrackingColorID color,
+    const CommonHSVColorRange *preset)
+{
+    std::string hmd_id = (hmd != nullptr) ? hmd->getConfigIdentifier() : "";
+
+    return m_device->setTrackingColorPreset(hmd_id, color, preset);
+}
+
+void ServerTrackerView::getHMDTrackingColorPreset(
+    const class ServerHMDView *hmd,
+    eCommonTrackingColorID color,
+    CommonHSVColorRange *out_preset) const
+{
+    std::string hmd_id = (hmd != nullptr) ? hmd->getConfigIdentifier() : "";
+
+    return m_device->getTrackingColorPreset(hmd_id, color, out_preset);
+}
+
+bool
+ServerTrackerView::computeProjectionForController(
+    const ServerControllerView* tracked_controller,
+    const CommonDeviceTrackingShape *tracking_shape,
+    ControllerOpticalPoseEstimation *out_pose_estimate)
+{
+    TrackerVisionRequest request;
+    TrackerVisionResult result;
+    const bool bSuccess =
+        prepareVisionRequestForController(tracked_controller, tracking_shape, request) &&
+        computeProjectionWithinVisionBudget(request, result);
+
+    if (bSuccess)
+    {
+        applyVisionResultToPoseEstimate(result, out_pose_estimate);
+    }
+
+    return bSuccess;
+}
+
+bool ServerTrackerView::computeProjectionForHMD(
+    const class ServerHMDView* tracked_hmd,
+    const struct CommonDeviceTrackingShape *tracking_shape,
+    struct HMDOpticalPoseEstimation *out_pose_estimate)
+{
+    TrackerVisionRequest request;
+    TrackerVisionResult result;
+    const bool bSuccess =
+        prepareVisionRequestForHMD(tracked_hmd, tracking_shape, request) &&
+        computeProjectionWithinVisionBudget(request, result);
+
+    if (bSuccess)
+    {
+        applyVisionResultToPoseEstimate(result, out_pose_estimate);
+    }
+
+    return bSuccess;
+}
+
+bool ServerTrackerView::computeProjectionWithinVisionBudget(
+    const TrackerVisionRequest &request,
+    TrackerVisionResult &out_result)
+{
+    TrackerManager *tracker_manager = DeviceManager::getInstance()->m_tracker_manager;
+
+    // Out of main thread vision time this update, so the device sits this frame out
+    if (!tracker_manager->getHasVisionBudget())
+    {
+        m_bVisionFrameSkipped = true;
+        return false;
+    }
+
+    if (!consumeFullFrameSearchBudget(request))
+    {
+        return false;
+    }
+
+    const std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+    const bool bSuccess = computeProjectionForVisionRequest(m_opencv_buffer_state, m_device, request, out_result);
+
+    tracker_manager->chargeVisionTime(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time));
+    m_bVisionFrameProcessed = true;
+
+    return bSuccess;
+}
+
+bool ServerTrackerView::requestProjectionForController(
+    const ServerControllerView* tracked_controller,
+    const CommonDeviceTrackingShape *tracking_shape)
+{
+    bool bSuccess = false;
+
+    if (m_vision_worker != nullptr && m_bHasVisionFrame)
+    {
+        TrackerVisionRequest request;
+
+        if (prepareVisionRequestForController(tracked_controller, tracking_shape, request) &&
+            consumeFullFrameSearchBudget(request))
+        {
+            m_vision_worker->addRequest(request);
+            bSuccess = true;
+        }
+    }
+
+    return bSuccess;
+}
+
+bool ServerTrackerView::requestProjectionForHMD(
+    const ServerHMDView* tracked_hmd,
+    const CommonDeviceTrackingShape *tracking_shape)
+{
+    bool bSuccess = false;
+
+    if (m_vision_worker != nullptr && m_bHasVisionFrame)
+    {
+        TrackerVisionRequest request;
+
+        if (prepareVisionRequestForHMD(tracked_hmd, tracking_shape, request) &&
+            consumeFullFrameSearchBudget(request))
+        {
+            m_vision_worker->addRequest(request);
+            bSuccess = true;
+        }
+    }
+
+    return bSuccess;
+}
+
+void ServerTrackerView::dispatchVisionRequests()
+{
+    if (m_vision_worker != nullptr && m_bHasVisionFrame)
+    {
+        SharedVideoFrameStreamSet *shared_memory_streams =
+            m_shared_memory_streams->getHasActiveStreams() ? m_shared_memory_streams : nullptr;
+
+        const bool bHasRequests = m_vision_worker->getHasQueuedRequests();
+
+        if (m_vision_worker->dispatchRequests(m_opencv_buffer_state, m_device, shared_memory_streams) && bHasRequests)
+        {
+            m_bVisionFrameProcessed = true;
+        }
+        m_bHasVisionFrame = false;
+    }
+}
+
+bool ServerTrackerView::fetchProjectionForController(
+    const ServerControllerView* tracked_controller,
+    ControllerOpticalPoseEstimation *out_pose_estimate)
+{
+    bool bSuccess = false;
+
+    if (m_vision_worker != nullptr)
+    {
+        TrackerVisionResult result;
+
+        if (m_vision_worker->fetchResult(_TrackerVisionTarget_Controller, tracked_controller->getDeviceID(), result))
+        {
+            applyVisionResultToPoseEstimate(result, out_pose_estimate);
+            bSuccess = true;
+        }
+    }
+
+    return bSuccess;
+}
+
+bool ServerTrackerView::fetchProjectionForHMD(
+    const ServerHMDView* tracked_hmd,
+    HMDOpticalPoseEstimation *out_pose_estimate)
+{
+    bool bSuccess = false;
+
+    if (m_vision_worker != nullptr)
+    {
+        TrackerVisionResult result;
+
+        if (m_vision_worker->fetchResult(_TrackerVisionTarget_HMD, tracked_hmd->getDeviceID(), result))
+        {
+            applyVisionResultToPoseEstimate(result, out_pose_estimate);
+            bSuccess = true;
+        }
+    }
+
+    return bSuccess;
 }
 
-void ServerTrackerView::gatherTrackingColorPresets(
-    const class ServerHMDView *hmd,
-    PSMoveProtocol::Response_ResultTrackerSettings* settings) const
+void ServerTrackerView::beginVisionFrame()
 {
-    std::string hmd_id = (hmd != nullptr) ? hmd->getConfigIdentifier() : "";
-
-    return m_device->gatherTrackingColorPresets(hmd_id, settings);
-}
+    // A frame only counts as dropped if none of it got searched
+    if (m_bVisionFrameProcessed)
+    {
+        ++m_processed_vision_frame_count;
+    }
+    else if (m_bVisionFrameSkipped)
+    {
+        ++m_dropped_vision_frame_count;
+    }
+    m_bVisionFrameProcessed = false;
+    m_bVisionFrameSkipped = false;
 
-void ServerTrackerView::setControllerTrackingColorPreset(
-    const class ServerControllerView *controller,
-    eCommonTrackingColorID color, 
-    const CommonHSVColorRange *preset)
-{
-    std::string controller_id= (controller != nullptr) ? controller->getConfigIdentifier() : "";
+    ++m_vision_frame_index;
+    m_full_frame_search_count = 0;
 
-    return m_device->setTrackingColorPreset(controller_id, color, preset);
+    // Anyone who searched more recently than the longest waiting device deferred last frame yields to it
+    m_oldest_deferred_search_frame = m_next_oldest_deferred_search_frame;
+    m_next_oldest_deferred_search_frame = std::numeric_limits<int>::max();
 }
 
-void ServerTrackerView::getControllerTrackingColorPreset(
-    const class ServerControllerView *controller,
-    eCommonTrackingColorID color,
-    CommonHSVColorRange *out_preset) const
+bool ServerTrackerView::consumeFullFrameSearchBudget(const TrackerVisionRequest &request)
 {
-    std::string controller_id= (controller != nullptr) ? controller->getConfigIdentifier() : "";
+    const TrackerManagerConfig &trackerMgrConfig = DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    const int max_searches = trackerMgrConfig.max_full_frame_searches_per_frame;
 
-    return m_device->getTrackingColorPreset(controller_id, color, out_preset);
-}
+    // Tracked devices only search their ROI, so they are never held back
+    if (!request.bReacquiring || max_searches <= 0)
+    {
+        return true;
+    }
 
-void ServerTrackerView::setHMDTrackingColorPreset(
-    const class ServerHMDView *hmd,
-    eCommonTrackingColorID color,
-    const CommonHSVColorRange *preset)
-{
-    std::string hmd_id = (hmd != nullptr) ? hmd->getConfigIdentifier() : "";
+    const std::pair<int, int> target_key(static_cast<int>(request.target_type), request.target_device_id);
+    const auto it = m_last_full_frame_search_frames.find(target_key);
+    const int last_search_frame = (it != m_last_full_frame_search_frames.end()) ? it->second : -1;
 
-    return m_device->setTrackingColorPreset(hmd_id, color, preset);
-}
+    if (m_full_frame_search_count < max_searches && last_search_frame <= m_oldest_deferred_search_frame)
+    {
+        m_last_full_frame_search_frames[target_key] = m_vision_frame_index;
+        ++m_full_frame_search_count;
 
-void ServerTrackerView::getHMDTrackingColorPreset(
-    const class ServerHMDView *hmd,
-    eCommonTrackingColorID color,
-    CommonHSVColorRange *out_preset) const
-{
-    std::string hmd_id = (hmd != nullptr) ? hmd->getConfigIdentifier() : "";
+        return true;
+    }
 
-    return m_device->getTrackingColorPreset(hmd_id, color, out_preset);
+    m_next_oldest_deferred_search_frame = std::min(m_next_oldest_deferred_search_frame, last_search_frame);
+
+    return false;
 }
 
-bool
-ServerTrackerView::computeProjectionForController(
+bool ServerTrackerView::prepareVisionRequestForController(
     const ServerControllerView* tracked_controller,
     const CommonDeviceTrackingShape *tracking_shape,
-    ControllerOpticalPoseEstimation *out_pose_estimate)
+    TrackerVisionRequest &out_request) const
 {
-    bool bSuccess = true;
-
     // Get the HSV filter used to find the tracking blob
-    CommonHSVColorRange hsvColorRange;
-    if (bSuccess)
+    const eCommonTrackingColorID tracked_color_id = tracked_controller->getTrackingColorID();
+    if (tracked_color_id == eCommonTrackingColorID::INVALID_COLOR)
     {
-        eCommonTrackingColorID tracked_color_id = tracked_controller->getTrackingColorID();
-
-        if (tracked_color_id != eCommonTrackingColorID::INVALID_COLOR)
-        {
-            getControllerTrackingColorPreset(tracked_controller, tracked_color_id, &hsvColorRange);
-        }
-        else
-        {
-            bSuccess = false;
-        }
+        return false;
     }
 
+    out_request.target_type = _TrackerVisionTarget_Controller;
+    out_request.target_device_id = tracked_controller->getDeviceID();
+    out_request.tracking_shape = *tracking_shape;
+    getControllerTrackingColorPreset(tracked_controller, tracked_color_id, &out_request.hsv_color_range);
+    out_request.tracked_color_id = tracked_color_id;
+
     // Compute a region of interest in the tracker buffer around where we expect to find the tracking shape
     const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
-    const bool bRoiDisabled = tracked_controller->getIsROIDisabled() || trackerMgrConfig.disable_roi;
+    out_request.bRoiDisabled = tracked_controller->getIsROIDisabled() || trackerMgrConfig.disable_roi;
+    out_request.min_valid_projection_area = trackerMgrConfig.min_valid_projection_area;
 
     const ControllerOpticalPoseEstimation *priorPoseEst= 
         tracked_controller->getTrackerPoseEstimate(this->getDeviceID());
     const bool bIsTracking = priorPoseEst->bCurrentlyTracking;
 
-    cv::Rect2i ROI= computeTrackerROIForPoseProjection(
-        bRoiDisabled,
+    out_request.roi= computeTrackerROIForPoseProjection(
+        out_request.bRoiDisabled,
         this,		
         bIsTracking ? tracked_controller->getPoseFilter() : nullptr,
         bIsTracking ? &priorPoseEst->projection : nullptr,
+        (bIsTracking && priorPoseEst->bVelocityValid) ? &priorPoseEst->velocity_cm_per_sec : nullptr,
+        priorPoseEst->getCaptureAgeSeconds(),
         tracking_shape);
+    out_request.bReacquiring = !bIsTracking && !out_request.bRoiDisabled;
+    out_request.reacquisition_pyramid_levels = std::min(std::max(trackerMgrConfig.reacquisition_pyramid_levels, 0), k_max_reacquisition_pyramid_levels);
 
-    m_opencv_buffer_state->applyROI(ROI);
-
-    // Find the contour associated with the controller
-    t_opencv_int_contour_list biggest_contours;
-    std::vector<double> contour_areas;
-    if (bSuccess)
-    {
-        bSuccess = m_opencv_buffer_state->computeBiggestNContours(hsvColorRange, biggest_contours, contour_areas, 1);
-    }
-    
-    // Process the contour for its 2D and 3D pose.
-    if (bSuccess)
-    {
-        // Get camera parameters.
-        // Needed for undistortion.
-        cv::Matx33f camera_matrix;
-        cv::Matx<float, 5, 1> distortions;
-        computeOpenCVCameraIntrinsicMatrix(m_device, camera_matrix, distortions);
-                
-        // Compute the tracker relative 3d position of the controller from the contour
-        switch (tracking_shape->shape_type)
-        {
-        // For the sphere projection we can go ahead and compute the full pose estimation now
-        case eCommonTrackingShapeType::Sphere:
-            {
-                // Compute the convex hull of the contour
-                t_opencv_int_contour convex_contour;
-                cv::convexHull(biggest_contours[0], convex_contour);
-                m_opencv_buffer_state->draw_contour(convex_contour);
-
-                // Convert integer to float
-                t_opencv_float_contour convex_contour_f;
-                cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
-
-                // Undistort points
-                t_opencv_float_contour undistort_contour;  //destination for undistorted contour
-                cv::undistortPoints(convex_contour_f, undistort_contour,
-                                    camera_matrix,
-                                    distortions);//,
-                                    //cv::noArray(),
-                                    //camera_matrix);
-                // Note: if we omit the last two arguments, then
-                // undistort_contour points are in 'normalized' space.
-                // i.e., they are relative to their F_PX,F_PY
-                
-                // Compute the sphere center AND the projected ellipse
-                Eigen::Vector3f sphere_center;
-                EigenFitEllipse ellipse_projection;
-
-                std::vector<Eigen::Vector2f> eigen_contour;
-                std::for_each(undistort_contour.begin(),
-                              undistort_contour.end(),
-                              [&eigen_contour](cv::Point2f& p) {
-                                  eigen_contour.push_back(Eigen::Vector2f(p.x, p.y));
-                              });
-                eigen_alignment_fit_focal_cone_to_sphere(eigen_contour.data(),
-                                                         static_cast<int>(eigen_contour.size()),
-                                                         tracking_shape->shape.sphere.radius_cm,
-                                                         1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
-                                                         &sphere_center,
-                                                         &ellipse_projection);
-                
-                if (ellipse_projection.area > k_real_epsilon)
-                {
-                    //Save the optically-estimate 3D pose.
-                    out_pose_estimate->position_cm.set(sphere_center.x(), sphere_center.y(), sphere_center.z());
-                    out_pose_estimate->bCurrentlyTracking = true;
-                    // Not possible to get an orientation off of a sphere
-                    out_pose_estimate->orientation.clear();
-                    out_pose_estimate->bOrientationValid = false;
-
-                    // Save off the projection of the sphere (an ellipse)
-                    out_pose_estimate->projection.shape.ellipse.angle = ellipse_projection.angle;
-                    out_pose_estimate->projection.screen_area= ellipse_projection.area;
-                    //The ellipse projection is still in normalized space.
-                    //i.e., it is a 2-dimensional ellipse floating somewhere.
-                    //We must reproject it onto the camera.
-                    //TODO: Use opencv's project points instead of manual way below
-                    //because it will account for distortion, at least for the center point.
-                    out_pose_estimate->projection.shape_type = eCommonTrackingProjectionType::ProjectionType_Ellipse;
-                    out_pose_estimate->projection.shape.ellipse.center.set(
-                        ellipse_projection.center.x()*camera_matrix.val[0] + camera_matrix.val[2],
-                        ellipse_projection.center.y()*camera_matrix.val[4] + camera_matrix.val[5]);
-                    out_pose_estimate->projection.shape.ellipse.half_x_extent = ellipse_projection.extents.x()*camera_matrix.val[0];
-                    out_pose_estimate->projection.shape.ellipse.half_y_extent = ellipse_projection.extents.y()*camera_matrix.val[0];
-                    out_pose_estimate->projection.screen_area=
-                        k_real_pi*out_pose_estimate->projection.shape.ellipse.half_x_extent*out_pose_estimate->projection.shape.ellipse.half_y_extent;
-                
-                    //Draw results onto m_opencv_buffer_state
-                    m_opencv_buffer_state->draw_pose_projection(out_pose_estimate->projection);
-
-                    bSuccess = true;
-                }
-            } break;
-        // For the LightBar projection we only want to compute the projection shape.
-        // The pose estimation is deferred until we know if we can leverage triangulation or not.
-        case eCommonTrackingShapeType::LightBar:
-            {
-                // Draw the raw source contour
-                m_opencv_buffer_state->draw_contour(biggest_contours[0]);
-
-                // Convert integer contour to float
-                t_opencv_float_contour biggest_contour_f;
-                cv::Mat(biggest_contours[0]).convertTo(biggest_contour_f, cv::Mat(biggest_contour_f).type());
+    // Get camera parameters.
+    // Needed for undistortion.
+    computeOpenCVCameraIntrinsicMatrix(m_device, out_request.camera_matrix, out_request.distortions);
+    out_request.undistortion_cache = getUndistortionCache(out_request.camera_matrix, out_request.distortions);
 
-                // Compute an undistorted version of the contour
-                t_opencv_float_contour undistort_contour;
-                cv::undistortPoints(biggest_contour_f, undistort_contour,
-                                    camera_matrix,
-                                    distortions,
-                                    cv::noArray(),
-                                    camera_matrix);
+    // Controllers don't use a pose guess when computing the projection
+    out_request.tracker_pose_guess.clear();
+    out_request.bTrackerPoseGuessValid = false;
+    out_request.bTrackerOrientationGuessValid = false;
+    out_request.point_cloud_pose_budget_us = 0;
 
-                // Compute the lightbar tracking projection from the undistored contour
-                bSuccess=
-                    computeTrackerRelativeLightBarProjection(
-                        tracking_shape,
-                        undistort_contour,
-                        &out_pose_estimate->projection);
+    return true;
+}
 
-                //Draw results onto m_opencv_buffer_state
-                m_opencv_buffer_state->draw_pose_projection(out_pose_estimate->projection);
-            } break;
-        default:
-            assert(0 && "Unreachable");
-            break;
-        }
-    }
+std::shared_ptr<const OpenCVUndistortionCache> ServerTrackerView::getUndistortionCache(
+    const cv::Matx33f &camera_matrix,
+    const cv::Matx<float, 5, 1> &distortions) const
+{
+    const int frame_width = static_cast<int>(m_device->getFrameWidth());
+    const int frame_height = static_cast<int>(m_device->getFrameHeight());
 
-    // Throw out the result if the contour we found was too small and 
-    // we were using an ROI less that the size of the full screen
-    if (bSuccess && !bRoiDisabled)
+    // The intrinsics can also change underneath us (e.g. a config reload), so check them every time.
+    // Comparing 14 floats is still far cheaper than undistorting a single contour.
+    if (!m_undistortion_cache ||
+        !m_undistortion_cache->getIsBuiltFor(camera_matrix, distortions, frame_width, frame_height))
     {
-        float screenWidth, screenHeight;
-        getPixelDimensions(screenWidth, screenHeight);
+        OpenCVUndistortionCache *undistortion_cache = new OpenCVUndistortionCache();
 
-        if (ROI.width < screenWidth || ROI.height < screenHeight)
-        {
-            bSuccess= out_pose_estimate->projection.screen_area >= trackerMgrConfig.min_valid_projection_area;
-        }
+        undistortion_cache->build(camera_matrix, distortions, frame_width, frame_height);
+        m_undistortion_cache.reset(undistortion_cache);
     }
 
-    return bSuccess;
+    return m_undistortion_cache;
 }
 
-bool ServerTrackerView::computeProjectionForHMD(
-    const class ServerHMDView* tracked_hmd,
-    const struct CommonDeviceTrackingShape *tracking_shape,
-    struct HMDOpticalPoseEstimation *out_pose_estimate)
+bool ServerTrackerView::prepareVisionRequestForHMD(
+    const ServerHMDView* tracked_hmd,
+    const CommonDeviceTrackingShape *tracking_shape,
+    TrackerVisionRequest &out_request) const
 {
-    bool bSuccess = true;
-
     // Get the HSV filter used to find the tracking blob
-    CommonHSVColorRange hsvColorRange;
-    if (bSuccess)
+    const eCommonTrackingColorID tracked_color_id = tracked_hmd->getTrackingColorID();
+    if (tracked_color_id == eCommonTrackingColorID::INVALID_COLOR)
     {
-        eCommonTrackingColorID tracked_color_id = tracked_hmd->getTrackingColorID();
-
-        if (tracked_color_id != eCommonTrackingColorID::INVALID_COLOR)
-        {
-            getHMDTrackingColorPreset(tracked_hmd, tracked_color_id, &hsvColorRange);
-        }
-        else
-        {
-            bSuccess = false;
-        }
+        return false;
     }
-    
+
+    out_request.target_type = _TrackerVisionTarget_HMD;
+    out_request.target_device_id = tracked_hmd->getDeviceID();
+    out_request.tracking_shape = *tracking_shape;
+    getHMDTrackingColorPreset(tracked_hmd, tracked_color_id, &out_request.hsv_color_range);
+    out_request.tracked_color_id = tracked_color_id;
+
     // Compute a region of interest in the tracker buffer around where we expect to find the tracking shape
     const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
-    const bool bRoiDisabled = tracked_hmd->getIsROIDisabled() || trackerMgrConfig.disable_roi;
+    out_request.bRoiDisabled = tracked_hmd->getIsROIDisabled() || trackerMgrConfig.disable_roi;
+    out_request.min_valid_projection_area = trackerMgrConfig.min_valid_projection_area;
 
     const HMDOpticalPoseEstimation *priorPoseEst= 
         tracked_hmd->getTrackerPoseEstimate(this->getDeviceID());
     const bool bIsTracking = priorPoseEst->bCurrentlyTracking;
 
-    cv::Rect2i ROI = computeTrackerROIForPoseProjection(
-        bRoiDisabled,
+    out_request.roi = computeTrackerROIForPoseProjection(
+        out_request.bRoiDisabled,
         this, 
         bIsTracking ? tracked_hmd->getPoseFilter() : nullptr,
         bIsTracking ? &priorPoseEst->projection : nullptr,
+        (bIsTracking && priorPoseEst->bVelocityValid) ? &priorPoseEst->velocity_cm_per_sec : nullptr,
+        priorPoseEst->getCaptureAgeSeconds(),
         tracking_shape);
-    m_opencv_buffer_state->applyROI(ROI);
-
-    // Find the N best contours associated with the HMD
-    t_opencv_int_contour_list biggest_contours;
-    std::vector<double> contour_areas;
-    if (bSuccess)
-    {
-        bSuccess = 
-            m_opencv_buffer_state->computeBiggestNContours(
-                hsvColorRange, biggest_contours, contour_areas, CommonDeviceTrackingProjection::MAX_POINT_CLOUD_POINT_COUNT);
-    }
-
-    // Compute the tracker relative 3d position of the controller from the contour
-    if (bSuccess)
-    {
-        cv::Matx33f camera_matrix;
-        cv::Matx<float, 5, 1> distortions;
-        computeOpenCVCameraIntrinsicMatrix(m_device, camera_matrix, distortions);
-
-        switch (tracking_shape->shape_type)
-        {
-        // For the sphere projection we can go ahead and compute the full pose estimation now
-        case eCommonTrackingShapeType::Sphere:
-            {
-                // Compute the convex hull of the contour
-                t_opencv_int_contour convex_contour;
-                cv::convexHull(biggest_contours[0], convex_contour);
-                m_opencv_buffer_state->draw_contour(convex_contour);
-
-                // Convert integer to float
-                t_opencv_float_contour convex_contour_f;
-                cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
-
-                // Undistort points
-                t_opencv_float_contour undistorted_contour;  //destination for undistorted contour
-                cv::undistortPoints(convex_contour_f, undistorted_contour,
-                                    camera_matrix,
-                                    distortions);//,
-                                    //cv::noArray(),
-                                    //camera_matrix);
-                // Note: if we omit the last two arguments, then
-                // undistort_contour points are in 'normalized' space.
-                // i.e., they are relative to their F_PX,F_PY
-                
-                // Compute the sphere center AND the projected ellipse
-                Eigen::Vector3f sphere_center;
-                EigenFitEllipse ellipse_projection;
-
-                std::vector<Eigen::Vector2f> eigen_contour;
-                std::for_each(undistorted_contour.begin(),
-                              undistorted_contour.end(),
-                              [&eigen_contour](const cv::Point2f& p) {
-                                  eigen_contour.push_back(Eigen::Vector2f(p.x, p.y));
-                              });
-                eigen_alignment_fit_focal_cone_to_sphere(eigen_contour.data(),
-                                                         static_cast<int>(eigen_contour.size()),
-                                                         tracking_shape->shape.sphere.radius_cm,
-                                                         1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
-                                                         &sphere_center,
-                                                         &ellipse_projection);
-                
-                if (ellipse_projection.area > k_real_epsilon)
-                {
-                    //Save the optically-estimate 3D pose.
-                    out_pose_estimate->position_cm.set(sphere_center.x(), sphere_center.y(), sphere_center.z());
-                    out_pose_estimate->bCurrentlyTracking = true;
-                    // Not possible to get an orientation off of a sphere
-                    out_pose_estimate->orientation.clear();
-                    out_pose_estimate->bOrientationValid = false;
-
-                    // Save off the projection of the sphere (an ellipse)
-                    out_pose_estimate->projection.shape.ellipse.angle = ellipse_projection.angle;
-                    out_pose_estimate->projection.screen_area= ellipse_projection.area;
-                    //The ellipse projection is still in normalized space.
-                    //i.e., it is a 2-dimensional ellipse floating somewhere.
-                    //We must reproject it onto the camera.
-                    //TODO: Use opencv's project points instead of manual way below
-                    //because it will account for distortion, at least for the center point.
-                    out_pose_estimate->projection.shape_type = eCommonTrackingProjectionType::ProjectionType_Ellipse;
-                    out_pose_estimate->projection.shape.ellipse.center.set(
-                        ellipse_projection.center.x()*camera_matrix.val[0] + camera_matrix.val[2],
-                        ellipse_projection.center.y()*camera_matrix.val[4] + camera_matrix.val[5]);
-                    out_pose_estimate->projection.shape.ellipse.half_x_extent = ellipse_projection.extents.x()*camera_matrix.val[0];
-                    out_pose_estimate->projection.shape.ellipse.half_y_extent = ellipse_projection.extents.y()*camera_matrix.val[0];
-                    out_pose_estimate->projection.screen_area=
-                        k_real_pi*out_pose_estimate->projection.shape.ellipse.half_x_extent*out_pose_estimate->projection.shape.ellipse.half_y_extent;
-                
-                    //Draw results onto m_opencv_buffer_state
-                    m_opencv_buffer_state->draw_pose_projection(out_pose_estimate->projection);
+    out_request.bReacquiring = !bIsTracking && !out_request.bRoiDisabled;
+    out_request.reacquisition_pyramid_levels = std::min(std::max(trackerMgrConfig.reacquisition_pyramid_levels, 0), k_max_reacquisition_pyramid_levels);
 
-                    bSuccess = true;
-                }
-            } break;
-        case eCommonTrackingShapeType::PointCloud:
-            {
-                const HMDOpticalPoseEstimation *prior_post_est= tracked_hmd->getTrackerPoseEstimate(getDeviceID());
-                CommonDevicePose tracker_pose_guess= {prior_post_est->position_cm, prior_post_est->orientation};
+    computeOpenCVCameraIntrinsicMatrix(m_device, out_request.camera_matrix, out_request.distortions);
+    out_request.undistortion_cache = getUndistortionCache(out_request.camera_matrix, out_request.distortions);
 
-                // Undistort the source contours
-                t_opencv_float_contour_list undistorted_contours;
-                for (auto it = biggest_contours.begin(); it != biggest_contours.end(); ++it)
-                {
-                    // Draw the source contour
-                    m_opencv_buffer_state->draw_contour(*it);
+    // The filtered pose, moved into tracker space, is the guess the point cloud pose solver starts from.
+    // The orientation is fused with the IMU, so it stays usable while the HMD is optically lost.
+    const IPoseFilter *pose_filter = tracked_hmd->getPoseFilter();
 
-                    // Convert integer contour to float
-                    t_opencv_float_contour biggest_contour_f;
-                    cv::Mat(*it).convertTo(biggest_contour_f, cv::Mat(biggest_contour_f).type());
+    out_request.tracker_pose_guess.clear();
+    out_request.bTrackerPoseGuessValid = false;
+    out_request.bTrackerOrientationGuessValid = false;
+    out_request.point_cloud_pose_budget_us = trackerMgrConfig.point_cloud_pose_budget_us;
 
-                    // Compute an undistorted version of the contour
-                    t_opencv_float_contour undistort_contour;
-                    cv::undistortPoints(biggest_contour_f, undistort_contour,
-                        camera_matrix,
-                        distortions,
-                        cv::noArray(),
-                        camera_matrix);
+    if (pose_filter != nullptr && pose_filter->getIsOrientationStateValid())
+    {
+        const Eigen::Quaternionf filter_orientation = pose_filter->getOrientation();
+        CommonDeviceQuaternion world_orientation;
+        world_orientation.w = filter_orientation.w();
+        world_orientation.x = filter_orientation.x();
+        world_orientation.y = filter_orientation.y();
+        world_orientation.z = filter_orientation.z();
 
-                    undistorted_contours.push_back(biggest_contour_f);
-                }
+        out_request.tracker_pose_guess.Orientation = computeTrackerOrientation(&world_orientation);
+        out_request.bTrackerOrientationGuessValid = true;
 
-                bSuccess =
-                    computeTrackerRelativePointCloudContourPose(
-                        m_device,
-                        tracking_shape,
-                        undistorted_contours,
-                        prior_post_est->bCurrentlyTracking ? &tracker_pose_guess : nullptr,
-                        out_pose_estimate);
+        if (bIsTracking && pose_filter->getIsPositionStateValid())
+        {
+            const Eigen::Vector3f filter_position_cm = pose_filter->getPositionCm();
+            CommonDevicePosition world_position_cm;
+            world_position_cm.set(filter_position_cm.x(), filter_position_cm.y(), filter_position_cm.z());
 
-                //Draw results onto m_opencv_buffer_state
-                m_opencv_buffer_state->draw_pose_projection(out_pose_estimate->projection);
-            } break;
-        default:
-            assert(0 && "Unreachable");
-            break;
+            out_request.tracker_pose_guess.PositionCm = computeTrackerPosition(&world_position_cm);
+            out_request.bTrackerPoseGuessValid = true;
         }
     }
 
-    return bSuccess;
+    return true;
 }
 
 bool 
@@ -1691,9 +2709,14 @@ ServerTrackerView::computeTrackerOrientation(
         world_relative_orientation->x,
         world_relative_orientation->y,
         world_relative_orientation->z);    
+    // Undo computeWorldOrientation, global "forward" rotation included
+    const TrackerManagerConfig &cfg = DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    const float global_forward_yaw_radians = cfg.global_forward_degrees*k_degrees_to_radians;
+    const glm::quat global_forward_inv_quat= glm::conjugate(glm::quat(glm::vec3(0.f, global_forward_yaw_radians, 0.f)));
+
     const glm::quat camera_inv_quat= glm::conjugate(computeGLMCameraTransformQuaternion(m_device));
     // combined_rotation = second_rotation * first_rotation;
-    const glm::quat rel_quat = camera_inv_quat * world_orientation;
+    const glm::quat rel_quat = camera_inv_quat * global_forward_inv_quat * world_orientation;
     
     CommonDeviceQuaternion result;
     result.w= rel_quat.w;
@@ -1850,33 +2873,14 @@ ServerTrackerView::triangulateWorldPosition(
     const ServerTrackerView *tracker, 
     const CommonDeviceScreenLocation *screen_location,
     const ServerTrackerView *other_tracker,
-    const CommonDeviceScreenLocation *other_screen_location)
-{
-    float screenWidth, screenHeight;
-    tracker->getPixelDimensions(screenWidth, screenHeight);
-    
-    float otherScreenWidth, otherScreenHeight;
-    tracker->getPixelDimensions(otherScreenWidth, otherScreenHeight);
-
-    cv::Mat projPoints1 = cv::Mat(cv::Point2f(screen_location->x, screen_location->y));
-    cv::Mat projPoints2 = cv::Mat(cv::Point2f(other_screen_location->x, other_screen_location->y));
-
-    // Compute the pinhole camera matrix for each tracker that allows you to raycast
-    // from the tracker center in world space through the screen location, into the world
-    // See: http://docs.opencv.org/2.4/modules/calib3d/doc/camera_calibration_and_3d_reconstruction.html
-    cv::Mat projMat1 = cv::Mat(computeOpenCVCameraPinholeMatrix(tracker->m_device));
-    cv::Mat projMat2 = cv::Mat(computeOpenCVCameraPinholeMatrix(other_tracker->m_device));
+    const CommonDeviceScreenLocation *other_screen_location)
+{
+    const ServerTrackerView *trackers[2] = { tracker, other_tracker };
+    const CommonDeviceScreenLocation screen_locations[2] = { *screen_location, *other_screen_location };
 
     // Triangulate the world position from the two cameras
-    cv::Mat point3D(1, 1, CV_32FC4);
-    cv::triangulatePoints(projMat1, projMat2, projPoints1, projPoints2, point3D);
-
-    // Return the world space position
     CommonDevicePosition result;
-    const float w = point3D.at<float>(3, 0);
-    result.x = point3D.at<float>(0, 0) / w;
-    result.y = point3D.at<float>(1, 0) / w;
-    result.z = point3D.at<float>(2, 0) / w;
+    triangulateWorldPositionFromTrackers(trackers, screen_locations, nullptr, 2, &result);
 
     return result;
 }
@@ -1890,45 +2894,109 @@ ServerTrackerView::triangulateWorldPositions(
     const int screen_location_count,
     CommonDevicePosition *out_result)
 {
-    float screenWidth, screenHeight;
-    tracker->getPixelDimensions(screenWidth, screenHeight);
-
-    float otherScreenWidth, otherScreenHeight;
-    tracker->getPixelDimensions(otherScreenWidth, otherScreenHeight);
+    const ServerTrackerView *trackers[2] = { tracker, other_tracker };
 
-    std::vector<cv::Point2f> projPoints1;
-    std::vector<cv::Point2f> projPoints2;
+    // Triangulate the world positions from the two cameras
     for (int point_index = 0; point_index < screen_location_count; ++point_index)
     {
-        const CommonDeviceScreenLocation &p1= screen_locations[point_index];
-        const CommonDeviceScreenLocation &p2= other_screen_locations[point_index];
+        const CommonDeviceScreenLocation point_screen_locations[2] = {
+            screen_locations[point_index], other_screen_locations[point_index] };
 
-        projPoints1.push_back(cv::Point2f(p1.x, p1.y));
-        projPoints2.push_back(cv::Point2f(p2.x, p2.y));
+        triangulateWorldPositionFromTrackers(trackers, point_screen_locations, nullptr, 2, &out_result[point_index]);
     }
+}
 
-    // Compute the pinhole camera matrix for each tracker that allows you to raycast
-    // from the tracker center in world space through the screen location, into the world
-    // See: http://docs.opencv.org/2.4/modules/calib3d/doc/camera_calibration_and_3d_reconstruction.html
-    cv::Mat projMat1 = cv::Mat(computeOpenCVCameraPinholeMatrix(tracker->m_device));
-    cv::Mat projMat2 = cv::Mat(computeOpenCVCameraPinholeMatrix(other_tracker->m_device));
+bool
+ServerTrackerView::triangulateWorldPositionFromTrackers(
+    const ServerTrackerView * const *trackers,
+    const CommonDeviceScreenLocation *screen_locations,
+    const float *weights,
+    const int tracker_count,
+    CommonDevicePosition *out_result)
+{
+    // Each view contributes two rows to the usual DLT system A*X = 0 (X = homogeneous world position):
+    //   x*P.row(2) - P.row(0)
+    //   y*P.row(2) - P.row(1)
+    // Fixing X.w = 1 turns that into a 3x3 weighted least squares problem, solved here through
+    // its normal equations so that nothing gets allocated regardless of the tracker count.
+    // Each row's residual is the pixel error scaled by the depth of the point in that view,
+    // so a second pass divides the rows by the depths from the first pass.
+    // That way farther trackers don't count for more than closer ones.
+    static const int k_solver_pass_count = 2;
+    static const double k_min_view_depth = 1.0; // cm
+
+    Eigen::Vector3d world_position = Eigen::Vector3d::Zero();
+    bool bSuccess = tracker_count >= 2;
+
+    for (int pass_index = 0; bSuccess && pass_index < k_solver_pass_count; ++pass_index)
+    {
+        Eigen::Matrix3d normal_matrix = Eigen::Matrix3d::Zero();
+        Eigen::Vector3d normal_vector = Eigen::Vector3d::Zero();
 
-    // Triangulate the world positions from the two cameras
-    cv::Mat points3D(1, screen_location_count, CV_32FC4);
-    cv::triangulatePoints(projMat1, projMat2, projPoints1, projPoints2, points3D);
+        for (int tracker_index = 0; tracker_index < tracker_count; ++tracker_index)
+        {
+            // Eigen view of the cached OpenCV projection matrix (cv::Matx stores its values row major)
+            const Eigen::Map<const Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> projection(
+                trackers[tracker_index]->getProjectionMatrix().val);
+            const Eigen::Vector4d p0 = projection.row(0).transpose().cast<double>();
+            const Eigen::Vector4d p1 = projection.row(1).transpose().cast<double>();
+            const Eigen::Vector4d p2 = projection.row(2).transpose().cast<double>();
+            const CommonDeviceScreenLocation &screen_location = screen_locations[tracker_index];
+
+            double weight = (weights != nullptr) ? static_cast<double>(weights[tracker_index]) : 1.0;
+            if (pass_index > 0)
+            {
+                const double depth = fabs(p2.head<3>().dot(world_position) + p2(3));
 
-    // Return the world space positions
-    for (int point_index = 0; point_index < screen_location_count; ++point_index)
-    {
-        CommonDevicePosition &result= out_result[point_index];
+                if (depth > k_min_view_depth)
+                {
+                    weight /= depth*depth;
+                }
+            }
+
+            const Eigen::Vector4d rows[2] = {
+                static_cast<double>(screen_location.x)*p2 - p0,
+                static_cast<double>(screen_location.y)*p2 - p1
+            };
+
+            for (int row_index = 0; row_index < 2; ++row_index)
+            {
+                const Eigen::Vector3d a = rows[row_index].head<3>();
+
+                normal_matrix += weight*a*a.transpose();
+                normal_vector -= weight*rows[row_index](3)*a;
+            }
+        }
+
+        // Parallel rays (or zero weights) leave the system singular
+        const Eigen::LDLT<Eigen::Matrix3d> solver(normal_matrix);
+        const Eigen::Vector3d pivots = solver.vectorD().cwiseAbs();
+
+        if (solver.info() == Eigen::Success && pivots.minCoeff() > k_real_epsilon*pivots.maxCoeff())
+        {
+            world_position = solver.solve(normal_vector);
+            bSuccess = world_position.allFinite();
+        }
+        else
+        {
+            bSuccess = false;
+        }
+    }
 
-        const float w = points3D.at<float>(3, point_index);
-        result.x = points3D.at<float>(0, point_index) / w;
-        result.y = points3D.at<float>(1, point_index) / w;
-        result.z = points3D.at<float>(2, point_index) / w;
+    if (bSuccess)
+    {
+        out_result->set(
+            static_cast<float>(world_position.x()),
+            static_cast<float>(world_position.y()),
+            static_cast<float>(world_position.z()));
+    }
+    else
+    {
+        out_result->clear();
     }
-}
 
+    return bSuccess;
+}
 
 std::vector<CommonDeviceScreenLocation>
 ServerTrackerView::projectTrackerRelativePositions(const std::vector<CommonDevicePosition> &objectPositions) const
@@ -2262,15 +3330,14 @@ static bool computeTrackerRelativeLightBarPose(
 }
 
 static bool computeTrackerRelativePointCloudContourPose(
-    const ITrackerInterface *tracker_device,
-    const CommonDeviceTrackingShape *tracking_shape,
+    const TrackerVisionRequest &request,
     const t_opencv_float_contour_list &opencv_contours,
-    const CommonDevicePose *tracker_relative_pose_guess,
     HMDOpticalPoseEstimation *out_pose_estimate)
 {
+    const CommonDeviceTrackingShape *tracking_shape = &request.tracking_shape;
     assert(tracking_shape->shape_type == eCommonTrackingShapeType::PointCloud);
 
-    bool bValidTrackerPose = true;
+    bool bValidTrackerPose = false;
     float projectionArea = 0.f;
 
     // Compute centers of mass for the contours
@@ -2280,15 +3347,69 @@ static bool computeTrackerRelativePointCloudContourPose(
         cv::Point2f massCenter= computeSafeCenterOfMassForContour<t_opencv_float_contour>(*it);
 
         cvImagePoints.push_back(massCenter);
+        projectionArea += static_cast<float>(cv::contourArea(*it));
     }
 
     if (cvImagePoints.size() >= 3)
     {
-        //###HipsterSloth $TODO Solve the pose using SoftPOSIT
-        out_pose_estimate->position_cm.clear();
-        out_pose_estimate->orientation.clear();
-        out_pose_estimate->bOrientationValid = false;
-        bValidTrackerPose = true;
+        // Only the blob centers need undistorting, the solver works on an ideal pinhole camera
+        t_opencv_float_contour cvUndistortedImagePoints;
+        request.undistortion_cache->undistortPointsPixels(cvImagePoints, cvUndistortedImagePoints);
+
+        std::vector<cv::Point3f> cvObjectPoints;
+        for (int point_index = 0; point_index < tracking_shape->shape.point_cloud.point_count; ++point_index)
+        {
+            const CommonDevicePosition &point = tracking_shape->shape.point_cloud.point[point_index];
+
+            cvObjectPoints.push_back(cv::Point3f(point.x, point.y, point.z));
+        }
+
+        PointCloudPoseSolverSettings settings;
+        settings.time_budget = std::chrono::microseconds(request.point_cloud_pose_budget_us);
+
+        // The solver expects rotation matrices, solvePnP style
+        PointCloudPose pose_guess;
+        if (request.bTrackerOrientationGuessValid)
+        {
+            cv::Mat rvec(3, 1, cv::DataType<double>::type);
+            cv::Mat rotation;
+
+            commonDeviceOrientationToOpenCVRodrigues(request.tracker_pose_guess.Orientation, rvec);
+            cv::Rodrigues(rvec, rotation);
+
+            pose_guess.rotation = cv::Matx33d(rotation.ptr<double>());
+            pose_guess.translation = cv::Vec3d(
+                request.tracker_pose_guess.PositionCm.x,
+                request.tracker_pose_guess.PositionCm.y,
+                request.tracker_pose_guess.PositionCm.z);
+        }
+
+        const OpenCVPointCloudPoseSolver solver(cvObjectPoints, request.camera_matrix, settings);
+        PointCloudPoseSolution solution;
+
+        if (solver.solve(
+                cvUndistortedImagePoints,
+                (request.bTrackerOrientationGuessValid && request.bTrackerPoseGuessValid) ? &pose_guess : nullptr,
+                request.bTrackerOrientationGuessValid ? &pose_guess.rotation : nullptr,
+                solution))
+        {
+            cv::Mat rvec;
+            float axis_x, axis_y, axis_z, axis_theta;
+
+            // Extract the angle-axis components from the solution rotation
+            cv::Rodrigues(cv::Mat(solution.pose.rotation), rvec);
+            openCVRodriguesToAngleAxis(rvec, axis_x, axis_y, axis_z, axis_theta);
+
+            angleAxisVectorToCommonDeviceOrientation(axis_x, axis_y, axis_z, axis_theta, out_pose_estimate->orientation);
+            out_pose_estimate->bOrientationValid = true;
+
+            out_pose_estimate->position_cm.set(
+                static_cast<float>(solution.pose.translation[0]),
+                static_cast<float>(solution.pose.translation[1]),
+                static_cast<float>(solution.pose.translation[2]));
+
+            bValidTrackerPose = true;
+        }
     }
 
     // Return the projection of the tracking shape
@@ -2313,11 +3434,350 @@ static bool computeTrackerRelativePointCloudContourPose(
     return bValidTrackerPose;
 }
 
+static int getMaxContourCountForTrackingShape(const CommonDeviceTrackingShape *tracking_shape)
+{
+    return
+        (tracking_shape->shape_type == eCommonTrackingShapeType::PointCloud)
+        ? CommonDeviceTrackingProjection::MAX_POINT_CLOUD_POINT_COUNT
+        : 1;
+}
+
+// Where to look for the device in the current frame.
+// Returns false if a reacquisition search already knows the device isn't visible.
+static bool computeSearchROIForVisionRequest(
+    OpenCVBufferState *buffer_state,
+    const TrackerVisionRequest &request,
+    cv::Rect2i &out_search_roi)
+{
+    out_search_roi = request.roi;
+
+    // When reacquiring a lost device, find candidates at a coarse pyramid level first
+    // and only run the full resolution search around them
+    if (request.bReacquiring && request.reacquisition_pyramid_levels > 0)
+    {
+        return buffer_state->computeReacquisitionROI(
+            request.hsv_color_range,
+            request.reacquisition_pyramid_levels,
+            getMaxContourCountForTrackingShape(&request.tracking_shape),
+            out_search_roi);
+    }
+
+    return true;
+}
+
+static bool computeProjectionForContours(
+    OpenCVBufferState *buffer_state,
+    const ITrackerInterface *tracker_device,
+    const TrackerVisionRequest &request,
+    const t_opencv_int_contour_list &biggest_contours,
+    TrackerVisionResult &out_result);
+
+static bool computeProjectionForVisionRequest(
+    OpenCVBufferState *buffer_state,
+    const ITrackerInterface *tracker_device,
+    const TrackerVisionRequest &request,
+    TrackerVisionResult &out_result)
+{
+    cv::Rect2i search_roi;
+    if (!computeSearchROIForVisionRequest(buffer_state, request, search_roi))
+    {
+        return false;
+    }
+
+    buffer_state->draw_predicted_roi(search_roi);
+    buffer_state->applyROI(search_roi);
+
+    // Find the contour(s) associated with the tracked device
+    t_opencv_int_contour_list biggest_contours;
+    std::vector<double> contour_areas;
+    const bool bSuccess = 
+        buffer_state->computeBiggestNContours(
+            request.hsv_color_range, request.tracked_color_id, biggest_contours, contour_areas,
+            getMaxContourCountForTrackingShape(&request.tracking_shape));
+
+    return bSuccess && computeProjectionForContours(buffer_state, tracker_device, request, biggest_contours, out_result);
+}
+
+static void computeProjectionsForVisionRequests(
+    OpenCVBufferState *buffer_state,
+    const ITrackerInterface *tracker_device,
+    const std::vector<TrackerVisionRequest> &requests,
+    std::vector<TrackerVisionResult> &out_results)
+{
+    std::vector<TrackerSegmentationRequest> segmentation_requests;
+    std::vector<TrackerSegmentationRegion> regions;
+
+    for (size_t request_index = 0; request_index < requests.size(); ++request_index)
+    {
+        const TrackerVisionRequest &request = requests[request_index];
+
+        // Colors missing from the color label table have to be thresholded on their own
+        if (!buffer_state->getIsColorLabeled(request.tracked_color_id))
+        {
+            TrackerVisionResult result;
+
+            if (computeProjectionForVisionRequest(buffer_state, tracker_device, request, result))
+            {
+                out_results.push_back(result);
+            }
+            continue;
+        }
+
+        cv::Rect2i search_roi;
+        if (!computeSearchROIForVisionRequest(buffer_state, request, search_roi))
+        {
+            continue;
+        }
+
+        buffer_state->draw_predicted_roi(search_roi);
+
+        TrackerSegmentationRequest segmentation_request;
+        segmentation_request.request_index = static_cast<int>(request_index);
+        segmentation_request.color_id = request.tracked_color_id;
+        segmentation_request.search_roi = buffer_state->clampROI(search_roi);
+        segmentation_requests.push_back(segmentation_request);
+    }
+
+    planSegmentationRegions(buffer_state->frameWidth, buffer_state->frameHeight, segmentation_requests, regions);
+
+    for (const TrackerSegmentationRegion &region : regions)
+    {
+        // The color label image is cached per tile, so overlapping regions only classify their pixels once
+        buffer_state->applyROI(region.roi);
+        buffer_state->updateLabelBuffer(region.roi);
+
+        segmentRegionByColor(
+            region, buffer_state->labelROI, buffer_state->gsLowerROI, buffer_state->blobExtractor,
+            [&](const TrackerSegmentationRequest &segmentation_request, const cv::Rect2f &centroid_region) {
+                const TrackerVisionRequest &request = requests[segmentation_request.request_index];
+                t_opencv_int_contour_list biggest_contours;
+                std::vector<double> contour_areas;
+                TrackerVisionResult result;
+
+                buffer_state->draw_mask();
+
+                if (buffer_state->selectBiggestNContours(
+                        &centroid_region,
+                        biggest_contours, contour_areas,
+                        getMaxContourCountForTrackingShape(&request.tracking_shape)) &&
+                    computeProjectionForContours(buffer_state, tracker_device, request, biggest_contours, result))
+                {
+                    out_results.push_back(result);
+                }
+            });
+    }
+}
+
+// Computes the projection (and pose where possible) from the contour(s) found for the request
+static bool computeProjectionForContours(
+    OpenCVBufferState *buffer_state,
+    const ITrackerInterface *tracker_device,
+    const TrackerVisionRequest &request,
+    const t_opencv_int_contour_list &biggest_contours,
+    TrackerVisionResult &out_result)
+{
+    const CommonDeviceTrackingShape *tracking_shape = &request.tracking_shape;
+    const cv::Matx33f &camera_matrix = request.camera_matrix;
+
+    out_result.target_type = request.target_type;
+    out_result.target_device_id = request.target_device_id;
+    memset(&out_result.projection, 0, sizeof(CommonDeviceTrackingProjection));
+    out_result.projection.shape_type = eCommonTrackingProjectionType::INVALID_PROJECTION;
+    out_result.position_cm.clear();
+    out_result.orientation.clear();
+    out_result.bPositionValid = false;
+    out_result.bOrientationValid = false;
+    out_result.capture_time = buffer_state->videoFrame.getCaptureTime();
+
+    bool bSuccess = biggest_contours.size() > 0;
+
+    // Process the contour for its 2D and 3D pose.
+    if (bSuccess)
+    {
+        switch (tracking_shape->shape_type)
+        {
+        // For the sphere projection we can go ahead and compute the full pose estimation now
+        case eCommonTrackingShapeType::Sphere:
+            {
+                // Compute the convex hull of the contour
+                t_opencv_int_contour convex_contour;
+                cv::convexHull(biggest_contours[0], convex_contour);
+                buffer_state->draw_contour(convex_contour);
+
+                // Convert integer to float
+                t_opencv_float_contour convex_contour_f;
+                cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
+
+                // Undistort points
+                t_opencv_float_contour undistort_contour;  //destination for undistorted contour
+                request.undistortion_cache->undistortPointsNormalized(convex_contour_f, undistort_contour);
+                // Note: undistort_contour points are in 'normalized' space.
+                // i.e., they are relative to their F_PX,F_PY
+                
+                // Compute the sphere center AND the projected ellipse
+                Eigen::Vector3f sphere_center;
+                EigenFitEllipse ellipse_projection;
+
+                std::vector<Eigen::Vector2f> eigen_contour;
+                std::for_each(undistort_contour.begin(),
+                              undistort_contour.end(),
+                              [&eigen_contour](const cv::Point2f& p) {
+                                  eigen_contour.push_back(Eigen::Vector2f(p.x, p.y));
+                              });
+                eigen_alignment_fit_focal_cone_to_sphere(eigen_contour.data(),
+                                                         static_cast<int>(eigen_contour.size()),
+                                                         tracking_shape->shape.sphere.radius_cm,
+                                                         1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
+                                                         &sphere_center,
+                                                         &ellipse_projection);
+                
+                if (ellipse_projection.area > k_real_epsilon)
+                {
+                    //Save the optically-estimate 3D pose.
+                    out_result.position_cm.set(sphere_center.x(), sphere_center.y(), sphere_center.z());
+                    out_result.bPositionValid = true;
+                    // Not possible to get an orientation off of a sphere
+                    out_result.orientation.clear();
+                    out_result.bOrientationValid = false;
+
+                    // Save off the projection of the sphere (an ellipse)
+                    CommonDeviceTrackingProjection &projection = out_result.projection;
+                    projection.shape.ellipse.angle = ellipse_projection.angle;
+                    //The ellipse projection is still in normalized space.
+                    //i.e., it is a 2-dimensional ellipse floating somewhere.
+                    //We must reproject it onto the camera.
+                    //TODO: Use opencv's project points instead of manual way below
+                    //because it will account for distortion, at least for the center point.
+                    projection.shape_type = eCommonTrackingProjectionType::ProjectionType_Ellipse;
+                    projection.shape.ellipse.center.set(
+                        ellipse_projection.center.x()*camera_matrix.val[0] + camera_matrix.val[2],
+                        ellipse_projection.center.y()*camera_matrix.val[4] + camera_matrix.val[5]);
+                    projection.shape.ellipse.half_x_extent = ellipse_projection.extents.x()*camera_matrix.val[0];
+                    projection.shape.ellipse.half_y_extent = ellipse_projection.extents.y()*camera_matrix.val[0];
+                    projection.screen_area=
+                        k_real_pi*projection.shape.ellipse.half_x_extent*projection.shape.ellipse.half_y_extent;
+                
+                    //Draw results onto the buffer state
+                    buffer_state->draw_pose_projection(projection);
+                }
+                else
+                {
+                    bSuccess = false;
+                }
+            } break;
+        // For the LightBar projection we only want to compute the projection shape.
+        // The pose estimation is deferred until we know if we can leverage triangulation or not.
+        case eCommonTrackingShapeType::LightBar:
+            {
+                // Draw the raw source contour
+                buffer_state->draw_contour(biggest_contours[0]);
+
+                // Convert integer contour to float
+                t_opencv_float_contour biggest_contour_f;
+                cv::Mat(biggest_contours[0]).convertTo(biggest_contour_f, cv::Mat(biggest_contour_f).type());
+
+                // Compute an undistorted version of the contour
+                t_opencv_float_contour undistort_contour;
+                request.undistortion_cache->undistortPointsPixels(biggest_contour_f, undistort_contour);
+
+                // Compute the lightbar tracking projection from the undistored contour
+                bSuccess=
+                    computeTrackerRelativeLightBarProjection(
+                        tracking_shape,
+                        undistort_contour,
+                        &out_result.projection);
+
+                //Draw results onto the buffer state
+                if (bSuccess)
+                {
+                    buffer_state->draw_pose_projection(out_result.projection);
+                }
+            } break;
+        case eCommonTrackingShapeType::PointCloud:
+            {
+                HMDOpticalPoseEstimation pose_estimate;
+                pose_estimate.clear();
+
+                // Gather the source contours.
+                // These stay distorted, only the blob centers get undistorted.
+                t_opencv_float_contour_list source_contours;
+                for (auto it = biggest_contours.begin(); it != biggest_contours.end(); ++it)
+                {
+                    // Draw the source contour
+                    buffer_state->draw_contour(*it);
+
+                    // Convert integer contour to float
+                    t_opencv_float_contour biggest_contour_f;
+                    cv::Mat(*it).convertTo(biggest_contour_f, cv::Mat(biggest_contour_f).type());
+
+                    source_contours.push_back(biggest_contour_f);
+                }
+
+                bSuccess =
+                    computeTrackerRelativePointCloudContourPose(
+                        request,
+                        source_contours,
+                        &pose_estimate);
+
+                if (bSuccess)
+                {
+                    out_result.projection = pose_estimate.projection;
+                    out_result.position_cm = pose_estimate.position_cm;
+                    out_result.orientation = pose_estimate.orientation;
+                    out_result.bOrientationValid = pose_estimate.bOrientationValid;
+                    out_result.bPositionValid = true;
+
+                    //Draw results onto the buffer state
+                    buffer_state->draw_pose_projection(out_result.projection);
+                }
+            } break;
+        default:
+            assert(0 && "Unreachable");
+            break;
+        }
+    }
+
+    // Throw out the controller result if the contour we found was too small and 
+    // we were using an ROI less that the size of the full screen
+    if (bSuccess && 
+        request.target_type == _TrackerVisionTarget_Controller && 
+        !request.bRoiDisabled)
+    {
+        if (request.roi.width < buffer_state->frameWidth || request.roi.height < buffer_state->frameHeight)
+        {
+            bSuccess= out_result.projection.screen_area >= request.min_valid_projection_area;
+        }
+    }
+
+    return bSuccess;
+}
+
+template <typename t_optical_pose_estimation>
+static void applyVisionResultToPoseEstimate(
+    const TrackerVisionResult &result,
+    t_optical_pose_estimation *out_pose_estimate)
+{
+    out_pose_estimate->projection = result.projection;
+    out_pose_estimate->capture_timestamp = result.capture_time;
+    out_pose_estimate->bValidCaptureTimestamp = true;
+
+    // Lightbar projections only have a pose once the multi-tracker stage decides how to solve it
+    if (result.bPositionValid)
+    {
+        out_pose_estimate->position_cm = result.position_cm;
+        out_pose_estimate->orientation = result.orientation;
+        out_pose_estimate->bOrientationValid = result.bOrientationValid;
+        out_pose_estimate->bCurrentlyTracking = true;
+    }
+}
+
 static cv::Rect2i computeTrackerROIForPoseProjection(
     const bool roi_disabled,
     const ServerTrackerView *tracker,
     const IPoseFilter* pose_filter,
     const CommonDeviceTrackingProjection *prior_tracking_projection,
+    const CommonDeviceVector *prior_tracker_relative_velocity,
+    const float prior_projection_age,
     const CommonDeviceTrackingShape *tracking_shape)
 {
     // Get expected ROI
@@ -2442,30 +3902,124 @@ static cv::Rect2i computeTrackerROIForPoseProjection(
             } break;
         }
 
-        // The center of the ROI is the pixel projection center from last frame
-        // The size of the ROI computed by projecting the bounding box 
+        // Where the device should be by now in tracker space.
+        // Prefer the velocity this tracker observed, since the fused filter velocity
+        // also carries any calibration mismatch between the trackers.
+        // (Light bar projections don't get a per-tracker position every frame, so they can't)
+        const float prediction_time = clampf(prior_projection_age, 0.f, k_max_roi_prediction_time);
+        CommonDeviceVector tracker_velocity_cm_per_sec;
+        if (prior_tracker_relative_velocity != nullptr &&
+            prior_tracking_projection->shape_type != eCommonTrackingProjectionType::ProjectionType_LightBar)
         {
-            std::vector<CommonDevicePosition> trps{ tl, br };
-            std::vector<CommonDeviceScreenLocation> screen_locs = tracker->projectTrackerRelativePositions(trps);
-
-            const int proj_min_x = static_cast<int>(std::min(screen_locs[0].x, screen_locs[1].x));
-            const int proj_max_x = static_cast<int>(std::max(screen_locs[0].x, screen_locs[1].x));
-            const int proj_min_y = static_cast<int>(std::min(screen_locs[0].y, screen_locs[1].y));
-            const int proj_max_y = static_cast<int>(std::max(screen_locs[0].y, screen_locs[1].y));
+            tracker_velocity_cm_per_sec = *prior_tracker_relative_velocity;
+        }
+        else
+        {
+            const Eigen::Vector3f world_velocity_cm_per_sec = pose_filter->getVelocityCmPerSec();
+            CommonDevicePosition world_offset_cm;
+            world_offset_cm.set(
+                world_position_cm.x + world_velocity_cm_per_sec.x(),
+                world_position_cm.y + world_velocity_cm_per_sec.y(),
+                world_position_cm.z + world_velocity_cm_per_sec.z());
+            const CommonDevicePosition tracker_offset_cm = tracker->computeTrackerPosition(&world_offset_cm);
+
+            tracker_velocity_cm_per_sec.set(
+                tracker_offset_cm.x - tracker_position_cm.x,
+                tracker_offset_cm.y - tracker_position_cm.y,
+                tracker_offset_cm.z - tracker_position_cm.z);
+        }
 
-            const int proj_width = proj_max_x - proj_min_x;
-            const int proj_height = proj_max_y - proj_min_y;
+        CommonDevicePosition predicted_tracker_position_cm;
+        predicted_tracker_position_cm.set(
+            tracker_position_cm.x + tracker_velocity_cm_per_sec.i*prediction_time,
+            tracker_position_cm.y + tracker_velocity_cm_per_sec.j*prediction_time,
+            tracker_position_cm.z + tracker_velocity_cm_per_sec.k*prediction_time);
 
-            const cv::Point2i roi_center(static_cast<int>(projection_pixel_center.x), static_cast<int>(projection_pixel_center.y));
+        // Rotate the filter's position covariance into tracker space
+        const Eigen::Matrix3f world_covariance = pose_filter->getPositionCovarianceCmSqr();
+        Eigen::Matrix3f world_to_tracker_rotation;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            CommonDevicePosition world_axis_cm;
+            world_axis_cm.set(
+                world_position_cm.x + ((axis == 0) ? 1.f : 0.f),
+                world_position_cm.y + ((axis == 1) ? 1.f : 0.f),
+                world_position_cm.z + ((axis == 2) ? 1.f : 0.f));
+            const CommonDevicePosition tracker_axis_cm = tracker->computeTrackerPosition(&world_axis_cm);
+
+            world_to_tracker_rotation.col(axis) = Eigen::Vector3f(
+                tracker_axis_cm.x - tracker_position_cm.x,
+                tracker_axis_cm.y - tracker_position_cm.y,
+                tracker_axis_cm.z - tracker_position_cm.z);
+        }
+        const Eigen::Matrix3f tracker_covariance =
+            world_to_tracker_rotation * world_covariance * world_to_tracker_rotation.transpose();
+        const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> covariance_solver(tracker_covariance);
+
+        // Project the shape extents, the current and predicted positions,
+        // and the principal axes of the uncertainty ellipsoid around the predicted position
+        std::vector<CommonDevicePosition> trps{ tl, br, tracker_position_cm, predicted_tracker_position_cm };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float sigma = sqrtf(fmaxf(covariance_solver.eigenvalues()[axis], 0.f));
+            const Eigen::Vector3f offset = covariance_solver.eigenvectors().col(axis) * (sigma * k_roi_sigma_count);
+            CommonDevicePosition axis_point;
+
+            axis_point.set(
+                predicted_tracker_position_cm.x + offset.x(),
+                predicted_tracker_position_cm.y + offset.y(),
+                predicted_tracker_position_cm.z + offset.z());
+            trps.push_back(axis_point);
+            axis_point.set(
+                predicted_tracker_position_cm.x - offset.x(),
+                predicted_tracker_position_cm.y - offset.y(),
+                predicted_tracker_position_cm.z - offset.z());
+            trps.push_back(axis_point);
+        }
+        const std::vector<CommonDeviceScreenLocation> screen_locs = tracker->projectTrackerRelativePositions(trps);
 
-            const int safe_proj_width = std::max(proj_width, k_min_roi_size);
-            const int safe_proj_height = std::max(proj_height, k_min_roi_size);
+        const float shape_half_width = 0.5f*fabsf(screen_locs[0].x - screen_locs[1].x);
+        const float shape_half_height = 0.5f*fabsf(screen_locs[0].y - screen_locs[1].y);
 
-            const cv::Point2i roi_top_left = roi_center + cv::Point2i(-safe_proj_width, -safe_proj_height);
-            const cv::Size roi_size(2*safe_proj_width, 2*safe_proj_height);
+        float uncertainty_half_width = 0.f;
+        float uncertainty_half_height = 0.f;
+        for (size_t loc_index = 4; loc_index < screen_locs.size(); ++loc_index)
+        {
+            uncertainty_half_width = fmaxf(uncertainty_half_width, fabsf(screen_locs[loc_index].x - screen_locs[3].x));
+            uncertainty_half_height = fmaxf(uncertainty_half_height, fabsf(screen_locs[loc_index].y - screen_locs[3].y));
+        }
 
-            ROI = cv::Rect2i(roi_top_left, roi_size);
+        // Anchor on last frame's projection (it's what this tracker actually saw)
+        // and shift it by however much the predicted motion moves the projection.
+        // The ROI spans both in case the device stopped or turned around.
+        const float predicted_center_x = projection_pixel_center.x + (screen_locs[3].x - screen_locs[2].x);
+        const float predicted_center_y = projection_pixel_center.y + (screen_locs[3].y - screen_locs[2].y);
+        const float half_width = shape_half_width + uncertainty_half_width + k_roi_margin_px;
+        const float half_height = shape_half_height + uncertainty_half_height + k_roi_margin_px;
+
+        float roi_min_x = fminf(projection_pixel_center.x, predicted_center_x) - half_width;
+        float roi_max_x = fmaxf(projection_pixel_center.x, predicted_center_x) + half_width;
+        float roi_min_y = fminf(projection_pixel_center.y, predicted_center_y) - half_height;
+        float roi_max_y = fmaxf(projection_pixel_center.y, predicted_center_y) + half_height;
+
+        // Don't let the ROI collapse around a tiny or far away projection
+        if (roi_max_x - roi_min_x < k_min_roi_size)
+        {
+            const float center_x = 0.5f*(roi_min_x + roi_max_x);
+            roi_min_x = center_x - 0.5f*k_min_roi_size;
+            roi_max_x = center_x + 0.5f*k_min_roi_size;
         }
+        if (roi_max_y - roi_min_y < k_min_roi_size)
+        {
+            const float center_y = 0.5f*(roi_min_y + roi_max_y);
+            roi_min_y = center_y - 0.5f*k_min_roi_size;
+            roi_max_y = center_y + 0.5f*k_min_roi_size;
+        }
+
+        const cv::Point2i roi_top_left(static_cast<int>(floorf(roi_min_x)), static_cast<int>(floorf(roi_min_y)));
+        const cv::Point2i roi_bottom_right(static_cast<int>(ceilf(roi_max_x)), static_cast<int>(ceilf(roi_max_y)));
+
+        ROI = cv::Rect2i(roi_top_left, roi_bottom_right);
     }
 
     return ROI;
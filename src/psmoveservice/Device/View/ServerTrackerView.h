@@ -4,6 +4,10 @@
 //-- includes -----
 #include "ServerDeviceView.h"
 #include "PSMoveProtocolInterface.h"
+#include "opencv2/core/core.hpp"
+#include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 
 // -- pre-declarations -----
@@ -25,8 +29,15 @@ public:
 
     // Starts or stops streaming of the video feed to the shared memory buffer.
     // Keep a ref count of how many clients are following the stream.
-    void startSharedMemoryVideoStream();
-    void stopSharedMemoryVideoStream();
+    // Each client picks a stream format (see eSharedVideoFrameFormat), each with its own shared memory block,
+    // and the debug overlay layers it wants (see eTrackerDebugOverlayLayer).
+    // Every stream of a format shows all of the layers its clients asked for.
+    // Stop with the same layers and format the stream started with.
+    void startSharedMemoryVideoStream(unsigned int debug_overlay_layers = 0, int video_stream_format = 0);
+    void stopSharedMemoryVideoStream(unsigned int debug_overlay_layers = 0, int video_stream_format = 0);
+
+    // Debug overlay layers wanted by any stream watching this tracker (0 when nobody is watching)
+    unsigned int getDebugOverlayLayers() const;
 
     // Fetch the next video frame and copy to shared memory
     bool poll() override;
@@ -42,7 +53,8 @@ public:
     // Returns the full usb device path for the controller
     std::string getUSBDevicePath() const;
 
-    // Returns the name of the shared memory block video frames are written to
+    // Returns the name of the shared memory block full resolution video frames are written to.
+    // The other stream formats use this name with a suffix (see getSharedVideoFrameStreamName).
     std::string getSharedMemoryStreamName() const;
     
     void loadSettings();
@@ -71,6 +83,36 @@ public:
 		const class ServerHMDView* tracked_hmd,
 		const struct CommonDeviceTrackingShape *tracking_shape,
 		struct HMDOpticalPoseEstimation *out_pose_estimate);
+
+    // Returns true if blob finding for this tracker runs on a dedicated vision worker thread
+    inline bool getIsVisionWorkerEnabled() const { return m_vision_worker != nullptr; }
+
+    // Video frames the vision stage searched, and ones it skipped because
+    // the vision worker was still busy or the vision time budget was spent
+    inline int getProcessedVisionFrameCount() const { return m_processed_vision_frame_count; }
+    inline int getDroppedVisionFrameCount() const { return m_dropped_vision_frame_count; }
+
+    // Queue a projection request against the most recently captured video frame.
+    // Queued requests are handed to the vision worker thread in dispatchVisionRequests().
+    bool requestProjectionForController(
+        const class ServerControllerView* tracked_controller,
+        const struct CommonDeviceTrackingShape *tracking_shape);
+    bool requestProjectionForHMD(
+        const class ServerHMDView* tracked_hmd,
+        const struct CommonDeviceTrackingShape *tracking_shape);
+
+    // Hand all queued projection requests to the vision worker thread
+    void dispatchVisionRequests();
+
+    // Fetch a projection the vision worker thread computed since the last fetch.
+    // Returns false if the tracked device wasn't found in the last processed frame.
+    bool fetchProjectionForController(
+        const class ServerControllerView* tracked_controller,
+        struct ControllerOpticalPoseEstimation *out_pose_estimate);
+    bool fetchProjectionForHMD(
+        const class ServerHMDView* tracked_hmd,
+        struct HMDOpticalPoseEstimation *out_pose_estimate);
+
     bool computePoseForProjection(
 		const struct CommonDeviceTrackingProjection *projection,
 		const struct CommonDeviceTrackingShape *tracking_shape,
@@ -102,6 +144,16 @@ public:
 		const int screen_location_count,
 		CommonDevicePosition *out_result);
 
+    /// Given the screen location of the same point on any number of trackers, compute its world space location
+    /// with a single weighted least squares solve over all of them. Weights are optional (e.g. projection areas).
+    /// Returns false if the trackers can't pin down the point (fewer than two, or parallel rays).
+    static bool triangulateWorldPositionFromTrackers(
+        const ServerTrackerView * const *trackers,
+        const CommonDeviceScreenLocation *screen_locations,
+        const float *weights,
+        const int tracker_count,
+        CommonDevicePosition *out_result);
+
     /// Given screen projections on two different trackers, compute the triangulated world space location
     static CommonDevicePose triangulateWorldPose(
         const ServerTrackerView *tracker, const CommonDeviceTrackingProjection *tracker_relative_projection,
@@ -142,15 +194,57 @@ protected:
     bool allocate_device_interface(const class DeviceEnumerator *enumerator) override;
     void free_device_interface() override;
     void publish_device_data_frame() override;
+    void updateColorLabelTable();
+    bool prepareVisionRequestForController(
+        const class ServerControllerView* tracked_controller,
+        const struct CommonDeviceTrackingShape *tracking_shape,
+        struct TrackerVisionRequest &out_request) const;
+    bool prepareVisionRequestForHMD(
+        const class ServerHMDView* tracked_hmd,
+        const struct CommonDeviceTrackingShape *tracking_shape,
+        struct TrackerVisionRequest &out_request) const;
+    // Tallies the previous video frame's vision statistics and
+    // starts a new frame's worth of full frame searches for lost devices
+    void beginVisionFrame();
+    // Returns false if the request is a full frame search for a lost device that has to wait for a later frame.
+    // Devices that have waited the longest get searched first, so they all get a turn.
+    bool consumeFullFrameSearchBudget(const struct TrackerVisionRequest &request);
+    // Computes the projection on the main thread, unless this update's vision time budget is already spent
+    bool computeProjectionWithinVisionBudget(
+        const struct TrackerVisionRequest &request,
+        struct TrackerVisionResult &out_result);
+    // Returns the cached world to screen pinhole camera matrix
+    const cv::Matx34f &getProjectionMatrix() const;
+    // Returns the undistortion cache for the given intrinsics, rebuilding it if they changed
+    std::shared_ptr<const class OpenCVUndistortionCache> getUndistortionCache(
+        const cv::Matx33f &camera_matrix,
+        const cv::Matx<float, 5, 1> &distortions) const;
     static void generate_tracker_data_frame_for_stream(
         const ServerTrackerView *tracker_view, const struct TrackerStreamInfo *stream_info,
         DeviceOutputDataFramePtr &data_frame);
 
 private:
     char m_shared_memory_name[256];
-    class SharedVideoFrameReadWriteAccessor *m_shared_memory_accesor;
-    int m_shared_memory_video_stream_count;
+    class SharedVideoFrameStreamSet *m_shared_memory_streams;
     class OpenCVBufferState *m_opencv_buffer_state;
+    class TrackerVisionWorker *m_vision_worker;
+    bool m_bHasVisionFrame;
+    // Built lazily on the main thread, shared read-only with vision requests
+    mutable std::shared_ptr<const class OpenCVUndistortionCache> m_undistortion_cache;
+    // World to screen pinhole camera matrix, rebuilt when the pose or intrinsics change
+    mutable cv::Matx34f m_projection_matrix;
+    mutable bool m_bProjectionMatrixValid;
+    // Full frame search budget state
+    int m_vision_frame_index;
+    int m_full_frame_search_count; // full frame searches made this frame
+    int m_oldest_deferred_search_frame; // last search frame of the longest waiting device deferred last frame
+    int m_next_oldest_deferred_search_frame; // same as above, gathered this frame
+    std::map<std::pair<int, int>, int> m_last_full_frame_search_frames; // (target type, device id) -> frame index
+    // Vision frame statistics
+    int m_processed_vision_frame_count;
+    int m_dropped_vision_frame_count;
+    bool m_bVisionFrameProcessed; // some request got computed against the current frame
+    bool m_bVisionFrameSkipped; // some request against the current frame got skipped
     ITrackerInterface *m_device;
 };
 
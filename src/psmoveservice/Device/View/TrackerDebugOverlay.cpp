@@ -0,0 +1,214 @@
+//-- includes -----
+#include "TrackerDebugOverlay.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+//-- public methods -----
+TrackerDebugOverlay::TrackerDebugOverlay()
+    : m_enabledLayers(0)
+    , m_commands()
+    , m_contourPoints()
+    , m_maskPool()
+    , m_maskCount(0)
+{
+}
+
+void TrackerDebugOverlay::beginFrame(unsigned int enabled_layers)
+{
+    m_enabledLayers = enabled_layers;
+    m_commands.clear();
+    m_contourPoints.clear();
+    m_maskCount = 0;
+}
+
+void TrackerDebugOverlay::addRectangle(eTrackerDebugOverlayLayer layer, const cv::Rect2i &rect, const cv::Scalar &color)
+{
+    if (getIsLayerEnabled(layer))
+    {
+        DrawCommand command;
+        command.type = DrawCommand_Rectangle;
+        command.layer = layer;
+        command.color = color;
+        command.rect = rect;
+
+        m_commands.push_back(command);
+    }
+}
+
+void TrackerDebugOverlay::addContour(eTrackerDebugOverlayLayer layer, const std::vector<cv::Point> &contour, const cv::Scalar &color)
+{
+    if (getIsLayerEnabled(layer) && contour.size() > 0)
+    {
+        DrawCommand command;
+        command.type = DrawCommand_Contour;
+        command.layer = layer;
+        command.color = color;
+        command.data_index = static_cast<int>(m_contourPoints.size());
+        command.data_count = static_cast<int>(contour.size());
+
+        m_contourPoints.insert(m_contourPoints.end(), contour.begin(), contour.end());
+        m_commands.push_back(command);
+    }
+}
+
+void TrackerDebugOverlay::addEllipse(
+    eTrackerDebugOverlayLayer layer, const cv::Point &center, const cv::Size &axes, float angle, const cv::Scalar &color)
+{
+    if (getIsLayerEnabled(layer))
+    {
+        DrawCommand command;
+        command.type = DrawCommand_Ellipse;
+        command.layer = layer;
+        command.color = color;
+        command.rect = cv::Rect2i(center, axes);
+        command.angle = angle;
+
+        m_commands.push_back(command);
+    }
+}
+
+void TrackerDebugOverlay::addLine(eTrackerDebugOverlayLayer layer, const cv::Point &pt1, const cv::Point &pt2, const cv::Scalar &color)
+{
+    if (getIsLayerEnabled(layer))
+    {
+        DrawCommand command;
+        command.type = DrawCommand_Line;
+        command.layer = layer;
+        command.color = color;
+        command.pt1 = pt1;
+        command.pt2 = pt2;
+
+        m_commands.push_back(command);
+    }
+}
+
+void TrackerDebugOverlay::addMarker(eTrackerDebugOverlayLayer layer, const cv::Point &position, int size, const cv::Scalar &color)
+{
+    if (getIsLayerEnabled(layer))
+    {
+        DrawCommand command;
+        command.type = DrawCommand_Marker;
+        command.layer = layer;
+        command.color = color;
+        command.pt1 = position;
+        command.size = size;
+
+        m_commands.push_back(command);
+    }
+}
+
+void TrackerDebugOverlay::addMask(eTrackerDebugOverlayLayer layer, const cv::Mat &mask, const cv::Point &offset, const cv::Scalar &color)
+{
+    if (getIsLayerEnabled(layer) && !mask.empty())
+    {
+        if (m_maskCount >= static_cast<int>(m_maskPool.size()))
+        {
+            m_maskPool.push_back(cv::Mat());
+        }
+        mask.copyTo(m_maskPool[m_maskCount]);
+
+        DrawCommand command;
+        command.type = DrawCommand_Mask;
+        command.layer = layer;
+        command.color = color;
+        command.rect = cv::Rect2i(offset, mask.size());
+        command.data_index = m_maskCount;
+
+        ++m_maskCount;
+        m_commands.push_back(command);
+    }
+}
+
+void TrackerDebugOverlay::render(const cv::Mat &frame, cv::Mat &out_frame, unsigned int layers) const
+{
+    frame.copyTo(out_frame);
+    draw(out_frame, layers);
+}
+
+void TrackerDebugOverlay::draw(cv::Mat &out_frame, unsigned int layers) const
+{
+    const cv::Rect2i frame_rect(0, 0, out_frame.cols, out_frame.rows);
+
+    for (auto it = m_commands.begin(); it != m_commands.end(); ++it)
+    {
+        const DrawCommand &command = *it;
+
+        if ((command.layer & layers) == 0)
+        {
+            continue;
+        }
+
+        switch (command.type)
+        {
+        case DrawCommand_Rectangle:
+            {
+                cv::rectangle(out_frame, command.rect, command.color);
+            } break;
+        case DrawCommand_Contour:
+            {
+                const cv::Point *points = &m_contourPoints[command.data_index];
+                const int point_count = command.data_count;
+
+                cv::polylines(out_frame, &points, &point_count, 1, true, command.color);
+            } break;
+        case DrawCommand_Ellipse:
+            {
+                cv::ellipse(out_frame, command.rect.tl(), command.rect.size(), command.angle, 0, 360, command.color);
+            } break;
+        case DrawCommand_Line:
+            {
+                cv::line(out_frame, command.pt1, command.pt2, command.color);
+            } break;
+        case DrawCommand_Marker:
+            {
+                cv::drawMarker(out_frame, command.pt1, command.color, cv::MARKER_CROSS, command.size);
+            } break;
+        case DrawCommand_Mask:
+            {
+                // Blend the mask color over the masked pixels
+                const cv::Rect2i mask_rect = command.rect & frame_rect;
+
+                if (mask_rect.area() > 0)
+                {
+                    const cv::Mat mask(
+                        m_maskPool[command.data_index],
+                        cv::Rect2i(mask_rect.tl() - command.rect.tl(), mask_rect.size()));
+                    cv::Mat frameROI(out_frame, mask_rect);
+                    cv::Mat tinted;
+
+                    cv::addWeighted(frameROI, 0.5, cv::Mat(frameROI.size(), frameROI.type(), command.color), 0.5, 0.0, tinted);
+                    tinted.copyTo(frameROI, mask);
+                }
+            } break;
+        }
+    }
+}
+
+void TrackerDebugOverlay::renderMasks(const cv::Size &frame_size, cv::Mat &out_mask) const
+{
+    out_mask.create(frame_size, CV_8UC1);
+    out_mask.setTo(cv::Scalar(0));
+
+    const cv::Rect2i frame_rect(0, 0, frame_size.width, frame_size.height);
+
+    for (auto it = m_commands.begin(); it != m_commands.end(); ++it)
+    {
+        const DrawCommand &command = *it;
+
+        if (command.type == DrawCommand_Mask)
+        {
+            const cv::Rect2i mask_rect = command.rect & frame_rect;
+
+            if (mask_rect.area() > 0)
+            {
+                const cv::Mat mask(
+                    m_maskPool[command.data_index],
+                    cv::Rect2i(mask_rect.tl() - command.rect.tl(), mask_rect.size()));
+                cv::Mat maskROI(out_mask, mask_rect);
+
+                // Masks from overlapping ROIs get combined
+                cv::bitwise_or(maskROI, mask, maskROI);
+            }
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef TRACKER_DEBUG_OVERLAY_H
+#define TRACKER_DEBUG_OVERLAY_H
+
+//-- includes -----
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+
+// -- constants -----
+// Bit flags for the things the vision stage can draw over a tracker's video stream.
+// Video stream clients pick which ones they want (see RequestStartTrackerDataStream).
+enum eTrackerDebugOverlayLayer
+{
+    TrackerDebugOverlay_SearchROI = 1 << 0, // clamped region each vision request searched
+    TrackerDebugOverlay_Contours = 1 << 1, // contours found in the color mask
+    TrackerDebugOverlay_Projections = 1 << 2, // fitted shape projections
+    TrackerDebugOverlay_PredictedROI = 1 << 3, // unclamped region predicted from the pose filter
+    TrackerDebugOverlay_Masks = 1 << 4, // tint over the pixels that passed the color threshold
+
+    TrackerDebugOverlay_LayerCount = 5,
+    TrackerDebugOverlay_AllLayers = (1 << TrackerDebugOverlay_LayerCount) - 1,
+
+    // What the video stream always used to show
+    TrackerDebugOverlay_DefaultLayers =
+        TrackerDebugOverlay_SearchROI | TrackerDebugOverlay_Contours | TrackerDebugOverlay_Projections,
+
+    // Requests the plain video with nothing drawn over it (a requested mask of 0 means the default layers)
+    TrackerDebugOverlay_NoLayers = 1 << 30,
+};
+
+// Turns the layer mask a video stream asked for into the layers to record
+inline unsigned int resolveTrackerDebugOverlayLayers(unsigned int requested_layers)
+{
+    return (requested_layers == 0) ? TrackerDebugOverlay_DefaultLayers : (requested_layers & TrackerDebugOverlay_AllLayers);
+}
+
+// -- declarations -----
+// Records debug draw commands against a video frame and renders them over a copy of the frame on demand.
+// Nothing gets recorded for layers that aren't enabled, so with no one watching the video stream
+// the vision stage only pays for the enabled check.
+class TrackerDebugOverlay
+{
+public:
+    TrackerDebugOverlay();
+
+    // Throws away the last frame's commands and sets which layers to record for the new frame
+    void beginFrame(unsigned int enabled_layers);
+
+    inline unsigned int getEnabledLayers() const { return m_enabledLayers; }
+    inline bool getIsLayerEnabled(eTrackerDebugOverlayLayer layer) const { return (m_enabledLayers & layer) != 0; }
+
+    void addRectangle(eTrackerDebugOverlayLayer layer, const cv::Rect2i &rect, const cv::Scalar &color);
+    void addContour(eTrackerDebugOverlayLayer layer, const std::vector<cv::Point> &contour, const cv::Scalar &color);
+    void addEllipse(eTrackerDebugOverlayLayer layer, const cv::Point &center, const cv::Size &axes, float angle, const cv::Scalar &color);
+    void addLine(eTrackerDebugOverlayLayer layer, const cv::Point &pt1, const cv::Point &pt2, const cv::Scalar &color);
+    void addMarker(eTrackerDebugOverlayLayer layer, const cv::Point &position, int size, const cv::Scalar &color);
+    // Copies the mask, since mask buffers get reused by the next vision request
+    void addMask(eTrackerDebugOverlayLayer layer, const cv::Mat &mask, const cv::Point &offset, const cv::Scalar &color);
+
+    // Copies the frame into out_frame and draws the recorded commands of the given layers over it
+    void render(const cv::Mat &frame, cv::Mat &out_frame, unsigned int layers = TrackerDebugOverlay_AllLayers) const;
+
+    // Draws the recorded commands of the given layers over the frame in place
+    void draw(cv::Mat &frame, unsigned int layers = TrackerDebugOverlay_AllLayers) const;
+
+    // Writes the recorded masks into a single channel image of the given size (255 = pixel passed the threshold)
+    void renderMasks(const cv::Size &frame_size, cv::Mat &out_mask) const;
+
+private:
+    enum eDrawCommandType
+    {
+        DrawCommand_Rectangle,
+        DrawCommand_Contour,
+        DrawCommand_Ellipse,
+        DrawCommand_Line,
+        DrawCommand_Marker,
+        DrawCommand_Mask,
+    };
+
+    struct DrawCommand
+    {
+        eDrawCommandType type;
+        eTrackerDebugOverlayLayer layer;
+        cv::Scalar color;
+        cv::Rect2i rect; // rectangle, mask placement, or ellipse center and axes
+        cv::Point pt1, pt2; // line end points or marker position
+        float angle;
+        int size;
+        int data_index; // first contour point or mask pool index
+        int data_count; // contour point count
+    };
+
+    unsigned int m_enabledLayers;
+    std::vector<DrawCommand> m_commands;
+    std::vector<cv::Point> m_contourPoints;
+    std::vector<cv::Mat> m_maskPool; // kept between frames so mask copies don't reallocate
+    int m_maskCount;
+};
+
+#endif // TRACKER_DEBUG_OVERLAY_H
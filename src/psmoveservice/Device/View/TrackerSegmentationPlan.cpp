@@ -0,0 +1,142 @@
+//-- includes -----
+#include "TrackerSegmentationPlan.h"
+#include "OpenCVBlobExtractor.h"
+
+//-- private methods -----
+static int countColors(unsigned char color_mask)
+{
+    int color_count = 0;
+
+    for (; color_mask != 0; color_mask &= color_mask - 1)
+    {
+        ++color_count;
+    }
+
+    return color_count;
+}
+
+static void appendRegionRequests(TrackerSegmentationRegion &region, const TrackerSegmentationRegion &other_region)
+{
+    region.color_mask |= other_region.color_mask;
+    region.requests.insert(region.requests.end(), other_region.requests.begin(), other_region.requests.end());
+}
+
+//-- public methods -----
+int getSegmentationRegionCost(const TrackerSegmentationRegion &region)
+{
+    return region.roi.area() * countColors(region.color_mask);
+}
+
+void planSegmentationRegions(
+    const int frame_width,
+    const int frame_height,
+    const std::vector<TrackerSegmentationRequest> &requests,
+    std::vector<TrackerSegmentationRegion> &out_regions)
+{
+    out_regions.clear();
+
+    for (const TrackerSegmentationRequest &request : requests)
+    {
+        TrackerSegmentationRegion region;
+        region.roi = request.search_roi;
+        region.color_mask = static_cast<unsigned char>(1 << request.color_id);
+        region.requests.push_back(request);
+        out_regions.push_back(region);
+    }
+
+    bool bMerged = true;
+
+    while (bMerged)
+    {
+        bMerged = false;
+
+        for (size_t index_a = 0; index_a < out_regions.size() && !bMerged; ++index_a)
+        {
+            for (size_t index_b = index_a + 1; index_b < out_regions.size() && !bMerged; ++index_b)
+            {
+                TrackerSegmentationRegion &region_a = out_regions[index_a];
+                const TrackerSegmentationRegion &region_b = out_regions[index_b];
+
+                TrackerSegmentationRegion merged_region;
+                merged_region.roi = region_a.roi | region_b.roi;
+                merged_region.color_mask = region_a.color_mask | region_b.color_mask;
+
+                // Differently colored regions never pass this, each color would still need its own pass
+                // over the bigger bounding box (the color label image is cached per tile either way)
+                if (getSegmentationRegionCost(merged_region) <
+                    getSegmentationRegionCost(region_a) + getSegmentationRegionCost(region_b))
+                {
+                    region_a.roi = merged_region.roi;
+                    appendRegionRequests(region_a, region_b);
+                    out_regions.erase(out_regions.begin() + index_b);
+                    bMerged = true;
+                }
+            }
+        }
+    }
+
+    if (out_regions.size() > 1)
+    {
+        TrackerSegmentationRegion full_frame_region;
+        full_frame_region.roi = cv::Rect2i(0, 0, frame_width, frame_height);
+        full_frame_region.color_mask = 0;
+
+        int total_cost = 0;
+        for (const TrackerSegmentationRegion &region : out_regions)
+        {
+            full_frame_region.color_mask |= region.color_mask;
+            total_cost += getSegmentationRegionCost(region);
+        }
+
+        if (total_cost > getSegmentationRegionCost(full_frame_region))
+        {
+            for (const TrackerSegmentationRegion &region : out_regions)
+            {
+                appendRegionRequests(full_frame_region, region);
+            }
+
+            out_regions.clear();
+            out_regions.push_back(full_frame_region);
+        }
+    }
+}
+
+void segmentRegionByColor(
+    const TrackerSegmentationRegion &region,
+    const cv::Mat &region_labels,
+    cv::Mat &region_mask,
+    OpenCVBlobExtractor &blob_extractor,
+    const t_segmentation_request_func &request_func)
+{
+    for (int color_index = 0; color_index < eCommonTrackingColorID::MAX_TRACKING_COLOR_TYPES; ++color_index)
+    {
+        const unsigned char color_bit = static_cast<unsigned char>(1 << color_index);
+
+        if ((region.color_mask & color_bit) == 0)
+        {
+            continue;
+        }
+
+        // Blobs are joined on this color's bit alone, same as on a request's own ROI
+        cv::bitwise_and(region_labels, cv::Scalar(color_bit), region_mask);
+        blob_extractor.extractBlobs(region_mask);
+
+        for (const TrackerSegmentationRequest &request : region.requests)
+        {
+            if (request.color_id != color_index)
+            {
+                continue;
+            }
+
+            // Only blobs centered in the request's own ROI,
+            // so merging doesn't expose it to anything it wouldn't have seen on its own
+            const cv::Rect2f centroid_region(
+                static_cast<float>(request.search_roi.x - region.roi.x),
+                static_cast<float>(request.search_roi.y - region.roi.y),
+                static_cast<float>(request.search_roi.width),
+                static_cast<float>(request.search_roi.height));
+
+            request_func(request, centroid_region);
+        }
+    }
+}
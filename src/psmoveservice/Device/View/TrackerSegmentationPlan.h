@@ -0,0 +1,61 @@
+#ifndef TRACKER_SEGMENTATION_PLAN_H
+#define TRACKER_SEGMENTATION_PLAN_H
+
+//-- includes -----
+#include "DeviceInterface.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <functional>
+#include <vector>
+
+// -- declarations -----
+class OpenCVBlobExtractor;
+
+// A vision request's tracking color and its search ROI (already clamped to the frame)
+struct TrackerSegmentationRequest
+{
+    int request_index; // the caller's index for the request
+    eCommonTrackingColorID color_id;
+    cv::Rect2i search_roi;
+};
+
+// One search region of the frame and the requests whose ROIs were merged into it
+struct TrackerSegmentationRegion
+{
+    cv::Rect2i roi;
+    unsigned char color_mask; // colors of every request searching this region
+    std::vector<TrackerSegmentationRequest> requests;
+};
+
+// Called for every request of a region while the blobs of its color are in the blob extractor.
+// centroid_region is the request's search ROI in region coordinates.
+typedef std::function<void(const TrackerSegmentationRequest &request, const cv::Rect2f &centroid_region)>
+    t_segmentation_request_func;
+
+// Pixels the blob passes of a region cover: the whole region once per color
+int getSegmentationRegionCost(const TrackerSegmentationRegion &region);
+
+// Groups the requests into regions, one per request to start with.
+// Regions are merged whenever one pass per color over their bounding box covers fewer pixels than their
+// separate passes did, and all of them collapse into one full frame region if that covers fewer still.
+// So the regions never cost more than segmenting each request's own ROI,
+// nor more than one full frame pass per color.
+void planSegmentationRegions(
+    const int frame_width,
+    const int frame_height,
+    const std::vector<TrackerSegmentationRequest> &requests,
+    std::vector<TrackerSegmentationRegion> &out_regions);
+
+// For every color of the region, masks the region's color label image down to that color's bit
+// (pixels matching several colors count for each of them) and extracts the blobs of the mask,
+// then calls request_func for the requests of that color.
+// region_mask is a CV_8UC1 image the size of the region that the masks get written to.
+void segmentRegionByColor(
+    const TrackerSegmentationRegion &region,
+    const cv::Mat &region_labels,
+    cv::Mat &region_mask,
+    OpenCVBlobExtractor &blob_extractor,
+    const t_segmentation_request_func &request_func);
+
+#endif // TRACKER_SEGMENTATION_PLAN_H
@@ -62,6 +62,12 @@ void CompoundPoseFilter::allocate_filters(
 {
 	dispose_filters();
 
+	// Assume the worst until the first optical measurement comes in
+	m_position_variance_curve = constant.position_constants.position_variance_curve;
+	m_optical_position_variance_cm_sqr =
+		m_position_variance_curve.MaxValue * k_meters_to_centimeters * k_meters_to_centimeters;
+	m_time_since_optical_update = 0.f;
+
 	switch(orientationFilterType)
 	{
     case OrientationFilterTypeNone:
@@ -155,6 +161,19 @@ void CompoundPoseFilter::update(
 
 		m_position_filter->update(delta_time, position_filter_packet);
 	}
+
+    // Keep track of how noisy the last optical position was and how long ago it was
+    if (orientation_filter_packet.tracking_projection_area_px_sqr > 0.f)
+    {
+        m_optical_position_variance_cm_sqr =
+            m_position_variance_curve.evaluate(orientation_filter_packet.tracking_projection_area_px_sqr)
+            * k_meters_to_centimeters * k_meters_to_centimeters;
+        m_time_since_optical_update = 0.f;
+    }
+    else
+    {
+        m_time_since_optical_update += delta_time;
+    }
 }
 
 void CompoundPoseFilter::resetState()
@@ -164,6 +183,10 @@ void CompoundPoseFilter::resetState()
 		m_orientation_filter->resetState();
 		m_position_filter->resetState();
 	}
+
+	m_optical_position_variance_cm_sqr =
+		m_position_variance_curve.MaxValue * k_meters_to_centimeters * k_meters_to_centimeters;
+	m_time_since_optical_update = 0.f;
 }
 
 void CompoundPoseFilter::recenterOrientation(const Eigen::Quaternionf& q_pose)
@@ -214,6 +237,23 @@ Eigen::Vector3f CompoundPoseFilter::getAccelerationCmPerSecSqr() const
 	return (m_position_filter != nullptr) ? m_position_filter->getAccelerationCmPerSecSqr() : Eigen::Vector3f::Zero();
 }
 
+Eigen::Matrix3f CompoundPoseFilter::getPositionCovarianceCmSqr() const
+{
+	Eigen::Matrix3f covariance;
+
+	if (m_position_filter == nullptr || !m_position_filter->getPositionCovarianceCmSqr(covariance))
+	{
+		// Approximate it as the noise of the last optical measurement,
+		// plus however far the device could have moved since then
+		const float drift_cm = getVelocityCmPerSec().norm() * m_time_since_optical_update;
+		const float variance_cm_sqr = m_optical_position_variance_cm_sqr + drift_cm*drift_cm;
+
+		covariance = Eigen::Matrix3f::Identity() * variance_cm_sqr;
+	}
+
+	return covariance;
+}
+
 void CompoundPoseFilter::dispose_filters()
 {
 	if (m_orientation_filter != nullptr)
@@ -33,7 +33,11 @@ public:
     CompoundPoseFilter() 
         : m_position_filter(nullptr)
         , m_orientation_filter(nullptr)
-    {}
+        , m_optical_position_variance_cm_sqr(0.f)
+        , m_time_since_optical_update(0.f)
+    {
+        m_position_variance_curve.clear();
+    }
     virtual ~CompoundPoseFilter()
     { dispose_filters(); }
 
@@ -65,6 +69,7 @@ public:
     Eigen::Vector3f getPositionCm(float time = 0.f) const override;
     Eigen::Vector3f getVelocityCmPerSec() const override;
     Eigen::Vector3f getAccelerationCmPerSecSqr() const override;
+    Eigen::Matrix3f getPositionCovarianceCmSqr() const override;
 
 protected:
 	void allocate_filters(
@@ -76,6 +81,11 @@ protected:
 
     IPositionFilter *m_position_filter;
     IOrientationFilter *m_orientation_filter;
+
+    // Used to estimate the position uncertainty when the position filter doesn't track it
+    ExponentialCurve m_position_variance_curve; // meters^2 as a function of projection area
+    float m_optical_position_variance_cm_sqr;
+    float m_time_since_optical_update; // seconds
 };
 
 #endif // COMPOUND_POSE_FILTER_H
\ No newline at end of file
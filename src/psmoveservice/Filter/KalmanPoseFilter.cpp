@@ -1132,6 +1132,20 @@ public:
 		return new_state;
 	}
 
+	/**
+	* @brief Covariance of the position part of the state (meters^2)
+	*/
+	Eigen::Matrix3d get_position_covariance() const
+	{
+		// S is the lower Cholesky factor of the state covariance
+		Eigen::Matrix<double, 3, S_DIM> S_position;
+		S_position.row(0) = S.row(NOISE_POSITION_X);
+		S_position.row(1) = S.row(NOISE_POSITION_Y);
+		S_position.row(2) = S.row(NOISE_POSITION_Z);
+
+		return S_position * S_position.transpose();
+	}
+
 	/**
 	* @brief Perform filter prediction step using control input \f$u\f$ and corresponding system model
 	*
@@ -1412,6 +1426,9 @@ public:
 		state.set_position_meters(position.cast<double>());
 		state.set_quaternion(orientation.cast<double>());
     }
+
+	/// Covariance of the filtered position (meters^2)
+	virtual Eigen::Matrix3d get_position_covariance() const = 0;
 };
 
 class DS4KalmanPoseFilterImpl : public KalmanPoseFilterImpl
@@ -1419,6 +1436,11 @@ class DS4KalmanPoseFilterImpl : public KalmanPoseFilterImpl
 public:
 	PoseSRUFK<DS4_MeasurementModel, DS4_MeasurementVector> srukf;
 
+	Eigen::Matrix3d get_position_covariance() const override
+	{
+		return srukf.get_position_covariance();
+	}
+
 	void init(
 		const PoseFilterConstants &constants) override
 	{
@@ -1441,6 +1463,11 @@ class PSMoveKalmanPoseFilterImpl : public KalmanPoseFilterImpl
 public:
 	PoseSRUFK<PSMove_MeasurementModel, PSMove_MeasurementVector> srukf;
 
+	Eigen::Matrix3d get_position_covariance() const override
+	{
+		return srukf.get_position_covariance();
+	}
+
 	void init(
 		const PoseFilterConstants &constants) override
 	{
@@ -1596,6 +1623,13 @@ Eigen::Vector3f KalmanPoseFilter::getAccelerationCmPerSecSqr() const
 	return accel.cast<float>();
 }
 
+Eigen::Matrix3f KalmanPoseFilter::getPositionCovarianceCmSqr() const
+{
+	const Eigen::Matrix3d covariance_meters_sqr = m_filter->get_position_covariance();
+
+	return (covariance_meters_sqr * k_meters_to_centimeters * k_meters_to_centimeters).cast<float>();
+}
+
 //-- KalmanPoseFilterDS4 --
 bool KalmanPoseFilterDS4::init(
 	const PoseFilterConstants &constants)
@@ -26,6 +26,7 @@ public:
 	Eigen::Vector3f getPositionCm(float time = 0.f) const override;
 	Eigen::Vector3f getVelocityCmPerSec() const override;
 	Eigen::Vector3f getAccelerationCmPerSecSqr() const override;
+	Eigen::Matrix3f getPositionCovarianceCmSqr() const override;
 
 protected:
 	PoseFilterConstants m_constants;
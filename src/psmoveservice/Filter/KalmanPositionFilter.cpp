@@ -590,6 +590,23 @@ Eigen::Vector3f KalmanPositionFilter::getAccelerationCmPerSecSqr() const
 	return accel.cast<float>();
 }
 
+bool KalmanPositionFilter::getPositionCovarianceCmSqr(Eigen::Matrix3f &out_covariance) const
+{
+    const Kalman::Covariance<PositionStateVectord> P = m_filter->ukf.getCovariance();
+    const int position_indices[3] = { POSITION_X, POSITION_Y, POSITION_Z };
+
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int col = 0; col < 3; ++col)
+        {
+            out_covariance(row, col) = static_cast<float>(
+                P(position_indices[row], position_indices[col]) * k_meters_to_centimeters * k_meters_to_centimeters);
+        }
+    }
+
+    return true;
+}
+
 //-- Private functions --
 // Adapted from: https://github.com/rlabbe/filterpy/blob/master/filterpy/common/discretization.py#L55-L57
 
@@ -23,6 +23,7 @@ public:
 	Eigen::Vector3f getPositionCm(float time = 0.f) const override;
 	Eigen::Vector3f getVelocityCmPerSec() const override;
 	Eigen::Vector3f getAccelerationCmPerSecSqr() const override;
+	bool getPositionCovarianceCmSqr(Eigen::Matrix3f &out_covariance) const override;
 
 protected:
 	PositionFilterConstants m_constants;
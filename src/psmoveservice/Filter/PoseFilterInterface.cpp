@@ -69,6 +69,17 @@ void PoseFilterSpace::createFilterPacket(
 	// Positional filtering is done is meters to improve numerical stability
     outFilterPacket.optical_position_cm = sensorPacket.optical_position_cm;
     outFilterPacket.tracking_projection_area_px_sqr= sensorPacket.tracking_projection_area_px_sqr;
+    outFilterPacket.optical_sample_age_seconds= sensorPacket.optical_sample_age_seconds;
+
+    // The optical position describes where the device was when the video frame was captured.
+    // Move it forward along the filter's current velocity to where it should be now.
+    if (sensorPacket.optical_sample_age_seconds > 0.f && sensorPacket.tracking_projection_area_px_sqr > 0.f)
+    {
+        const float compensation_seconds=
+            fminf(sensorPacket.optical_sample_age_seconds, k_max_optical_latency_compensation_seconds);
+
+        outFilterPacket.optical_position_cm+= outFilterPacket.current_linear_velocity_cm_s * compensation_seconds;
+    }
 
     outFilterPacket.imu_gyroscope_rad_per_sec= m_SensorTransform * sensorPacket.imu_gyroscope_rad_per_sec;
     outFilterPacket.imu_accelerometer_g_units= m_SensorTransform * sensorPacket.imu_accelerometer_g_units;
@@ -76,4 +87,29 @@ void PoseFilterSpace::createFilterPacket(
         
 	outFilterPacket.world_accelerometer=
 		eigen_vector3f_clockwise_rotate(outFilterPacket.current_orientation, outFilterPacket.imu_accelerometer_g_units);
+}
+
+void PoseFilterSpace::updateFilterWithSubSamples(
+    const PoseSensorPacket &sensorPacket,
+    const PoseSensorIMUSubSample *subSamples,
+    const int subSampleCount,
+    const float deltaTime,
+    IPoseFilter *poseFilter) const
+{
+    // The sub-samples were taken evenly spaced over the report interval
+    const float subSampleDeltaTime= deltaTime / static_cast<float>(subSampleCount);
+    PoseSensorPacket subSamplePacket= sensorPacket;
+
+    for (int subSampleIndex= 0; subSampleIndex < subSampleCount; ++subSampleIndex)
+    {
+        PoseFilterPacket filterPacket;
+
+        subSamplePacket.imu_accelerometer_g_units= subSamples[subSampleIndex].imu_accelerometer_g_units;
+        subSamplePacket.imu_gyroscope_rad_per_sec= subSamples[subSampleIndex].imu_gyroscope_rad_per_sec;
+
+        // Each filter packet starts from the state the previous sub-sample left the filter in
+        createFilterPacket(subSamplePacket, poseFilter, filterPacket);
+
+        poseFilter->update(subSampleDeltaTime, filterPacket);
+    }
 }
\ No newline at end of file
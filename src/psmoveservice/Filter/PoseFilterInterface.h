@@ -21,6 +21,10 @@ extern const Eigen::Matrix3f *k_eigen_sensor_transform_opengl;
 #define k_meters_to_centimeters  100.f
 #define k_centimeters_to_meters  0.01f
 
+// Optical samples older than this are only compensated up to this age.
+// Anything older than a few frames means the pipeline stalled and extrapolating further does more harm than good.
+#define k_max_optical_latency_compensation_seconds  0.1f
+
 //-- declarations -----
 struct ExponentialCurve
 {
@@ -49,6 +53,8 @@ struct PoseSensorPacket
     Eigen::Vector3f optical_position_cm; // cm
     Eigen::Quaternionf optical_orientation;
     float tracking_projection_area_px_sqr; // pixels^2
+    // How long ago the video frame the optical readings came from was captured (0 if unknown)
+    float optical_sample_age_seconds; // seconds
 
     // Sensor readings in the controller's reference frame
     Eigen::Vector3f imu_accelerometer_g_units; // g-units
@@ -61,6 +67,14 @@ struct PoseSensorPacket
 	}
 };
 
+/// One accelerometer/gyroscope reading out of a device report that packs several of them
+/// (the PSMove and Morpheus send two per report)
+struct PoseSensorIMUSubSample
+{
+    Eigen::Vector3f imu_accelerometer_g_units; // g-units
+    Eigen::Vector3f imu_gyroscope_rad_per_sec; // rad/s
+};
+
 /// A snapshot of IMU data transformed into a world space plus world space calibration vectors
 /// used to update a state filter
 struct PoseFilterPacket : PoseSensorPacket
@@ -122,6 +136,16 @@ public:
 		const class IPoseFilter *poseFilter,
         PoseFilterPacket &outFilterPacket) const;
 
+    /// Runs one filter update per IMU sub-sample of a device report, oldest first,
+    /// each over an even share of the time since the previous report.
+    /// The optical and magnetometer readings of sensorPacket go along with every sub-sample.
+    void updateFilterWithSubSamples(
+        const PoseSensorPacket &sensorPacket,
+        const PoseSensorIMUSubSample *subSamples,
+        const int subSampleCount,
+        const float deltaTime,
+        class IPoseFilter *poseFilter) const;
+
 private:
     Eigen::Vector3f m_IdentityGravity;
     Eigen::Vector3f m_IdentityMagnetometer;
@@ -279,6 +303,10 @@ public:
 
     /// Get the current velocity of the filter state (cm/s^2)
     virtual Eigen::Vector3f getAccelerationCmPerSecSqr() const = 0;
+
+    /// Get the covariance of the current position estimate (cm^2).
+    /// Returns false if the filter doesn't track its own uncertainty.
+    virtual bool getPositionCovarianceCmSqr(Eigen::Matrix3f &out_covariance) const = 0;
 };
 
 /// Common interface to all pose filters (filter orientation and position simultaneously)
@@ -308,6 +336,10 @@ public:
 
     /// Get the current velocity of the filter state (cm/s^2)
     virtual Eigen::Vector3f getAccelerationCmPerSecSqr() const = 0;
+
+    /// Get the covariance of the current position estimate in world space (cm^2).
+    /// Filters that don't track their uncertainty estimate it from the optical measurement noise.
+    virtual Eigen::Matrix3f getPositionCovarianceCmSqr() const = 0;
 };
 
 #endif // POSE_FILTER_INTERFACE_H
\ No newline at end of file
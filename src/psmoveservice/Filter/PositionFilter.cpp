@@ -217,6 +217,14 @@ Eigen::Vector3f PositionFilter::getAccelerationCmPerSecSqr() const
     return (m_state->bIsValid) ? result : Eigen::Vector3f::Zero();
 }
 
+bool PositionFilter::getPositionCovarianceCmSqr(Eigen::Matrix3f &out_covariance) const
+{
+    // The low pass and complimentary filters don't model their uncertainty
+    out_covariance = Eigen::Matrix3f::Zero();
+
+    return false;
+}
+
 // -- Position Filters ----
 // -- PositionFilterPassThru --
 void PositionFilterPassThru::update(
@@ -9,6 +9,7 @@
 #include "ServerUtility.h"
 #include "hidapi.h"
 #include "libusb.h"
+#include <algorithm>
 #include <vector>
 #include <cstdlib>
 #ifdef _WIN32
@@ -184,6 +185,7 @@ static void morpheus_close_usb_device(MorpheusUSBContext *morpheus_context);
 static bool morpheus_enable_tracking(MorpheusUSBContext *morpheus_context);
 static bool morpheus_set_headset_power(MorpheusUSBContext *morpheus_context, bool bIsOn);
 static bool morpheus_set_led_brightness(MorpheusUSBContext *morpheus_context, unsigned short led_bitmask, unsigned char intensity);
+static void morpheus_build_led_brightness_command(unsigned short led_bitmask, unsigned char intensity, MorpheusCommand &out_command);
 static bool morpheus_turn_off_processor_unit(MorpheusUSBContext *morpheus_context);
 static bool morpheus_set_vr_mode(MorpheusUSBContext *morpheus_context, bool bIsOn);
 static bool morpheus_set_cinematic_configuration(
@@ -363,6 +365,7 @@ void MorpheusHMDState::parse_data_input(
 MorpheusHMD::MorpheusHMD()
     : cfg()
     , USBContext(nullptr)
+    , CommandWriter("MorpheusHMD")
     , NextPollSequenceNumber(0)
     , InData(nullptr)
     , HMDStates()
@@ -453,6 +456,18 @@ bool MorpheusHMD::open(
 						morpheus_set_led_brightness(USBContext, _MorpheusLED_ALL, 0);
 					}
 				}
+
+				// Commands sent while the HMD is running don't need to stall the main loop.
+				// Only the latest LED state matters, so there is no minimum interval or keep-alive.
+				CommandWriter.start(
+					[this](const unsigned char *report, size_t report_size) {
+						MorpheusCommand command = { {0} };
+						memcpy(&command, report, std::min(report_size, sizeof(MorpheusCommand)));
+
+						return morpheus_send_command(USBContext, command);
+					},
+					0,
+					0);
 			}
 
 			// Always save the config back out in case some defaults changed
@@ -486,6 +501,8 @@ void MorpheusHMD::close()
 		if (USBContext->usb_device_handle != nullptr)
 		{
 			SERVER_LOG_INFO("MorpheusHMD::close") << "Closing MorpheusHMD command interface";
+			// Let any queued LED command finish before powering down the headset
+			CommandWriter.stop();
 			morpheus_set_headset_power(USBContext, false);
 			morpheus_close_usb_device(USBContext);
 		}
@@ -667,14 +684,18 @@ void MorpheusHMD::setTrackingEnabled(bool bEnable)
 {
 	if (USBContext->usb_device_handle != nullptr)
 	{
+		MorpheusCommand command;
+
 		if (!bIsTracking && bEnable)
 		{
-			morpheus_set_led_brightness(USBContext, _MorpheusLED_ALL, 50);
+			morpheus_build_led_brightness_command(_MorpheusLED_ALL, 50, command);
+			CommandWriter.postReport((const unsigned char *)&command, sizeof(MorpheusCommand), false);
 			bIsTracking = true;
 		}
 		else if (bIsTracking && !bEnable)
 		{
-			morpheus_set_led_brightness(USBContext, _MorpheusLED_ALL, 0);
+			morpheus_build_led_brightness_command(_MorpheusLED_ALL, 0, command);
+			CommandWriter.postReport((const unsigned char *)&command, sizeof(MorpheusCommand), false);
 			bIsTracking = false;
 		}
 	}
@@ -840,20 +861,29 @@ static bool morpheus_set_led_brightness(
 	unsigned short led_bitmask,
 	unsigned char intensity)
 {
-	MorpheusCommand command = { {0} };
-	command.header.request_id = Morpheus_Req_SetLEDBrightness;
-	command.header.magic = MORPHEUS_COMMAND_MAGIC;
-	command.header.length = 16;
-	((unsigned short*)command.payload)[0] = led_bitmask;
+	MorpheusCommand command;
+	morpheus_build_led_brightness_command(led_bitmask, intensity, command);
+
+	return morpheus_send_command(morpheus_context, command);
+}
+
+static void morpheus_build_led_brightness_command(
+	unsigned short led_bitmask,
+	unsigned char intensity,
+	MorpheusCommand &out_command)
+{
+	memset(&out_command, 0, sizeof(MorpheusCommand));
+	out_command.header.request_id = Morpheus_Req_SetLEDBrightness;
+	out_command.header.magic = MORPHEUS_COMMAND_MAGIC;
+	out_command.header.length = 16;
+	((unsigned short*)out_command.payload)[0] = led_bitmask;
 
 	unsigned short mask = led_bitmask;
 	for (int led_index = 0; led_index < 9; ++led_index)
 	{
-		command.payload[2 + led_index] = ((mask & 0x001) > 0) ? intensity : 0;
+		out_command.payload[2 + led_index] = ((mask & 0x001) > 0) ? intensity : 0;
 		mask = mask >> 1;
 	}
-
-	return morpheus_send_command(morpheus_context, command);
 }
 
 static bool morpheus_turn_off_processor_unit(
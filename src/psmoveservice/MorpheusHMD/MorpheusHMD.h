@@ -4,6 +4,7 @@
 #include "PSMoveConfig.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
+#include "DeviceOutputWriter.h"
 #include "MathUtility.h"
 #include <string>
 #include <vector>
@@ -256,6 +257,7 @@ private:
     // Constant while the HMD is open
     MorpheusHMDConfig cfg;
     class MorpheusUSBContext *USBContext;                    // Buffer that holds static MorpheusAPI HMD description
+    DeviceOutputWriter CommandWriter;                        // Sends runtime commands (LEDs) off the main thread
 
     // Read HMD State
     int NextPollSequenceNumber;
@@ -29,7 +29,6 @@
 #define PSDS4_BTADDR_GET_SIZE 16
 #define PSDS4_BTADDR_SET_SIZE 23
 #define PSDS4_BTADDR_SIZE 6
-#define PSDS4_STATE_BUFFER_MAX 16
 
 #define PSDS4_TRACKING_TRIANGLE_WIDTH  .9386f // The width of a triangle enclosed in the DS4 tracking bar in cm
 #define PSDS4_TRACKING_TRIANGLE_HEIGHT  .6548f // The height of a triangle enclosed in the DS4 tracking bar in cm
@@ -45,7 +44,7 @@
 #define PSDS4_CALIBRATION_SIZE 49 /* Buffer size for calibration data */
 #define PSDS4_CALIBRATION_BLOB_SIZE (PSDS4_CALIBRATION_SIZE*3 - 2*2) /* Three blocks, minus header (2 bytes) for blocks 2,3 */
 
-/* Minimum time (in milliseconds) psmove write updates */
+/* How often (in milliseconds) to repeat the LED/rumble state while either is on */
 #define PSDS4_WRITE_DATA_INTERVAL_MS 120
 
 enum ePSDualShock4_RequestType {
@@ -299,6 +298,8 @@ PSDualShock4ControllerConfig::config2ptree()
 
     pt.put("prediction_time", prediction_time);
     pt.put("max_poll_failure_count", max_poll_failure_count);
+    pt.put("use_hid_reader_thread", use_hid_reader_thread);
+    pt.put("min_output_write_interval_ms", min_output_write_interval_ms);
 
 	writeTrackingColor(pt, tracking_color_id);
 
@@ -315,6 +316,8 @@ PSDualShock4ControllerConfig::ptree2config(const boost::property_tree::ptree &pt
         is_valid = pt.get<bool>("is_valid", false);
         prediction_time = pt.get<float>("prediction_time", 0.f);
         max_poll_failure_count = pt.get<long>("max_poll_failure_count", 100);
+        use_hid_reader_thread = pt.get<bool>("use_hid_reader_thread", false);
+        min_output_write_interval_ms = pt.get<int>("min_output_write_interval_ms", 10);
 
         // Use the current accelerometer values (constructor defaults) as the default values
         accelerometer_gain.i = pt.get<float>("Calibration.Accel.X.k", accelerometer_gain.i);
@@ -372,7 +375,9 @@ PSDualShock4Controller::PSDualShock4Controller()
     , RumbleRight(0)
     , RumbleLeft(0)
     , bWriteStateDirty(false)
+    , OutputWriter("PSDualShock4Controller")
     , NextPollSequenceNumber(0)
+    , InputReader("PSDualShock4Controller")
 {
 	HIDDetails.vendor_id = -1;
 	HIDDetails.product_id = -1;
@@ -459,6 +464,7 @@ bool PSDualShock4Controller::open(
         {             
             // Don't block on hid report requests
             hid_set_nonblocking(HIDDetails.Handle, 1);
+            InputReader.start(HIDDetails.Handle, sizeof(PSDualShock4DataInput), false);
 
             /* -USB or Bluetooth Device-
 
@@ -537,12 +543,29 @@ bool PSDualShock4Controller::open(
             // Reset the polling sequence counter
             NextPollSequenceNumber = 0;
 
+            if (success)
+            {
+                OutputWriter.start(
+                    [this](const unsigned char *report, size_t report_size) {
+                        return writeOutputReport(report, report_size);
+                    },
+                    cfg.min_output_write_interval_ms,
+                    PSDS4_WRITE_DATA_INTERVAL_MS);
+            }
+
             // Write out the initial controller state
             if (success && IsBluetooth)
             {
                 bWriteStateDirty= true;
                 writeDataOut();
             }
+
+            // Hand bluetooth input over to a reader thread
+            if (success && IsBluetooth && cfg.use_hid_reader_thread)
+            {
+                InputReader.stop();
+                InputReader.start(HIDDetails.Handle, sizeof(PSDualShock4DataInput), true);
+            }
         }
         else
         {
@@ -560,6 +583,9 @@ void PSDualShock4Controller::close()
     {
         SERVER_LOG_INFO("PSDualShock4Controller::close") << "Closing PSDualShock4Controller(" << HIDDetails.Device_path << ")";
 
+        // The reader thread has to be done with the handle before it gets closed
+        InputReader.stop();
+
         if (HIDDetails.Handle != nullptr)
         {
             if (IsBluetooth)
@@ -567,6 +593,9 @@ void PSDualShock4Controller::close()
                 clearAndWriteDataOut();
             }
 
+            // Flushes the LED/rumble off report before the handle goes away
+            OutputWriter.stop();
+
             hid_close(HIDDetails.Handle);
             HIDDetails.Handle = nullptr;
         }
@@ -779,7 +808,8 @@ PSDualShock4Controller::poll()
         for (int iteration = 0; iteration < k_max_iterations; ++iteration)
         {
             // Attempt to read the next update packet from the controller
-            int res = hid_read(HIDDetails.Handle, (unsigned char*)InData, sizeof(PSDualShock4DataInput));
+            std::chrono::steady_clock::time_point arrival_time;
+            int res = InputReader.read((unsigned char*)InData, sizeof(PSDualShock4DataInput), arrival_time);
 
             if (res == 0)
             {
@@ -821,6 +851,7 @@ PSDualShock4Controller::poll()
 
             // Increment the sequence for every new polling packet
             newState.PollSequenceNumber = NextPollSequenceNumber;
+            newState.ArrivalTime = arrival_time;
             ++NextPollSequenceNumber;
 
             // Smush the button state into one unsigned 32-bit variable
@@ -981,28 +1012,8 @@ PSDualShock4Controller::poll()
                 break;
             }            
 
-            // Make room for new entry if at the max queue size
-            if (ControllerStates.size() >= PSDS4_STATE_BUFFER_MAX)
-            {
-                ControllerStates.erase(ControllerStates.begin(),
-                    ControllerStates.begin() + ControllerStates.size() - PSDS4_STATE_BUFFER_MAX);
-            }
-
             ControllerStates.push_back(newState);
         }
-
-        // Update recurrent writes on a regular interval
-        {
-            std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
-
-            // See if it's time to update the LED/rumble state
-            std::chrono::duration<double, std::milli> led_update_diff = now - lastWriteStateTime;
-            if (led_update_diff.count() >= PSDS4_WRITE_DATA_INTERVAL_MS)
-            {
-                writeDataOut();
-                lastWriteStateTime = now;
-            }
-        }
     }
 
     return result;
@@ -1012,11 +1023,13 @@ const CommonDeviceState *
 PSDualShock4Controller::getState(
 int lookBack) const
 {
-    const int queueSize = static_cast<int>(ControllerStates.size());
-    const CommonDeviceState * result =
-        (lookBack < queueSize) ? &ControllerStates.at(queueSize - lookBack - 1) : nullptr;
+    return ControllerStates.getLookBack(lookBack);
+}
 
-    return result;
+bool
+PSDualShock4Controller::getHasQueuedInput() const
+{
+    return InputReader.getHasQueuedReports();
 }
 
 const std::tuple<unsigned char, unsigned char, unsigned char>
@@ -1140,28 +1153,37 @@ PSDualShock4Controller::writeDataOut()
         // a.k.a Hard Rumble Motor
         OutData->rumble_left = RumbleLeft;
 
-        // Keep writing state out until the desired LED and Rumble are 0 
-        bWriteStateDirty = bLedIsOn || bIsRumbleOn;
-
-        // Unfortunately in windows simply writing to the HID device, via WriteFile() internally, 
-        // doesn't appear to actually set the data on the controller (despite returning successfully).
-        // In the DS4 implementation they use the HidD_SetOutputReport() Win32 API call instead. 
-        // Unfortunately HIDAPI doesn't have any equivalent call, so we have to make our own.
-        #ifdef _WIN32
-        int res = hid_set_output_report(HIDDetails.Handle, (unsigned char*)OutData, sizeof(PSDualShock4DataOutput));
-        #else
-        int res = hid_write(HIDDetails.Handle, (unsigned char*)OutData, sizeof(PSDualShock4DataOutput));
-        #endif
-        bSuccess = res > 0;
-
-        if (!bSuccess)
-        {
-            char szErrorMessage[256];
+        // The writer keeps writing the state out until the desired LED and Rumble are 0 
+        const bool bKeepAlive = bLedIsOn || bIsRumbleOn;
 
-            if (hid_error_mbs(HIDDetails.Handle, szErrorMessage, sizeof(szErrorMessage)))
-            {
-                SERVER_LOG_ERROR("PSDualShock4Controller::writeDataOut") << "HID ERROR: " << szErrorMessage;
-            }
+        bSuccess = OutputWriter.postReport((unsigned char*)OutData, sizeof(PSDualShock4DataOutput), bKeepAlive);
+        bWriteStateDirty = false;
+    }
+
+    return bSuccess;
+}
+
+bool
+PSDualShock4Controller::writeOutputReport(const unsigned char *report, size_t report_size)
+{
+    // Unfortunately in windows simply writing to the HID device, via WriteFile() internally, 
+    // doesn't appear to actually set the data on the controller (despite returning successfully).
+    // In the DS4 implementation they use the HidD_SetOutputReport() Win32 API call instead. 
+    // Unfortunately HIDAPI doesn't have any equivalent call, so we have to make our own.
+    #ifdef _WIN32
+    int res = hid_set_output_report(HIDDetails.Handle, report, report_size);
+    #else
+    int res = hid_write(HIDDetails.Handle, report, report_size);
+    #endif
+    bool bSuccess = res > 0;
+
+    if (!bSuccess)
+    {
+        char szErrorMessage[256];
+
+        if (hid_error_mbs(HIDDetails.Handle, szErrorMessage, sizeof(szErrorMessage)))
+        {
+            SERVER_LOG_ERROR("PSDualShock4Controller::writeOutputReport") << "HID ERROR: " << szErrorMessage;
         }
     }
 
@@ -4,13 +4,18 @@
 #include "PSMoveConfig.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
+#include "DeviceOutputWriter.h"
+#include "DeviceStateRing.h"
+#include "HIDInputReader.h"
 #include "MathUtility.h"
 #include "hidapi.h"
 #include <string>
 #include <vector>
-#include <deque>
 #include <chrono>
 
+// Number of past controller states kept for the filters to catch up on
+#define PSDS4_STATE_BUFFER_MAX 16
+
 // The angle the accelerometer reading is pitched forward when the DS4 is on a flat surface
 // The value comes from the accelerometer calibration utility
 #define FLAT_SURFACE_ACCELEROMETER_PITCH_DEGREES 12.661f
@@ -47,6 +52,8 @@ public:
 		, position_filter_type("ComplimentaryOpticalIMU")
 		, orientation_filter_type("ComplementaryOpticalARG")
         , max_poll_failure_count(100)
+        , use_hid_reader_thread(false)
+        , min_output_write_interval_ms(10)
         , prediction_time(0.f)
         , accelerometer_noise_radius(0.015f) // rounded value from config tool measurement (g-units)
 		, accelerometer_variance(1.45e-05f) // rounded value from config tool measurement (g-units^2)
@@ -118,6 +125,13 @@ public:
 
 	// The max number of polling failures before we consider the controller disconnected
     long max_poll_failure_count;
+
+	// Read bluetooth input reports on a dedicated thread as soon as they arrive
+	// instead of draining them from the main loop
+	bool use_hid_reader_thread;
+
+	// LED and rumble changes closer together than this get merged into one write
+	int min_output_write_interval_ms;
 	// The amount of prediction to apply to the controller pose after filtering
     float prediction_time;
 
@@ -287,6 +301,7 @@ public:
     virtual long getMaxPollFailureCount() const override;
     virtual CommonDeviceState::eDeviceType getDeviceType() const override;
     virtual const CommonDeviceState * getState(int lookBack = 0) const override;
+    virtual bool getHasQueuedInput() const override;
 
     // -- IControllerInterface
     virtual bool setHostBluetoothAddress(const std::string &address) override;
@@ -327,6 +342,7 @@ private:
     bool getBTAddressesViaUSB(std::string& host, std::string& controller);
     void clearAndWriteDataOut();
     bool writeDataOut();                            // Setters will call this
+    bool writeOutputReport(const unsigned char *report, size_t report_size); // Called on the output writer thread
 
     // Constant while a controller is open
     PSDualShock4ControllerConfig cfg;
@@ -338,12 +354,13 @@ private:
     unsigned char RumbleRight; // Weak
     unsigned char RumbleLeft; // Strong
     bool bWriteStateDirty;
-    std::chrono::time_point<std::chrono::high_resolution_clock> lastWriteStateTime;
+    DeviceOutputWriter OutputWriter;                      // Writes OutData reports off the main thread
 
     // Read Controller State
     int NextPollSequenceNumber;
-    std::deque<PSDualShock4ControllerState> ControllerStates;
+    DeviceStateRing<PSDualShock4ControllerState, PSDS4_STATE_BUFFER_MAX> ControllerStates;
     PSDualShock4DataInput* InData;                        // Buffer to read hidapi reports into
+    HIDInputReader InputReader;                           // Reads InData on the poll thread or a reader thread
     PSDualShock4DataOutput* OutData;                      // Buffer to write hidapi reports out from
 };
 #endif // PSDUALSHOCK4_CONTROLLER_H
@@ -27,7 +27,7 @@ PSMoveConfig::PSMoveConfig(const std::string &fnamebase)
 }
 
 const std::string
-PSMoveConfig::getConfigPath()
+PSMoveConfig::getConfigDirectoryPath()
 {
     const char *homedir;
 #ifdef _WIN32
@@ -47,6 +47,14 @@ PSMoveConfig::getConfigPath()
     boost::filesystem::path configpath(homedir);
     configpath /= "PSMoveService";
     boost::filesystem::create_directory(configpath);
+
+    return configpath.string();
+}
+
+const std::string
+PSMoveConfig::getConfigPath()
+{
+    boost::filesystem::path configpath(getConfigDirectoryPath());
     configpath /= ConfigFileBase + ".json";
     std::cout << "Config file name: " << configpath << std::endl;
     return configpath.string();
@@ -42,6 +42,9 @@ public:
 	static void writeTrackingColor(boost::property_tree::ptree &pt, int tracking_color_id);
 	static int readTrackingColor(const boost::property_tree::ptree &pt);
 
+    // Returns the directory the config files are stored in (created if it doesn't exist)
+    static const std::string getConfigDirectoryPath();
+
 private:
     const std::string getConfigPath();
 };
@@ -62,11 +62,10 @@ POSSIBILITY OF SUCH DAMAGE.
 #define PSMOVE_FW_GET_SIZE 13
 #define PSMOVE_CALIBRATION_SIZE 49 /* Buffer size for calibration data */
 #define PSMOVE_CALIBRATION_BLOB_SIZE (PSMOVE_CALIBRATION_SIZE*3 - 2*2) /* Three blocks, minus header (2 bytes) for blocks 2,3 */
-#define PSMOVE_STATE_BUFFER_MAX 16
 
 #define PSMOVE_TRACKING_BULB_RADIUS  2.25f // The radius of the psmove tracking bulb in cm
 
-/* Minimum time (in milliseconds) psmove write updates */
+/* How often (in milliseconds) to repeat the LED/rumble state so the controller doesn't time it out */
 #define PSMOVE_WRITE_DATA_INTERVAL_MS 120
 
 /* Decode 12-bit signed value (assuming two's complement) */
@@ -206,6 +205,8 @@ PSMoveControllerConfig::config2ptree()
 
     pt.put("prediction_time", prediction_time);
     pt.put("max_poll_failure_count", max_poll_failure_count);
+    pt.put("use_hid_reader_thread", use_hid_reader_thread);
+    pt.put("min_output_write_interval_ms", min_output_write_interval_ms);
     
     pt.put("Calibration.Accel.X.k", cal_ag_xyz_kb[0][0][0]);
     pt.put("Calibration.Accel.X.b", cal_ag_xyz_kb[0][0][1]);
@@ -284,6 +285,8 @@ PSMoveControllerConfig::ptree2config(const boost::property_tree::ptree &pt)
 
         prediction_time = pt.get<float>("prediction_time", 0.f);
         max_poll_failure_count = pt.get<long>("max_poll_failure_count", 100);
+        use_hid_reader_thread = pt.get<bool>("use_hid_reader_thread", false);
+        min_output_write_interval_ms = pt.get<int>("min_output_write_interval_ms", 10);
 
         cal_ag_xyz_kb[0][0][0] = pt.get<float>("Calibration.Accel.X.k", 1.0f);
         cal_ag_xyz_kb[0][0][1] = pt.get<float>("Calibration.Accel.X.b", 0.0f);
@@ -378,7 +381,9 @@ PSMoveController::PSMoveController()
     , LedB(0)
     , Rumble(0)
     , bWriteStateDirty(false)
+    , OutputWriter("PSMoveController")
     , NextPollSequenceNumber(0)
+    , InputReader("PSMoveController")
 {
 	HIDDetails.vendor_id = -1;
 	HIDDetails.product_id = -1;
@@ -461,6 +466,7 @@ bool PSMoveController::open(
     #endif
         HIDDetails.Handle = hid_open_path(HIDDetails.Device_path.c_str());
         hid_set_nonblocking(HIDDetails.Handle, 1);
+        InputReader.start(HIDDetails.Handle, sizeof(PSMoveDataInput), false);
                 
         // On my Mac, using bluetooth,
         // cur_dev->path = Bluetooth_054c_03d5_779732e8
@@ -564,6 +570,23 @@ bool PSMoveController::open(
 				}
 			}
 
+			// Now that the initial state is in, hand bluetooth input over to a reader thread
+			if (success && IsBluetooth && cfg.use_hid_reader_thread)
+			{
+				InputReader.stop();
+				InputReader.start(HIDDetails.Handle, sizeof(PSMoveDataInput), true);
+			}
+
+			if (success)
+			{
+				OutputWriter.start(
+					[this](const unsigned char *report, size_t report_size) {
+						return hid_write(HIDDetails.Handle, report, report_size) == static_cast<int>(report_size);
+					},
+					cfg.min_output_write_interval_ms,
+					PSMOVE_WRITE_DATA_INTERVAL_MS);
+			}
+
 			if (bSaveConfig)
 			{
 				cfg.save();
@@ -588,6 +611,10 @@ void PSMoveController::close()
     {
         SERVER_LOG_INFO("PSMoveController::close") << "Closing PSMoveController(" << HIDDetails.Device_path << ")";
 
+        // The reader and writer threads have to be done with the handle before it gets closed
+        InputReader.stop();
+        OutputWriter.stop();
+
         if (HIDDetails.Handle != nullptr)
         {
             hid_close(HIDDetails.Handle);
@@ -1043,7 +1070,8 @@ PSMoveController::poll()
         for (int iteration= 0; iteration < k_max_iterations; ++iteration)
         {
             // Attempt to read the next update packet from the controller
-            int res = hid_read(HIDDetails.Handle, (unsigned char*)InData, sizeof(PSMoveDataInput));
+            std::chrono::steady_clock::time_point arrival_time;
+            int res = InputReader.read((unsigned char*)InData, sizeof(PSMoveDataInput), arrival_time);
 
             if (res == 0)
             {
@@ -1081,6 +1109,7 @@ PSMoveController::poll()
         
             // Increment the sequence for every new polling packet
             newState.PollSequenceNumber= NextPollSequenceNumber;
+            newState.ArrivalTime= arrival_time;
             ++NextPollSequenceNumber;
 
             // Buttons
@@ -1190,28 +1219,8 @@ PSMoveController::poll()
             newState.RawTimeStamp = InData->timelow | (InData->timehigh << 8);
             newState.TempRaw = (InData->temphigh << 4) | ((InData->templow_mXhigh & 0xF0) >> 4);
 
-            // Make room for new entry if at the max queue size
-            if (ControllerStates.size() >= PSMOVE_STATE_BUFFER_MAX)
-            {
-                ControllerStates.erase(ControllerStates.begin(),
-                    ControllerStates.begin() + ControllerStates.size() - PSMOVE_STATE_BUFFER_MAX);
-            }
-
             ControllerStates.push_back(newState);
         }
-
-        // Update recurrent writes on a regular interval
-        {
-            std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
-
-            // See if it's time to update the LED/rumble state
-            std::chrono::duration<double, std::milli> led_update_diff = now - lastWriteStateTime;
-            if (led_update_diff.count() >= PSMOVE_WRITE_DATA_INTERVAL_MS)
-            {
-                writeDataOut();
-                lastWriteStateTime = now;
-            }
-        }
     }
 
     return result;
@@ -1221,11 +1230,13 @@ const CommonDeviceState *
 PSMoveController::getState(
     int lookBack) const
 {
-    const int queueSize= static_cast<int>(ControllerStates.size());
-    const CommonDeviceState * result=
-        (lookBack < queueSize) ? &ControllerStates.at(queueSize - lookBack - 1) : nullptr;
+    return ControllerStates.getLookBack(lookBack);
+}
 
-    return result;
+bool
+PSMoveController::getHasQueuedInput() const
+{
+    return InputReader.getHasQueuedReports();
 }
 
 const std::tuple<unsigned char, unsigned char, unsigned char>
@@ -1338,12 +1349,11 @@ PSMoveController::writeDataOut()
         data_out.b = LedB;
         data_out.rumble = Rumble;
 
-        // Keep writing state out until the desired LED and Rumble are 0 
-        bWriteStateDirty = LedR != 0 || LedG != 0 || LedB != 0 || Rumble != 0;
+        // The writer keeps writing the state out until the desired LED and Rumble are 0 
+        const bool bKeepAlive = LedR != 0 || LedG != 0 || LedB != 0 || Rumble != 0;
 
-        int res = hid_write(HIDDetails.Handle, (unsigned char*)(&data_out),
-            sizeof(data_out));
-        bSuccess= (res == sizeof(data_out));
+        bSuccess = OutputWriter.postReport((unsigned char*)(&data_out), sizeof(data_out), bKeepAlive);
+        bWriteStateDirty = false;
     }
 
     return bSuccess;
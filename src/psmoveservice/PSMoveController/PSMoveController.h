@@ -4,13 +4,18 @@
 #include "PSMoveConfig.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
+#include "DeviceOutputWriter.h"
+#include "DeviceStateRing.h"
+#include "HIDInputReader.h"
 #include "MathUtility.h"
 #include "hidapi.h"
 #include <string>
 #include <array>
-#include <deque>
 #include <chrono>
 
+// Number of past controller states kept for the filters to catch up on
+#define PSMOVE_STATE_BUFFER_MAX 16
+
 struct PSMoveHIDDetails {
 	int vendor_id;
 	int product_id;
@@ -37,6 +42,8 @@ public:
 		, bt_firmware_version(0)
 		, firmware_revision(0)
         , max_poll_failure_count(100) 
+        , use_hid_reader_thread(false)
+        , min_output_write_interval_ms(10)
         , prediction_time(0.f)
 		, position_filter_type("LowPassExponential")
 		, orientation_filter_type("ComplementaryMARG")
@@ -87,6 +94,13 @@ public:
 	// The max number of polling failures before we consider the controller disconnected
     long max_poll_failure_count;
 
+	// Read bluetooth input reports on a dedicated thread as soon as they arrive
+	// instead of draining them from the main loop
+	bool use_hid_reader_thread;
+
+	// LED and rumble changes closer together than this get merged into one write
+	int min_output_write_interval_ms;
+
 	// The amount of prediction to apply to the controller pose after filtering
     float prediction_time;
 
@@ -182,8 +196,6 @@ struct PSMoveControllerState : public CommonControllerState
 
     int TempRaw;
 
-    //TODO: high-precision timestamp. Need to do in hidapi?
-    
     PSMoveControllerState()
     {
         clear();
@@ -242,6 +254,7 @@ public:
     virtual long getMaxPollFailureCount() const override;
     virtual CommonDeviceState::eDeviceType getDeviceType() const override;
     virtual const CommonDeviceState * getState(int lookBack = 0) const override;
+    virtual bool getHasQueuedInput() const override;
     
     // -- IControllerInterface
     virtual bool setHostBluetoothAddress(const std::string &address) override;
@@ -296,11 +309,12 @@ private:
     unsigned char Rumble;
     unsigned long LedPWMF;
     bool bWriteStateDirty;
-    std::chrono::time_point<std::chrono::high_resolution_clock> lastWriteStateTime;
+    DeviceOutputWriter OutputWriter;                // Writes LED/rumble reports off the main thread
 
     // Read Controller State
     int NextPollSequenceNumber;
-    std::deque<PSMoveControllerState> ControllerStates;
+    DeviceStateRing<PSMoveControllerState, PSMOVE_STATE_BUFFER_MAX> ControllerStates;
     PSMoveDataInput* InData;                        // Buffer to copy hidapi reports into
+    HIDInputReader InputReader;                     // Reads InData on the poll thread or a reader thread
 };
 #endif // PSMOVE_CONTROLLER_H
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "PSMoveProtocol.pb.h"
 #include "TrackerDeviceEnumerator.h"
 #include "TrackerManager.h"
+#include "TrackerVideoFrameRing.h"
 #include "opencv2/opencv.hpp"
 
 // -- constants -----
@@ -20,12 +21,27 @@ class PSEyeCaptureData
 {
 public:
     PSEyeCaptureData()
-        : frame()
+        : frame_ring()
+        , frame_width(0)
+        , frame_height(0)
+        , frame_stride(0)
     {
 
     }
 
-    cv::Mat frame;
+    void allocateFrameRing(int width, int height, int stride)
+    {
+        frame_ring.allocate(width, height, stride);
+        frame_width = width;
+        frame_height = height;
+        frame_stride = stride;
+    }
+
+    // Frames get captured straight into the ring and handed out by reference
+    TrackerVideoFrameRing frame_ring;
+    int frame_width;
+    int frame_height;
+    int frame_stride;
 };
 
 // -- public methods
@@ -42,6 +58,7 @@ PS3EyeTrackerConfig::PS3EyeTrackerConfig(const std::string &fnamebase)
 	, frame_rate(40)
     , exposure(32)
     , gain(32)
+    , sensor_latency_ms(0.0)
     , focalLengthX(554.2563) // pixels
     , focalLengthY(554.2563) // pixels
     , principalX(320.0) // pixels
@@ -80,6 +97,7 @@ PS3EyeTrackerConfig::config2ptree()
 	pt.put("frame_rate", frame_rate);
     pt.put("exposure", exposure);
 	pt.put("gain", gain);
+    pt.put("sensor_latency_ms", sensor_latency_ms);
     pt.put("focalLengthX", focalLengthX);
     pt.put("focalLengthY", focalLengthY);
     pt.put("principalX", principalX);
@@ -126,6 +144,7 @@ PS3EyeTrackerConfig::ptree2config(const boost::property_tree::ptree &pt)
 		frame_rate = pt.get<double>("frame_rate", 40);
         exposure = pt.get<double>("exposure", 32);
 		gain = pt.get<double>("gain", 32);
+        sensor_latency_ms = pt.get<double>("sensor_latency_ms", 0.0);
         hfov = pt.get<double>("hfov", 60.0);
         vfov = pt.get<double>("vfov", 45.0);
         zNear = pt.get<double>("zNear", 10.0);
@@ -363,6 +382,14 @@ bool PS3EyeTracker::open(const DeviceEnumerator *enumerator)
 		VideoCapture->set(cv::CAP_PROP_EXPOSURE, cfg.exposure);
 		VideoCapture->set(cv::CAP_PROP_GAIN, cfg.gain);
 		VideoCapture->set(cv::CAP_PROP_FPS, cfg.frame_rate);
+
+        // Frames are always retrieved as BGR, whatever format the camera reports,
+        // so the ring is sized for 3 bytes per pixel rather than from getVideoFrameDimensions' stride
+        int width, height;
+        if (getVideoFrameDimensions(&width, &height, nullptr))
+        {
+            CaptureData->allocateFrameRing(width, height, 3 * width);
+        }
     }
 
     return bSuccess;
@@ -384,8 +411,50 @@ IDeviceInterface::ePollResult PS3EyeTracker::poll()
 
     if (getIsOpen())
     {
-        if (!VideoCapture->grab() || 
-            !VideoCapture->retrieve(CaptureData->frame, cv::CAP_OPENNI_BGR_IMAGE))
+        bool bNewFrame = false;
+
+        if (VideoCapture->grab())
+        {
+            // Stamp the frame as soon as it arrives, backed up by however long the sensor takes to deliver it
+            const std::chrono::steady_clock::time_point capture_time =
+                std::chrono::steady_clock::now() -
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::milli>(cfg.sensor_latency_ms));
+
+            // Capture into a frame buffer nobody is looking at anymore (if there is one).
+            // The vision stage and video stream then use the frame in place.
+            unsigned char *frame_buffer = CaptureData->frame_ring.beginFrameWrite();
+
+            if (frame_buffer != nullptr)
+            {
+                cv::Mat frame(
+                    CaptureData->frame_height, CaptureData->frame_width, CV_8UC3,
+                    frame_buffer, CaptureData->frame_stride);
+
+                // retrieve() reallocates the frame if the capture size no longer matches the ring
+                bNewFrame =
+                    VideoCapture->retrieve(frame, cv::CAP_OPENNI_BGR_IMAGE) &&
+                    frame.data == frame_buffer;
+                CaptureData->frame_ring.endFrameWrite(bNewFrame, capture_time);
+
+                if (!bNewFrame && frame.data != frame_buffer && !frame.empty())
+                {
+                    if (frame.type() == CV_8UC3)
+                    {
+                        SERVER_LOG_INFO("PS3EyeTracker::poll") << "Video frame size changed to "
+                            << frame.cols << "x" << frame.rows << ", reallocating frame buffers";
+                        CaptureData->allocateFrameRing(frame.cols, frame.rows, 3 * frame.cols);
+                    }
+                    else
+                    {
+                        SERVER_LOG_ERROR("PS3EyeTracker::poll") << "Camera " << USBDevicePath
+                            << " delivered a non-BGR video frame, dropping it";
+                    }
+                }
+            }
+        }
+
+        if (!bNewFrame)
         {
             // Device still in valid state
             result = IControllerInterface::_PollResultSuccessNoData;
@@ -496,6 +565,7 @@ bool PS3EyeTracker::getVideoFrameDimensions(
                     break;
                 default:
                     assert(false && "Unknown video format?");
+                    bytes_per_pixel = 3;
                     break;
                 }
             }
@@ -522,13 +592,13 @@ bool PS3EyeTracker::getVideoFrameDimensions(
     return bSuccess;
 }
 
-const unsigned char *PS3EyeTracker::getVideoFrameBuffer() const
+TrackerVideoFrameRef PS3EyeTracker::getVideoFrame() const
 {
-    const unsigned char *result = nullptr;
+    TrackerVideoFrameRef result;
 
     if (CaptureData != nullptr)
     {
-        return static_cast<const unsigned char *>(CaptureData->frame.data);
+        result = CaptureData->frame_ring.getLatestFrame();
     }
 
     return result;
@@ -42,6 +42,9 @@ public:
 	double frame_rate;
     double exposure;
 	double gain;
+    // How long before grab() returns a frame the frame was actually exposed.
+    // Subtracted from every frame's capture timestamp.
+    double sensor_latency_ms;
     double focalLengthX;
     double focalLengthY;
     double principalX;
@@ -104,7 +107,7 @@ public:
     ITrackerInterface::eDriverType getDriverType() const override;
     std::string getUSBDevicePath() const override;
     bool getVideoFrameDimensions(int *out_width, int *out_height, int *out_stride) const override;
-    const unsigned char *getVideoFrameBuffer() const override;
+    class TrackerVideoFrameRef getVideoFrame() const override;
     void loadSettings() override;
     void saveSettings() override;
 	void setFrameWidth(double value, bool bUpdateConfig) override;
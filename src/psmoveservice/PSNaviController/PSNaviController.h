@@ -4,9 +4,12 @@
 #include "PSMoveConfig.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
+#include "DeviceStateRing.h"
 #include <string>
 #include <vector>
-#include <deque>
+
+// Number of past controller states kept around
+#define PSNAVI_STATE_BUFFER_MAX 16
 
 class PSNaviControllerConfig : public PSMoveConfig
 {
@@ -130,7 +133,7 @@ private:
 
     // Read Controller State
     int NextPollSequenceNumber;
-    std::deque<PSNaviControllerState> ControllerStates;
+    DeviceStateRing<PSNaviControllerState, PSNAVI_STATE_BUFFER_MAX> ControllerStates;
     unsigned char InBuffer[64];                        // Buffer to copy hidapi reports into
 };
 #endif // PSMOVE_CONTROLLER_H
\ No newline at end of file
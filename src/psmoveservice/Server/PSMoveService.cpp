@@ -7,6 +7,7 @@
 #include "DeviceManager.h"
 #include "ProtocolVersion.h"
 #include "ServerLog.h"
+#include "ServerUpdateSignal.h"
 #include "SharedTrackerState.h"
 #include "TrackerManager.h"
 #include "USBDeviceManager.h"
@@ -14,6 +15,7 @@
 #include <boost/asio.hpp>
 #include <boost/application.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
 #include <fstream>
 #include <cstdio>
 #include <string>
@@ -39,6 +41,9 @@ public:
     PSMoveServiceImpl()
         : m_io_service()
         , m_signals(m_io_service)
+        , m_update_timer(m_io_service)
+        , m_update_timer_wait_id(0)
+        , m_bStaleUpdateTimerWake(false)
         , m_usb_device_manager()
         , m_device_manager()
         , m_request_handler(&m_device_manager)
@@ -68,15 +73,22 @@ public:
 
 				const TrackerManagerConfig &cfg = DeviceManager::getInstance()->m_tracker_manager->getConfig();
 
+                // Let the device and worker threads interrupt the wait for new input
+                ServerUpdateSignal::bind([this]() { m_io_service.post([]() {}); });
+
                 while (m_status->state() != boost::application::status::stoped)
                 {
+                    const std::chrono::steady_clock::time_point update_time = std::chrono::steady_clock::now();
+
                     if (m_status->state() != boost::application::status::paused)
                     {
                         update();
                     }
 
-					std::this_thread::sleep_for(std::chrono::milliseconds(cfg.tracker_sleep_ms));
+                    waitForInput(update_time, cfg);
                 }
+
+                ServerUpdateSignal::bind(std::function<void()>());
             }
             else
             {
@@ -216,6 +228,61 @@ private:
         m_network_manager.update();
     }
 
+    /// Blocks the application loop until there is something to update:
+    /// a device or worker thread raised the ServerUpdateSignal, network traffic arrived,
+    /// or a device manager is due to be polled.
+    /// Never returns sooner than min_update_interval_us after the start of the last update.
+    void waitForInput(
+        const std::chrono::steady_clock::time_point &last_update_time,
+        const TrackerManagerConfig &cfg)
+    {
+        std::this_thread::sleep_until(last_update_time + std::chrono::microseconds(cfg.min_update_interval_us));
+
+        // Input showed up while we were updating or sleeping
+        if (ServerUpdateSignal::consume())
+        {
+            return;
+        }
+
+        const std::chrono::steady_clock::time_point latest_update_time =
+            last_update_time + std::chrono::milliseconds(cfg.max_update_wait_ms);
+        const std::chrono::microseconds wait_time = std::min(
+            std::chrono::duration_cast<std::chrono::microseconds>(latest_update_time - std::chrono::steady_clock::now()),
+            m_device_manager.getTimeUntilNextPoll());
+
+        if (wait_time.count() <= 0)
+        {
+            return;
+        }
+
+        m_update_timer.expires_from_now(boost::posix_time::microseconds(wait_time.count()));
+        const int wait_id = ++m_update_timer_wait_id;
+        m_update_timer.async_wait([this, wait_id](const boost::system::error_code &error) {
+            // The handler of a wait canceled on an earlier tick can still be queued up
+            m_bStaleUpdateTimerWake = (wait_id != m_update_timer_wait_id);
+        });
+
+        // Returns after the first handler that runs:
+        // the timer, a network completion, a termination signal or a ServerUpdateSignal post
+        do
+        {
+            m_bStaleUpdateTimerWake = false;
+
+            if (m_io_service.run_one() == 0)
+            {
+                // Only happens if the io_service ran out of work
+                m_io_service.reset();
+                break;
+            }
+        } while (m_bStaleUpdateTimerWake);
+
+        // No-op if the timer is what woke us
+        m_update_timer.cancel();
+
+        // The coming update takes care of any input signaled during the wait
+        ServerUpdateSignal::consume();
+    }
+
     void shutdown()
     {
         // Kill any pending request state
@@ -247,6 +314,11 @@ private:
     // The signal_set is used to register for process termination notifications.
     boost::asio::signal_set m_signals;
 
+    // Bounds how long the application loop waits for new input
+    boost::asio::deadline_timer m_update_timer;
+    int m_update_timer_wait_id;
+    bool m_bStaleUpdateTimerWake;
+
     // Manages all control and bulk transfer requests in another thread
     USBDeviceManager m_usb_device_manager;
 
@@ -25,6 +25,7 @@
 #include "ServerHMDView.h"
 #include "ServerLog.h"
 #include "ServerUtility.h"
+#include "SharedTrackerState.h"
 #include "TrackerManager.h"
 #include "VirtualController.h"
 
@@ -466,7 +467,9 @@ public:
                 // Halt any shared memory streams this connection has going
                 if (connection_state->active_tracker_stream_info[tracker_id].streaming_video_data)
                 {
-                    m_device_manager.getTrackerViewPtr(tracker_id)->stopSharedMemoryVideoStream();
+                    m_device_manager.getTrackerViewPtr(tracker_id)->stopSharedMemoryVideoStream(
+                        connection_state->active_tracker_stream_info[tracker_id].debug_overlay_layers,
+                        connection_state->active_tracker_stream_info[tracker_id].video_stream_format);
                 }
             }
 
@@ -1815,7 +1818,7 @@ protected:
         {
             ServerTrackerViewPtr tracker_view = m_device_manager.getTrackerViewPtr(tracker_id);
 
-            if (tracker_view->getIsOpen())
+            if (tracker_view->getIsOpen() && getIsSharedVideoFrameFormatValid(request.video_stream_format()))
             {
                 TrackerStreamInfo &streamInfo =
                     context.connection_state->active_tracker_stream_info[tracker_id];
@@ -1824,11 +1827,21 @@ protected:
                 // All we have to do is keep track of which connections care about the updates.
                 context.connection_state->active_tracker_streams.set(tracker_id, true);
 
+                // Restarting a stream just swaps the debug overlay layers and format it wants
+                if (streamInfo.streaming_video_data)
+                {
+                    tracker_view->stopSharedMemoryVideoStream(
+                        streamInfo.debug_overlay_layers, streamInfo.video_stream_format);
+                }
+
                 // Set control flags for the stream
                 streamInfo.streaming_video_data = true;
+                streamInfo.debug_overlay_layers = static_cast<unsigned int>(request.debug_overlay_layers());
+                streamInfo.video_stream_format = request.video_stream_format();
 
                 // Increment the number of stream listeners
-                tracker_view->startSharedMemoryVideoStream();
+                tracker_view->startSharedMemoryVideoStream(
+                    streamInfo.debug_overlay_layers, streamInfo.video_stream_format);
 
                 // Return the name of the shared memory block the video frames will be written to
                 response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
@@ -1857,6 +1870,11 @@ protected:
 
             if (tracker_view->getIsOpen())
             {
+                const unsigned int debug_overlay_layers =
+                    context.connection_state->active_tracker_stream_info[tracker_id].debug_overlay_layers;
+                const int video_stream_format =
+                    context.connection_state->active_tracker_stream_info[tracker_id].video_stream_format;
+
                 context.connection_state->active_tracker_streams.set(tracker_id, false);
                 context.connection_state->active_tracker_stream_info[tracker_id].Clear();
 
@@ -1867,7 +1885,7 @@ protected:
                 }
 
                 // Decrement the number of stream listeners
-                tracker_view->stopSharedMemoryVideoStream();
+                tracker_view->stopSharedMemoryVideoStream(debug_overlay_layers, video_stream_format);
 
                 response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
             }
@@ -42,11 +42,15 @@ struct TrackerStreamInfo
 {
     bool streaming_video_data;
 	bool has_temp_settings_override;
+    unsigned int debug_overlay_layers; // eTrackerDebugOverlayLayer flags drawn over the video (0 = defaults)
+    int video_stream_format; // eSharedVideoFrameFormat the video is streamed in
 
     inline void Clear()
     {
         streaming_video_data = false;
 		has_temp_settings_override = false;
+        debug_overlay_layers = 0;
+        video_stream_format = 0;
     }
 };
 
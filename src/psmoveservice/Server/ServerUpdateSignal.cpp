@@ -0,0 +1,37 @@
+//-- includes -----
+#include "ServerUpdateSignal.h"
+
+#include <atomic>
+#include <mutex>
+
+//-- statics -----
+static std::atomic_bool g_bSignaled(false);
+static std::mutex g_wake_callback_mutex;
+static std::function<void()> g_wake_callback;
+
+//-- public methods -----
+void ServerUpdateSignal::bind(std::function<void()> wake_callback)
+{
+    std::lock_guard<std::mutex> lock(g_wake_callback_mutex);
+
+    g_wake_callback = wake_callback;
+}
+
+void ServerUpdateSignal::signal()
+{
+    // Only the first signal since the main loop last looked has to interrupt its wait
+    if (!g_bSignaled.exchange(true))
+    {
+        std::lock_guard<std::mutex> lock(g_wake_callback_mutex);
+
+        if (g_wake_callback)
+        {
+            g_wake_callback();
+        }
+    }
+}
+
+bool ServerUpdateSignal::consume()
+{
+    return g_bSignaled.exchange(false);
+}
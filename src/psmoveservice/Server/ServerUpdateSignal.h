@@ -0,0 +1,26 @@
+#ifndef SERVER_UPDATE_SIGNAL_H
+#define SERVER_UPDATE_SIGNAL_H
+
+//-- includes -----
+#include <functional>
+
+//-- definitions -----
+/// Lets the device and worker threads wake up the service main loop
+/// as soon as they have new input for it (USB transfer results, vision results, ...).
+/// Network traffic wakes the main loop on its own since it waits on the same io_service.
+namespace ServerUpdateSignal
+{
+    /// Sets the function that interrupts the main loop wait (empty function to unbind).
+    /// The main loop binds this at startup and unbinds it before shutdown.
+    void bind(std::function<void()> wake_callback);
+
+    /// Tells the main loop there is new input for the next update.
+    /// Safe to call from any thread. Signals raised before the main loop gets to them are coalesced.
+    void signal();
+
+    /// Called by the main loop before it waits.
+    /// \return true if there was a signal since the last call
+    bool consume();
+};
+
+#endif // SERVER_UPDATE_SIGNAL_H
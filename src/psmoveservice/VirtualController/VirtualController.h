@@ -4,15 +4,16 @@
 #include "PSMoveConfig.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
+#include "DeviceStateRing.h"
 #include "MathUtility.h"
 #include "hidapi.h"
 #include <string>
 #include <array>
-#include <deque>
 #include <chrono>
 
 #define MAX_VIRTUAL_CONTROLLER_BUTTONS 32
 #define MAX_VIRTUAL_CONTROLLER_AXES 32
+#define VIRTUAL_CONTROLLER_STATE_BUFFER_MAX 16
 
 class VirtualControllerConfig : public PSMoveConfig
 {
@@ -170,7 +171,7 @@ private:
 
     // Read HMD State
     int NextPollSequenceNumber;
-    std::deque<VirtualControllerState> ControllerStates;
+    DeviceStateRing<VirtualControllerState, VIRTUAL_CONTROLLER_STATE_BUFFER_MAX> ControllerStates;
 
 	bool bIsTracking;
 };
@@ -0,0 +1,18 @@
+/* Tracking color presets shared by the HSV tests */
+#ifndef __TEST_COLOR_PRESETS_H
+#define __TEST_COLOR_PRESETS_H
+
+#include "DeviceInterface.h"
+
+// Same as the default presets in PSMoveConfig.cpp, in eCommonTrackingColorID order
+static const CommonHSVColorRange k_test_color_presets[] = {
+    { { 300 / 2, 10 }, { 255, 32 }, { 255, 32 } }, // Magenta
+    { { 180 / 2, 10 }, { 255, 32 }, { 255, 32 } }, // Cyan
+    { { 60 / 2, 10 }, { 255, 32 }, { 255, 32 } }, // Yellow
+    { { 0, 10 }, { 255, 32 }, { 255, 32 } }, // Red
+    { { 120 / 2, 10 }, { 255, 32 }, { 255, 32 } }, // Green
+    { { 240 / 2, 10 }, { 255, 32 }, { 255, 32 } }, // Blue
+};
+static const int k_preset_count = sizeof(k_test_color_presets) / sizeof(CommonHSVColorRange);
+
+#endif // __TEST_COLOR_PRESETS_H
@@ -0,0 +1,177 @@
+// Accuracy report for the quantized BGR->HSV lookup tables (see bgr_to_hsv_lookup_table_bits).
+// Every 24-bit BGR color is converted through each table and compared against cv::COLOR_BGR2HSV:
+//  * per channel max/mean error over all colors and over the colors the tracking presets can match
+//  * per preset, the number of colors the table classifies differently than the exact conversion
+// Returns non-zero if the 8-bit table differs from cvtColor anywhere, if saturation or value are ever off
+// (they're exact at every table size) or if a quantized table's hue error on the preset colors
+// exceeds OpenCVBGRToHSVMapper::k_max_tracking_hue_error.
+
+#include "DeviceInterface.h"
+#include "HSVThresholdKernel.h"
+#include "OpenCVBGRToHSVMapper.h"
+#include "test_color_presets.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *k_preset_names[] = { "magenta", "cyan", "yellow", "red", "green", "blue" };
+static const int k_color_count = 256 * 256 * 256;
+
+typedef cv::Point3_<uint8_t> ColorTuple;
+
+struct ChannelErrorStats
+{
+    int max_error[3];
+    double total_error[3];
+    int sample_count;
+
+    void clear()
+    {
+        memset(this, 0, sizeof(ChannelErrorStats));
+    }
+
+    void addSample(const ColorTuple &exact, const ColorTuple &approx)
+    {
+        // Hue is an angle, so measure the error around the circle
+        const int hue_error = abs(static_cast<int>(exact.x) - static_cast<int>(approx.x));
+        const int errors[3] = {
+            std::min(hue_error, 180 - hue_error),
+            abs(static_cast<int>(exact.y) - static_cast<int>(approx.y)),
+            abs(static_cast<int>(exact.z) - static_cast<int>(approx.z))
+        };
+
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            max_error[channel] = std::max(max_error[channel], errors[channel]);
+            total_error[channel] += errors[channel];
+        }
+        ++sample_count;
+    }
+
+    void print(const char *label) const
+    {
+        const double n = static_cast<double>(std::max(sample_count, 1));
+
+        printf("  %-18s max error h/s/v = %d/%d/%d, mean error h/s/v = %.3f/%.3f/%.3f (%d colors)\n",
+            label,
+            max_error[0], max_error[1], max_error[2],
+            total_error[0] / n, total_error[1] / n, total_error[2] / n,
+            sample_count);
+    }
+};
+
+static bool isInRange(const ColorTuple &hsv, const HSVThresholdRange &range)
+{
+    const bool bHueInRange =
+        (hsv.x >= range.hue_min[0] && hsv.x <= range.hue_max[0]) ||
+        (hsv.x >= range.hue_min[1] && hsv.x <= range.hue_max[1]);
+
+    return
+        bHueInRange &&
+        hsv.y >= range.saturation_min && hsv.y <= range.saturation_max &&
+        hsv.z >= range.value_min && hsv.z <= range.value_max;
+}
+
+int main(int, char**)
+{
+    // Every BGR color, in the same order as the exact table
+    cv::Mat bgrColors(k_color_count, 1, CV_8UC3);
+    for (int index = 0; index < k_color_count; ++index)
+    {
+        bgrColors.at<ColorTuple>(index, 0) = ColorTuple(index & 0xff, (index >> 8) & 0xff, (index >> 16) & 0xff);
+    }
+
+    cv::Mat exactHsv;
+    cv::cvtColor(bgrColors, exactHsv, cv::COLOR_BGR2HSV);
+
+    HSVThresholdRange ranges[k_preset_count];
+    for (int preset_index = 0; preset_index < k_preset_count; ++preset_index)
+    {
+        ranges[preset_index] = HSVThresholdRange::fromColorRange(k_test_color_presets[preset_index]);
+    }
+
+    bool bSuccess = true;
+
+    for (int bits = OpenCVBGRToHSVMapper::k_max_bits_per_channel; bits >= 5; --bits)
+    {
+        const auto build_start = std::chrono::high_resolution_clock::now();
+        OpenCVBGRToHSVMapper *mapper = OpenCVBGRToHSVMapper::allocate(bits);
+        mapper->waitUntilReady();
+        const auto build_end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> build_time = build_end - build_start;
+
+        ChannelErrorStats all_colors_stats, preset_colors_stats;
+        int misclassified[k_preset_count] = { 0 };
+        int exact_matches[k_preset_count] = { 0 };
+
+        all_colors_stats.clear();
+        preset_colors_stats.clear();
+
+        for (int index = 0; index < k_color_count; ++index)
+        {
+            const ColorTuple &bgr = bgrColors.at<ColorTuple>(index, 0);
+            const ColorTuple &exact = exactHsv.at<ColorTuple>(index, 0);
+            const ColorTuple approx = mapper->lookup(bgr.x, bgr.y, bgr.z);
+            bool bInAnyPreset = false;
+
+            all_colors_stats.addSample(exact, approx);
+
+            for (int preset_index = 0; preset_index < k_preset_count; ++preset_index)
+            {
+                const bool bExactInRange = isInRange(exact, ranges[preset_index]);
+
+                if (bExactInRange != isInRange(approx, ranges[preset_index]))
+                {
+                    ++misclassified[preset_index];
+                }
+                if (bExactInRange)
+                {
+                    ++exact_matches[preset_index];
+                    bInAnyPreset = true;
+                }
+            }
+
+            if (bInAnyPreset)
+            {
+                preset_colors_stats.addSample(exact, approx);
+            }
+        }
+
+        printf("%d bits per channel: table size %.1f KB, built in %.1f ms\n",
+            bits, static_cast<double>(mapper->getTableSizeBytes()) / 1024.0, build_time.count());
+        all_colors_stats.print("all colors:");
+        preset_colors_stats.print("preset colors:");
+        for (int preset_index = 0; preset_index < k_preset_count; ++preset_index)
+        {
+            printf("  %-18s %d of %d matching colors misclassified (%.3f%%)\n",
+                k_preset_names[preset_index],
+                misclassified[preset_index],
+                exact_matches[preset_index],
+                100.0 * static_cast<double>(misclassified[preset_index]) / static_cast<double>(std::max(exact_matches[preset_index], 1)));
+        }
+
+        const int max_hue_error = OpenCVBGRToHSVMapper::k_max_tracking_hue_error[bits];
+        bool bTableOk = all_colors_stats.max_error[1] == 0 && all_colors_stats.max_error[2] == 0;
+
+        if (bits == OpenCVBGRToHSVMapper::k_max_bits_per_channel)
+        {
+            bTableOk &= all_colors_stats.max_error[0] == 0;
+        }
+        else
+        {
+            bTableOk &= preset_colors_stats.max_error[0] <= max_hue_error;
+        }
+
+        printf("  %s (saturation/value exact, preset hue error <= %d)\n", bTableOk ? "PASSED" : "FAILED", max_hue_error);
+        bSuccess &= bTableOk;
+
+        OpenCVBGRToHSVMapper::dispose(mapper);
+    }
+
+    return bSuccess ? 0 : 1;
+}
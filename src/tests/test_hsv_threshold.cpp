@@ -0,0 +1,287 @@
+// Micro-benchmark comparing the ways the tracker can threshold a BGR video frame by a tracking color:
+//  * cv::cvtColor(COLOR_BGR2HSV) followed by cv::inRange()
+//  * the OpenCVBGRToHSVMapper lookup tables followed by cv::inRange()
+//  * the fused BGR->HSV threshold kernel (scalar, SSE4.1 and AVX2 variants)
+// Also reports how many mask pixels each path disagrees with cvtColor+inRange on.
+// Returns non-zero if a fused kernel disagrees anywhere but right on a range boundary
+// (where cvtColor's fixed-point division can round the other way),
+// or if the SIMD kernels don't match the scalar kernel exactly.
+// Per pixel the two pass paths read 3 BGR bytes, write and re-read 3 HSV bytes (plus a random
+// table read for the LUT) and write 1-2 mask bytes, where the fused kernel reads 3 and writes 1.
+
+#include "DeviceInterface.h"
+#include "HSVThresholdKernel.h"
+#include "OpenCVBGRToHSVMapper.h"
+#include "test_color_presets.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+static const int k_frame_width = 640;
+static const int k_frame_height = 480;
+static const int k_iterations = 200;
+
+// cvtColor divides with 12-bit fixed-point reciprocal tables, which are off from the exact hue and saturation
+// by up to ~0.16 units. Closer than this to a rounding boundary, it's allowed to land on the other side.
+static const double k_max_boundary_distance = 0.25;
+
+typedef cv::Point3_<uint8_t> ColorTuple;
+
+static void inRangeWithHueWrap(const cv::Mat &hsv, const HSVThresholdRange &range, cv::Mat &scratch, cv::Mat &mask)
+{
+    cv::inRange(
+        hsv,
+        cv::Scalar(range.hue_min[0], range.saturation_min, range.value_min),
+        cv::Scalar(range.hue_max[0], range.saturation_max, range.value_max),
+        mask);
+
+    if (range.hue_min[1] <= range.hue_max[1])
+    {
+        cv::inRange(
+            hsv,
+            cv::Scalar(range.hue_min[1], range.saturation_min, range.value_min),
+            cv::Scalar(range.hue_max[1], range.saturation_max, range.value_max),
+            scratch);
+        cv::bitwise_or(mask, scratch, mask);
+    }
+}
+
+static void makeTestFrame(cv::Mat &bgr)
+{
+    // Dim noisy background with a saturated blob of every preset color
+    cv::RNG rng(0x5EED);
+    rng.fill(bgr, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(96));
+
+    for (int preset_index = 0; preset_index < k_preset_count; ++preset_index)
+    {
+        cv::Mat hsv_pixel(1, 1, CV_8UC3, cv::Scalar(k_test_color_presets[preset_index].hue_range.center, 250, 250));
+        cv::Mat bgr_pixel;
+        cv::cvtColor(hsv_pixel, bgr_pixel, cv::COLOR_HSV2BGR);
+
+        const ColorTuple c = bgr_pixel.at<ColorTuple>(0, 0);
+        const cv::Point center(80 + preset_index * 90, 120 + (preset_index % 2) * 200);
+        cv::circle(bgr, center, 30, cv::Scalar(c.x, c.y, c.z), -1);
+    }
+
+    // Blur the blob edges so the boundary pixels cover lots of in-between colors
+    cv::GaussianBlur(bgr, bgr, cv::Size(5, 5), 0);
+}
+
+template <typename t_threshold_func>
+static double timeThreshold(t_threshold_func threshold_func)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for (int iteration = 0; iteration < k_iterations; ++iteration)
+    {
+        for (int preset_index = 0; preset_index < k_preset_count; ++preset_index)
+        {
+            threshold_func(preset_index);
+        }
+    }
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> elapsed = end - start;
+
+    return elapsed.count() / static_cast<double>(k_iterations * k_preset_count);
+}
+
+static bool isNearBound(double x, int bound_min, int bound_max)
+{
+    // round(x) changes sides of [bound_min, bound_max] at bound_min - 0.5 and bound_max + 0.5
+    return
+        fabs(x - (static_cast<double>(bound_min) - 0.5)) <= k_max_boundary_distance ||
+        fabs(x - (static_cast<double>(bound_max) + 0.5)) <= k_max_boundary_distance;
+}
+
+// True if the exact (unrounded) hue or saturation of the pixel sits on the edge of the range
+static bool isNearRangeBoundary(const ColorTuple &bgr, const HSVThresholdRange &range)
+{
+    const int b = bgr.x, g = bgr.y, r = bgr.z;
+    const int v = std::max(std::max(b, g), r);
+    const int diff = v - std::min(std::min(b, g), r);
+
+    if (v > 0 && isNearBound(255.0 * diff / v, range.saturation_min, range.saturation_max))
+    {
+        return true;
+    }
+
+    if (diff > 0)
+    {
+        double hue;
+        if (v == r)
+        {
+            hue = 30.0 * (g - b) / diff;
+            if (hue < -0.5)
+            {
+                hue += 180.0;
+            }
+        }
+        else if (v == g)
+        {
+            hue = 60.0 + 30.0 * (b - r) / diff;
+        }
+        else
+        {
+            hue = 120.0 + 30.0 * (r - g) / diff;
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (range.hue_min[i] <= range.hue_max[i] && isNearBound(hue, range.hue_min[i], range.hue_max[i]))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Mask pixels that disagree with the reference and aren't explained by rounding on a range boundary
+static int countOffBoundaryMismatches(
+    const cv::Mat &bgr,
+    const HSVThresholdRange *ranges,
+    const std::vector<cv::Mat> &expected,
+    const std::vector<cv::Mat> &actual)
+{
+    int mismatches = 0;
+
+    for (size_t index = 0; index < expected.size(); ++index)
+    {
+        for (int y = 0; y < bgr.rows; ++y)
+        {
+            for (int x = 0; x < bgr.cols; ++x)
+            {
+                if (expected[index].at<uint8_t>(y, x) != actual[index].at<uint8_t>(y, x) &&
+                    !isNearRangeBoundary(bgr.at<ColorTuple>(y, x), ranges[index]))
+                {
+                    ++mismatches;
+                }
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+static int countMismatches(const std::vector<cv::Mat> &expected, const std::vector<cv::Mat> &actual)
+{
+    int mismatches = 0;
+
+    for (size_t index = 0; index < expected.size(); ++index)
+    {
+        cv::Mat diff;
+        cv::compare(expected[index], actual[index], diff, cv::CMP_NE);
+        mismatches += cv::countNonZero(diff);
+    }
+
+    return mismatches;
+}
+
+int main(int, char**)
+{
+    cv::Mat bgr(k_frame_height, k_frame_width, CV_8UC3);
+    cv::Mat hsv(k_frame_height, k_frame_width, CV_8UC3);
+    cv::Mat scratch(k_frame_height, k_frame_width, CV_8UC1);
+    std::vector<cv::Mat> reference_masks(k_preset_count);
+    std::vector<cv::Mat> scalar_masks(k_preset_count);
+    std::vector<cv::Mat> masks(k_preset_count);
+    HSVThresholdRange ranges[k_preset_count];
+
+    makeTestFrame(bgr);
+    for (int preset_index = 0; preset_index < k_preset_count; ++preset_index)
+    {
+        ranges[preset_index] = HSVThresholdRange::fromColorRange(k_test_color_presets[preset_index]);
+        reference_masks[preset_index].create(k_frame_height, k_frame_width, CV_8UC1);
+        scalar_masks[preset_index].create(k_frame_height, k_frame_width, CV_8UC1);
+        masks[preset_index].create(k_frame_height, k_frame_width, CV_8UC1);
+    }
+
+    bool bSuccess = true;
+
+    printf("Thresholding a %dx%d frame, %d iterations x %d colors\n",
+        k_frame_width, k_frame_height, k_iterations, k_preset_count);
+    printf("%-24s %10s %12s %14s\n", "Path", "ms/color", "mismatches", "off boundary");
+
+    // cvtColor + inRange (the reference)
+    {
+        const double ms = timeThreshold([&](int preset_index) {
+            cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+            inRangeWithHueWrap(hsv, ranges[preset_index], scratch, reference_masks[preset_index]);
+        });
+        printf("%-24s %10.3f %12d\n", "cvtColor+inRange", ms, 0);
+    }
+
+    // OpenCVBGRToHSVMapper lookup tables + inRange
+    for (int bits = OpenCVBGRToHSVMapper::k_max_bits_per_channel; bits >= 6; bits -= 2)
+    {
+        OpenCVBGRToHSVMapper *mapper = OpenCVBGRToHSVMapper::allocate(bits);
+        mapper->waitUntilReady();
+        char label[32];
+
+        const double ms = timeThreshold([&](int preset_index) {
+            mapper->cvtColor(bgr, hsv);
+            inRangeWithHueWrap(hsv, ranges[preset_index], scratch, masks[preset_index]);
+        });
+        snprintf(label, sizeof(label), "LUT(%d bit)+inRange", bits);
+        printf("%-24s %10.3f %12d\n", label, ms, countMismatches(reference_masks, masks));
+
+        OpenCVBGRToHSVMapper::dispose(mapper);
+    }
+
+    // Fused kernels
+    const struct { eHSVThresholdKernelType type; const char *name; } kernels[] = {
+        { HSVThresholdKernel_Scalar, "fused (scalar)" },
+        { HSVThresholdKernel_SSE41, "fused (SSE4.1)" },
+        { HSVThresholdKernel_AVX2, "fused (AVX2)" },
+    };
+    for (const auto &kernel : kernels)
+    {
+        if (kernel.type > getBestSupportedHSVThresholdKernel())
+        {
+            printf("%-24s %10s\n", kernel.name, "n/a");
+            continue;
+        }
+
+        std::vector<cv::Mat> &kernel_masks = (kernel.type == HSVThresholdKernel_Scalar) ? scalar_masks : masks;
+        const double ms = timeThreshold([&](int preset_index) {
+            cv::Mat &mask = kernel_masks[preset_index];
+
+            thresholdBGRByHSVRangeWithKernel(
+                kernel.type,
+                bgr.data, static_cast<int>(bgr.step),
+                mask.data, static_cast<int>(mask.step),
+                bgr.cols, bgr.rows,
+                ranges[preset_index]);
+        });
+
+        const int off_boundary_mismatches = countOffBoundaryMismatches(bgr, ranges, reference_masks, kernel_masks);
+        printf("%-24s %10.3f %12d %14d\n",
+            kernel.name, ms, countMismatches(reference_masks, kernel_masks), off_boundary_mismatches);
+
+        if (off_boundary_mismatches > 0)
+        {
+            printf("FAILED: %s disagrees with cvtColor+inRange away from the range boundaries\n", kernel.name);
+            bSuccess = false;
+        }
+
+        // The SIMD kernels do the same integer math as the scalar one, so they have to match it bit for bit
+        if (kernel.type != HSVThresholdKernel_Scalar && countMismatches(scalar_masks, kernel_masks) > 0)
+        {
+            printf("FAILED: %s disagrees with the scalar kernel\n", kernel.name);
+            bSuccess = false;
+        }
+    }
+
+    if (bSuccess)
+    {
+        printf("PASSED\n");
+    }
+
+    return bSuccess ? 0 : 1;
+}
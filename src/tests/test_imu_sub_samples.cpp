@@ -0,0 +1,297 @@
+// Checks that splitting a device report into its IMU sub-samples (PoseFilterSpace::updateFilterWithSubSamples)
+// integrates orientation as well as feeding every reading on its own.
+// Uses a recording of a moving PSMove (misc/test_data/movement.csv), one IMU reading per row.
+// Consecutive rows are paired up into two-reading reports, the way the PSMove and Morpheus send them,
+// and run through a Madgwick orientation filter:
+//  * every reading on its own with its recorded time delta (the reference)
+//  * one update per reading of a report, each over half of the report interval
+//  * one update per report with only the newest reading (what you get ignoring the older sub-sample)
+// Returns non-zero if the sub-sample orientation strays from the reference,
+// or doesn't beat dropping the older reading.
+//
+// Usage: test_imu_sub_samples <movement.csv>
+
+#include "CompoundPoseFilter.h"
+#include "MathAlignment.h"
+#include "MathEigen.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Columns of the recorded samples:
+// [acc.x, acc.y, acc.z, gyro.x, gyro.y, gyro.z, mag.x, mag.y, mag.z, pos.x, pos.y, pos.z, q.w, q.x, q.y, q.z, time]
+enum eRecordedSampleFields
+{
+    FIELD_ACCELEROMETER_X= 0,
+    FIELD_GYROSCOPE_X= 3,
+    FIELD_MAGNETOMETER_X= 6,
+    FIELD_TIME= 16,
+
+    FIELD_COUNT= 17
+};
+
+// Calibration the recording was made with (see misc/python/examples/filter_datafiles.py)
+static const float k_gyro_variance = 0.000382817292f;
+static const float k_mean_update_time_delta = 1.f / 60.f;
+
+static const int k_readings_per_report = 2;
+
+// The recording was timestamped by the host at ~60Hz, so the readings of a "report" aren't evenly spaced
+// and the even split drifts a little from the reference (about 0.5 deg on average, 1.2 deg at worst)
+static const double k_max_allowed_sub_sample_angle_error_degrees = 2.0;
+
+static const double k_radians_to_degrees = 180.0 / 3.14159265358979323846;
+
+struct RecordedSample
+{
+    Eigen::Vector3f accelerometer; // g-units
+    Eigen::Vector3f gyroscope; // rad/s
+    Eigen::Vector3f magnetometer; // unit vector
+    float time; // seconds
+};
+
+struct ErrorStats
+{
+    double max_degrees;
+    double total_degrees;
+    int count;
+
+    ErrorStats() : max_degrees(0.0), total_degrees(0.0), count(0) {}
+
+    void add(const Eigen::Quaternionf &q, const Eigen::Quaternionf &q_reference)
+    {
+        const double dot = fabs(static_cast<double>(q.normalized().dot(q_reference.normalized())));
+        const double angle_degrees = 2.0 * acos(fmin(dot, 1.0)) * k_radians_to_degrees;
+
+        max_degrees = fmax(max_degrees, angle_degrees);
+        total_degrees += angle_degrees;
+        ++count;
+    }
+
+    double mean_degrees() const
+    {
+        return (count > 0) ? total_degrees / static_cast<double>(count) : 0.0;
+    }
+};
+
+static bool load_recorded_samples(const char *filename, std::vector<RecordedSample> &out_samples);
+static IPoseFilter *create_pose_filter(const PoseFilterSpace &pose_filter_space);
+static void set_sensor_packet(const RecordedSample &sample, PoseSensorPacket &out_packet);
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: test_imu_sub_samples <movement.csv>\n");
+        return -1;
+    }
+
+    std::vector<RecordedSample> samples;
+    if (!load_recorded_samples(argv[1], samples) || samples.size() < 2 * k_readings_per_report)
+    {
+        printf("Movement file: %s, doesn't contain enough samples\n", argv[1]);
+        return -1;
+    }
+
+    // Same filter space as a PSMove
+    PoseFilterSpace pose_filter_space;
+    pose_filter_space.setIdentityGravity(Eigen::Vector3f(0.f, 1.f, 0.f));
+    pose_filter_space.setIdentityMagnetometer(samples[0].magnetometer);
+    pose_filter_space.setCalibrationTransform(*k_eigen_identity_pose_laying_flat);
+    pose_filter_space.setSensorTransform(*k_eigen_sensor_transform_opengl);
+
+    IPoseFilter *reference_filter = create_pose_filter(pose_filter_space);
+    IPoseFilter *sub_sample_filter = create_pose_filter(pose_filter_space);
+    IPoseFilter *newest_only_filter = create_pose_filter(pose_filter_space);
+
+    ErrorStats sub_sample_error;
+    ErrorStats newest_only_error;
+
+    const size_t report_count = samples.size() / k_readings_per_report;
+    float last_report_time = samples[0].time - k_mean_update_time_delta;
+    float last_sample_time = last_report_time;
+
+    for (size_t report_index = 0; report_index < report_count; ++report_index)
+    {
+        const RecordedSample *report_samples = &samples[report_index * k_readings_per_report];
+        const RecordedSample &newest_sample = report_samples[k_readings_per_report - 1];
+        const float report_delta_time = newest_sample.time - last_report_time;
+
+        // Reference: every reading on its own over its recorded time delta
+        for (int reading = 0; reading < k_readings_per_report; ++reading)
+        {
+            PoseSensorPacket sensor_packet;
+            PoseSensorIMUSubSample sub_sample;
+
+            set_sensor_packet(report_samples[reading], sensor_packet);
+            sub_sample.imu_accelerometer_g_units = report_samples[reading].accelerometer;
+            sub_sample.imu_gyroscope_rad_per_sec = report_samples[reading].gyroscope;
+
+            pose_filter_space.updateFilterWithSubSamples(
+                sensor_packet, &sub_sample, 1, report_samples[reading].time - last_sample_time, reference_filter);
+            last_sample_time = report_samples[reading].time;
+        }
+
+        // Every reading of the report, each over an even share of the report interval
+        {
+            PoseSensorPacket sensor_packet;
+            PoseSensorIMUSubSample sub_samples[k_readings_per_report];
+
+            set_sensor_packet(newest_sample, sensor_packet);
+            for (int reading = 0; reading < k_readings_per_report; ++reading)
+            {
+                sub_samples[reading].imu_accelerometer_g_units = report_samples[reading].accelerometer;
+                sub_samples[reading].imu_gyroscope_rad_per_sec = report_samples[reading].gyroscope;
+            }
+
+            pose_filter_space.updateFilterWithSubSamples(
+                sensor_packet, sub_samples, k_readings_per_report, report_delta_time, sub_sample_filter);
+        }
+
+        // Only the newest reading over the whole report interval
+        {
+            PoseSensorPacket sensor_packet;
+            PoseSensorIMUSubSample sub_sample;
+
+            set_sensor_packet(newest_sample, sensor_packet);
+            sub_sample.imu_accelerometer_g_units = newest_sample.accelerometer;
+            sub_sample.imu_gyroscope_rad_per_sec = newest_sample.gyroscope;
+
+            pose_filter_space.updateFilterWithSubSamples(
+                sensor_packet, &sub_sample, 1, report_delta_time, newest_only_filter);
+        }
+
+        last_report_time = newest_sample.time;
+
+        const Eigen::Quaternionf reference_orientation = reference_filter->getOrientation();
+        sub_sample_error.add(sub_sample_filter->getOrientation(), reference_orientation);
+        newest_only_error.add(newest_only_filter->getOrientation(), reference_orientation);
+    }
+
+    delete reference_filter;
+    delete sub_sample_filter;
+    delete newest_only_filter;
+
+    printf("%d reports of %d readings\n", static_cast<int>(report_count), k_readings_per_report);
+    printf("  all sub-samples: mean %.3f deg, max %.3f deg from reference\n",
+        sub_sample_error.mean_degrees(), sub_sample_error.max_degrees);
+    printf("  newest only:     mean %.3f deg, max %.3f deg from reference\n",
+        newest_only_error.mean_degrees(), newest_only_error.max_degrees);
+
+    bool bSuccess = true;
+
+    if (sub_sample_error.max_degrees > k_max_allowed_sub_sample_angle_error_degrees)
+    {
+        printf("FAILED: sub-sample orientation strays more than %.1f deg from the reference\n",
+            k_max_allowed_sub_sample_angle_error_degrees);
+        bSuccess = false;
+    }
+
+    if (sub_sample_error.mean_degrees() >= newest_only_error.mean_degrees())
+    {
+        printf("FAILED: using every sub-sample isn't closer to the reference than the newest reading alone\n");
+        bSuccess = false;
+    }
+
+    if (bSuccess)
+    {
+        printf("PASSED\n");
+    }
+
+    return bSuccess ? 0 : 1;
+}
+
+static bool
+load_recorded_samples(const char *filename, std::vector<RecordedSample> &out_samples)
+{
+    FILE *fp = fopen(filename, "rt");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), fp) != nullptr)
+    {
+        float columns[FIELD_COUNT];
+        int valid_columns = 0;
+
+        char *cursor = line;
+        while (valid_columns < FIELD_COUNT)
+        {
+            char *end = nullptr;
+            columns[valid_columns] = strtof(cursor, &end);
+            if (end == cursor)
+            {
+                break;
+            }
+
+            ++valid_columns;
+            cursor = (*end == ',') ? end + 1 : end;
+        }
+
+        if (valid_columns == FIELD_COUNT)
+        {
+            RecordedSample sample;
+
+            sample.accelerometer = Eigen::Vector3f(
+                columns[FIELD_ACCELEROMETER_X], columns[FIELD_ACCELEROMETER_X + 1], columns[FIELD_ACCELEROMETER_X + 2]);
+            sample.gyroscope = Eigen::Vector3f(
+                columns[FIELD_GYROSCOPE_X], columns[FIELD_GYROSCOPE_X + 1], columns[FIELD_GYROSCOPE_X + 2]);
+            sample.magnetometer = Eigen::Vector3f(
+                columns[FIELD_MAGNETOMETER_X], columns[FIELD_MAGNETOMETER_X + 1], columns[FIELD_MAGNETOMETER_X + 2]);
+            eigen_vector3f_normalize_with_default(sample.magnetometer, Eigen::Vector3f::Zero());
+            sample.time = columns[FIELD_TIME];
+
+            out_samples.push_back(sample);
+        }
+    }
+
+    fclose(fp);
+
+    return true;
+}
+
+static IPoseFilter *
+create_pose_filter(const PoseFilterSpace &pose_filter_space)
+{
+    PoseFilterConstants constants;
+    constants.clear();
+
+    constants.orientation_constants.gravity_calibration_direction = pose_filter_space.getGravityCalibrationDirection();
+    constants.orientation_constants.magnetometer_calibration_direction = pose_filter_space.getMagnetometerCalibrationDirection();
+    constants.orientation_constants.mean_update_time_delta = k_mean_update_time_delta;
+    constants.orientation_constants.gyro_variance =
+        Eigen::Vector3f(k_gyro_variance, k_gyro_variance, k_gyro_variance);
+
+    constants.position_constants.gravity_calibration_direction = pose_filter_space.getGravityCalibrationDirection();
+    constants.position_constants.mean_update_time_delta = k_mean_update_time_delta;
+
+    CompoundPoseFilter *filter = new CompoundPoseFilter();
+    filter->init(
+        CommonDeviceState::PSMove,
+        OrientationFilterTypeMadgwickARG,
+        PositionFilterTypePassThru,
+        constants,
+        Eigen::Vector3f::Zero(),
+        Eigen::Quaternionf::Identity());
+
+    return filter;
+}
+
+static void
+set_sensor_packet(const RecordedSample &sample, PoseSensorPacket &out_packet)
+{
+    // Orientation only, no optical readings
+    out_packet.optical_position_cm = Eigen::Vector3f::Zero();
+    out_packet.optical_orientation = Eigen::Quaternionf::Identity();
+    out_packet.tracking_projection_area_px_sqr = 0.f;
+    out_packet.optical_sample_age_seconds = 0.f;
+
+    out_packet.imu_accelerometer_g_units = sample.accelerometer;
+    out_packet.imu_gyroscope_rad_per_sec = sample.gyroscope;
+    out_packet.imu_magnetometer_unit = sample.magnetometer;
+}
@@ -479,6 +479,8 @@ apply_filter(
 		sensorPacket.optical_orientation = Eigen::Quaternionf(sample.ori[0], sample.ori[1], sample.ori[2], sample.ori[3]);
 		sensorPacket.tracking_projection_area_px_sqr = sample.area;
 		sensorPacket.optical_position_cm = Eigen::Vector3f(sample.pos[0], sample.pos[1], sample.pos[2]);
+		// Recorded samples don't carry capture timestamps, so no latency compensation
+		sensorPacket.optical_sample_age_seconds = 0.f;
 
 		PoseFilterPacket filterPacket;
 		pose_filter_space->createFilterPacket(sensorPacket, pose_filter, filterPacket);
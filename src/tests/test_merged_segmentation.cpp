@@ -0,0 +1,354 @@
+// Checks the tracker's segmentation planning (see TrackerSegmentationPlan):
+//  * planSegmentationRegions never plans more blob pass pixels than segmenting each request's own ROI,
+//    or than one full frame pass per color, and only merges requests when that saves pixels
+//    (differently colored controllers next to each other stay apart)
+//  * segmentRegionByColor finds the same blob for a request in a merged, mixed color region
+//    as in the request's own ROI, even where the two colors' HSV ranges overlap.
+//    The tracker labels every pixel with one bit per matching color, so pixels in the overlap carry both bits.
+// Returns non-zero if any of these don't hold.
+
+#include "OpenCVBlobExtractor.h"
+#include "TrackerSegmentationPlan.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static const int k_frame_width = 640;
+static const int k_frame_height = 480;
+static const int k_sphere_radius = 40;
+
+// Two devices whose hue ranges overlap on [155, 160]
+struct TestDevice
+{
+    const char *name;
+    eCommonTrackingColorID color_id;
+    int hue_min, hue_max;
+    cv::Point sphere_center;
+    int sphere_hue_begin, sphere_hue_end; // hue ramps left to right across the sphere
+    cv::Rect2i roi;
+};
+
+static const TestDevice k_test_devices[] = {
+    { "device A", eCommonTrackingColorID::Magenta, 140, 160, cv::Point(200, 240), 148, 162, cv::Rect2i(145, 185, 110, 110) },
+    { "device B", eCommonTrackingColorID::Cyan, 155, 175, cv::Point(290, 240), 170, 170, cv::Rect2i(235, 185, 110, 110) },
+};
+static const int k_test_device_count = sizeof(k_test_devices) / sizeof(TestDevice);
+
+struct SegmentationResult
+{
+    bool bFound;
+    int area;
+    cv::Rect2i bounding_box; // frame coordinates
+    cv::Point2f centroid; // frame coordinates
+    std::vector<cv::Point> contour; // frame coordinates
+};
+
+static bool isInSphere(const TestDevice &device, int x, int y)
+{
+    const int dx = x - device.sphere_center.x;
+    const int dy = y - device.sphere_center.y;
+
+    return dx*dx + dy*dy <= k_sphere_radius*k_sphere_radius;
+}
+
+// Pixels of the device's sphere carrying its color bit
+static int countSpherePixels(const cv::Mat &labels, const TestDevice &device)
+{
+    const int color_bit = 1 << device.color_id;
+    int pixel_count = 0;
+
+    for (int y = device.sphere_center.y - k_sphere_radius; y <= device.sphere_center.y + k_sphere_radius; ++y)
+    {
+        for (int x = device.sphere_center.x - k_sphere_radius; x <= device.sphere_center.x + k_sphere_radius; ++x)
+        {
+            if (isInSphere(device, x, y) && (labels.at<unsigned char>(y, x) & color_bit) != 0)
+            {
+                ++pixel_count;
+            }
+        }
+    }
+
+    return pixel_count;
+}
+
+static void makeLabelImage(cv::Mat &labels)
+{
+    // Saturated, bright spheres on a black background, so only the hue decides the labels
+    labels = cv::Mat::zeros(k_frame_height, k_frame_width, CV_8UC1);
+
+    for (int device_index = 0; device_index < k_test_device_count; ++device_index)
+    {
+        const TestDevice &device = k_test_devices[device_index];
+
+        for (int y = device.sphere_center.y - k_sphere_radius; y <= device.sphere_center.y + k_sphere_radius; ++y)
+        {
+            for (int x = device.sphere_center.x - k_sphere_radius; x <= device.sphere_center.x + k_sphere_radius; ++x)
+            {
+                if (!isInSphere(device, x, y))
+                {
+                    continue;
+                }
+
+                const float t = static_cast<float>(x - device.sphere_center.x + k_sphere_radius) / static_cast<float>(2 * k_sphere_radius);
+                const int hue = static_cast<int>(floorf(
+                    static_cast<float>(device.sphere_hue_begin) +
+                    t * static_cast<float>(device.sphere_hue_end - device.sphere_hue_begin) + 0.5f));
+
+                // Same as the color label table: one bit for every color range the pixel falls in
+                unsigned char label = 0;
+                for (int color_index = 0; color_index < k_test_device_count; ++color_index)
+                {
+                    const TestDevice &color = k_test_devices[color_index];
+
+                    if (hue >= color.hue_min && hue <= color.hue_max)
+                    {
+                        label |= static_cast<unsigned char>(1 << color.color_id);
+                    }
+                }
+
+                labels.at<unsigned char>(y, x) = label;
+            }
+        }
+    }
+}
+
+static TrackerSegmentationRequest makeRequest(int request_index, eCommonTrackingColorID color_id, const cv::Rect2i &roi)
+{
+    TrackerSegmentationRequest request;
+    request.request_index = request_index;
+    request.color_id = color_id;
+    request.search_roi = roi;
+
+    return request;
+}
+
+// Runs segmentRegionByColor on every region and keeps the biggest blob each request gets to see
+static void segmentRegions(
+    const cv::Mat &labels,
+    const std::vector<TrackerSegmentationRegion> &regions,
+    std::vector<SegmentationResult> &out_results)
+{
+    OpenCVBlobExtractor blob_extractor;
+    cv::Mat mask(labels.size(), CV_8UC1);
+
+    // Value initialized, so nothing found yet
+    out_results.assign(k_test_device_count, SegmentationResult());
+
+    for (const TrackerSegmentationRegion &region : regions)
+    {
+        const cv::Mat region_labels(labels, region.roi);
+        cv::Mat region_mask(mask, region.roi);
+
+        segmentRegionByColor(
+            region, region_labels, region_mask, blob_extractor,
+            [&](const TrackerSegmentationRequest &request, const cv::Rect2f &centroid_region) {
+                SegmentationResult &result = out_results[request.request_index];
+                std::vector<int> blob_indices;
+
+                blob_extractor.selectLargestBlobs(1, blob_indices, &centroid_region);
+
+                if (blob_indices.size() > 0 &&
+                    blob_extractor.traceBlobContour(blob_indices[0], region.roi.tl(), result.contour))
+                {
+                    const OpenCVBlob &blob = blob_extractor.getBlob(blob_indices[0]);
+
+                    result.bFound = true;
+                    result.area = blob.area;
+                    result.bounding_box = blob.bounding_box + region.roi.tl();
+                    result.centroid =
+                        blob.centroid + cv::Point2f(static_cast<float>(region.roi.x), static_cast<float>(region.roi.y));
+                }
+            });
+    }
+}
+
+static bool resultsMatch(const SegmentationResult &a, const SegmentationResult &b)
+{
+    return
+        a.bFound == b.bFound &&
+        a.area == b.area &&
+        a.bounding_box == b.bounding_box &&
+        fabsf(a.centroid.x - b.centroid.x) < 1e-3f &&
+        fabsf(a.centroid.y - b.centroid.y) < 1e-3f &&
+        a.contour == b.contour;
+}
+
+// Plans the requests and checks the plan's pixel bounds and region count
+static bool checkPlan(
+    const char *name,
+    const std::vector<TrackerSegmentationRequest> &requests,
+    const size_t expected_region_count)
+{
+    std::vector<TrackerSegmentationRegion> regions;
+    planSegmentationRegions(k_frame_width, k_frame_height, requests, regions);
+
+    int request_pixel_count = 0;
+    unsigned char color_mask = 0;
+    for (const TrackerSegmentationRequest &request : requests)
+    {
+        request_pixel_count += request.search_roi.area();
+        color_mask |= static_cast<unsigned char>(1 << request.color_id);
+    }
+
+    int color_count = 0;
+    for (int color_index = 0; color_index < eCommonTrackingColorID::MAX_TRACKING_COLOR_TYPES; ++color_index)
+    {
+        color_count += ((color_mask & (1 << color_index)) != 0) ? 1 : 0;
+    }
+
+    int planned_request_count = 0;
+    int planned_pixel_count = 0;
+    for (const TrackerSegmentationRegion &region : regions)
+    {
+        planned_request_count += static_cast<int>(region.requests.size());
+        planned_pixel_count += getSegmentationRegionCost(region);
+    }
+
+    printf("%s: %d requests -> %d regions, %d blob pass pixels (%d unmerged)\n",
+        name, static_cast<int>(requests.size()), static_cast<int>(regions.size()),
+        planned_pixel_count, request_pixel_count);
+
+    bool bSuccess = true;
+
+    if (planned_request_count != static_cast<int>(requests.size()))
+    {
+        printf("FAILED: %s plan lost track of requests\n", name);
+        bSuccess = false;
+    }
+
+    if (planned_pixel_count > request_pixel_count ||
+        planned_pixel_count > color_count * k_frame_width * k_frame_height)
+    {
+        printf("FAILED: %s plan covers more pixels than the unmerged ROIs or one frame per color\n", name);
+        bSuccess = false;
+    }
+
+    if (regions.size() != expected_region_count)
+    {
+        printf("FAILED: %s plan expected %d regions\n", name, static_cast<int>(expected_region_count));
+        bSuccess = false;
+    }
+
+    return bSuccess;
+}
+
+int main(int, char**)
+{
+    bool bSuccess = true;
+
+    // Planning
+    {
+        std::vector<TrackerSegmentationRequest> requests;
+
+        // Differently colored controllers next to each other need a pass per color either way
+        requests.clear();
+        for (int device_index = 0; device_index < k_test_device_count; ++device_index)
+        {
+            requests.push_back(makeRequest(device_index, k_test_devices[device_index].color_id, k_test_devices[device_index].roi));
+        }
+        bSuccess &= checkPlan("two colors side by side", requests, 2);
+
+        // Three colors all over the frame mustn't turn into three full frame passes
+        requests.clear();
+        requests.push_back(makeRequest(0, eCommonTrackingColorID::Magenta, cv::Rect2i(0, 0, 400, 300)));
+        requests.push_back(makeRequest(1, eCommonTrackingColorID::Cyan, cv::Rect2i(240, 0, 400, 300)));
+        requests.push_back(makeRequest(2, eCommonTrackingColorID::Yellow, cv::Rect2i(120, 180, 400, 300)));
+        bSuccess &= checkPlan("three colors across the frame", requests, 3);
+
+        // The same color seen twice in overlapping ROIs shares a pass
+        requests.clear();
+        requests.push_back(makeRequest(0, eCommonTrackingColorID::Magenta, cv::Rect2i(100, 100, 200, 200)));
+        requests.push_back(makeRequest(1, eCommonTrackingColorID::Magenta, cv::Rect2i(150, 150, 200, 200)));
+        requests.push_back(makeRequest(2, eCommonTrackingColorID::Cyan, cv::Rect2i(120, 120, 200, 200)));
+        bSuccess &= checkPlan("one color twice", requests, 2);
+
+        // Big ROIs of one color that don't pair up well collapse into a single full frame pass
+        requests.clear();
+        requests.push_back(makeRequest(0, eCommonTrackingColorID::Magenta, cv::Rect2i(0, 0, 400, 260)));
+        requests.push_back(makeRequest(1, eCommonTrackingColorID::Magenta, cv::Rect2i(240, 220, 400, 260)));
+        requests.push_back(makeRequest(2, eCommonTrackingColorID::Magenta, cv::Rect2i(0, 220, 230, 260)));
+        requests.push_back(makeRequest(3, eCommonTrackingColorID::Magenta, cv::Rect2i(410, 0, 230, 210)));
+        bSuccess &= checkPlan("one color everywhere", requests, 1);
+    }
+
+    // Segmentation with overlapping color ranges
+    {
+        cv::Mat labels;
+        makeLabelImage(labels);
+
+        const unsigned char both_colors =
+            static_cast<unsigned char>((1 << k_test_devices[0].color_id) | (1 << k_test_devices[1].color_id));
+        const int overlap_pixel_count = cv::countNonZero(labels == both_colors);
+        printf("%d pixels fall in both color ranges\n", overlap_pixel_count);
+        if (overlap_pixel_count == 0)
+        {
+            printf("FAILED: test color ranges don't overlap on the spheres\n");
+            bSuccess = false;
+        }
+
+        // Each request on its own ROI, the way the tracker segments unmerged requests
+        std::vector<TrackerSegmentationRegion> own_regions;
+        // Both requests in one region spanning both ROIs
+        std::vector<TrackerSegmentationRegion> mixed_regions(1);
+        mixed_regions[0].roi = k_test_devices[0].roi | k_test_devices[1].roi;
+        mixed_regions[0].color_mask = both_colors;
+        // Both requests in one full frame region
+        std::vector<TrackerSegmentationRegion> full_frame_regions(1);
+        full_frame_regions[0].roi = cv::Rect2i(0, 0, k_frame_width, k_frame_height);
+        full_frame_regions[0].color_mask = both_colors;
+
+        for (int device_index = 0; device_index < k_test_device_count; ++device_index)
+        {
+            const TestDevice &device = k_test_devices[device_index];
+            const TrackerSegmentationRequest request = makeRequest(device_index, device.color_id, device.roi);
+
+            TrackerSegmentationRegion own_region;
+            own_region.roi = device.roi;
+            own_region.color_mask = static_cast<unsigned char>(1 << device.color_id);
+            own_region.requests.push_back(request);
+            own_regions.push_back(own_region);
+
+            mixed_regions[0].requests.push_back(request);
+            full_frame_regions[0].requests.push_back(request);
+        }
+
+        std::vector<SegmentationResult> own_results;
+        std::vector<SegmentationResult> mixed_results;
+        std::vector<SegmentationResult> full_frame_results;
+        segmentRegions(labels, own_regions, own_results);
+        segmentRegions(labels, mixed_regions, mixed_results);
+        segmentRegions(labels, full_frame_regions, full_frame_results);
+
+        for (int device_index = 0; device_index < k_test_device_count; ++device_index)
+        {
+            const TestDevice &device = k_test_devices[device_index];
+            const SegmentationResult &own = own_results[device_index];
+
+            // Every pixel of the sphere with the device's color bit should end up in the one blob
+            const int sphere_pixel_count = countSpherePixels(labels, device);
+
+            printf("%s: own ROI area %d centroid (%.2f, %.2f), mixed region area %d, full frame area %d, sphere pixels %d\n",
+                device.name, own.area, own.centroid.x, own.centroid.y,
+                mixed_results[device_index].area, full_frame_results[device_index].area, sphere_pixel_count);
+
+            if (!own.bFound || own.area != sphere_pixel_count)
+            {
+                printf("FAILED: %s sphere didn't come out as a single blob\n", device.name);
+                bSuccess = false;
+            }
+
+            if (!resultsMatch(own, mixed_results[device_index]) || !resultsMatch(own, full_frame_results[device_index]))
+            {
+                printf("FAILED: %s finds a different blob in a merged region\n", device.name);
+                bSuccess = false;
+            }
+        }
+    }
+
+    printf(bSuccess ? "PASSED\n" : "FAILED\n");
+
+    return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,312 @@
+// Accuracy and timing benchmark for the HMD point cloud pose solver (see OpenCVPointCloudPoseSolver).
+// The Morpheus LED constellation is projected through the default PS3Eye intrinsics at random poses,
+// with pixel noise, occluded LEDs and the occasional stray blob, then solved:
+//  * with the prior pose a frame behind (normal tracking)
+//  * with only the prior orientation (optically lost, IMU still good)
+//  * with no prior at all (cold start)
+//  * with only three LEDs left visible
+// Reports success rate, position/orientation error and solve time for each case.
+// Returns non-zero if tracking gets unreliable or the solve time breaks the per-frame budget.
+
+#include "OpenCVPointCloudPoseSolver.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+// Same as the default PS3Eye intrinsics in PS3EyeTracker.cpp.
+// The vision code negates fy, so the test does too.
+static const float k_frame_width = 640.f;
+static const float k_frame_height = 480.f;
+static const float k_focal_length_x = 554.2563f;
+static const float k_focal_length_y = -554.2563f;
+static const float k_principal_x = 320.f;
+static const float k_principal_y = 240.f;
+
+// Same as the tracking shape in MorpheusHMD.cpp
+static const float k_morpheus_points[][3] = {
+    { 0.f, 0.f, 0.f },
+    { 8.f, 4.5f, -2.5f },
+    { 9.f, 0.f, -10.f },
+    { 8.f, -4.5f, -2.5f },
+    { -8.f, 4.5f, -2.5f },
+    { -9.f, 0.f, -10.f },
+    { -8.f, -4.5f, -2.5f },
+    { 6.f, -1.f, -24.f },
+    { -6.f, -1.f, -24.f }
+};
+static const int k_morpheus_point_count = sizeof(k_morpheus_points) / sizeof(k_morpheus_points[0]);
+
+static const int k_trial_count = 2000;
+static const int k_max_visible_points = 6; // CommonDeviceTrackingProjection::MAX_POINT_CLOUD_POINT_COUNT
+static const float k_pixel_noise = 0.3f;
+static const float k_stray_blob_probability = 0.1f;
+static const double k_prior_position_error_cm = 2.0; // how far the device moves in a frame, roughly
+static const double k_prior_angle_error_degrees = 3.0;
+
+static const double k_min_tracking_success_rate = 0.98;
+static const double k_min_orientation_prior_success_rate = 0.95;
+// Medians, since a few blobs a couple of meters out leave the depth ambiguous by several cm
+static const double k_max_allowed_position_error_cm = 1.5;
+static const double k_max_allowed_angle_error_degrees = 2.0;
+static const double k_max_allowed_solve_time_us = 1000.0; // 99th percentile
+
+static const double k_degrees_to_radians = 3.14159265358979323846 / 180.0;
+
+enum ePriorType
+{
+    _Prior_Pose,
+    _Prior_Orientation,
+    _Prior_None
+};
+
+struct ScenarioStats
+{
+    std::vector<double> solve_times_us;
+    std::vector<double> position_errors_cm;
+    std::vector<double> angle_errors_degrees;
+    int success_count;
+    int trial_count;
+
+    ScenarioStats() : success_count(0), trial_count(0) {}
+
+    double getSuccessRate() const
+    {
+        return (trial_count > 0) ? static_cast<double>(success_count) / trial_count : 0.0;
+    }
+
+    static double percentile(std::vector<double> samples, double fraction)
+    {
+        if (samples.size() == 0)
+        {
+            return 0.0;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        return samples[std::min(static_cast<size_t>(fraction*samples.size()), samples.size() - 1)];
+    }
+
+    void print(const char *label) const
+    {
+        printf("%s: %d/%d solved (%.1f%%)\n", label, success_count, trial_count, 100.0*getSuccessRate());
+        printf("  position error: median %.3f cm, 90%% %.3f cm, 99%% %.3f cm\n",
+            percentile(position_errors_cm, 0.5), percentile(position_errors_cm, 0.9), percentile(position_errors_cm, 0.99));
+        printf("  angle error:    median %.3f deg, 99%% %.3f deg\n",
+            percentile(angle_errors_degrees, 0.5), percentile(angle_errors_degrees, 0.99));
+        printf("  solve time:     median %.1f us, 99%% %.1f us, max %.1f us\n",
+            percentile(solve_times_us, 0.5), percentile(solve_times_us, 0.99), percentile(solve_times_us, 1.0));
+    }
+};
+
+static cv::Matx33d rotationAboutAxis(int axis, double radians)
+{
+    const double c = cos(radians);
+    const double s = sin(radians);
+
+    switch (axis)
+    {
+    case 0:
+        return cv::Matx33d(1.0, 0.0, 0.0, 0.0, c, -s, 0.0, s, c);
+    case 1:
+        return cv::Matx33d(c, 0.0, s, 0.0, 1.0, 0.0, -s, 0.0, c);
+    default:
+        return cv::Matx33d(c, -s, 0.0, s, c, 0.0, 0.0, 0.0, 1.0);
+    }
+}
+
+static cv::Matx33d randomRotation(cv::RNG &rng, double max_degrees)
+{
+    const double max_radians = max_degrees*k_degrees_to_radians;
+
+    return
+        rotationAboutAxis(1, rng.uniform(-max_radians, max_radians)) *
+        rotationAboutAxis(0, rng.uniform(-max_radians, max_radians)) *
+        rotationAboutAxis(2, rng.uniform(-max_radians, max_radians));
+}
+
+static double computeAngleBetweenDegrees(const cv::Matx33d &a, const cv::Matx33d &b)
+{
+    const cv::Matx33d delta = a.t()*b;
+    const double cos_angle = std::min(std::max(0.5*(delta(0, 0) + delta(1, 1) + delta(2, 2) - 1.0), -1.0), 1.0);
+
+    return acos(cos_angle) / k_degrees_to_radians;
+}
+
+static void runScenario(
+    const OpenCVPointCloudPoseSolver &solver,
+    const std::vector<cv::Point3f> &model_points,
+    ePriorType prior_type,
+    int max_visible_points,
+    cv::RNG &rng,
+    ScenarioStats &stats)
+{
+    for (int trial_index = 0; trial_index < k_trial_count; ++trial_index)
+    {
+        // The headset faces the camera (its +Z towards the camera's -Z),
+        // turned at most 50 degrees away and 1-3 meters out
+        PointCloudPose true_pose;
+        true_pose.rotation = randomRotation(rng, 50.0)*rotationAboutAxis(1, 3.14159265358979323846);
+        true_pose.translation = cv::Vec3d(rng.uniform(-60.0, 60.0), rng.uniform(-40.0, 40.0), rng.uniform(100.0, 300.0));
+
+        // The LEDs that face the camera are the ones that show up
+        std::vector<cv::Point2f> image_points;
+        std::vector<int> visible_indices;
+        for (int point_index = 0; point_index < static_cast<int>(model_points.size()); ++point_index)
+        {
+            const cv::Point3f &model_point = model_points[point_index];
+            const cv::Vec3d camera_point = true_pose.rotation*cv::Vec3d(model_point.x, model_point.y, model_point.z) + true_pose.translation;
+            const cv::Vec3d facing = true_pose.rotation*cv::Vec3d(0.0, 0.0, 1.0);
+            const bool bBackLed = model_point.z < -20.f;
+
+            // Front LEDs show when the front faces the camera, the back ones only from behind or the side
+            if ((facing[2] < 0.0) == bBackLed && fabs(facing[2]) > 0.2)
+            {
+                continue;
+            }
+
+            const cv::Point2f pixel(
+                static_cast<float>(k_focal_length_x*camera_point[0] / camera_point[2] + k_principal_x),
+                static_cast<float>(k_focal_length_y*camera_point[1] / camera_point[2] + k_principal_y));
+
+            if (pixel.x >= 0.f && pixel.x < k_frame_width && pixel.y >= 0.f && pixel.y < k_frame_height)
+            {
+                visible_indices.push_back(point_index);
+            }
+        }
+
+        // Occlude random LEDs down to the number of blobs the tracker reports
+        while (static_cast<int>(visible_indices.size()) > max_visible_points)
+        {
+            visible_indices.erase(visible_indices.begin() + rng.uniform(0, static_cast<int>(visible_indices.size())));
+        }
+
+        if (static_cast<int>(visible_indices.size()) < 3)
+        {
+            continue;
+        }
+
+        for (auto it = visible_indices.begin(); it != visible_indices.end(); ++it)
+        {
+            const cv::Point3f &model_point = model_points[*it];
+            const cv::Vec3d camera_point = true_pose.rotation*cv::Vec3d(model_point.x, model_point.y, model_point.z) + true_pose.translation;
+
+            image_points.push_back(cv::Point2f(
+                static_cast<float>(k_focal_length_x*camera_point[0] / camera_point[2] + k_principal_x + rng.gaussian(k_pixel_noise)),
+                static_cast<float>(k_focal_length_y*camera_point[1] / camera_point[2] + k_principal_y + rng.gaussian(k_pixel_noise))));
+        }
+
+        // A reflection or some other light in the tracking color
+        if (max_visible_points > 3 && rng.uniform(0.f, 1.f) < k_stray_blob_probability)
+        {
+            image_points.push_back(cv::Point2f(rng.uniform(0.f, k_frame_width), rng.uniform(0.f, k_frame_height)));
+        }
+
+        // Blobs come in no particular order
+        for (int point_index = static_cast<int>(image_points.size()) - 1; point_index > 0; --point_index)
+        {
+            std::swap(image_points[point_index], image_points[rng.uniform(0, point_index + 1)]);
+        }
+
+        // Last frame's pose, off by about a frame's worth of motion
+        PointCloudPose prior_pose;
+        prior_pose.rotation = randomRotation(rng, k_prior_angle_error_degrees)*true_pose.rotation;
+        prior_pose.translation = true_pose.translation + cv::Vec3d(
+            rng.gaussian(k_prior_position_error_cm), rng.gaussian(k_prior_position_error_cm), rng.gaussian(k_prior_position_error_cm));
+
+        PointCloudPoseSolution solution;
+        const auto solve_start = std::chrono::high_resolution_clock::now();
+        const bool bSolved = solver.solve(
+            image_points,
+            (prior_type == _Prior_Pose) ? &prior_pose : nullptr,
+            (prior_type != _Prior_None) ? &prior_pose.rotation : nullptr,
+            solution);
+        const auto solve_end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::micro> solve_time = solve_end - solve_start;
+
+        ++stats.trial_count;
+        stats.solve_times_us.push_back(solve_time.count());
+
+        if (bSolved)
+        {
+            const cv::Vec3d position_error = solution.pose.translation - true_pose.translation;
+
+            ++stats.success_count;
+            stats.position_errors_cm.push_back(sqrt(position_error.dot(position_error)));
+            stats.angle_errors_degrees.push_back(computeAngleBetweenDegrees(solution.pose.rotation, true_pose.rotation));
+        }
+    }
+}
+
+int main(int, char**)
+{
+    const cv::Matx33f camera_matrix(
+        k_focal_length_x, 0.f, k_principal_x,
+        0.f, k_focal_length_y, k_principal_y,
+        0.f, 0.f, 1.f);
+
+    std::vector<cv::Point3f> model_points;
+    for (int point_index = 0; point_index < k_morpheus_point_count; ++point_index)
+    {
+        model_points.push_back(cv::Point3f(
+            k_morpheus_points[point_index][0], k_morpheus_points[point_index][1], k_morpheus_points[point_index][2]));
+    }
+
+    const PointCloudPoseSolverSettings settings;
+    const OpenCVPointCloudPoseSolver solver(model_points, camera_matrix, settings);
+    cv::RNG rng(0x4d6f7270);
+
+    ScenarioStats tracking_stats;
+    ScenarioStats orientation_prior_stats;
+    ScenarioStats cold_start_stats;
+    ScenarioStats occluded_stats;
+
+    runScenario(solver, model_points, _Prior_Pose, k_max_visible_points, rng, tracking_stats);
+    runScenario(solver, model_points, _Prior_Orientation, k_max_visible_points, rng, orientation_prior_stats);
+    runScenario(solver, model_points, _Prior_None, k_max_visible_points, rng, cold_start_stats);
+    runScenario(solver, model_points, _Prior_Pose, 3, rng, occluded_stats);
+
+    tracking_stats.print("Prior pose");
+    orientation_prior_stats.print("Prior orientation only");
+    cold_start_stats.print("No prior (successive frames keep searching)");
+    occluded_stats.print("Prior pose, 3 LEDs visible");
+
+    bool bSuccess = true;
+
+    if (tracking_stats.getSuccessRate() < k_min_tracking_success_rate)
+    {
+        printf("FAILED: tracking solved less than %.0f%% of the time\n", 100.0*k_min_tracking_success_rate);
+        bSuccess = false;
+    }
+
+    if (orientation_prior_stats.getSuccessRate() < k_min_orientation_prior_success_rate)
+    {
+        printf("FAILED: reacquiring from the prior orientation solved less than %.0f%% of the time\n", 100.0*k_min_orientation_prior_success_rate);
+        bSuccess = false;
+    }
+
+    if (ScenarioStats::percentile(tracking_stats.position_errors_cm, 0.5) > k_max_allowed_position_error_cm ||
+        ScenarioStats::percentile(tracking_stats.angle_errors_degrees, 0.5) > k_max_allowed_angle_error_degrees)
+    {
+        printf("FAILED: median tracking error exceeds %.1f cm or %.1f degrees\n",
+            k_max_allowed_position_error_cm, k_max_allowed_angle_error_degrees);
+        bSuccess = false;
+    }
+
+    const ScenarioStats *all_stats[] = { &tracking_stats, &orientation_prior_stats, &cold_start_stats, &occluded_stats };
+    for (const ScenarioStats *stats : all_stats)
+    {
+        if (ScenarioStats::percentile(stats->solve_times_us, 0.99) > k_max_allowed_solve_time_us)
+        {
+            printf("FAILED: solve time exceeds %.0f us\n", k_max_allowed_solve_time_us);
+            bSuccess = false;
+            break;
+        }
+    }
+
+    printf(bSuccess ? "PASSED\n" : "FAILED\n");
+
+    return bSuccess ? 0 : 1;
+}
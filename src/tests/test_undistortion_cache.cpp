@@ -0,0 +1,156 @@
+// Accuracy report for the tracker contour undistortion cache (see OpenCVUndistortionCache).
+// A dense set of sub-pixel points covering the frame is undistorted through the cache and
+// compared against cv::undistortPoints:
+//  * max/mean error in pixels for each grid step, for both normalized and pixel output
+//  * time taken by each method
+// Returns non-zero if the default grid step misses cv::undistortPoints by more than k_max_allowed_error_px.
+
+#include "OpenCVUndistortionCache.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+// Same as the default PS3Eye intrinsics in PS3EyeTracker.cpp.
+// The vision code negates fy, so the test does too.
+static const float k_frame_width = 640.f;
+static const float k_frame_height = 480.f;
+static const float k_focal_length_x = 554.2563f;
+static const float k_focal_length_y = -554.2563f;
+static const float k_principal_x = 320.f;
+static const float k_principal_y = 240.f;
+static const float k_distortion_k1 = -0.10771770030260086f;
+static const float k_distortion_k2 = 0.1213262677192688f;
+static const float k_distortion_k3 = 0.04875476285815239f;
+static const float k_distortion_p1 = 0.00091733073350042105f;
+static const float k_distortion_p2 = 0.00010589254816295579f;
+
+static const float k_max_allowed_error_px = 0.05f;
+static const int k_grid_steps[] = { 4, 8, 16 };
+static const int k_grid_step_count = sizeof(k_grid_steps) / sizeof(int);
+
+struct PointErrorStats
+{
+    double max_error;
+    double total_error;
+    int sample_count;
+
+    PointErrorStats() : max_error(0.0), total_error(0.0), sample_count(0) {}
+
+    // Errors get measured in pixels, so normalized points get scaled by the focal length first
+    void addSamples(const std::vector<cv::Point2f> &exact, const std::vector<cv::Point2f> &approx, float scale_x, float scale_y)
+    {
+        for (size_t point_index = 0; point_index < exact.size(); ++point_index)
+        {
+            const double dx = (exact[point_index].x - approx[point_index].x)*scale_x;
+            const double dy = (exact[point_index].y - approx[point_index].y)*scale_y;
+            const double error = sqrt(dx*dx + dy*dy);
+
+            max_error = std::max(max_error, error);
+            total_error += error;
+            ++sample_count;
+        }
+    }
+
+    void print(const char *label) const
+    {
+        printf("  %-10s max error = %.5f px, mean error = %.5f px (%d points)\n",
+            label, max_error, (sample_count > 0) ? total_error / sample_count : 0.0, sample_count);
+    }
+};
+
+int main(int, char**)
+{
+    const cv::Matx33f camera_matrix(
+        k_focal_length_x, 0.f, k_principal_x,
+        0.f, k_focal_length_y, k_principal_y,
+        0.f, 0.f, 1.f);
+    const cv::Matx<float, 5, 1> distortions(
+        k_distortion_k1, k_distortion_k2, k_distortion_p1, k_distortion_p2, k_distortion_k3);
+
+    // Sub-pixel points over the whole frame, plus a border outside of it to exercise the fallback path
+    std::vector<cv::Point2f> test_points;
+    for (float y = -4.f; y < k_frame_height + 4.f; y += 0.73f)
+    {
+        for (float x = -4.f; x < k_frame_width + 4.f; x += 0.61f)
+        {
+            test_points.push_back(cv::Point2f(x, y));
+        }
+    }
+
+    std::vector<cv::Point2f> exact_normalized;
+    std::vector<cv::Point2f> exact_pixels;
+
+    const auto exact_start = std::chrono::high_resolution_clock::now();
+    cv::undistortPoints(test_points, exact_normalized, camera_matrix, distortions);
+    const auto exact_end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::milli> exact_time = exact_end - exact_start;
+
+    cv::undistortPoints(test_points, exact_pixels, camera_matrix, distortions, cv::noArray(), camera_matrix);
+
+    printf("cv::undistortPoints: %d points in %.2f ms\n", static_cast<int>(test_points.size()), exact_time.count());
+
+    bool bSuccess = true;
+
+    for (int step_index = 0; step_index < k_grid_step_count; ++step_index)
+    {
+        const int grid_step = k_grid_steps[step_index];
+        OpenCVUndistortionCache cache;
+
+        const auto build_start = std::chrono::high_resolution_clock::now();
+        cache.build(camera_matrix, distortions, static_cast<int>(k_frame_width), static_cast<int>(k_frame_height), grid_step);
+        const auto build_end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> build_time = build_end - build_start;
+
+        std::vector<cv::Point2f> cached_normalized;
+        std::vector<cv::Point2f> cached_pixels;
+
+        const auto lookup_start = std::chrono::high_resolution_clock::now();
+        cache.undistortPointsNormalized(test_points, cached_normalized);
+        const auto lookup_end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double, std::milli> lookup_time = lookup_end - lookup_start;
+
+        cache.undistortPointsPixels(test_points, cached_pixels);
+
+        PointErrorStats normalized_stats;
+        PointErrorStats pixel_stats;
+        normalized_stats.addSamples(exact_normalized, cached_normalized, k_focal_length_x, k_focal_length_y);
+        pixel_stats.addSamples(exact_pixels, cached_pixels, 1.f, 1.f);
+
+        printf("%d pixel grid step: built in %.2f ms, undistorted in %.2f ms\n",
+            grid_step, build_time.count(), lookup_time.count());
+        normalized_stats.print("normalized");
+        pixel_stats.print("pixels");
+
+        if (grid_step == DEFAULT_UNDISTORTION_GRID_STEP &&
+            (normalized_stats.max_error > k_max_allowed_error_px || pixel_stats.max_error > k_max_allowed_error_px))
+        {
+            printf("  FAILED: default grid step exceeds %.3f px\n", k_max_allowed_error_px);
+            bSuccess = false;
+        }
+    }
+
+    // The cache has to notice when the intrinsics it was built from change
+    {
+        OpenCVUndistortionCache cache;
+        cv::Matx<float, 5, 1> changed_distortions = distortions;
+        changed_distortions(0) += 0.01f;
+
+        cache.build(camera_matrix, distortions, static_cast<int>(k_frame_width), static_cast<int>(k_frame_height));
+
+        if (!cache.getIsBuiltFor(camera_matrix, distortions, static_cast<int>(k_frame_width), static_cast<int>(k_frame_height)) ||
+            cache.getIsBuiltFor(camera_matrix, changed_distortions, static_cast<int>(k_frame_width), static_cast<int>(k_frame_height)) ||
+            cache.getIsBuiltFor(camera_matrix, distortions, 320, 240))
+        {
+            printf("FAILED: cache doesn't track the intrinsics it was built from\n");
+            bSuccess = false;
+        }
+    }
+
+    printf(bSuccess ? "PASSED\n" : "FAILED\n");
+
+    return bSuccess ? 0 : 1;
+}